@@ -50,9 +50,10 @@ else
 fi
 
 # Merge snapshots made by individual MPI processes for visualization.
+# The number of processes is needed if NPROCX, NPROCY or NPROCZ is 0.
 echo "$sep"
 echo "Prepare snapshots"
-snapmerge $config_file
+snapmerge $config_file $nmpiprocs
 if [ $? -eq 0 ]; then
     echo "OK"
 else
@@ -54,4 +54,52 @@ void CPML_ini_elastic(int * xb, int * yb, int * zb){
 
 }
 
-	
+
+/*------------------------------------------------------------------------
+ *  Division of the local grid into the boxes of the CPML frame: the
+ *  layers in x are at i<xb[0] and i>xb[1], those in y and z accordingly.
+ *  Each box lies either within one layer or outside the layers of each
+ *  axis (faces, edges and corners of the frame), so that the kernels need
+ *  no tests at the grid points. The interior box is included only if
+ *  interior is set. Returns the number of boxes (at most 27).
+ *  ----------------------------------------------------------------------*/
+
+int CPML_boxes(const int * xb, const int * yb, const int * zb, int interior, CpmlBox * box){
+
+	extern int NX, NY, NZ, FW;
+
+	const int n[3]={NX, NY, NZ};
+	const int * b[3]={xb, yb, zb};
+	int s1[3][3], s2[3][3], c[3][3], o[3][3], ns[3];
+	int a, ix, iy, iz, nbox=0;
+
+	/* segments of each axis: first layer, inside, last layer */
+	for (a=0;a<3;a++){
+		ns[a]=0;
+		if (b[a][0]>1){
+			s1[a][ns[a]]=1; s2[a][ns[a]]=b[a][0]-1;
+			c[a][ns[a]]=1; o[a][ns[a]]=0; ns[a]++;
+		}
+		s1[a][ns[a]]=b[a][0]; s2[a][ns[a]]=b[a][1];
+		c[a][ns[a]]=0; o[a][ns[a]]=0; ns[a]++;
+		if (b[a][1]<n[a]){
+			s1[a][ns[a]]=b[a][1]+1; s2[a][ns[a]]=n[a];
+			c[a][ns[a]]=1; o[a][ns[a]]=b[a][1]-FW; ns[a]++;
+		}
+	}
+
+	for (iy=0;iy<ns[1];iy++)
+	for (ix=0;ix<ns[0];ix++)
+	for (iz=0;iz<ns[2];iz++){
+		if ((!interior) && (!c[0][ix]) && (!c[1][iy]) && (!c[2][iz])) continue;
+		box[nbox].box.nx1=s1[0][ix]; box[nbox].box.nx2=s2[0][ix];
+		box[nbox].box.ny1=s1[1][iy]; box[nbox].box.ny2=s2[1][iy];
+		box[nbox].box.nz1=s1[2][iz]; box[nbox].box.nz2=s2[2][iz];
+		box[nbox].cx=c[0][ix]; box[nbox].ox=o[0][ix];
+		box[nbox].cy=c[1][iy]; box[nbox].oy=o[1][iy];
+		box[nbox].cz=c[2][iz]; box[nbox].oz=o[2][iz];
+		nbox++;
+	}
+
+	return nbox;
+}
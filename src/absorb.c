@@ -1,11 +1,18 @@
 /* ------------------------------------------------------------------------
  *   Create dissipative boundarie around the model grid
- *   The dissipative coefficients are stored in the 3-D array
- *   absorb_coeff. The interior of the model is weighted by the
- *   coefficient 1. In the absorbing frame the coefficients 
- *   are less than one. Coefficients are computed using 
- *   exponential damping (see Cerjan et al., 1985, 
- *   Geophysics, 50, 705-708)
+ *   The interior of the model is weighted by the coefficient 1.
+ *   In the absorbing frame the coefficients are less than one.
+ *   Coefficients are computed using exponential damping
+ *   (see Cerjan et al., 1985, Geophysics, 50, 705-708)
+ *
+ *   The coefficient at a grid point depends only on its distance to
+ *   the nearest absorbing face, so it is the smallest of three 1-D
+ *   profiles in x, y and z. The profiles and the undamped interior box
+ *   are stored in an AbsorbFrame (see data_structures.h) instead of a
+ *   3-D array, and absorb_damp() multiplies the wavefield only in the
+ *   frame. (If the two faces of an axis overlap within a subdomain of
+ *   less than 2*FW grid points, the coefficient of the back face is used
+ *   there, as in former versions with a 3-D array.)
  *
  ------------------------------------------------------------------------*/
 
@@ -13,20 +20,50 @@
 #include "globvar.h"
 
 
-void absorb(float *** absorb_coeff){
+/* 1-D profile p[1-na..n+na] of an axis of the grid, off is the
+   number of global grid points before the first one of this PE and ng
+   the number of global grid points, front and back tell if the first
+   and last face of the global grid are absorbing. The ghost zone is set
+   as on the neighbouring PE; it is 1 beyond the global grid. Returns the
+   longest range [*i1..*i2] of ones. */
+static void absorb_profile(float *p, int n, int na, int off, int ng,
+		int front, int back, const float *coeff, int ifw, int *i1, int *i2){
+
+	int i, g, run=0;
+
+	*i1=1; *i2=0;
+	for (i=1-na;i<=n+na;i++){
+		g=off+i;
+		p[i]=1.0;
+		if ((g>=1) && (g<=ng)){
+			if ((front) && (g<=ifw)) p[i]=coeff[g];
+			if ((back) && (ng-g+1<=ifw)) p[i]=coeff[ng-g+1];
+		}
+
+		run=(p[i]==1.0) ? run+1 : 0;
+		if (run>*i2-*i1+1){
+			*i1=i-run+1;
+			*i2=i;
+		}
+	}
+}
+
+
+/* compute the absorbing frame of the local grid and a ghost zone of na
+   grid points */
+void absorb(AbsorbFrame *frame, int na){
 
 	/* extern variables */
 
 	extern float DAMPING;
 	extern int FREE_SURF, NX, NY, NZ, BOUNDARY, FW;
-	extern int NPROCX, NPROCY, NPROCZ, MYID, POS[4];
-	
+	extern int NXG, NYG, NZG, OFFX[], OFFY[], OFFZ[], MYID, POS[4];
+
 	/* local variables */
-	int i, j, k, ifw, ii, jj, kk, xb, yb, zb, xe, ye, ze;
+	int i, ifw;
 	float amp, a, *coeff;
-	char modfile[STRING_SIZE];
 	extern FILE *FP;
-	
+
 	if (MYID==0){
 		fprintf(FP,"\n **Message from absorb (printed by PE %d):\n",MYID);
 		fprintf(FP," Coefficients for absorbing frame are now calculated.\n");
@@ -38,115 +75,74 @@ void absorb(float *** absorb_coeff){
 	ifw=FW;  /* frame width in gridpoints */
 	coeff=vector(1,ifw);
 	a=sqrt(-log(amp)/((ifw-1)*(ifw-1)));
-	
+
 	for (i=1;i<=ifw;i++)
 		coeff[i]=exp(-(a*a*(ifw-i)*(ifw-i)));
-	
+
 	if (MYID==0){
 		fprintf(FP," Table of coefficients \n # \t coeff \n");
 		/*fprintf(FP," ifw=%d \t a=%f amp=%f \n", ifw,a,amp); */
 		for (i=1;i<=ifw;i++)
 			fprintf(FP," %d \t %5.3f \n", i, coeff[i]);
-	}	
-	
-
-	/* initialize array of coefficients with one */
-	for (k=1;k<=NZ;k++)
-	for (j=1;j<=NY;j++)
-	for (i=1;i<=NX;i++) absorb_coeff[j][i][k]=1.0;
-
-
-	/* compute coefficients for left and right grid boundaries (x-direction) */
-	if ((!BOUNDARY) && (POS[1]==0)){
-		zb=1; yb=1; ye=NY; ze=NZ;
-		for (i=1;i<=ifw;i++){
-			if (POS[3]==0) zb=i;
-			if (POS[3]==NPROCZ-1) ze=NZ-i+1;
-			if ((POS[2]==0) && (!(FREE_SURF))) yb=i;
-			if (POS[2]==NPROCY-1) ye=NY-i+1;
-			for (k=zb;k<=ze;k++)
-				for (j=yb;j<=ye;j++)
-					absorb_coeff[j][i][k]=coeff[i];
-		}
-	}
-			
-	if ((!BOUNDARY) && (POS[1]==NPROCX-1)){
-		zb=1; yb=1; ye=NY; ze=NZ;
-		for (i=1;i<=ifw;i++){
-			ii=NX-i+1;
-			if (POS[3]==0) zb=i;
-			if (POS[3]==NPROCZ-1) ze=NZ-i+1;
-			if ((POS[2]==0) && (!(FREE_SURF))) yb=i;
-			if (POS[2]==NPROCY-1) ye=NY-i+1;
-			for (k=zb;k<=ze;k++)
-				for (j=yb;j<=ye;j++)
-					absorb_coeff[j][ii][k]=coeff[i];
-		}
-	}
-	
-	/* compute coefficients for front and backward grid boundaries (z-direction) */
-			
-	if ((!BOUNDARY) && (POS[3]==0)){
-		xb=1; yb=1; ye=NY; xe=NX;
-		for (k=1;k<=ifw;k++){
-			if (POS[1]==0) xb=k;
-			if (POS[1]==NPROCX-1) xe=NX-k+1;
-			if ((POS[2]==0) && (!(FREE_SURF))) yb=k;
-			if (POS[2]==NPROCY-1) ye=NY-k+1;
-			for (i=xb;i<=xe;i++)
-				for (j=yb;j<=ye;j++)
-					absorb_coeff[j][i][k]=coeff[k];
-		}
-	}
-
-			
-	if ((!BOUNDARY) && (POS[3]==NPROCZ-1)){
-		xb=1; yb=1; ye=NY; xe=NX;
-		for (k=1;k<=ifw;k++){
-			kk=NZ-k+1;
-			if (POS[1]==0) xb=k;
-			if (POS[1]==NPROCX-1) xe=NX-k+1;
-			if ((POS[2]==0) && (!(FREE_SURF))) yb=k;
-			if (POS[2]==NPROCY-1) ye=NY-k+1;
-			for (i=xb;i<=xe;i++)
-				for (j=yb;j<=ye;j++)
-					absorb_coeff[j][i][kk]=coeff[k];
-		}
 	}
 
-	/* compute coefficients for top and bottom grid boundaries (y-direction) */
-
-	if ((POS[2]==0) && (!(FREE_SURF))){
-		xb=1; zb=1; ze=NZ; xe=NX;
-		for (j=1;j<=ifw;j++){
-			if ((!BOUNDARY) && (POS[1]==0)) xb=j;
-			if ((!BOUNDARY) && (POS[1]==NPROCX-1)) xe=NX-j+1;
-			if ((!BOUNDARY) && (POS[3]==0)) zb=j;
-			if ((!BOUNDARY) && (POS[3]==NPROCZ-1)) ze=NZ-j+1;
-			for (i=xb;i<=xe;i++)
-				for (k=zb;k<=ze;k++)
-					absorb_coeff[j][i][k]=coeff[j];
-		}
-	}
-
-	if (POS[2]==NPROCY-1){
-		xb=1; zb=1; ze=NZ; xe=NX;
-		for (j=1;j<=ifw;j++){
-			jj=NY-j+1;
-			if ((!BOUNDARY) && (POS[1]==0)) xb=j;
-			if ((!BOUNDARY) && (POS[1]==NPROCX-1)) xe=NX-j+1;
-			if ((!BOUNDARY) && (POS[3]==0)) zb=j;
-		   if ((!BOUNDARY) && (POS[3]==NPROCZ-1)) ze=NZ-j+1;
-			for (i=xb;i<=xe;i++)
-				for (k=zb;k<=ze;k++)
-					absorb_coeff[jj][i][k]=coeff[j];
-		}
-	}
+	frame->na=na;
+	frame->x=vector(1-na,NX+na);
+	frame->y=vector(1-na,NY+na);
+	frame->z=vector(1-na,NZ+na);
 
-	sprintf(modfile,"model/absorb.bin");
+	/* left and right grid boundaries (x-direction), front and back
+	   grid boundaries (z-direction), top and bottom grid boundaries
+	   (y-direction) */
+	absorb_profile(frame->x,NX,na,OFFX[POS[1]],NXG,!BOUNDARY,!BOUNDARY,coeff,ifw,&frame->x1,&frame->x2);
+	absorb_profile(frame->z,NZ,na,OFFZ[POS[3]],NZG,!BOUNDARY,!BOUNDARY,coeff,ifw,&frame->z1,&frame->z2);
+	absorb_profile(frame->y,NY,na,OFFY[POS[2]],NYG,!FREE_SURF,1,coeff,ifw,&frame->y1,&frame->y2);
 
 	free_vector(coeff,1,ifw);
 }
 
 
+void absorb_free(AbsorbFrame *frame){
+
+	extern int NX, NY, NZ;
+	int na=frame->na;
+
+	free_vector(frame->x,1-na,NX+na);
+	free_vector(frame->y,1-na,NY+na);
+	free_vector(frame->z,1-na,NZ+na);
+}
+
 
+/* damp the n fields u[0..n-1] at gridpoints [nx1...nx2][ny1...ny2][nz1...nz2];
+   in the rows of the undamped box only the grid points of the z-frame
+   are multiplied */
+void absorb_damp(const AbsorbFrame *frame, int nx1, int nx2, int ny1, int ny2,
+		int nz1, int nz2, int n, float ***u[]){
+
+	const float *px=frame->x, *py=frame->y, *pz=frame->z;
+	float c, ***w;
+	int i, j, k, m, kb, kc;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+	private(i, k, m, kb, kc, c, w)
+#endif
+	for (j=ny1;j<=ny2;j++){
+		for (i=nx1;i<=nx2;i++){
+			c=min(py[j],px[i]);
+			if ((j>=frame->y1) && (j<=frame->y2) && (i>=frame->x1) && (i<=frame->x2)
+					&& (frame->z1<=frame->z2)){
+				kb=min(nz2,frame->z1-1);
+				kc=max(nz1,frame->z2+1);
+			} else {
+				kb=nz2;
+				kc=nz2+1;
+			}
+			for (m=0;m<n;m++){
+				w=u[m];
+				for (k=nz1;k<=kb;k++) w[j][i][k]*=min(c,pz[k]);
+				for (k=kc;k<=nz2;k++) w[j][i][k]*=min(c,pz[k]);
+			}
+		}
+	}
+}
@@ -1,32 +1,96 @@
 /*-------------------------------------------------------------
   * Cat seismograms (collect seismogram portions from each PE for collective output)
   *
+  * Only PE 0 writes the seismograms, so the traces of the other PEs are
+  * sent to PE 0 point-to-point and received directly into their rows of
+  * the global section. PE 0 learns the global trace numbers of each PE
+  * (ascending, as marked in recswitch) with MPI_Gatherv; the traces of a
+  * PE are placed by an indexed datatype. No PE but PE 0 holds the global
+  * section.
   *------------------------------------------------------------- */
 
 #include "fd.h"
 #include "globvar.h"
 
 
+/*
+ * Collect the seismogram section of all PEs on PE 0.
+ *
+ * Parameters
+ * ----------
+ * data :
+ *     Local section data[1..ntr_loc][1..ns] of this PE.
+ * fulldata :
+ *     Global section fulldata[1..ntr_glob][1..ns], only used on PE 0.
+ * recswitch :
+ *     recswitch[i] is 1 if global trace i is recorded by this PE.
+ */
 void	catseis(float **data, float **fulldata, int *recswitch, int ntr_glob, int ns) {
-	int		i, j, k;
-	float		**fulldata2;
 
-	/* temporary global data array for MPI-exchange */
-	fulldata2 = fmatrix(1,ntr_glob,1,ns);
+	extern int MYID, NP;
 
-	k = 0;	/* trace counter for local data array */
+	int		i, j, k, r, ntr_loc = 0, ntr_sum;
+	int		*traces, *counts = NULL, *displs = NULL, *alltraces = NULL;
+	MPI_Request	*req = NULL;
+	MPI_Datatype	rows;
 
-	/* loop over global traces: copy traces of local array	*/
-	/* to appropriate locations in the global array		*/
-	for(i=1;i<=ntr_glob;i++)
-	{
-		if (recswitch[i]) {
-			k++;
-			for(j=1;j<=ns;j++)	fulldata2[i][j] = data[k][j];
+	/* global trace numbers of the local traces */
+	traces = ivector(1,ntr_glob);
+	for (i=1;i<=ntr_glob;i++)
+		if (recswitch[i]) traces[++ntr_loc] = i - 1;
+
+	if (MYID == 0) {
+		counts = ivector(0,NP-1);
+		displs = ivector(0,NP-1);
+	}
+	MPI_Gather(&ntr_loc, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if (MYID == 0) {
+		ntr_sum = 0;
+		for (r=0;r<NP;r++) {
+			displs[r] = ntr_sum;
+			ntr_sum += counts[r];
 		}
+		if (ntr_sum != ntr_glob)
+			err("catseis: %d of %d receivers are assigned to a PE", ntr_sum, ntr_glob);
+		alltraces = ivector(0,ntr_glob-1);
+	}
+	MPI_Gatherv(&traces[1], ntr_loc, MPI_INT, alltraces, counts, displs, MPI_INT, 0, MPI_COMM_WORLD);
+
+	if (MYID != 0) {
+		if (ntr_loc > 0)
+			MPI_Send(&data[1][1], ntr_loc * ns, MPI_FLOAT, 0, TAG1, MPI_COMM_WORLD);
+		free_ivector(traces,1,ntr_glob);
+		return;
 	}
 
-	MPI_Allreduce(&fulldata2[1][1], &fulldata[1][1], ntr_glob*ns, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+	req = (MPI_Request *) malloc((size_t) NP * sizeof(MPI_Request));
+	if (!req) err("allocation failure in function catseis() ");
+	req[0] = MPI_REQUEST_NULL;
+	for (r=1;r<NP;r++) {
+		req[r] = MPI_REQUEST_NULL;
+		if (counts[r] == 0) continue;
+		/* rows of the global section for the traces of PE r */
+		for (k=0;k<counts[r];k++) alltraces[displs[r]+k] *= ns;
+		MPI_Type_create_indexed_block(counts[r], ns, &alltraces[displs[r]], MPI_FLOAT, &rows);
+		MPI_Type_commit(&rows);
+		MPI_Irecv(&fulldata[1][1], 1, rows, r, TAG1, MPI_COMM_WORLD, &req[r]);
+		MPI_Type_free(&rows);
+	}
+
+	/* own traces */
+	for (k=1;k<=ntr_loc;k++)
+		for (j=1;j<=ns;j++) fulldata[traces[k]+1][j] = data[k][j];
+
+	MPI_Waitall(NP, req, MPI_STATUSES_IGNORE);
+
+	/* write zeros as +0.0 as the former summation over all PEs did (the IBM
+	   conversion of -0.0 is not zero) */
+	for (i=1;i<=ntr_glob;i++)
+		for (j=1;j<=ns;j++) fulldata[i][j] += 0.0f;
 
-	free_matrix(fulldata2, 1,ntr_glob,1,ns);
+	free(req);
+	free_ivector(alltraces,0,ntr_glob-1);
+	free_ivector(displs,0,NP-1);
+	free_ivector(counts,0,NP-1);
+	free_ivector(traces,1,ntr_glob);
 }
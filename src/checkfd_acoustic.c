@@ -18,8 +18,8 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 	/* external variables */
 	extern float DX, DY, DZ, DT, TS, TIME, TSNAP2;
 	extern int NX, NY, NZ, MYID, IDX, IDY, IDZ, FW, POS[4], NT, NDT, NDTSHIFT;
-	extern int FDCOEFF, ABS_TYPE;
-	extern int NPROCX, NPROCY,NPROCZ, FW, SRCREC, FREE_SURF;
+	extern int FDCOEFF, ABS_TYPE, TIME_BLOCK;
+	extern int NXG, NYG, NZG, FW, SRCREC, FREE_SURF;
 	extern int SNAP, SEISMO, CHECKPTREAD, CHECKPTWRITE, SEIS_FORMAT[6], SNAP_FORMAT;
 	extern int FDORDER;
 	extern char SEIS_FILE[STRING_SIZE], CHECKPTFILE[STRING_SIZE], SNAP_FILE[STRING_SIZE];
@@ -29,7 +29,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 	float  c, cmax_p=0.0, cmin_p=1e9, fmax, cwater=1.0e-1;
 	float  cmax=0.0, cmin=1e9, dtstab, cmax_r, cmin_r, g=0.0, gamma=0.0, dhmax, dhmin;
 	float snapoutx=0.0, snapouty=0.0, snapoutz=0.0;
-	float srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+	float srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 	float srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 	int nfw=FW;
 	int i, j, k, ny1=1, nx, ny, nz;
@@ -46,6 +46,10 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 	fprintf(fp,"\n ************ CHECKS OF INPUT FILE PARAMETERS  ************");
 	fprintf(fp,"\n **********************************************************\n\n");
 	fprintf(fp,"\n **Message from checkfd (printed by PE %d):\n",MYID);
+
+	/* temporal blocking is only implemented for the absorbing frame */
+	if ((TIME_BLOCK>1) && (ABS_TYPE!=2))
+		err(" TIME_BLOCK>1 requires ABS_TYPE=2. ");
 	fprintf(fp,"\n\n ------------------ CHECK OUTPUT FILES --------------------------\n");	
 
 	/* The original checks might delete files accidentally that would not be overwritten anyway. 
@@ -422,9 +426,9 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 		snapoutx=NX/(float)IDX;
 		snapouty=NY/(float)IDY;
 		snapoutz=NZ/(float)IDZ;
-		fprintf(fp,"    Output of snapshot gridpoints per node (NX/NPROCX/IDX) %8.2f .\n", snapoutx);
-		fprintf(fp,"    Output of snapshot gridpoints per node (NY/NPROCY/IDY) %8.2f .\n", snapouty);
-		fprintf(fp,"    Output of snapshot gridpoints per node (NZ/NPROCZ/IDZ) %8.2f .\n", snapoutz);
+		fprintf(fp,"    Output of snapshot gridpoints per node (NX/IDX) %8.2f .\n", snapoutx);
+		fprintf(fp,"    Output of snapshot gridpoints per node (NY/IDY) %8.2f .\n", snapouty);
+		fprintf(fp,"    Output of snapshot gridpoints per node (NZ/IDZ) %8.2f .\n", snapoutz);
 
 		if (snapoutx-(int)snapoutx>0)
 			err("\n\n Ratio NX-NPROCX-IDX must be whole-numbered \n\n");
@@ -442,12 +446,12 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 	}
 
 	if ((SEISMO>0) && (MYID==0)) {
-		srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+		srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 		srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 		fprintf(fp,"\n Checking for receiver position(s) specified in input file.\n");
-		fprintf(fp,"    Global grid size in m : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",DX,NX*DX*NPROCX,DY,NY*DY*NPROCY,DZ,NZ*DZ*NPROCZ);
-		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DY,NY*DY*NPROCY-FW*DY,FW*DZ,NZ*DZ*NPROCZ-FW*DZ);
-		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DY,NY*DY*NPROCY-FW*DY,DZ,NZ*DZ*NPROCZ-FW*DZ);
+		fprintf(fp,"    Global grid size in m : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",DX,NXG*DX,DY,NYG*DY,DZ,NZG*DZ);
+		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,FW*DY,NYG*DY-FW*DY,FW*DZ,NZG*DZ-FW*DZ);
+		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,FW*DY,NYG*DY-FW*DY,DZ,NZG*DZ-FW*DZ);
 
 		/* find maximum and minimum source positions coordinate ---- from input file*/
 		/*note that "y" is used for the vertical coordinate */
@@ -504,7 +508,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 		if ((((srec_maxx<0.0) || (srec_maxy<0.0)) || ((srec_maxz<0.0))) || (((srec_minx<0.0) || (srec_miny<0.0)) || ((srec_minz<0.0)))) {
 			err("\n\n Coordinate of at least one receiver location is outside the global grid. \n\n");
 		}
-		if (((srec_maxx>NX*DX*NPROCX) || (srec_maxy>NZ*DZ*NPROCZ)) || ((srec_maxz>NY*DY*NPROCY))) {
+		if (((srec_maxx>NXG*DX) || (srec_maxy>NZG*DZ)) || ((srec_maxz>NYG*DY))) {
 			err("\n\n Coordinate of at least one receiver location is outside the global grid. \n\n");
 		}
 		/* checking if receiver coordinate of first receiver in line specified in input-file is outside the Absorbing Boundary  */
@@ -512,7 +516,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 			/* this warning appears, when at least a single receiver is located in AB between 0 - FW+DX/DX/DZ ("inner boundary")*/
 			warning("\n\n Coordinate of at least one receiver location is inside the Absorbing Boundary (warning 1). \n\n");
 		}
-		if (((srec_maxx>(NX*DX*NPROCX-FW*DX)) || (srec_maxy>(NY*DY*NPROCY-FW*DY)) || ((srec_maxz>(NY*DZ*NPROCZ-FW*DZ))))) {
+		if (((srec_maxx>(NXG*DX-FW*DX)) || (srec_maxy>(NYG*DY-FW*DY)) || ((srec_maxz>(NZG*DZ-FW*DZ))))) {
 			/* this warning appears, when at least a single receiver is located in AB between NX/NY/NZ-FW+DX/DX/DZ and NX/NY/NZ ("outer boundary")*/
 			warning("\n\n Coordinate of at least one receiver location is inside the Absorbing Boundary (warning 2). \n\n");
 		}
@@ -522,12 +526,12 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 	}
 
 	if ((SRCREC==1)&& (MYID==0)){
-		srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+		srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 		srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 		fprintf(fp,"\n Checking for source position(s) specified in source file. \n");
-		fprintf(fp,"    Global grid size in m: %5.2f (x) : %5.2f (y) : %5.2f (z) :.\n",NX*DX*NPROCX,NY*DY*NPROCY,NZ*DZ*NPROCZ);
-		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in	m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DZ,NY*DY*NPROCY-FW*DY,FW*DZ,NZ*DZ*NPROCZ-FW*DZ);
-		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m(-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DY,NZ*DY*NPROCY-FW*DY,DZ,NZ*DZ*NPROCZ-FW*DZ);
+		fprintf(fp,"    Global grid size in m: %5.2f (x) : %5.2f (y) : %5.2f (z) :.\n",NXG*DX,NYG*DY,NZG*DZ);
+		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in	m).\n",FW*DX,NXG*DX-FW*DX,FW*DZ,NYG*DY-FW*DY,FW*DZ,NZG*DZ-FW*DZ);
+		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m(-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,FW*DY,NYG*DY-FW*DY,DZ,NZG*DZ-FW*DZ);
 
 		/*only for testing
 			fprintf(fp," initial min : %5.2f (x) %5.2f (y) %5.2f (z). \n",srec_minx,srec_miny,srec_minz);
@@ -556,7 +560,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 		if ((((srec_maxx<0.0) || (srec_maxy<0.0)) || ((srec_maxz<0.0))) || (((srec_minx<0.0) || (srec_miny<0.0)) || ((srec_minz<0.0)))) {
 			err("\n\n Coordinate of at least one source location is outside the global grid. \n\n");
 		}
-		if (((srec_maxx>NX*DX*NPROCX) || (srec_maxy>NY*DY*NPROCY)) || ((srec_maxz>NZ*DZ*NPROCZ))) {
+		if (((srec_maxx>NXG*DX) || (srec_maxy>NYG*DY)) || ((srec_maxz>NZG*DZ))) {
 			err("\n\n Coordinate of at least one source location is outside the global grid. \n\n");
 		}
 		/* checking if receiver coordinate of first receiver in line specified in input-file is outside the Absorbing Boundary  */
@@ -564,7 +568,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 			/* this warning appears, when at least a single receiver is located in AB between 0 - FW+DX/DX/DZ ("inner boundary")*/
 			warning("\n\n Coordinate of at least one source location is inside the Absorbing Boundary (warning 1). \n\n");
 		}
-		if (((srec_maxx>(NX*DX*NPROCX-FW*DX)) || (srec_maxy>(NY*DY*NPROCY-FW*DY)) || ((srec_maxz>(NZ*DZ*NPROCZ-FW*DZ))))) {
+		if (((srec_maxx>(NXG*DX-FW*DX)) || (srec_maxy>(NYG*DY-FW*DY)) || ((srec_maxz>(NZG*DZ-FW*DZ))))) {
 			/* this warning appears, when at least a single receiver is located in AB between NX/NY/NZ-FW+DX/DX/DZ and NX/NY/NZ ("outer boundary")*/
 			warning("\n\n Coordinate of at least one source location is inside the Absorbing Boundary (warning 2). \n\n");
 		}
@@ -598,7 +602,7 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 			warning(" Be aware of strong artificial reflections from grid boundaries ! \n");}
 	if (((((NX)<FW) || ((NY)<FW)) || ((NZ)<FW)) && (MYID==0))	{
 		fprintf(fp," \n Width of boundary area (FW=%i gridpoints) is larger than at least one subdomain dimension: \n",FW);
-		fprintf(fp," \t NX/NPROCX = %i, NY/NPROCY = %i, NZ/NPROCZ = %i gridpoints.\n",NX,NY,NZ);
+		fprintf(fp," \t NX = %i, NY = %i, NZ = %i gridpoints.\n",NX,NY,NZ);
 		err(" Choose smaller width of absorbing frame (ABS) or increase subdomain dimensions");
 	}
 }
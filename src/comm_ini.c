@@ -1,53 +1,96 @@
 /*------------------------------------------------------------------------
  *   initialisation of repeated comunications. This may reduce the
  *   network overhead. Communication is started later
- *   with MPI_START(request)
+ *   with MPI_Startall(request)
  *  ----------------------------------------------------------------------*/
 
 #include "fd.h"
 #include "globvar.h"
 
 
-void comm_ini(float *** bufferlef_to_rig, float *** bufferrig_to_lef, 
-float *** buffertop_to_bot, float *** bufferbot_to_top, 
-float *** bufferfro_to_bac, float *** bufferbac_to_fro, 
-MPI_Request *req_send, MPI_Request *req_rec){
+/*
+ * Neighbouring PEs taking part in the exchange across each face.
+ *
+ * Parameters
+ * ----------
+ * nb :
+ *     Output, nb[1..6] are the ranks of the left, right, upper, lower,
+ *     front and back neighbour (same order as INDEX) or MPI_PROC_NULL
+ *     at the edges of the global grid if no periodic boundary is applied.
+ */
+void comm_neighbours(int *nb)
+{
+	extern int POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, INDEX[7];
 
+	nb[1] = ((BOUNDARY) || (POS[1]!=0)) ? INDEX[1] : MPI_PROC_NULL;
+	nb[2] = ((BOUNDARY) || (POS[1]!=NPROCX-1)) ? INDEX[2] : MPI_PROC_NULL;
+	nb[3] = ((BOUNDARY) || (POS[2]!=0)) ? INDEX[3] : MPI_PROC_NULL;
+	nb[4] = ((BOUNDARY) || (POS[2]!=NPROCY-1)) ? INDEX[4] : MPI_PROC_NULL;
+	nb[5] = ((BOUNDARY) || (POS[3]!=0)) ? INDEX[5] : MPI_PROC_NULL;
+	nb[6] = ((BOUNDARY) || (POS[3]!=NPROCZ-1)) ? INDEX[6] : MPI_PROC_NULL;
+}
+
+
+/*
+ * Create persistent requests for the exchange of one wavefield
+ * (PERSISTENT_COMM). Sent and received faces are stored in separate
+ * buffers, so all twelve messages may be started at once.
+ *
+ * Parameters
+ * ----------
+ * nf1, nf2 :
+ *     Number of values per face point sent in positive
+ *     (left to right, top to bottom, front to back) and negative
+ *     direction, see exchange_v.c and exchange_s.c.
+ * bufferlef_to_rig, ..., bufferbac_to_fro :
+ *     Send buffers.
+ * rbufferlef_to_rig, ..., rbufferbac_to_fro :
+ *     Receive buffers of the same size.
+ * req :
+ *     Output, req[0..5] receive and req[6..11] send requests in the order
+ *     top-bottom, left-right, front-back, as expected by
+ *     `exchange_v_start` and `exchange_s_start`.
+ */
+void comm_ini(int nf1, int nf2,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req){
 
-	extern int NX, NY, NZ, INDEX[7], FDORDER;
+	extern int NX, NY, NZ;
 	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
 
-	int nf1, nf2;
-
-	/* comunication initialisation for persistent communication */
-
-	/* buffer arrays are copied into local buffers using buffered send (bsend),
-	  Actually send is activated by MPI_START(request) within time loop.
-	  MPI_BSEND and MPI_RECV (see below) are then non-blocking.
-	*/
-	
-	
-	/* number of wavefield parameters that need to be exchanged - see exchange_v.c */
-	nf1=3*FDORDER/2 -1;
-	nf2=nf1-1;
-	
-	
-	MPI_Bsend_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,MPI_COMM_WORLD,&req_send[0]);
-	MPI_Bsend_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,MPI_COMM_WORLD,&req_send[1]);
-	MPI_Bsend_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,MPI_COMM_WORLD,&req_send[2]);
-	MPI_Bsend_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,MPI_COMM_WORLD,&req_send[3]);
-	MPI_Bsend_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,MPI_COMM_WORLD,&req_send[4]);
-	MPI_Bsend_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,MPI_COMM_WORLD,&req_send[5]);
-
-	/* initialising of receive of buffer arrays. Same arrays for send and receive
-	   are used. Thus, before starting receive, it is necessary to check if
-	   Bsend has copied data into local buffers, i.e. has completed.
-	*/
-	MPI_Recv_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG1,MPI_COMM_WORLD,&req_rec[0]);
-	MPI_Recv_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG2,MPI_COMM_WORLD,&req_rec[1]);
-	MPI_Recv_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG3,MPI_COMM_WORLD,&req_rec[2]);
-	MPI_Recv_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG4,MPI_COMM_WORLD,&req_rec[3]);
-	MPI_Recv_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG5,MPI_COMM_WORLD,&req_rec[4]);
-	MPI_Recv_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG6,MPI_COMM_WORLD,&req_rec[5]);
+	int nb[7];
+
+	comm_neighbours(nb);
+
+	MPI_Recv_init(&rbuffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req[0]);
+	MPI_Recv_init(&rbufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req[1]);
+	MPI_Recv_init(&rbufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req[2]);
+	MPI_Recv_init(&rbufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req[3]);
+	MPI_Recv_init(&rbufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req[4]);
+	MPI_Recv_init(&rbufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req[5]);
+
+	MPI_Send_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req[6]);
+	MPI_Send_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req[7]);
+	MPI_Send_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req[8]);
+	MPI_Send_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req[9]);
+	MPI_Send_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req[10]);
+	MPI_Send_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req[11]);
+
+}
+
+
+/*
+ * Free the persistent requests created by `comm_ini`.
+ */
+void comm_free(MPI_Request *req){
+
+	int l;
 
+	for (l=0;l<2*REQUEST_COUNT;l++)
+		MPI_Request_free(&req[l]);
 }
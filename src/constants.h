@@ -6,6 +6,14 @@
 //#define STRING_SIZE 74 //previous value, sometimes not enough to handle longer file names
 #define STRING_SIZE 256
 #define REQUEST_COUNT 6
+/* alignment in bytes of the rows of wavefield and material arrays */
+#define FIELD_ALIGN 64
+/* largest number of distinct media of the material table, see mat_table.c */
+#define MAT_MEDIA_MAX 4096
+/* largest number of fields in a checkpoint file, see save_checkpoint.c */
+#define CHECKPOINT_FIELDS_MAX 96
+/* version of the checkpoint files */
+#define CHECKPOINT_VERSION 2
 
 enum NPROC_ENUM { NPROCX_MAX = 100, NPROCY_MAX = 100, NPROCZ_MAX = 100 };
 #endif
@@ -1,6 +1,9 @@
 #ifndef __DATA_STRUCTURES__
 #define __DATA_STRUCTURES__
 
+#include <stdint.h>
+#include <mpi.h>
+
 // Structure that contains velocity components.
 typedef struct {
     float ***x;
@@ -93,6 +96,151 @@ typedef struct {
     float ***C55ipkp;
 } OrthoPar;
 
+/*
+ * Material field stored with 16 bits per value, see mat16.c.
+ * The value at a grid point is the decoded 16-bit number times `scale`,
+ * a power of two which brings the field into the range of FP16.
+ */
+typedef struct {
+    uint16_t ***v;
+    float scale;
+} Mat16Field;
+
+/*
+ * The material parameters read by the vectorized FDORDER_TIME=2 kernels
+ * (update_simd.c) in 16-bit storage (MAT_PRECISION > 0).
+ * `format` is MAT_FP16 or MAT_BF16, see enum.h.
+ */
+typedef struct {
+    int format;
+    Mat16Field C11, C22, C33, C12, C13, C23;
+    Mat16Field C66ipjp, C44jpkp, C55ipkp;
+    // Density on the half-integer grid, see av_mat.c.
+    Mat16Field rjp, rkp, rip;
+} OrthoPar16;
+
+/*
+ * The material parameters read by the vectorized FDORDER_TIME=2 kernels
+ * as a table of the distinct media of the local grid and an index volume
+ * (MAT_COMPRESS=1), see mat_table.c.
+ * Field f at point [j][i][k] is f[idx8[j][i][k]] if the table has at most
+ * 256 media, f[idx16[j][i][k]] otherwise; the other index is NULL.
+ */
+typedef struct {
+    int nmedia;
+    float *C11, *C22, *C33, *C12, *C13, *C23;
+    float *C66ipjp, *C44jpkp, *C55ipkp;
+    float *rjp, *rkp, *rip;
+    uint8_t ***idx8;
+    uint16_t ***idx16;
+} MatTable;
+
+/*
+ * Rectangular part [nx1..nx2] x [ny1..ny2] x [nz1..nz2] of the local grid.
+ * The box is empty if any upper index is smaller than the lower one.
+ */
+typedef struct {
+    int nx1, nx2;
+    int ny1, ny2;
+    int nz1, nz2;
+} GridBox;
+
+/*
+ * Box of the CPML frame (ABS_TYPE=1), see CPML_boxes(). The layers of the
+ * axes with cx, cy or cz set apply in the whole box; the memory variables
+ * and the damping profiles of such an axis are indexed with i-ox, j-oy or
+ * k-oz.
+ */
+typedef struct {
+    GridBox box;
+    int cx, cy, cz;
+    int ox, oy, oz;
+} CpmlBox;
+
+/*
+ * Subset of the local point sources in the same layout as
+ * `srcpos_loc`, `signals` and `stype_loc` in the main program.
+ */
+typedef struct {
+    int nsrc;
+    float **srcpos;
+    float **signals;
+    int *stype;
+} PointSources;
+
+/*
+ * Absorbing frame of the exponential damping (ABS_TYPE=2), see absorb.c.
+ * The damping factor at point [j][i][k] is the smallest of the 1-D
+ * profiles y[j], x[i] and z[k], which are 1 outside the frame and are
+ * defined on the local grid and a ghost zone of `na` points. The box
+ * [x1..x2] x [y1..y2] x [z1..z2] is not damped (it may be empty).
+ */
+typedef struct {
+    float *x, *y, *z;
+    int x1, x2;
+    int y1, y2;
+    int z1, z2;
+    int na;
+} AbsorbFrame;
+
+/*
+ * Binary model file of the global grid opened with MPI-IO, see
+ * readmod_mpiio.c. Each PE reads its sub grid plane by plane (in z);
+ * the value at local point [j][i] of the current plane is
+ * plane[(i - 1) * NY + j - 1]. `fh` is MPI_FILE_NULL if the file could
+ * not be opened, `nread` counts the collective reads.
+ */
+typedef struct {
+    MPI_File fh;
+    float *plane;
+    int nread;
+} ModelFile;
+
+/*
+ * State of a simulation saved in checkpoint files, see save_checkpoint.c.
+ * The structures are the variables of the main program, so that the
+ * pointers rotated by the Adams-Bashforth method (FDORDER_TIME > 2) are
+ * seen; unused members are NULL. `psi` are the 18 memory variables of
+ * the CPML (ABS_TYPE=1), six for each of the layers in x, y and z in
+ * this order, and `section` the seismogram sections of the PE (vx, vy,
+ * vz, p, div, curl). The counters of the time loop after time
+ * step `nt` of shot `ishot` are saved as well.
+ */
+typedef struct {
+    Velocity *v;
+    Tensor3d *s, *r, *r_2, *r_3, *r_4;
+    VelocityDerivativesTensor *dv_2, *dv_3, *dv_4;
+    StressDerivativesWrtVelocity *ds_dv_2, *ds_dv_3, *ds_dv_4;
+    float ***psi[18];
+    float **section[6];
+    int ntr, ns;
+    int nt, ishot, lsnap, nsnap, lsamp, nlsamp;
+} Checkpoint;
+
+/*
+ * Header of the data of one PE in a checkpoint file. The data follow as
+ * `nfloat` floats, one contiguous slab per field, see save_checkpoint.c.
+ */
+typedef struct {
+    char magic[8];
+    int32_t version;
+    int32_t nt, ishot, lsnap, nsnap, lsamp, nlsamp;
+    int32_t nx, ny, nz, pos[3], nprocx, nprocy, nprocz;
+    int32_t fdorder, fdorder_time, nrelax, abs_type, fw, free_surf, ntr, ns;
+    int64_t nfloat;
+    uint64_t checksum;
+} CheckpointHeader;
+
+/*
+ * Field of a checkpoint: a[j1..j2][i1..i2][k1..k2], or m[i1..i2][k1..k2]
+ * if `a` is NULL.
+ */
+typedef struct {
+    float ***a;
+    float **m;
+    int j1, j2, i1, i2, k1, k2;
+} CheckpointField;
+
 /* ****************************************************************************
    Allocation and deallocation operations.
 */
@@ -0,0 +1,268 @@
+/*
+ * Sizes of the sub grids of the PEs (domain decomposition).
+ *
+ * The global grid is cut along each axis into NPROCX, NPROCY and NPROCZ
+ * slabs; the PE at POS[1], POS[2], POS[3] holds the global grid points
+ * OFFX[POS[1]]+1 ... OFFX[POS[1]+1] in x, and accordingly in y and z.
+ * Neighbouring PEs therefore always share the size of their common face.
+ *
+ * DECOMP=0 gives all PEs of an axis the same number of grid points (up to
+ * the remainder of the division). DECOMP=1 balances a cost model instead:
+ * a grid point in the CPML frame (ABS_TYPE=1) costs 1+DECOMP_CPML times
+ * as much as a point of the interior, and each column below the free
+ * surface costs one more grid point. The cost of a plane of an axis is
+ * the sum over its points, so that the PEs on the model boundary get
+ * thinner slabs. DECOMP_CPML can be estimated from the real times of the
+ * CPML and the interior updates printed with LOG.
+ *
+ * The cuts are multiples of IDX, IDY and IDZ, so that the decimated
+ * snapshots of the PEs fit together, and each slab has at least FW grid
+ * points (the CPML layers and the absorbing frame are set up locally) and
+ * at least FDORDER/2 points for the exchange with the neighbours.
+ *
+ * decomp_procs() chooses the number of PEs along the axes if they are not
+ * given in the parameter file.
+ */
+#include "fd.h"
+#include "globvar.h"
+
+
+/*
+ * Cut an axis of n grid points with the plane costs w[1..n] into nproc
+ * slabs of about equal cost. The cuts are multiples of unit and leave at
+ * least nmin grid points in each slab. Returns 0 if this is impossible.
+ */
+static int decomp_axis(int n, int nproc, const double *w, int unit, int nmin,
+        int *off)
+{
+    double *cum, target;
+    int p, g, best, lo, hi;
+
+    cum = (double *) malloc((n + 1) * sizeof(double));
+    if (cum == NULL) err("allocation failure in function decomp_axis()");
+    cum[0] = 0.0;
+    for (g = 1; g <= n; g++)
+        cum[g] = cum[g - 1] + w[g];
+
+    off[0] = 0;
+    off[nproc] = n;
+    for (p = 1; p < nproc; p++) {
+        /* the multiple of unit closest to an equal share of the cost */
+        target = cum[n] * p / nproc;
+        best = 0;
+        for (g = unit; g < n; g += unit)
+            if (fabs(cum[g] - target) < fabs(cum[best] - target))
+                best = g;
+
+        /* room for the remaining slabs */
+        lo = ((off[p - 1] + nmin + unit - 1) / unit) * unit;
+        hi = ((n - (nproc - p) * nmin) / unit) * unit;
+        if (lo > hi) {
+            free(cum);
+            return 0;
+        }
+        off[p] = (best < lo) ? lo : ((best > hi) ? hi : best);
+    }
+
+    free(cum);
+    return 1;
+}
+
+
+/*
+ * Costs w[1..n] of the planes of an axis with layers of fw grid points at
+ * the front and back (if set). f is the fraction of the plane which lies
+ * in the layers of the other two axes.
+ */
+static void decomp_cost(int n, int front, int back, int fw, double f,
+        double c, double *w)
+{
+    int g;
+
+    for (g = 1; g <= n; g++) {
+        if ((front && (g <= fw)) || (back && (g > n - fw)))
+            w[g] = 1.0 + c;
+        else
+            w[g] = 1.0 + c * f;
+    }
+}
+
+
+/*
+ * Compute OFFX, OFFY and OFFZ for the global grid of nxg x nyg x nzg
+ * points.
+ */
+void decomp(int nxg, int nyg, int nzg)
+{
+    extern int NPROCX, NPROCY, NPROCZ, FW, FDORDER, ABS_TYPE, FREE_SURF, IDX, IDY, IDZ;
+    extern int DECOMP, OFFX[], OFFY[], OFFZ[];
+    extern float DECOMP_CPML;
+
+    double *wx, *wy, *wz, c = 0.0, fx, fy, fz;
+    int cpml = (ABS_TYPE == 1), nmin = max(FW, FDORDER / 2), ok;
+
+    if ((NPROCX > NPROCX_MAX) || (NPROCY > NPROCY_MAX) || (NPROCZ > NPROCZ_MAX))
+        err("NPROCX=%d, NPROCY=%d, NPROCZ=%d, at most %d, %d, %d PEs per "
+            "direction are supported", NPROCX, NPROCY, NPROCZ,
+            NPROCX_MAX, NPROCY_MAX, NPROCZ_MAX);
+
+    wx = (double *) malloc((nxg + 1) * sizeof(double));
+    wy = (double *) malloc((nyg + 1) * sizeof(double));
+    wz = (double *) malloc((nzg + 1) * sizeof(double));
+    if ((wx == NULL) || (wy == NULL) || (wz == NULL))
+        err("allocation failure in function decomp()");
+
+    if ((DECOMP == 1) && cpml)
+        c = DECOMP_CPML;
+
+    /* fractions of the planes of each axis in the layers of the other two */
+    fx = (cpml) ? (double) max(nxg - 2 * FW, 0) / nxg : 1.0;
+    fy = (cpml) ? (double) max(nyg - ((FREE_SURF) ? 1 : 2) * FW, 0) / nyg : 1.0;
+    fz = (cpml) ? (double) max(nzg - 2 * FW, 0) / nzg : 1.0;
+    decomp_cost(nxg, cpml, cpml, FW, 1.0 - fy * fz, c, wx);
+    decomp_cost(nyg, cpml && !FREE_SURF, cpml, FW, 1.0 - fx * fz, c, wy);
+    decomp_cost(nzg, cpml, cpml, FW, 1.0 - fx * fy, c, wz);
+    if ((DECOMP == 1) && FREE_SURF)
+        wy[1] += 1.0;
+
+    ok = decomp_axis(nxg, NPROCX, wx, IDX, nmin, OFFX);
+    if (!ok)
+        err("NX=%d cannot be divided among NPROCX=%d PEs with at least %d "
+            "grid points each and cuts at multiples of IDX=%d", nxg, NPROCX, nmin, IDX);
+    ok = decomp_axis(nyg, NPROCY, wy, IDY, nmin, OFFY);
+    if (!ok)
+        err("NY=%d cannot be divided among NPROCY=%d PEs with at least %d "
+            "grid points each and cuts at multiples of IDY=%d", nyg, NPROCY, nmin, IDY);
+    ok = decomp_axis(nzg, NPROCZ, wz, IDZ, nmin, OFFZ);
+    if (!ok)
+        err("NZ=%d cannot be divided among NPROCZ=%d PEs with at least %d "
+            "grid points each and cuts at multiples of IDZ=%d", nzg, NPROCZ, nmin, IDZ);
+
+    free(wx);
+    free(wy);
+    free(wz);
+}
+
+
+/*
+ * Position of the PE along an axis whose sub grid holds the global grid
+ * point g, or -1 if g lies outside the global grid.
+ */
+int decomp_owner(const int *off, int nproc, int g)
+{
+    int p;
+
+    for (p = 0; p < nproc; p++)
+        if ((g > off[p]) && (g <= off[p + 1]))
+            return p;
+    return -1;
+}
+
+
+/*
+ * Number of samples ns[0..nproc-1] of the sub grids along an axis if
+ * every id-th grid point is written (snapshots, model files). Returns the
+ * number of samples of the global grid.
+ */
+int decomp_samples(const int *off, int nproc, int id, int *ns)
+{
+    int p, n = 0;
+
+    for (p = 0; p < nproc; p++) {
+        ns[p] = (off[p + 1] - off[p] - 1) / id + 1;
+        n += ns[p];
+    }
+    return n;
+}
+
+
+/*
+ * Check if an axis of n grid points can be cut into nproc slabs by
+ * decomp_axis().
+ */
+static int decomp_fits(int n, int nproc, int unit, int nmin)
+{
+    double *w;
+    int *off, g, ok;
+
+    w = (double *) malloc((n + 1) * sizeof(double));
+    off = (int *) malloc((nproc + 1) * sizeof(int));
+    if ((w == NULL) || (off == NULL))
+        err("allocation failure in function decomp_fits()");
+    for (g = 1; g <= n; g++)
+        w[g] = 1.0;
+    ok = decomp_axis(n, nproc, w, unit, nmin, off);
+    free(w);
+    free(off);
+    return ok;
+}
+
+
+/*
+ * Choose the number of PEs along the axes for np PEs (automatic domain
+ * decomposition). NPROCX, NPROCY or NPROCZ set to 0 in the parameter file
+ * are free, the others are kept. Of all factorizations of np which
+ * decomp() can realize the one with the smallest halo is taken: nf values
+ * per grid point of a face are sent in each exchange (nf1+nf2, see
+ * exchange_v.c), so the halo of a factorization is nf times the area of
+ * all cuts between the PEs (and the periodic faces with BOUNDARY=1). Ties
+ * go to the factorization with fewer PEs along x, then along y.
+ * Also sets NPROC.
+ */
+void decomp_procs(int np, int nf)
+{
+    extern int NX, NY, NZ, NPROC, NPROCX, NPROCY, NPROCZ, MYID;
+    extern int FW, FDORDER, BOUNDARY, IDX, IDY, IDZ;
+    extern FILE *FP;
+
+    int px, py, pz, bx = 0, by = 0, bz = 0, nmin = max(FW, FDORDER / 2);
+    double halo, best = -1.0;
+
+    if ((NPROCX < 0) || (NPROCY < 0) || (NPROCZ < 0))
+        err("NPROCX=%d, NPROCY=%d, NPROCZ=%d, must not be negative "
+            "(0 chooses the number of PEs automatically)", NPROCX, NPROCY, NPROCZ);
+
+    if (NPROCX && NPROCY && NPROCZ) {
+        NPROC = NPROCX * NPROCY * NPROCZ;
+        return;
+    }
+
+    for (px = 1; px <= min(np, NPROCX_MAX); px++) {
+        if ((np % px) || (NPROCX && (px != NPROCX)))
+            continue;
+        for (py = 1; py <= min(np / px, NPROCY_MAX); py++) {
+            if (((np / px) % py) || (NPROCY && (py != NPROCY)))
+                continue;
+            pz = np / (px * py);
+            if ((pz > NPROCZ_MAX) || (NPROCZ && (pz != NPROCZ)))
+                continue;
+            if (!decomp_fits(NX, px, IDX, nmin) || !decomp_fits(NY, py, IDY, nmin)
+                    || !decomp_fits(NZ, pz, IDZ, nmin))
+                continue;
+
+            halo = (double) nf * ((double) (px - !BOUNDARY) * NY * NZ
+                    + (double) (py - !BOUNDARY) * NX * NZ
+                    + (double) (pz - !BOUNDARY) * NX * NY);
+            if ((best < 0.0) || (halo < best)) {
+                best = halo;
+                bx = px;
+                by = py;
+                bz = pz;
+            }
+        }
+    }
+
+    if (best < 0.0)
+        err("NX=%d, NY=%d, NZ=%d cannot be divided among %d PEs with "
+            "NPROCX=%d, NPROCY=%d, NPROCZ=%d (0 = free)", NX, NY, NZ, np,
+            NPROCX, NPROCY, NPROCZ);
+
+    NPROCX = bx;
+    NPROCY = by;
+    NPROCZ = bz;
+    NPROC = np;
+    if (MYID == 0)
+        fprintf(FP, " Automatic domain decomposition: NPROCX=%d, NPROCY=%d, "
+                "NPROCZ=%d (halo of %.0f values per exchange)\n",
+                NPROCX, NPROCY, NPROCZ, best);
+}
@@ -49,4 +49,26 @@ enum FILE_FORMAT_ENUM {
     // SEG-Y format with 4-byte floats in IBM/BE format.
     FILE_FORMAT_SEGY_IBM_BIGEND = 5,
 };
+
+// Possible values of the SIMD global variable, i.e. the highest
+// instruction set used by the vectorized kernels in update_simd.c.
+enum SIMD_ENUM {
+    // Scalar code only.
+    SIMD_NONE = 0,
+    // AVX2, 8 floats per vector.
+    SIMD_AVX2 = 1,
+    // AVX-512, 16 floats per vector.
+    SIMD_AVX512 = 2,
+};
+
+// Possible values of the MAT_PRECISION global variable, i.e. the storage
+// of the material parameters read by the vectorized kernels, see mat16.c.
+enum MAT_PRECISION_ENUM {
+    // 32-bit floats, the material arrays are used directly.
+    MAT_FP32 = 0,
+    // IEEE 754 half precision with a power-of-two scale per field.
+    MAT_FP16 = 1,
+    // bfloat16, i.e. the upper 16 bits of a 32-bit float.
+    MAT_BF16 = 2,
+};
 #endif
@@ -13,7 +13,7 @@ void exchange_par(void) {
 	extern float SOURCE_ALPHA, SOURCE_BETA, VPPML;
 	extern float AMON, STR, DIP, RAKE;
 	extern float REC_ARRAY_DEPTH, REC_ARRAY_DIST;
-	extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING, FPML, NPOWER, K_MAX_CPML;
+	extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING, FPML, NPOWER, K_MAX_CPML, SNAP_TOL, DECOMP_CPML;
 	extern int SEISMO, NDT, NDTSHIFT, NGEOPH, SEIS_FORMAT[6], FREE_SURF, READMOD, READREC;
 
 	/*
@@ -25,11 +25,15 @@ void exchange_par(void) {
 	extern int   NX, NY, NZ, SOURCE_SHAPE, SOURCE_TYPE, SNAP, SNAP_FORMAT, SNAP_PLANE, OUTNTIMESTEPINFO, OUTSOURCEWAVELET;
 	extern int DRX, DRZ, L, SRCREC, FDORDER,FDORDER_TIME;
 	extern int NPROC,NPROCX,NPROCY,NPROCZ, MYID, CHECKPTREAD, CHECKPTWRITE, RUN_MULTIPLE_SHOTS, FDCOEFF;
+	extern int OVERLAP_COMM, PERSISTENT_COMM, THREADS, SIMD, DECOMP;
+	extern int TILE_X, TILE_Y, TILE_Z, TILE_AUTO, TIME_BLOCK, MAT_PRECISION, MAT_COMPRESS;
+	extern int SNAP_MPIIO, SNAP_ASYNC, SNAP_COMPRESS, CHECKPT_INC, CHECKPT_MPIIO, SEIS_BLOCK, SEIS_MPIIO;
 	extern int   LITTLEBIG, ASCIIEBCDIC, IEEEIBM;
 	extern char  MFILE[STRING_SIZE], SIGNAL_FILE[STRING_SIZE], LOG_FILE[STRING_SIZE], CHECKPTFILE[STRING_SIZE];
 	extern char  RSFDEN[STRING_SIZE]; // RSF
 	extern int RSF; // RSF
 	extern char SNAP_FILE[STRING_SIZE], SOURCE_FILE[STRING_SIZE], REC_FILE[STRING_SIZE], SEIS_FILE[STRING_SIZE];
+	extern char SNAP_PLAN[STRING_SIZE];
 	extern char  FILEINP[STRING_SIZE];
 
     // Model parameters for model generation.
@@ -120,6 +124,9 @@ void exchange_par(void) {
         fdum[65] = M23;
         fdum[66] = M33;
 
+        fdum[67] = SNAP_TOL;
+        fdum[68] = DECOMP_CPML;
+
 
 
 		idum[0]  = FDORDER;
@@ -181,6 +188,26 @@ void exchange_par(void) {
 		idum[47] = OUTSOURCEWAVELET;
 		idum[48] = OUTNTIMESTEPINFO;
 
+		idum[49] = OVERLAP_COMM;
+		idum[50] = PERSISTENT_COMM;
+		idum[51] = THREADS;
+		idum[52] = SIMD;
+		idum[53] = TILE_X;
+		idum[54] = TILE_Y;
+		idum[55] = TILE_Z;
+		idum[56] = TILE_AUTO;
+		idum[57] = TIME_BLOCK;
+		idum[58] = MAT_PRECISION;
+		idum[59] = MAT_COMPRESS;
+		idum[60] = SNAP_MPIIO;
+		idum[61] = SNAP_ASYNC;
+		idum[62] = CHECKPT_INC;
+		idum[63] = CHECKPT_MPIIO;
+		idum[64] = SEIS_BLOCK;
+		idum[65] = SEIS_MPIIO;
+		idum[66] = SNAP_COMPRESS;
+		idum[67] = DECOMP;
+
 	}
 
 	if (MYID != 0) FL=vector(1,L);
@@ -198,6 +225,7 @@ void exchange_par(void) {
 	//
 
 	MPI_Bcast(&SNAP_FILE,STRING_SIZE,MPI_CHAR,0,MPI_COMM_WORLD);
+	MPI_Bcast(&SNAP_PLAN,STRING_SIZE,MPI_CHAR,0,MPI_COMM_WORLD);
 	MPI_Bcast(&REC_FILE,STRING_SIZE,MPI_CHAR,0,MPI_COMM_WORLD);
 	MPI_Bcast(&SEIS_FILE,STRING_SIZE,MPI_CHAR,0,MPI_COMM_WORLD);
 	MPI_Bcast(&LOG_FILE,STRING_SIZE,MPI_CHAR,0,MPI_COMM_WORLD);
@@ -279,6 +307,9 @@ void exchange_par(void) {
     M23 = fdum[65];
     M33 = fdum[66];
 
+    SNAP_TOL = fdum[67];
+    DECOMP_CPML = fdum[68];
+
     // -------------------
     // Integer parameters.
 	FDORDER = idum[0];
@@ -341,6 +372,26 @@ void exchange_par(void) {
 	OUTSOURCEWAVELET = idum[47];
 	OUTNTIMESTEPINFO = idum[48];
 
+	OVERLAP_COMM = idum[49];
+	PERSISTENT_COMM = idum[50];
+	THREADS = idum[51];
+	SIMD = idum[52];
+	TILE_X = idum[53];
+	TILE_Y = idum[54];
+	TILE_Z = idum[55];
+	TILE_AUTO = idum[56];
+	TIME_BLOCK = idum[57];
+	MAT_PRECISION = idum[58];
+	MAT_COMPRESS = idum[59];
+	SNAP_MPIIO = idum[60];
+	SNAP_ASYNC = idum[61];
+	CHECKPT_INC = idum[62];
+	CHECKPT_MPIIO = idum[63];
+	SEIS_BLOCK = idum[64];
+	SEIS_MPIIO = idum[65];
+	SNAP_COMPRESS = idum[66];
+	DECOMP = idum[67];
+
 
 
 	MPI_Bcast(&FL[1],L,MPI_FLOAT,0,MPI_COMM_WORLD);
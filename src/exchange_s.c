@@ -1,5 +1,5 @@
 /*------------------------------------------------------------------------
- * exchange of particle velocities at grid boundaries between processors
+ * exchange of stress tensor components at grid boundaries between processors
  * when using the standard staggered grid
  *
  *  ----------------------------------------------------------------------*/
@@ -9,19 +9,19 @@
 #include "globvar.h"
 
 
-double exchange_s(int nt, Tensor3d *s,
+/*
+ * Copy the stress components at the faces of the local grid into the
+ * send buffers. Faces at the edges of the global grid are skipped unless
+ * periodic boundaries are applied.
+ */
+static void pack_s(Tensor3d *s,
 		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
 		float *** buffertop_to_bot, float *** bufferbot_to_top,
 		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
 
-	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, MYID, FDORDER, LOG, INDEX[7];
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
 
-	MPI_Status status;	
-	int i, j, k, l, n, nf1, nf2;
-	double time=0.0, time1=0.0, time2=0.0;
+	int i, j, k, l, n;
 
         float ***sxx = s->xx;
         float ***syy = s->yy;
@@ -30,13 +30,6 @@ double exchange_s(int nt, Tensor3d *s,
         float ***syz = s->yz;
         float ***sxz = s->xz;
 
-	nf1=(3*FDORDER/2)-1;
-	nf2=nf1-1;
-
-
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
-
 	/* top-bottom -----------------------------------------------------------*/	
 
 	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
@@ -57,12 +50,10 @@ double exchange_s(int nt, Tensor3d *s,
 			}
 		}
 
-
 	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
 		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
 
-
 				/* storage of bottom of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
@@ -77,92 +68,133 @@ double exchange_s(int nt, Tensor3d *s,
 			}
 		}
 
-	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);	
-	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	/* left-right -----------------------------------------------------------*/	
 
-	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
-		for (i=1;i<=NX;i++){
+	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
+		for (j=1;j<=NY;j++){
 			for (k=1;k<=NZ;k++){
 
+				/* storage of left edge of local volume into buffer */
 				n=1;
-				for (l=1;l<=(FDORDER/2);l++){
-					syy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+				for (l=1;l<=FDORDER/2;l++){
+					bufferlef_to_rig[j][k][n++] =  sxx[j][l][k];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					sxy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
-					syz[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+					bufferlef_to_rig[j][k][n++] =  sxy[j][l][k];
+					bufferlef_to_rig[j][k][n++] =  sxz[j][l][k];
 				}
+			}
+		}
 
+	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
+		for (j=1;j<=NY;j++){
+			for (k=1;k<=NZ;k++){
+				/* storage of right edge of local volume into buffer */
+				n=1;
 
+				for (l=1;l<=(FDORDER/2);l++){
+					bufferrig_to_lef[j][k][n++] =  sxy[j][NX-l+1][k];
+					bufferrig_to_lef[j][k][n++] =  sxz[j][NX-l+1][k];
+				}
+
+				for (l=1;l<=(FDORDER/2-1);l++){
+					bufferrig_to_lef[j][k][n++] =  sxx[j][NX-l+1][k];
+				}
 			}
 		}
 
-	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
+	/* front-back -----------------------------------------------------------*/
+	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
 		for (i=1;i<=NX;i++){
-			for (k=1;k<=NZ;k++){
+			for (j=1;j<=NY;j++){
 
+				/* storage of front side of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
-					sxy[1-l][i][k] = bufferbot_to_top[i][k][n++];
-					syz[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					bufferfro_to_bac[j][i][n++]  = szz[j][i][l];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					syy[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					bufferfro_to_bac[j][i][n++]  =  syz[j][i][l];
+					bufferfro_to_bac[j][i][n++]  =  sxz[j][i][l];
 				}
-
 			}
 		}
 
+	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
+		for (i=1;i<=NX;i++){
+			for (j=1;j<=NY;j++){
 
+				/* storage of back side of local volume into buffer */
+				n=1;
+				for (l=1;l<=FDORDER/2;l++){
+					bufferbac_to_fro[j][i][n++]  = syz[j][i][NZ-l+1];
+					bufferbac_to_fro[j][i][n++]  = sxz[j][i][NZ-l+1];
+				}
 
+				for (l=1;l<=(FDORDER/2-1);l++){
+					bufferbac_to_fro[j][i][n++]  = szz[j][i][NZ-l+1];
+				}
+			}
+		}
+}
 
 
+/*
+ * Copy the received stress components from the buffers into the
+ * ghost layers of the local grid.
+ */
+static void unpack_s(Tensor3d *s,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
 
-	/* left-right -----------------------------------------------------------*/	
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
 
+	int i, j, k, l, n;
 
+        float ***sxx = s->xx;
+        float ***syy = s->yy;
+        float ***szz = s->zz;
+        float ***sxy = s->xy;
+        float ***syz = s->yz;
+        float ***sxz = s->xz;
 
-	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
-		for (j=1;j<=NY;j++){
+	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
 
-
-				/* storage of left edge of local volume into buffer */
 				n=1;
-				for (l=1;l<=FDORDER/2;l++){
-					bufferlef_to_rig[j][k][n++] =  sxx[j][l][k];
+				for (l=1;l<=(FDORDER/2);l++){
+					syy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferlef_to_rig[j][k][n++] =  sxy[j][l][k];
-					bufferlef_to_rig[j][k][n++] =  sxz[j][l][k];
+					sxy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+					syz[NY+l][i][k] = buffertop_to_bot[i][k][n++];
 				}
+
 			}
 		}
 
-
-	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
-		for (j=1;j<=NY;j++){
+	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
-				/* storage of right edge of local volume into buffer */
-				n=1;
 
-				for (l=1;l<=(FDORDER/2);l++){
-					bufferrig_to_lef[j][k][n++] =  sxy[j][NX-l+1][k];
-					bufferrig_to_lef[j][k][n++] =  sxz[j][NX-l+1][k];
+				n=1;
+				for (l=1;l<=FDORDER/2;l++){
+					sxy[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					syz[1-l][i][k] = bufferbot_to_top[i][k][n++];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferrig_to_lef[j][k][n++] =  sxx[j][NX-l+1][k];
+					syy[1-l][i][k] = bufferbot_to_top[i][k][n++];
 				}
+
 			}
 		}
 
-	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
-
 	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
 		for (j=1;j<=NY;j++){
 			for (k=1;k<=NZ;k++){
@@ -195,51 +227,6 @@ double exchange_s(int nt, Tensor3d *s,
 			}
 		}
 
-
-
-
-
-
-	/* front-back -----------------------------------------------------------*/
-	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
-
-
-				/* storage of front side of local volume into buffer */
-				n=1;
-				for (l=1;l<=FDORDER/2;l++){
-					bufferfro_to_bac[j][i][n++]  = szz[j][i][l];
-				}
-
-				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferfro_to_bac[j][i][n++]  =  syz[j][i][l];
-					bufferfro_to_bac[j][i][n++]  =  sxz[j][i][l];
-				}
-			}
-		}
-
-
-	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
-
-				/* storage of back side of local volume into buffer */
-				n=1;
-				for (l=1;l<=FDORDER/2;l++){
-					bufferbac_to_fro[j][i][n++]  = syz[j][i][NZ-l+1];
-					bufferbac_to_fro[j][i][n++]  = sxz[j][i][NZ-l+1];
-				}
-
-				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferbac_to_fro[j][i][n++]  = szz[j][i][NZ-l+1];
-				}
-			}
-		}
-
-	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
-
 	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
 		for (i=1;i<=NX;i++){
 			for (j=1;j<=NY;j++){
@@ -256,7 +243,6 @@ double exchange_s(int nt, Tensor3d *s,
 			}
 		}
 
-
 	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
 		for (i=1;i<=NX;i++){
 			for (j=1;j<=NY;j++){
@@ -273,6 +259,42 @@ double exchange_s(int nt, Tensor3d *s,
 
 			}
 		}
+}
+
+
+double exchange_s(int nt, Tensor3d *s,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
+
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, INDEX[7];
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	MPI_Status status;	
+	int nf1, nf2;
+	double time=0.0, time1=0.0, time2=0.0;
+
+	nf1=(3*FDORDER/2)-1;
+	nf2=nf1-1;
+
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+
+	pack_s(s, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);	
+	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+	unpack_s(s, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
 
 	if (LOG)
 		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
@@ -285,21 +307,96 @@ double exchange_s(int nt, Tensor3d *s,
 }
 
 
+/*
+ * Start the non-blocking exchange of the stress tensor components.
+ * See `exchange_v_start` for details, the exchange is completed by
+ * `exchange_s_finish`. With PERSISTENT_COMM `req` are the requests
+ * created by `comm_ini` for these buffers.
+ */
+double exchange_s_start(int nt, Tensor3d *s,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req) {
 
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, PERSISTENT_COMM;
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern int OUTNTIMESTEPINFO;
 
+	int nf1, nf2;
+	int nb[7];
+	double time=0.0, time1=0.0;
 
+	nf1=(3*FDORDER/2)-1;
+	nf2=nf1-1;
 
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
 
+	if (PERSISTENT_COMM) {
+		/* requests prepared by comm_ini */
+		pack_s(s, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+		MPI_Startall(2*REQUEST_COUNT, req);
+	}
+	else {
+		comm_neighbours(nb);
+
+		MPI_Irecv(&rbuffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req[0]);
+		MPI_Irecv(&rbufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req[1]);
+		MPI_Irecv(&rbufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req[2]);
+		MPI_Irecv(&rbufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req[3]);
+		MPI_Irecv(&rbufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req[4]);
+		MPI_Irecv(&rbufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req[5]);
+
+		pack_s(s, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+				bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+		MPI_Isend(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req[6]);
+		MPI_Isend(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req[7]);
+		MPI_Isend(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req[8]);
+		MPI_Isend(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req[9]);
+		MPI_Isend(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req[10]);
+		MPI_Isend(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req[11]);
+	}
 
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
 
+	return time;
+}
 
 
+/*
+ * Complete the exchange started by `exchange_s_start` and copy the
+ * received stress components into the ghost layers of the local grid.
+ */
+double exchange_s_finish(int nt, Tensor3d *s,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req) {
 
+	extern int MYID, LOG;
+	extern int OUTNTIMESTEPINFO;
 
+	double time=0.0, time1=0.0;
 
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
 
+	MPI_Waitall(2*REQUEST_COUNT, req, MPI_STATUSES_IGNORE);
 
+	unpack_s(s, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+			rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro);
 
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
 
-
-
+	return time;
+}
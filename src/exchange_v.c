@@ -4,43 +4,24 @@
 
 
 /*
- * Exchange particle velocities at the grid boundaries between MPI processes.
- *
- * Parameters
- * ----------
- * nt :
- *     Time step.
- * v :
- *     Velocity field.
- * bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
- * bufferfro_to_bac, bufferbac_to_fro :
- *     Buffers used to exchange data between MPI processes in 3D grid.
+ * Copy the particle velocities at the faces of the local grid into the
+ * send buffers. Faces at the edges of the global grid are skipped unless
+ * periodic boundaries are applied.
  */
-double exchange_v(int nt, Velocity *v,
+static void pack_v(Velocity *v,
 	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
 	float *** buffertop_to_bot, float *** bufferbot_to_top,
 	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
 {
-	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, MYID, FDORDER, LOG, INDEX[7];
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
 
 	float ***vx = v->x;
 	float ***vy = v->y;
 	float ***vz = v->z;
 
-	MPI_Status status;	
-	int i, j, k, l, n, nf1, nf2;
-	double time=0.0, time1=0.0, time2=0.0;
-
-	nf1=3*FDORDER/2-1;
-	nf2=nf1-1; 
-
-	if (LOG){
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+	int i, j, k, l, n;
 
-	/* top-bottom -----------------------------------------------------------*/	
+	/* top-bottom -----------------------------------------------------------*/
 
 	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
 		for (i=1;i<=NX;i++){
@@ -75,155 +56,164 @@ double exchange_v(int nt, Velocity *v,
 			}
 		}
 
-	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	/* left-right -----------------------------------------------------------*/
 
-	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
-		for (i=1;i<=NX;i++){
+
+	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
+		for (j=1;j<=NY;j++){
 			for (k=1;k<=NZ;k++){
 
+				/* storage of left edge of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
-					vx[NY+l][i][k] = buffertop_to_bot[i][k][n++];
-					vz[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+					bufferlef_to_rig[j][k][n++]  =  vy[j][l][k];
+					bufferlef_to_rig[j][k][n++]  =  vz[j][l][k];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++)
-					vy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
-
-
+					bufferlef_to_rig[j][k][n++]  =  vx[j][l][k];
 			}
 		}
 
-	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
-		for (i=1;i<=NX;i++){
-			for (k=1;k<=NZ;k++){
 
+	/* no exchange if periodic boundary condition is applied */
+	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
+		for (j=1;j<=NY;j++){
+			for (k=1;k<=NZ;k++){
+				/* storage of right edge of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++)
-					vy[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					bufferrig_to_lef[j][k][n++] =  vx[j][NX-l+1][k];
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					vx[1-l][i][k] = bufferbot_to_top[i][k][n++];
-					vz[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					bufferrig_to_lef[j][k][n++] =  vy[j][NX-l+1][k];
+					bufferrig_to_lef[j][k][n++] =  vz[j][NX-l+1][k];
 				}
 			}
 		}
 
-	/* left-right -----------------------------------------------------------*/	
+	/* front-back -----------------------------------------------------------*/
 
 
-	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
-		for (j=1;j<=NY;j++){
-			for (k=1;k<=NZ;k++){
+	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
+		for (i=1;i<=NX;i++){
+			for (j=1;j<=NY;j++){
 
-				/* storage of left edge of local volume into buffer */
+				/* storage of front side of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
-					bufferlef_to_rig[j][k][n++]  =  vy[j][l][k];
-					bufferlef_to_rig[j][k][n++]  =  vz[j][l][k];
+					bufferfro_to_bac[j][i][n++]  =  vx[j][i][l];
+					bufferfro_to_bac[j][i][n++]  =  vy[j][i][l];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++)
-					bufferlef_to_rig[j][k][n++]  =  vx[j][l][k];
+					bufferfro_to_bac[j][i][n++]  =  vz[j][i][l];
 			}
 		}
 
 
 	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
-		for (j=1;j<=NY;j++){
-			for (k=1;k<=NZ;k++){
-				/* storage of right edge of local volume into buffer */
+	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
+		for (i=1;i<=NX;i++){
+			for (j=1;j<=NY;j++){
+
+				/* storage of back side of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++)
-					bufferrig_to_lef[j][k][n++] =  vx[j][NX-l+1][k];
+					bufferbac_to_fro[j][i][n++]  =  vz[j][i][NZ-l+1];
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferrig_to_lef[j][k][n++] =  vy[j][NX-l+1][k];
-					bufferrig_to_lef[j][k][n++] =  vz[j][NX-l+1][k];
+					bufferbac_to_fro[j][i][n++]  =  vx[j][i][NZ-l+1];
+					bufferbac_to_fro[j][i][n++]  =  vy[j][i][NZ-l+1];
 				}
+
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
 
-	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
-		for (j=1;j<=NY;j++){
+/*
+ * Copy the received particle velocities from the buffers into the
+ * ghost layers of the local grid.
+ */
+static void unpack_v(Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+	float *** buffertop_to_bot, float *** bufferbot_to_top,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
+
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int i, j, k, l, n;
+
+	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
 
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
-					vy[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
-					vz[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
+					vx[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+					vz[NY+l][i][k] = buffertop_to_bot[i][k][n++];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++)
-					vx[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
+					vy[NY+l][i][k] = buffertop_to_bot[i][k][n++];
+
+
 			}
 		}
 
-	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
-		for (j=1;j<=NY;j++){
+	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
 
 				n=1;
 				for (l=1;l<=FDORDER/2;l++)
-					vx[j][1-l][k] = bufferrig_to_lef[j][k][n++];
+					vy[1-l][i][k] = bufferbot_to_top[i][k][n++];
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					vy[j][1-l][k] = bufferrig_to_lef[j][k][n++];
-					vz[j][1-l][k] = bufferrig_to_lef[j][k][n++];
+					vx[1-l][i][k] = bufferbot_to_top[i][k][n++];
+					vz[1-l][i][k] = bufferbot_to_top[i][k][n++];
 				}
-
-
 			}
 		}
 
+	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
+		for (j=1;j<=NY;j++){
+			for (k=1;k<=NZ;k++){
 
-	/* front-back -----------------------------------------------------------*/
-
-
-	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
-
-				/* storage of front side of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++){
-					bufferfro_to_bac[j][i][n++]  =  vx[j][i][l];
-					bufferfro_to_bac[j][i][n++]  =  vy[j][i][l];
+					vy[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
+					vz[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
 				}
 
 				for (l=1;l<=(FDORDER/2-1);l++)
-					bufferfro_to_bac[j][i][n++]  =  vz[j][i][l];
+					vx[j][NX+l][k] = bufferlef_to_rig[j][k][n++];
 			}
 		}
 
-
 	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
+	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
+		for (j=1;j<=NY;j++){
+			for (k=1;k<=NZ;k++){
 
-				/* storage of back side of local volume into buffer */
 				n=1;
 				for (l=1;l<=FDORDER/2;l++)
-					bufferbac_to_fro[j][i][n++]  =  vz[j][i][NZ-l+1];
+					vx[j][1-l][k] = bufferrig_to_lef[j][k][n++];
 
 				for (l=1;l<=(FDORDER/2-1);l++){
-					bufferbac_to_fro[j][i][n++]  =  vx[j][i][NZ-l+1];
-					bufferbac_to_fro[j][i][n++]  =  vy[j][i][NZ-l+1];
+					vy[j][1-l][k] = bufferrig_to_lef[j][k][n++];
+					vz[j][1-l][k] = bufferrig_to_lef[j][k][n++];
 				}
 
+
 			}
 		}
 
-	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
-
 	/* no exchange if periodic boundary condition is applied */
 	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
 		for (i=1;i<=NX;i++){
@@ -257,8 +247,55 @@ double exchange_v(int nt, Velocity *v,
 				}
 			}
 		}
+}
 
 
+/*
+ * Exchange particle velocities at the grid boundaries between MPI processes.
+ *
+ * Parameters
+ * ----------
+ * nt :
+ *     Time step.
+ * v :
+ *     Velocity field.
+ * bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+ * bufferfro_to_bac, bufferbac_to_fro :
+ *     Buffers used to exchange data between MPI processes in 3D grid.
+ */
+double exchange_v(int nt, Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+	float *** buffertop_to_bot, float *** bufferbot_to_top,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, INDEX[7];
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	MPI_Status status;
+	int nf1, nf2;
+	double time=0.0, time1=0.0, time2=0.0;
+
+	nf1=3*FDORDER/2-1;
+	nf2=nf1-1;
+
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+
+	pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+		bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+	unpack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+		bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
 	if (LOG)
 		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
 			time2=MPI_Wtime();
@@ -268,3 +305,138 @@ double exchange_v(int nt, Velocity *v,
 	return time;
 
 }
+
+
+/*
+ * Start the non-blocking exchange of particle velocities.
+ *
+ * The faces of the local grid are copied into the send buffers and
+ * all receives and sends are posted at once. Messages across the edges of
+ * the global grid are not sent at all (MPI_PROC_NULL) unless periodic
+ * boundaries are applied. The velocities in the shell of the local grid
+ * must be final when this function is called; the exchange is
+ * completed by `exchange_v_finish`.
+ *
+ * Parameters
+ * ----------
+ * nt :
+ *     Time step.
+ * v :
+ *     Velocity field.
+ * bufferlef_to_rig, ..., bufferbac_to_fro :
+ *     Send buffers.
+ * rbufferlef_to_rig, ..., rbufferbac_to_fro :
+ *     Receive buffers of the same size as the corresponding send buffers.
+ * req :
+ *     Output, 12 requests which are completed by `exchange_v_finish`.
+ *     With PERSISTENT_COMM the requests created by `comm_ini` for
+ *     these buffers, which are started here.
+ *
+ * Returns
+ * -------
+ * Real time spent in this function (only measured on PE 0 when
+ * timing information is printed).
+ */
+double exchange_v_start(int nt, Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+	float *** buffertop_to_bot, float *** bufferbot_to_top,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+	float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+	float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+	float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+	MPI_Request *req)
+{
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, PERSISTENT_COMM;
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern int OUTNTIMESTEPINFO;
+
+	int nf1, nf2;
+	int nb[7];
+	double time=0.0, time1=0.0;
+
+	nf1=3*FDORDER/2-1;
+	nf2=nf1-1;
+
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+
+	if (PERSISTENT_COMM) {
+		/* requests prepared by comm_ini */
+		pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+		MPI_Startall(2*REQUEST_COUNT, req);
+	}
+	else {
+		comm_neighbours(nb);
+
+		MPI_Irecv(&rbuffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req[0]);
+		MPI_Irecv(&rbufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req[1]);
+		MPI_Irecv(&rbufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req[2]);
+		MPI_Irecv(&rbufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req[3]);
+		MPI_Irecv(&rbufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req[4]);
+		MPI_Irecv(&rbufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req[5]);
+
+		pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+		MPI_Isend(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req[6]);
+		MPI_Isend(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req[7]);
+		MPI_Isend(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req[8]);
+		MPI_Isend(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req[9]);
+		MPI_Isend(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req[10]);
+		MPI_Isend(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req[11]);
+	}
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
+
+	return time;
+}
+
+
+/*
+ * Complete the exchange started by `exchange_v_start` and copy the
+ * received particle velocities into the ghost layers of the local grid.
+ *
+ * Parameters
+ * ----------
+ * nt :
+ *     Time step.
+ * v :
+ *     Velocity field.
+ * rbufferlef_to_rig, ..., rbufferbac_to_fro :
+ *     Receive buffers passed to `exchange_v_start`.
+ * req :
+ *     Requests returned by `exchange_v_start`.
+ *
+ * Returns
+ * -------
+ * Real time spent in this function (only measured on PE 0 when
+ * timing information is printed).
+ */
+double exchange_v_finish(int nt, Velocity *v,
+	float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+	float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+	float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+	MPI_Request *req)
+{
+	extern int MYID, LOG;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0;
+
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+
+	MPI_Waitall(2*REQUEST_COUNT, req, MPI_STATUSES_IGNORE);
+
+	unpack_v(v, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+		rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro);
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
+
+	return time;
+}
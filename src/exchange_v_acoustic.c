@@ -8,31 +8,23 @@
 #include "globvar.h"
 
 
-double exchange_v(int nt, Velocity *v,
+/*
+ * Copy the particle velocities at the faces of the local grid into the
+ * send buffers. Only the velocity component normal to a face is exchanged.
+ */
+static void pack_v(Velocity *v,
 		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
 		float *** buffertop_to_bot, float *** bufferbot_to_top,
 		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
 
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
 
-	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, MYID, FDORDER, LOG, INDEX[7];
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
-
-	MPI_Status status;	
-	int i, j, k, l, nf1, nf2;
-	double time=0.0, time1=0.0, time2=0.0;
+	int i, j, k, l;
 
         float ***vx = v->x;
         float ***vy = v->y;
         float ***vz = v->z;
 
-	nf1=(FDORDER/2)-1;
-	nf2=FDORDER/2;
-
-	if (LOG){
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
-
 	/* top-bottom -----------------------------------------------------------*/	
 
 	if (POS[2]!=0)	/* no boundary exchange at top of global grid */
@@ -58,73 +50,102 @@ double exchange_v(int nt, Velocity *v,
 			}
 		}
 
+	/* left-right -----------------------------------------------------------*/	
 
-	/* persistent communication see comm_ini.c*/
 
-	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
+		for (j=1;j<=NY;j++){
+			for (k=1;k<=NZ;k++){
+
+				/* storage of left edge of local volume into buffer */
+				for (l=1;l<=(FDORDER/2-1);l++)
+					bufferlef_to_rig[j][k][l]  =  vx[j][l][k];
+			}
+		}
 
-	/*
-	MPI_Bsend(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Recv(&buffertop_to_bot[1][1][1], NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
-	MPI_Bsend(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Recv(&bufferbot_to_top[1][1][1], NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG6,MPI_COMM_WORLD,&status);			
-	 */
 
-	if (POS[2]!=NPROCY-1)	/* no boundary exchange at bottom of global grid */
-		for (i=1;i<=NX;i++){
+	/* no exchange if periodic boundary condition is applied */
+	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
+		for (j=1;j<=NY;j++){
 			for (k=1;k<=NZ;k++){
+				/* storage of right edge of local volume into buffer */
+				for (l=1;l<=FDORDER/2;l++)
+					bufferrig_to_lef[j][k][l] =  vx[j][NX-l+1][k];
+			}
+		}
 
+	/* front-back -----------------------------------------------------------*/
 
-				for (l=1;l<=(FDORDER/2-1);l++)
-					vy[NY+l][i][k] = buffertop_to_bot[i][k][l];
 
+	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
+		for (i=1;i<=NX;i++){
+			for (j=1;j<=NY;j++){
 
+				/* storage of front side of local volume into buffer */
+
+				for (l=1;l<=(FDORDER/2-1);l++)
+					bufferfro_to_bac[j][i][l]  =  vz[j][i][l];
 			}
 		}
 
 
-	if (POS[2]!=0)	/* no boundary exchange at top of global grid */
+	/* no exchange if periodic boundary condition is applied */
+	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
 		for (i=1;i<=NX;i++){
-			for (k=1;k<=NZ;k++){
+			for (j=1;j<=NY;j++){
 
+				/* storage of back side of local volume into buffer */
 				for (l=1;l<=FDORDER/2;l++)
-					vy[1-l][i][k] = bufferbot_to_top[i][k][l];
+					bufferbac_to_fro[j][i][l]  =  vz[j][i][NZ-l+1];
 
 			}
 		}
+}
 
-	/* left-right -----------------------------------------------------------*/	
 
+/*
+ * Copy the received particle velocities into the ghost layers
+ * of the local grid.
+ */
+static void unpack_v(Velocity *v,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
 
-	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
-		for (j=1;j<=NY;j++){
+	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, FDORDER;
+
+	int i, j, k, l;
+
+        float ***vx = v->x;
+        float ***vy = v->y;
+        float ***vz = v->z;
+
+	/* top-bottom -----------------------------------------------------------*/	
+
+	if (POS[2]!=NPROCY-1)	/* no boundary exchange at bottom of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
 
-				/* storage of left edge of local volume into buffer */
+
 				for (l=1;l<=(FDORDER/2-1);l++)
-					bufferlef_to_rig[j][k][l]  =  vx[j][l][k];
+					vy[NY+l][i][k] = buffertop_to_bot[i][k][l];
+
+
 			}
 		}
 
 
-	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
-		for (j=1;j<=NY;j++){
+	if (POS[2]!=0)	/* no boundary exchange at top of global grid */
+		for (i=1;i<=NX;i++){
 			for (k=1;k<=NZ;k++){
-				/* storage of right edge of local volume into buffer */
+
 				for (l=1;l<=FDORDER/2;l++)
-					bufferrig_to_lef[j][k][l] =  vx[j][NX-l+1][k];
+					vy[1-l][i][k] = bufferbot_to_top[i][k][l];
+
 			}
 		}
 
-
-	/* persistent communication see comm_ini.c*/
-	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
-
+	/* left-right -----------------------------------------------------------*/	
 
 	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
 		for (j=1;j<=NY;j++){
@@ -149,60 +170,66 @@ double exchange_v(int nt, Velocity *v,
 			}
 		}
 
-
 	/* front-back -----------------------------------------------------------*/
 
-
-	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
+	/* no exchange if periodic boundary condition is applied */
+	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
 		for (i=1;i<=NX;i++){
 			for (j=1;j<=NY;j++){
 
-				/* storage of front side of local volume into buffer */
 
 				for (l=1;l<=(FDORDER/2-1);l++)
-					bufferfro_to_bac[j][i][l]  =  vz[j][i][l];
+					vz[j][i][NZ+l] = bufferfro_to_bac[j][i][l];
+
+
 			}
 		}
 
 
 	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
+	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
 		for (i=1;i<=NX;i++){
 			for (j=1;j<=NY;j++){
-
-				/* storage of back side of local volume into buffer */
 				for (l=1;l<=FDORDER/2;l++)
-					bufferbac_to_fro[j][i][l]  =  vz[j][i][NZ-l+1];
-
+					vz[j][i][1-l] = bufferbac_to_fro[j][i][l];
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
 
-	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
+double exchange_v(int nt, Velocity *v,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
 
 
-				for (l=1;l<=(FDORDER/2-1);l++)
-					vz[j][i][NZ+l] = bufferfro_to_bac[j][i][l];
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, INDEX[7];
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
 
+	MPI_Status status;	
+	int nf1, nf2;
+	double time=0.0, time1=0.0, time2=0.0;
 
-			}
-		}
+	nf1=(FDORDER/2)-1;
+	nf2=FDORDER/2;
 
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
 
-	/* no exchange if periodic boundary condition is applied */
-	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
-		for (i=1;i<=NX;i++){
-			for (j=1;j<=NY;j++){
-				for (l=1;l<=FDORDER/2;l++)
-					vz[j][i][1-l] = bufferbac_to_fro[j][i][l];
-			}
-		}
+	pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+		bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
 
+	unpack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+		bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
 
 	if (LOG)
 		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
@@ -213,3 +240,96 @@ double exchange_v(int nt, Velocity *v,
 	return time;
 
 }
+
+
+/*
+ * Start the non-blocking exchange of particle velocities, see
+ * `exchange_v_start` in exchange_v.c. With PERSISTENT_COMM the requests
+ * created by `comm_ini` (nf1=FDORDER/2-1, nf2=FDORDER/2) are started.
+ */
+double exchange_v_start(int nt, Velocity *v,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req) {
+
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, PERSISTENT_COMM;
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern int OUTNTIMESTEPINFO;
+
+	int nf1, nf2;
+	int nb[7];
+	double time=0.0, time1=0.0;
+
+	nf1=(FDORDER/2)-1;
+	nf2=FDORDER/2;
+
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+
+	if (PERSISTENT_COMM) {
+		/* requests prepared by comm_ini */
+		pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+		MPI_Startall(2*REQUEST_COUNT, req);
+	}
+	else {
+		comm_neighbours(nb);
+
+		MPI_Irecv(&rbuffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req[0]);
+		MPI_Irecv(&rbufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req[1]);
+		MPI_Irecv(&rbufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req[2]);
+		MPI_Irecv(&rbufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req[3]);
+		MPI_Irecv(&rbufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req[4]);
+		MPI_Irecv(&rbufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req[5]);
+
+		pack_v(v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+			bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+		MPI_Isend(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req[6]);
+		MPI_Isend(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req[7]);
+		MPI_Isend(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req[8]);
+		MPI_Isend(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req[9]);
+		MPI_Isend(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req[10]);
+		MPI_Isend(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req[11]);
+	}
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
+
+	return time;
+}
+
+
+/*
+ * Complete the exchange started by `exchange_v_start`.
+ */
+double exchange_v_finish(int nt, Velocity *v,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req) {
+
+	extern int MYID, LOG;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0;
+
+	if (LOG){
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
+
+	MPI_Waitall(2*REQUEST_COUNT, req, MPI_STATUSES_IGNORE);
+
+	unpack_v(v, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+		rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro);
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			time=MPI_Wtime()-time1;
+
+	return time;
+}
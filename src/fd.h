@@ -39,7 +39,12 @@
 void removespace(char *str);
 void madinput(char header[],float ***DEN );
 
-void absorb(float *** absorb_coeff);
+void absorb(AbsorbFrame *frame, int na);
+
+void absorb_free(AbsorbFrame *frame);
+
+void absorb_damp(const AbsorbFrame *frame, int nx1, int nx2, int ny1, int ny2,
+        int nz1, int nz2, int n, float ***u[]);
 
 void absorb_PML(float *** absorb_coeffx, float *** absorb_coeffy, float *** absorb_coeffz);
 
@@ -52,6 +57,8 @@ void CPML_coeff(float * K_x, float * alpha_prime_x, float * a_x, float * b_x,
 
 void CPML_ini_elastic(int * xb, int * yb, int * zb);
 
+int CPML_boxes(const int * xb, const int * yb, const int * zb, int interior, CpmlBox * box);
+
 void av_mat(float *** rho,
         float *** C44, float *** C55, float *** C66,
         float *** taus,
@@ -70,21 +77,26 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 void checkfd_rsg(FILE *fp, float *** prho, float *** ppi, float *** pu,
         float *** ptaus, float *** ptaup, float *peta);
 
-void comm_ini(float *** bufferlef_to_rig,
-        float *** bufferrig_to_lef, float *** buffertop_to_bot,
-        float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
+void comm_neighbours(int *nb);
 
-void comm_ini_s(float *** bufferlef_to_rig,
-        float *** bufferrig_to_lef, float *** buffertop_to_bot,
-        float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
+void decomp(int nxg, int nyg, int nzg);
 
-void comm_ini_acoustic(float *** bufferlef_to_rig,
-        float *** bufferrig_to_lef, float *** buffertop_to_bot,
-        float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
+void decomp_procs(int np, int nf);
 
+int decomp_owner(const int *off, int nproc, int g);
+
+int decomp_samples(const int *off, int nproc, int id, int *ns);
+
+void comm_ini(int nf1, int nf2,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
+void comm_free(MPI_Request *req);
 
 void eqsource(int nt, Tensor3d *s,
         float **  srcpos_loc, float ** signals, int nsrc, int * stype,
@@ -103,11 +115,41 @@ double exchange_s(int nt, Tensor3d *s,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
         float *** bufferfro_to_bac, float *** bufferbac_to_fro);
 
+double exchange_s_start(int nt, Tensor3d *s,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
+double exchange_s_finish(int nt, Tensor3d *s,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
 double exchange_s_acoustic(int nt, float *** sxx,
         float *** bufferlef_to_rig, float *** bufferrig_to_lef,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
         float *** bufferfro_to_bac, float *** bufferbac_to_fro);
 
+double exchange_s_acoustic_start(int nt, float *** sxx,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
+double exchange_s_acoustic_finish(int nt, float *** sxx,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
 void exchange_v_rsg(int nt, float *** vx, float *** vy, float *** vz,
         float *** bufferlef_to_rig, float *** bufferrig_to_lef,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
@@ -118,14 +160,22 @@ double exchange_v(int nt, Velocity *v,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
         float *** bufferfro_to_bac, float *** bufferbac_to_fro);
 
-void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
-        Velocity *v,
-        Tensor3d *s,
-        Tensor3d *r,
-        float *** psi_sxx_x, float *** psi_sxy_x, float *** psi_sxz_x, float *** psi_sxy_y,
-        float *** psi_syy_y, float *** psi_syz_y, float *** psi_sxz_z, float *** psi_syz_z, float *** psi_szz_z,
-        float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
-        float *** psi_vxz, float *** psi_vyz, float *** psi_vzz);
+double exchange_v_start(int nt, Velocity *v,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
+double exchange_v_finish(int nt, Velocity *v,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req);
+
+int read_checkpoint(Checkpoint *c);
 
 void info(FILE *fp);
 
@@ -142,6 +192,12 @@ void matcopy_acoustic(float *** rho, float *** pi);
 
 void merge(int nsnap, int type);
 
+void merge_planes(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        const int *nxs, const int *nys, const int *nzs, int format);
+
+double merge_frames(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        const int *nxs, const int *nys, const int *nzs);
+
 void mergemod(char modfile[STRING_SIZE], int format);
 
 void merge_source_field(char modfile[STRING_SIZE], int format);
@@ -169,6 +225,12 @@ void outseis_glob(FILE *fp, FILE *fpdata, float **section,
         int **recpos, int **recpos_loc, int ntr, float ** srcpos,
         int nsrc, int ns, int seis_form[6], int ishot, int comp);
 
+void outseis_glob_header(FILE *fpdata, int ntr, int ns, int seis_form[6]);
+
+void outseis_glob_traces(FILE *fp, FILE *fpdata, float **section,
+        int **recpos, int **recpos_loc, int tr1, int tr2, int ntr, float ** srcpos,
+        int nsrc, int ns, int seis_form[6], int ishot, int comp);
+
 void output_source_signal(FILE *fp, float **signals, int ns, int seis_form);
 
 int plane_wave(float *** force_points);
@@ -199,11 +261,21 @@ void readbufv(float *** vx, float *** vy, float *** vz,
 
 float readdsk(FILE *fp_in, int format);
 
+void readdsk_block(FILE *fp_in, float *buf, int n, int format);
+
 
 void read_par_json(FILE *fp, char *fileinp);
 
 void readmod_acoustic(float  ***  rho, float ***  pi, int ishot);
 
+int modfile_open(ModelFile *f, const char *filename);
+
+int modfile_planes(void);
+
+void modfile_read(ModelFile *f);
+
+void modfile_close(ModelFile *f);
+
 void readmod(float ***rho, float ***pi, float ***u,
              float ***C11, float ***C12, float ***C13,
              float ***C22, float ***C23, float ***C33,
@@ -220,18 +292,44 @@ void saveseis(FILE *fp, float **sectionvx, float **sectionvy,float **sectionvz,
 void saveseis_glob(FILE *fp, float **sectiondata,
         int  **recpos, int ntr, float ** srcpos, int nsrc,int ns, int sectiondatatype);
 
-void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
-        Velocity *v,
-        Tensor3d *s,
-        Tensor3d *r,
-        float *** psi_sxx_x, float *** psi_sxy_x, float *** psi_sxz_x,
-        float *** psi_sxy_y, float *** psi_syy_y, float *** psi_syz_y, float *** psi_sxz_z, float *** psi_syz_z, float *** psi_szz_z,
-        float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
-        float *** psi_vxz, float *** psi_vyz, float *** psi_vzz);
+void seis_glob_file(char *file, int ishot, int sectiondatatype);
+
+MPI_File seis_mpiio_open(char *file, int ntr_glob, int ns, int seis_form[6],
+        MPI_Offset *hdr);
+
+void seis_mpiio_traces(MPI_File fh, MPI_Offset hdr, float **section,
+        int **recpos, int *traces, int n, int ntr_glob, float **srcpos,
+        int ishot, int ns, int seis_form[6], int comp);
+
+void saveseis_mpiio(FILE *fp, float **section[6], int **recpos, int *recswitch,
+        int ntr, int ntr_glob, float **srcpos, int ishot, int ns);
+
+void seis_stream_flush(float **section[6], int ntr, int nb, int ncol,
+        int iblock);
+
+void seis_stream_write(FILE *fp, float **section[6], int **recpos,
+        int *recswitch, int ntr, int ntr_glob, float **srcpos, int ishot,
+        int ns, int nb, int nrec);
+
+void save_checkpoint(const Checkpoint *c, int async);
+
+void checkpoint_wait(void);
+
+int checkpoint_fields(const Checkpoint *c, CheckpointField *f);
+
+void checkpoint_header(const Checkpoint *c, CheckpointHeader *h);
+
+uint64_t checkpoint_checksum(const float *buf, size_t n);
+
+void checkpoint_copy(const CheckpointField *f, int nf, float *buf, int store);
+
+int checkpoint_rank(void);
+
+MPI_Offset checkpoint_offset(size_t size);
 
 void seismo_acoustic(int lsamp, int ntr, int **recpos, float **sectionvx, float **sectionvy,
         float **sectionvz, float **sectiondiv, float **sectioncurl, float **sectionp,
-        Velocity *v, float ***sxx, float ***pi);
+        Velocity *v, float ***sxx, float ***pi, int ny1, int ny2);
 
 void seismo(int lsamp, int ntr, int **recpos, float **sectionvx, float **sectionvy,
         float **sectionvz, float **sectiondiv, float **sectioncurl, float **sectionp,
@@ -253,6 +351,45 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
         int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2,
         int ny2, int nz2);
 
+void snap_copy(float *buf, float ***a, int idx, int idy, int idz,
+        int nx1, int ny1, int nz1, int nx2, int ny2, int nz2);
+
+void snap_write(FILE *fp, const char *pefile, const char *mfile, int nsnap,
+        int format, const float *buf, int nxs, int nys, int nzs);
+
+int snap_write_pe(const char *pefile, int nsnap, int format,
+        const float *buf, int nxs, int nys, int nzs);
+
+int snap_compress_pe(const char *pefile, int nsnap, const float *buf,
+        int nxs, int nys, int nzs);
+
+long long snap_compress_read(FILE *fp, float *buf, int nxs, int nys, int nzs);
+
+void snap_async_start(void);
+
+int snap_async_submit(const char *pefile, int nsnap, int format,
+        const float *buf, int nxs, int nys, int nzs);
+
+void snap_async_wait(void);
+
+void snap_async_stop(void);
+
+void snap_async_exposed(double t);
+
+void snap_async_times(double *hidden, double *exposed);
+
+void snap_plan_init(FILE *fp);
+
+int snap_plan_n(void);
+
+int snap_plan_box(int ip, int *nx1, int *nx2, int *ny1, int *ny2, int *nz1,
+        int *nz2);
+
+void snap_plan_write(FILE *fp, int ip, const char *mfile, int nsnap,
+        const float *buf);
+
+void snap_plan_free(void);
+
 
 void snap_rsg(FILE *fp, int nt, int nsnap, int format, int type,
         float ***vx, float ***vy, float ***vz, float ***sxx, float ***syy, float ***szz,
@@ -271,6 +408,36 @@ int **splitrec(int **recpos,int *ntr_loc, int ntr,int *recswitch);
 
 float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype);
 
+void shell_width(int *w, int wtop);
+
+void shell_fit_sources(int *xb, int *yb, int *zb, int *w,
+        float **srcpos_loc, int nsrc);
+
+void shell_boxes(int *xb, int *yb, int *zb, int *w, GridBox *box);
+
+void shell_sources(int nbox, GridBox *box, int fp,
+        float **srcpos_loc, float **signals, int nsrc, int *stype,
+        PointSources *ps);
+
+void free_shell_sources(int nbox, PointSources *ps);
+
+void tile_auto(void);
+
+int tile_boxes(GridBox *box, int *tile, GridBox **tiles);
+
+int tblock_width(void);
+
+double exchange_halo(int n, float ****a, int w);
+
+void tblock_sources(float **srcpos, int nsrc, int *stype, PointSources *ps);
+
+double tblock_acoustic(int nt1, int nt2, int lsamp, int nlsamp,
+        Velocity *v, float ***sxx, float ***rho, float ***pi, const AbsorbFrame *absorb_frame,
+        PointSources *ps, int ntr, int **recpos_loc,
+        float **sectionvx, float **sectionvy, float **sectionvz,
+        float **sectiondiv, float **sectioncurl, float **sectionp,
+        double *time_exchange);
+
 void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** taup,
         float * eta, Tensor3d *s,
         Tensor3d *r, Velocity *v,
@@ -283,7 +450,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
         float * K_x, float * a_x, float * b_x, float * K_z, float * a_z, float * b_z,
         float *** psi_vxx, float *** psi_vzz );
 
-void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v);
+void surface_acoustic(int ndepth, int nx1, int nx2, int nz1, int nz2,
+        float *** pi, float *** sxx, Velocity *v);
 
 void timing(double * time_v_update,  double * time_s_update, double * time_s_exchange, double * time_v_exchange,
         double * time_timestep, int ishot);
@@ -319,6 +487,32 @@ void compute_vel_deriv_2nd_order(Velocity *v, int i, int j, int k, Strain_ijk *e
 
 void update_s_ijk_2nd_order(OrthoPar *op, Strain_ijk *e, int i, int j, int k, Tensor3d *s);
 
+int simd_level(void);
+
+int update_s_elastic_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, OrthoPar *op);
+
+int update_v_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, float ***rjp, float ***rkp, float ***rip);
+
+int update_simd_mat16(const OrthoPar16 *m);
+
+float mat16_to_float(uint16_t h, int format);
+
+uint16_t mat16_from_float(float x, int format);
+
+void mat16_pack(OrthoPar *op, float ***rjp, float ***rkp, float ***rip,
+        OrthoPar16 *m, int format);
+
+void mat16_free(OrthoPar16 *m);
+
+int update_simd_table(const MatTable *t);
+
+int mat_table_build(OrthoPar *op, float ***rjp, float ***rkp, float ***rip,
+        MatTable *t);
+
+void mat_table_free(MatTable *t);
+
 /*double update_s_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
  float *** vx, float *** vy, float *** vz, float *** sxx, float *** syy, float *** szz, float *** sxy,
  float *** syz, float *** sxz, float *** vx1, float *** vy1, float *** vz1, float *** sxx1, float *** syy1, float *** szz1, float *** sxy1,
@@ -328,7 +522,7 @@ void update_s_ijk_2nd_order(OrthoPar *op, Strain_ijk *e, int i, int j, int k, Te
  float ***  u, float ***  uipjp, float ***  ujpkp, float ***  uipkp, float  ***  taus, float  ***  tausipjp, float  ***  tausjpkp,
  float  ***  tausipkp, float  ***  taup, float *  eta, float *** absorb_coeffx, float *** absorb_coeffy, float *** absorb_coeffz);*/
 
-double update_s_CPML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt, Velocity *v,
+double update_s_CPML(int nbox, const CpmlBox *cpml, int nt, Velocity *v,
              Tensor3d *s,
                      Tensor3d *r,
                      float ***  pi, float ***  u, float ***  uipjp, float ***  ujpkp, float ***  uipkp,
@@ -338,14 +532,14 @@ double update_s_CPML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int n
         float * K_z, float * a_z, float * b_z, float * K_z_half, float * a_z_half, float * b_z_half,
         float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy, float *** psi_vxz, float *** psi_vyz, float *** psi_vzz);
 
-double update_s_CPML_elastic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt, Velocity *v,
+double update_s_CPML_elastic(int nbox, const CpmlBox *cpml, int nt, Velocity *v,
         Tensor3d *s, OrthoPar *op,
         float * K_x, float * a_x, float * b_x, float * K_x_half, float * a_x_half, float * b_x_half,
         float * K_y, float * a_y, float * b_y, float * K_y_half, float * a_y_half, float * b_y_half,
         float * K_z, float * a_z, float * b_z, float * K_z_half, float * a_z_half, float * b_z_half,
         float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy, float *** psi_vxz, float *** psi_vyz, float *** psi_vzz);
 
-double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
+double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                  Velocity *v, float *** sxx, float ***  pi);
 
 double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
@@ -365,12 +559,15 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         int nt, Velocity *v,
         Tensor3d *s,
         float  *** rjp, float  *** rkp, float  *** rip,
-        float **  srcpos_loc, float ** signals, int nsrc, float ***absorb_coeff, int * stype,
+        float **  srcpos_loc, float ** signals, int nsrc, const AbsorbFrame *absorb_frame, int * stype,
         StressDerivativesWrtVelocity *ds_dv,
         StressDerivativesWrtVelocity *ds_dv_2,
         StressDerivativesWrtVelocity *ds_dv_3,
         StressDerivativesWrtVelocity *ds_dv_4);
 
+void absorb_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Tensor3d *s, const AbsorbFrame *absorb_frame);
+
 /*double update_v_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt, float *** vx, float *** vy, float *** vz,
 float *** sxx, float *** syy, float *** szz, float *** sxy,float *** syz, float *** sxz, float *** vx1, float *** vy1,
 float *** vz1, float *** sxx1, float *** syy1, float *** szz1, float *** sxy1, float *** syz1, float *** sxz1, float *** vx2,
@@ -379,7 +576,7 @@ float *** vx3, float *** vy3, float *** vz3, float *** sxx3, float *** syy3, flo
 float *** sxz3,float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc, float *** absorb_coeffx, float *** absorb_coeffy, float *** absorb_coeffz, int * stype);*/
 
 double update_v_CPML(
-        int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        int nbox, const CpmlBox *cpml,
         int nt, Velocity *v,
         Tensor3d *s,
         // float  ***rho,
@@ -393,7 +590,10 @@ double update_v_CPML(
 
 double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         int nt, Velocity *v,
-        float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc, float ***absorb_coeff, int * stype);
+        float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc, const AbsorbFrame *absorb_frame, int * stype);
+
+void absorb_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        float *** sxx, const AbsorbFrame *absorb_frame);
 
 double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         int nt, Velocity *v, float *** sxx,  float *** vx1,
@@ -421,6 +621,8 @@ void writebufv(float *** vx, float *** vy, float *** vz,
 
 void writedsk(FILE *fp_out, float amp, int format);
 
+void writedsk_block(FILE *fp_out, const float *buf, int n, int format);
+
 void writemod(char modfile[STRING_SIZE], float *** rho, int format);
 
 void writepar(FILE *fp, int ns);
@@ -431,6 +633,10 @@ void write_source_field(char source_field_file[STRING_SIZE],
 void zero_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Velocity *v,
         float *** sxx);
 
+void zero_PML_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        float *** vx1, float *** vy2, float *** vz3,
+        float *** sxx1, float *** sxx2, float *** sxx3);
+
 void zero_elastic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Velocity *v,
                   Tensor3d *s,
                   VelocityDerivativesTensor *dv,
@@ -509,6 +715,11 @@ int *ivector(int nl, int nh);
 int **imatrix(int nrl, int nrh, int ncl, int nch);
 
 float ***f3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh);
+float ***f3tensor_aligned(int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
+int f3tensor_aligned_ld(int ndl, int ndh);
+int f3tensor_aligned_front(int ndl);
+uint16_t ***u16tensor(int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
+uint8_t ***u8tensor(int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
 
 void free_vector(float *v, int nl, int nh);
 void free_ivector(int *v, int nl, int nh);
@@ -516,6 +727,12 @@ void free_matrix(float **m, int nrl, int nrh, int ncl, int nch);
 void free_imatrix(int **m, int nrl, int nrh, int ncl, int nch);
 void free_f3tensor(float ***t, int nrl, int nrh, int ncl, int nch, int ndl,
         int ndh);
+void free_f3tensor_aligned(float ***t, int nrl, int nrh, int ncl, int nch,
+        int ndl, int ndh);
+void free_u16tensor(uint16_t ***t, int nrl, int nrh, int ncl, int nch,
+        int ndl, int ndh);
+void free_u8tensor(uint8_t ***t, int nrl, int nrh, int ncl, int nch,
+        int ndl, int ndh);
 
 double *dvector(int nl, int nh);
 void free_dvector(double *v, int nl, int nh);
@@ -52,6 +52,27 @@ extern int SOFI3DVERS; /* version of SOFI3D 33: current 3D isotropic elastic (SS
 
 // MPI variables.
 extern int NP, NPSP, NPROC, NPROCX, NPROCY, NPROCZ, MYID, IENDX, IENDY, IENDZ;
+extern int OVERLAP_COMM; /* overlap the exchange of the wavefield with the update of the subdomain interior */
+extern int PERSISTENT_COMM; /* exchange the wavefield with persistent MPI requests, see comm_ini.c */
+extern int THREADS; /* number of OpenMP threads per MPI process */
+extern int SIMD; /* highest instruction set of the vectorized kernels, see enum.h */
+extern int TILE_X, TILE_Y, TILE_Z; /* tile sizes of the update loops, 0: no tiling, see tiles.c */
+extern int TILE_AUTO; /* choose TILE_X and TILE_Z from the L2 cache size */
+extern int TIME_BLOCK; /* time steps per sweep of the acoustic program, see tblock_acoustic.c */
+extern int MAT_PRECISION; /* storage of the material parameters, see enum.h and mat16.c */
+extern int MAT_COMPRESS; /* table of distinct media and index volume, see mat_table.c */
+extern int SNAP_MPIIO; /* write the snapshots into one file per component with MPI-IO, see snap_write.c */
+extern int SNAP_ASYNC; /* write the snapshots on an I/O thread, see snap_async.c */
+extern int SNAP_COMPRESS; /* compression of the snapshots of the PEs, see snap_compress.c */
+extern float SNAP_TOL; /* error bound of the lossy snapshot compression */
+extern char SNAP_PLAN[STRING_SIZE]; /* planes and boxes written instead of the whole model, see snap_plan.c */
+extern int CHECKPT_INC; /* time steps between periodic checkpoints, see save_checkpoint.c */
+extern int CHECKPT_MPIIO; /* write the checkpoint into one file with MPI-IO */
+extern int SEIS_BLOCK; /* seismogram samples kept in memory per trace, see seis_stream.c */
+extern int SEIS_MPIIO; /* each PE writes its seismogram traces with MPI-IO, see seis_mpiio.c */
+extern int DECOMP; /* sizes of the sub grids, 0: equal, 1: balanced cost, see decomp.c */
+extern float DECOMP_CPML; /* extra cost of a grid point in the CPML frame for DECOMP=1 */
+extern int OFFX[NPROCX_MAX + 1], OFFY[NPROCY_MAX + 1], OFFZ[NPROCZ_MAX + 1]; /* global grid points before the sub grid of each PE position */
 extern int POS[4], INDEX[7];
 extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
 
@@ -1,7 +1,8 @@
 /* ----------------------------------------------------------------------
  * This is function initproc.
    Dividing the 3-D FD grid into domains and assigning the
-   PEs to these domains,
+   PEs to these domains, the sizes of the domains are computed
+   by decomp(), the PEs are placed by MPI_Cart_create.
    
 ----------------------------------------------------------------------*/
 
@@ -13,59 +14,69 @@ void initproc(void)	{
 
 	extern int NX, NY, NZ, IENDX, IENDY, IENDZ, POS[4], INDEX[7];
 	extern int NP, NPROC, NPROCX, NPROCY, NPROCZ, MYID;
+	extern int OFFX[], OFFY[], OFFZ[];
 	extern FILE *FP;
 
+	int p, rank, dims[3], periods[3]={1,1,1}, coords[3], nb[6];
+	MPI_Comm comm_cart;
+	MPI_Group group_cart, group_world;
+
 	if ((NPROC != NP)  && (MYID==0)) {
 		fprintf(FP,"You specified NPROC =  %d (in parameter file) and NP = %d (command line) \n",NPROC,NP);
 		err("NP and NPROC differ!");
 	}
 
 
-	// Determine the length of the subarray on this processor.
-	IENDX = NX / NPROCX;
-	IENDY = NY / NPROCY;
-	IENDZ = NZ / NPROCZ;
-
-	/* POS(1) indicates x POSition of the processor in the 
-		     logical 3D processor array*/
-	if ((NX % NPROCX) > 0)
-		err("NX % NPROCX must be zero!");
-	if ((NY % NPROCY) > 0)
-		err("NY % NPROCY must be zero!");
-	if ((NZ % NPROCZ) > 0)
-		err("NZ % NPROCZ must be zero!");
+	/* sizes of the sub grids of all PEs, see decomp.c */
+	decomp(NX, NY, NZ);
 
 	MPI_Barrier(MPI_COMM_WORLD);
 	if (MYID==0){
 		/*note that "y" denotes the vertical coordinate*/
 		fprintf(FP,"\n **Message from initprocs (printed by PE %d):\n",MYID);
 		fprintf(FP," Size of subarrays in gridpoints:\n");
-		fprintf(FP," IENDX = %d\n",IENDX);
-		fprintf(FP," IENDY = %d\n",IENDY);
-		fprintf(FP," IENDZ (vertical) = %d\n",IENDZ);
+		fprintf(FP," IENDX =");
+		for (p=0;p<NPROCX;p++) fprintf(FP," %d",OFFX[p+1]-OFFX[p]);
+		fprintf(FP,"\n IENDY =");
+		for (p=0;p<NPROCY;p++) fprintf(FP," %d",OFFY[p+1]-OFFY[p]);
+		fprintf(FP,"\n IENDZ (vertical) =");
+		for (p=0;p<NPROCZ;p++) fprintf(FP," %d",OFFZ[p+1]-OFFZ[p]);
+		fprintf(FP,"\n");
 	}
 
 
 	MPI_Barrier(MPI_COMM_WORLD);
 
-	/*---------------   index is indicating neighbouring processes	--------------------*/
-	INDEX[1]=MYID-1;  		 /* left	*/
-	INDEX[2]=MYID+1;  		 /* right	*/
-	INDEX[3]=MYID-NPROCX;  		 /* upper	*/
-	INDEX[4]=MYID+NPROCX;  		 /* lower	*/
-	INDEX[5]=MYID-NPROCX*NPROCY;  	 /* fronT	*/
-	INDEX[6]=MYID+NPROCX*NPROCY;  	 /* back	*/
 	/*---------------   POS indicates the processor location in the 3D logical processor array	---------*/
-	POS[1] = MYID % NPROCX;			/*  x coordinate */
-	POS[3] = (MYID/(NPROCX*NPROCY)); 	/*  y coordinate */
-	POS[2] = ( (MYID-(NPROCX*NPROCY)*POS[3]) / NPROCX ); 	/* z coordinate */
+	/* The PEs are placed by MPI_Cart_create, which may reorder them so that
+	   neighbouring PEs share a node. MYID remains the rank in MPI_COMM_WORLD;
+	   without reordering POS[1]=MYID%NPROCX (x), POS[2]=(MYID/NPROCX)%NPROCY
+	   (y) and POS[3]=MYID/(NPROCX*NPROCY) (z) as before. */
+	dims[0]=NPROCZ;
+	dims[1]=NPROCY;
+	dims[2]=NPROCX;
+	MPI_Cart_create(MPI_COMM_WORLD,3,dims,periods,1,&comm_cart);
+	MPI_Comm_rank(comm_cart,&rank);
+	MPI_Cart_coords(comm_cart,rank,3,coords);
+	POS[1]=coords[2];
+	POS[2]=coords[1];
+	POS[3]=coords[0];
 
-	if (POS[1] == 0)        INDEX[1]=INDEX[1] + NPROCX;        	  
-	if (POS[1] == NPROCX-1) INDEX[2]=INDEX[2] - NPROCX;          	 
-	if (POS[3] == 0)        INDEX[5]=NPROC-(NPROCX*NPROCY)+MYID;	 
-	if (POS[3] == NPROCZ-1) INDEX[6]=MYID-NPROC+(NPROCX*NPROCY); 	 
-	if (POS[2] == 0)        INDEX[3]=(NPROCX*NPROCY)+MYID-NPROCX; 	 
-	if (POS[2] == NPROCY-1) INDEX[4]=MYID+NPROCX-(NPROCX*NPROCY);	 
+	/*---------------   index is indicating neighbouring processes (periodic)	--------------------*/
+	MPI_Cart_shift(comm_cart,2,1,&nb[0],&nb[1]);  /* left, right	*/
+	MPI_Cart_shift(comm_cart,1,1,&nb[2],&nb[3]);  /* upper, lower	*/
+	MPI_Cart_shift(comm_cart,0,1,&nb[4],&nb[5]);  /* front, back	*/
+	MPI_Comm_group(comm_cart,&group_cart);
+	MPI_Comm_group(MPI_COMM_WORLD,&group_world);
+	MPI_Group_translate_ranks(group_cart,6,nb,group_world,&INDEX[1]);
+	MPI_Group_free(&group_cart);
+	MPI_Group_free(&group_world);
+	MPI_Comm_free(&comm_cart);
+
+	// Determine the length of the subarray on this processor.
+	IENDX = OFFX[POS[1]+1]-OFFX[POS[1]];
+	IENDY = OFFY[POS[2]+1]-OFFY[POS[2]];
+	IENDZ = OFFZ[POS[3]+1]-OFFZ[POS[3]];
 
 	fprintf(FP,"\n");
 	fprintf(FP," **Message from initprocs (written by PE %d):\n",MYID);
@@ -20,7 +20,8 @@ void madinput(char header[], float *** DEN ){
 
     // -------------  header file Reading ---------------------
     extern float DX, DY, DZ;//, OX, OY, OZ;
-    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], MYID;
+    extern int NX, NY, NZ, NXG, NYG, POS[4], MYID;
+    extern int OFFX[], OFFY[], OFFZ[];
     extern FILE *FP;
     fprintf(FP,"\n\n\n--------------------------------------------------------- \n");
     fprintf(FP," \n \n *********** Madagascar Input Start *************** \n \n");
@@ -30,7 +31,7 @@ void madinput(char header[], float *** DEN ){
     // local variables
     int i, ii, j, jj, k, kk;
 
-    float tempRho=0.0;
+    float tempRho=0.0, *line;
 
     // -------------  header file Reading ---------------------
     char *pch;
@@ -127,25 +128,25 @@ void madinput(char header[], float *** DEN ){
     if (ioh_file==NULL) err("\t \t \t :( No binaries  present :( ");
 
 
-    for (k=1;k<=NZG;k++){
-	for (i=1;i<=NXG;i++){
-	    for (j=1;j<=NYG;j++){
-
-		tempRho=readdsk(ioh_file, format);
-
-		if ((POS[1]==((i-1)/NX)) 
-			&& (POS[2]==((j-1)/NY)) 
-			&& (POS[3]==((k-1)/NZ)))
-		{
-		    if (tempRho!=5000) fprintf(FP,"\n New in %g Nx %d Ny %d Nz %d Nxg %d Nyg %d Nzg %d",tempRho,NX,NY,NZ,POS[1], POS[2], POS[3]);
-		    ii=i-POS[1]*NX;
-		    jj=j-POS[2]*NY;
-		    kk=k-POS[3]*NZ;
-		    DEN[jj][ii][kk]=tempRho;
-		}
+    /* read only the part of each y-line (NYG floats) in the sub grid of
+       this PE */
+    line=vector(1,NY);
+    for (kk=1;kk<=NZ;kk++){
+	k=kk+OFFZ[POS[3]];
+	for (ii=1;ii<=NX;ii++){
+	    i=ii+OFFX[POS[1]];
+	    j=1+OFFY[POS[2]];
+	    if (fseek(ioh_file,(long)((((size_t)(k-1)*NXG+(i-1))*NYG+(j-1))*sizeof(float)),SEEK_SET))
+		err("\t \t \t :( Binary is smaller than the grid :( ");
+	    readdsk_block(ioh_file, &line[1], NY, format);
+	    for (jj=1;jj<=NY;jj++){
+		tempRho=line[jj];
+		if (tempRho!=5000) fprintf(FP,"\n New in %g Nx %d Ny %d Nz %d Nxg %d Nyg %d Nzg %d",tempRho,NX,NY,NZ,POS[1], POS[2], POS[3]);
+		DEN[jj][ii][kk]=tempRho;
 	    }
 	}
     }
+    free_vector(line,1,NY);
 
     fclose(ioh_file);
     fprintf(FP,"\n\n\n--------------------------------------------------------- \n");
@@ -0,0 +1,219 @@
+/*------------------------------------------------------------------------
+ *   Storage of the material parameters read by the vectorized
+ *   FDORDER_TIME=2 kernels (update_simd.c) with 16 bits per value.
+ *
+ *   MAT_PRECISION=1 (FP16): IEEE 754 half precision, 11 significant bits.
+ *   The stiffnesses in Pa exceed the range of FP16 (65504), therefore each
+ *   field is divided by a power of two before the conversion such that its
+ *   largest absolute value lies in [2^14, 2^15). The scale is the same on
+ *   all PEs.
+ *
+ *   MAT_PRECISION=2 (BF16): the upper 16 bits of a float, 8 significant
+ *   bits and the full range of FP32, no scaling.
+ *
+ *   The kernels decode the values in registers and compute in FP32. Since
+ *   the scale is a power of two, decoding is exact: the FP32 arrays are
+ *   overwritten with the decoded values, so the CPML frame and the scalar
+ *   code see exactly the same model as the kernels.
+ *  ----------------------------------------------------------------------*/
+
+#include "data_structures.h"
+#include "enum.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+/*
+ * Round a float to IEEE 754 half precision (round to nearest, ties to
+ * even). Values beyond the range of FP16 become infinite, small values
+ * become subnormal or zero.
+ */
+static uint16_t float_to_half(float x)
+{
+    uint32_t f, sign, mant, rest;
+    int e;
+
+    memcpy(&f, &x, sizeof(f));
+    sign = (f >> 16) & 0x8000u;
+    e = (int) ((f >> 23) & 0xffu) - 127 + 15;
+    mant = f & 0x7fffffu;
+
+    if (e >= 31) {
+        /* overflow, infinity or NaN */
+        if (((f >> 23) & 0xffu) == 0xffu)
+            return (uint16_t) (sign | 0x7c00u | (mant ? 0x200u : 0u));
+        return (uint16_t) (sign | 0x7c00u);
+    }
+
+    if (e <= 0) {
+        /* subnormal half or zero */
+        if (e < -10) return (uint16_t) sign;
+        mant |= 0x800000u;
+        rest = mant & ((1u << (14 - e)) - 1u);
+        mant >>= (14 - e);
+        if ((rest > (1u << (13 - e))) ||
+                ((rest == (1u << (13 - e))) && (mant & 1u)))
+            mant++;
+        return (uint16_t) (sign | mant);
+    }
+
+    rest = mant & 0x1fffu;
+    mant = ((uint32_t) e << 10) | (mant >> 13);
+    /* a carry into the exponent is the correctly rounded result */
+    if ((rest > 0x1000u) || ((rest == 0x1000u) && (mant & 1u)))
+        mant++;
+    return (uint16_t) (sign | mant);
+}
+
+
+static float half_to_float(uint16_t h)
+{
+    uint32_t sign = ((uint32_t) h & 0x8000u) << 16;
+    uint32_t e = (h >> 10) & 0x1fu, mant = h & 0x3ffu, f;
+    float x;
+
+    if (e == 0) {
+        /* zero or subnormal: mant * 2^-24 is exact in FP32 */
+        x = (float) mant * 0x1p-24f;
+        return sign ? -x : x;
+    }
+    if (e == 31)
+        f = sign | 0x7f800000u | (mant << 13);
+    else
+        f = sign | ((e - 15 + 127) << 23) | (mant << 13);
+    memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+
+/*
+ * Round a float to bfloat16 (round to nearest, ties to even).
+ */
+static uint16_t float_to_bf16(float x)
+{
+    uint32_t f;
+
+    memcpy(&f, &x, sizeof(f));
+    if ((f & 0x7fffffffu) > 0x7f800000u)
+        return (uint16_t) ((f >> 16) | 0x40u); /* quiet NaN */
+    f += 0x7fffu + ((f >> 16) & 1u);
+    return (uint16_t) (f >> 16);
+}
+
+
+static float bf16_to_float(uint16_t h)
+{
+    uint32_t f = (uint32_t) h << 16;
+    float x;
+
+    memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+
+/*
+ * Decode a 16-bit value in the given format (MAT_FP16 or MAT_BF16).
+ */
+float mat16_to_float(uint16_t h, int format)
+{
+    return (format == MAT_FP16) ? half_to_float(h) : bf16_to_float(h);
+}
+
+
+/*
+ * Encode a float in the given format (MAT_FP16 or MAT_BF16).
+ */
+uint16_t mat16_from_float(float x, int format)
+{
+    return (format == MAT_FP16) ? float_to_half(x) : float_to_bf16(x);
+}
+
+
+/*
+ * Convert the points [1..NY][1..NX][1..NZ] of a material field to 16 bits
+ * and replace the FP32 values by the decoded ones.
+ */
+static void pack_field(Mat16Field *m, float ***a, int format)
+{
+    extern int NX, NY, NZ;
+
+    float amax = 0.0, gmax;
+    int i, j, k, e;
+
+    m->scale = 1.0;
+    if (format == MAT_FP16) {
+        for (j = 1; j <= NY; j++)
+            for (i = 1; i <= NX; i++)
+                for (k = 1; k <= NZ; k++)
+                    if (fabsf(a[j][i][k]) > amax) amax = fabsf(a[j][i][k]);
+        MPI_Allreduce(&amax, &gmax, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+        if (gmax > 0.0) {
+            frexpf(gmax, &e);
+            m->scale = ldexpf(1.0, e - 15);
+        }
+    }
+
+    m->v = u16tensor(1, NY, 1, NX, 1, NZ);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(i, k)
+#endif
+    for (j = 1; j <= NY; j++)
+        for (i = 1; i <= NX; i++)
+            for (k = 1; k <= NZ; k++) {
+                m->v[j][i][k] = mat16_from_float(a[j][i][k] / m->scale, format);
+                a[j][i][k] = mat16_to_float(m->v[j][i][k], format) * m->scale;
+            }
+}
+
+
+/*
+ * Store the material parameters of the FDORDER_TIME=2 elastic kernels
+ * with 16 bits per value.
+ *
+ * Parameters
+ * ----------
+ * op :
+ *     Material parameters, C11, C12, C13, C22, C23, C33, C66ipjp,
+ *     C44jpkp and C55ipkp are converted and overwritten with the decoded
+ *     values.
+ * rjp, rkp, rip :
+ *     Density on the half-integer grid, converted like `op`.
+ * m :
+ *     16-bit copy of the fields above.
+ * format :
+ *     MAT_FP16 or MAT_BF16.
+ */
+void mat16_pack(OrthoPar *op, float ***rjp, float ***rkp, float ***rip,
+        OrthoPar16 *m, int format)
+{
+    m->format = format;
+    pack_field(&m->C11, op->C11, format);
+    pack_field(&m->C22, op->C22, format);
+    pack_field(&m->C33, op->C33, format);
+    pack_field(&m->C12, op->C12, format);
+    pack_field(&m->C13, op->C13, format);
+    pack_field(&m->C23, op->C23, format);
+    pack_field(&m->C66ipjp, op->C66ipjp, format);
+    pack_field(&m->C44jpkp, op->C44jpkp, format);
+    pack_field(&m->C55ipkp, op->C55ipkp, format);
+    pack_field(&m->rjp, rjp, format);
+    pack_field(&m->rkp, rkp, format);
+    pack_field(&m->rip, rip, format);
+}
+
+
+void mat16_free(OrthoPar16 *m)
+{
+    extern int NX, NY, NZ;
+
+    Mat16Field *f[12] = {&m->C11, &m->C22, &m->C33, &m->C12, &m->C13,
+        &m->C23, &m->C66ipjp, &m->C44jpkp, &m->C55ipkp, &m->rjp, &m->rkp,
+        &m->rip};
+    int n;
+
+    for (n = 0; n < 12; n++) {
+        free_u16tensor(f[n]->v, 1, NY, 1, NX, 1, NZ);
+        f[n]->v = NULL;
+    }
+}
@@ -0,0 +1,175 @@
+/*------------------------------------------------------------------------
+ *   Material parameters of the vectorized FDORDER_TIME=2 kernels as a
+ *   table of distinct media plus an index volume (MAT_COMPRESS=1).
+ *
+ *   A medium is the tuple of the 12 values read by the kernels at one
+ *   grid point: C11, C22, C33, C12, C13, C23, C66ipjp, C44jpkp, C55ipkp,
+ *   rjp, rkp, rip. Models built of a few layers or bodies have only a few
+ *   distinct tuples (one per body plus some per interface, where the
+ *   averaged parameters differ), so the index volume of 1 or 2 bytes per
+ *   grid point replaces 48 bytes of dense arrays. The kernels gather the
+ *   parameters from the table; the values are the original floats, so the
+ *   results are identical to those with dense arrays.
+ *
+ *   If the local grid has more than MAT_MEDIA_MAX distinct media, no table
+ *   is built and the dense arrays are used.
+ *  ----------------------------------------------------------------------*/
+
+#include "data_structures.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+#define NFIELD 12
+
+
+/*
+ * Hash of a medium (FNV-1a of the bit patterns).
+ */
+static uint32_t medium_hash(const float *m)
+{
+    uint32_t h = 2166136261u, w;
+    int n;
+
+    for (n = 0; n < NFIELD; n++) {
+        memcpy(&w, &m[n], sizeof(w));
+        h = (h ^ w) * 16777619u;
+    }
+    return h;
+}
+
+
+/*
+ * Build the table of media of the points [1..NY][1..NX][1..NZ].
+ *
+ * Parameters
+ * ----------
+ * op :
+ *     Material parameters, only C11, C12, C13, C22, C23, C33, C66ipjp,
+ *     C44jpkp and C55ipkp are used.
+ * rjp, rkp, rip :
+ *     Density on the half-integer grid.
+ * t :
+ *     Table of media and index volume.
+ *
+ * Returns
+ * -------
+ * 1 if the table was built, 0 if the local grid has more than
+ * MAT_MEDIA_MAX media; `t` is left empty in this case.
+ */
+int mat_table_build(OrthoPar *op, float ***rjp, float ***rkp, float ***rip,
+        MatTable *t)
+{
+    extern int NX, NY, NZ;
+
+    float ***f[NFIELD] = {op->C11, op->C22, op->C33, op->C12, op->C13,
+        op->C23, op->C66ipjp, op->C44jpkp, op->C55ipkp, rjp, rkp, rip};
+    float *col[NFIELD];
+    float *media, m[NFIELD];
+    int *slot;
+    int i, j, k, n, h, nmedia = 0, nslot = 2;
+    uint32_t mask;
+
+    t->nmedia = 0;
+    t->idx8 = NULL;
+    t->idx16 = NULL;
+
+    while (nslot < 2 * MAT_MEDIA_MAX) nslot *= 2;
+    mask = (uint32_t) nslot - 1u;
+
+    media = (float *) malloc((size_t) MAT_MEDIA_MAX * NFIELD * sizeof(float));
+    slot = (int *) malloc((size_t) nslot * sizeof(int));
+    if ((!media) || (!slot))
+        err("allocation failure in function mat_table_build() ");
+    for (h = 0; h < nslot; h++) slot[h] = -1;
+    t->idx16 = u16tensor(1, NY, 1, NX, 1, NZ);
+
+    /* number of the medium of each point, open addressing with linear
+       probing */
+    for (j = 1; j <= NY; j++)
+        for (i = 1; i <= NX; i++)
+            for (k = 1; k <= NZ; k++) {
+                for (n = 0; n < NFIELD; n++) m[n] = f[n][j][i][k];
+                h = (int) (medium_hash(m) & mask);
+                while ((slot[h] >= 0) &&
+                        memcmp(&media[(size_t) slot[h] * NFIELD], m, sizeof(m)))
+                    h = (int) ((h + 1u) & mask);
+                if (slot[h] < 0) {
+                    if (nmedia == MAT_MEDIA_MAX) {
+                        free(media);
+                        free(slot);
+                        free_u16tensor(t->idx16, 1, NY, 1, NX, 1, NZ);
+                        t->idx16 = NULL;
+                        return 0;
+                    }
+                    memcpy(&media[(size_t) nmedia * NFIELD], m, sizeof(m));
+                    slot[h] = nmedia++;
+                }
+                t->idx16[j][i][k] = (uint16_t) slot[h];
+            }
+
+    /* one column per field */
+    for (n = 0; n < NFIELD; n++) {
+        col[n] = (float *) malloc((size_t) nmedia * sizeof(float));
+        if (!col[n]) err("allocation failure in function mat_table_build() ");
+        for (h = 0; h < nmedia; h++)
+            col[n][h] = media[(size_t) h * NFIELD + n];
+    }
+    t->C11 = col[0];
+    t->C22 = col[1];
+    t->C33 = col[2];
+    t->C12 = col[3];
+    t->C13 = col[4];
+    t->C23 = col[5];
+    t->C66ipjp = col[6];
+    t->C44jpkp = col[7];
+    t->C55ipkp = col[8];
+    t->rjp = col[9];
+    t->rkp = col[10];
+    t->rip = col[11];
+    t->nmedia = nmedia;
+
+    /* one byte per point is enough for up to 256 media */
+    if (nmedia <= 256) {
+        t->idx8 = u8tensor(1, NY, 1, NX, 1, NZ);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(i, k)
+#endif
+        for (j = 1; j <= NY; j++)
+            for (i = 1; i <= NX; i++)
+                for (k = 1; k <= NZ; k++)
+                    t->idx8[j][i][k] = (uint8_t) t->idx16[j][i][k];
+        free_u16tensor(t->idx16, 1, NY, 1, NX, 1, NZ);
+        t->idx16 = NULL;
+    }
+
+    free(media);
+    free(slot);
+    return 1;
+}
+
+
+void mat_table_free(MatTable *t)
+{
+    extern int NX, NY, NZ;
+
+    if (t->nmedia == 0) return;
+
+    free(t->C11);
+    free(t->C22);
+    free(t->C33);
+    free(t->C12);
+    free(t->C13);
+    free(t->C23);
+    free(t->C66ipjp);
+    free(t->C44jpkp);
+    free(t->C55ipkp);
+    free(t->rjp);
+    free(t->rkp);
+    free(t->rip);
+    if (t->idx8) free_u8tensor(t->idx8, 1, NY, 1, NX, 1, NZ);
+    if (t->idx16) free_u16tensor(t->idx16, 1, NY, 1, NX, 1, NZ);
+    t->nmedia = 0;
+    t->idx8 = NULL;
+    t->idx16 = NULL;
+}
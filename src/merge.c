@@ -12,14 +12,15 @@
 void merge(int nsnap, int type)
 {
     extern char SNAP_FILE[STRING_SIZE];
-    extern int NXG, NYG, SNAP_FORMAT, NPROCX, NPROCY, NPROCZ;
-    extern int NX, NY, NZ, IDX, IDY, IDZ;
+    extern int NXG, NYG, SNAP_FORMAT, NPROCX, NPROCY, NPROCZ, SNAP_COMPRESS;
+    extern int IDX, IDY, IDZ, OFFX[], OFFY[], OFFZ[];
     extern FILE *FP;
 
     char file[STRING_SIZE], mfile[STRING_SIZE], outfile[STRING_SIZE], ext[10];
     FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], *fpout;
-    int i, j, k, ip, jp, kp, n;
-    float a;
+    int ip, jp, kp, n, nxs[NPROCX_MAX], nys[NPROCY_MAX], nzs[NPROCZ_MAX];
+    double nsamp;
+    double nbytes = 0.0;
 
     if ((NPROCX > NPROCX_MAX) || (NPROCY > NPROCY_MAX) || (NPROCZ > NPROCZ_MAX))
         err(" merge.c: constant expression NPROC?_MAX < NPROC? ");
@@ -89,19 +90,23 @@ void merge(int nsnap, int type)
             }
     fprintf(FP, " ... finished. \n");
 
-    fprintf(FP, " Copying...");
-    for (n = 0; n < nsnap; n++)
-        for (kp = 0; kp <= NPROCZ - 1; kp++)
-            for (k = 1; k <= NZ; k += IDZ)
-                for (ip = 0; ip <= NPROCX - 1; ip++)
-                    for (i = 1; i <= NX; i += IDX)
-                        for (jp = 0; jp <= NPROCY - 1; jp++)
-                            for (j = 1; j <= NY; j += IDY)
-                            {
-                                a = readdsk(fp[jp][ip][kp], SNAP_FORMAT);
-                                writedsk(fpout, a, SNAP_FORMAT);
-                            }
-    fprintf(FP, " ... finished. \n");
+    /* samples of the PEs, see decomp.c */
+    nsamp = (double) decomp_samples(OFFX, NPROCX, IDX, nxs)
+        * decomp_samples(OFFY, NPROCY, IDY, nys)
+        * decomp_samples(OFFZ, NPROCZ, IDZ, nzs);
+    if (SNAP_COMPRESS) {
+        fprintf(FP, " Decompressing...");
+        for (n = 0; n < nsnap; n++)
+            nbytes += merge_frames(fp, fpout, nxs, nys, nzs);
+        fprintf(FP, " ... finished. \n");
+        fprintf(FP, " Compression ratio: %.2f\n", (double) nsnap * nsamp
+                * sizeof(float) / nbytes);
+    } else {
+        fprintf(FP, " Copying...");
+        for (n = 0; n < nsnap; n++)
+            merge_planes(fp, fpout, nxs, nys, nzs, SNAP_FORMAT);
+        fprintf(FP, " ... finished. \n");
+    }
 
     for (kp = 0; kp <= NPROCZ - 1; kp++)
         for (ip = 0; ip <= NPROCX - 1; ip++)
@@ -119,3 +124,117 @@ void merge(int nsnap, int type)
         fprintf(FP, "=====================================================\n");
     }
 }
+
+
+/*
+ * Copy one volume from the files of the PEs into one file.
+ *
+ * The file of each PE holds nzs planes of nxs * nys samples (y fastest);
+ * the merged file holds the planes of the global volume in the same
+ * order. Each plane of a PE is read with one call and each global plane
+ * is written with one call.
+ *
+ * Parameters
+ * ----------
+ * fp :
+ *     Files of the PEs, fp[jp][ip][kp] for the PE at POS = (ip, jp, kp).
+ * fpout :
+ *     Merged file.
+ * nxs, nys, nzs :
+ *     Number of samples of the PEs in x, y and z, nxs[ip] for the PEs at
+ *     POS[1] = ip and so on, see decomp_samples().
+ * format :
+ *     Format of the data, see readdsk().
+ */
+void merge_planes(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        const int *nxs, const int *nys, const int *nzs, int format)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+
+    int nxg = 0, nyg = 0, nplane, x0, y0;
+    int i, k, ip, jp, kp;
+    float *plane, *gplane;
+
+    for (ip = 0; ip < NPROCX; ip++) nxg += nxs[ip];
+    for (jp = 0; jp < NPROCY; jp++) nyg += nys[jp];
+    plane = vector(0, nxg * nyg - 1);
+    gplane = vector(0, nxg * nyg - 1);
+
+    for (kp = 0; kp <= NPROCZ - 1; kp++)
+        for (k = 0; k < nzs[kp]; k++) {
+            for (ip = 0, x0 = 0; ip <= NPROCX - 1; x0 += nxs[ip++])
+                for (jp = 0, y0 = 0; jp <= NPROCY - 1; y0 += nys[jp++]) {
+                    nplane = nxs[ip] * nys[jp];
+                    readdsk_block(fp[jp][ip][kp], plane, nplane, format);
+                    for (i = 0; i < nxs[ip]; i++)
+                        memcpy(&gplane[(x0 + i) * nyg + y0],
+                                &plane[i * nys[jp]], (size_t) nys[jp] * sizeof(float));
+                }
+            writedsk_block(fpout, gplane, nxg * nyg, format);
+        }
+
+    free_vector(plane, 0, nxg * nyg - 1);
+    free_vector(gplane, 0, nxg * nyg - 1);
+}
+
+
+/*
+ * Decompress one volume from the files of the PEs (SNAP_COMPRESS>0, see
+ * snap_compress.c) into one binary file.
+ *
+ * The volumes of the PEs with the same POS[3] are decompressed together
+ * and written as nzs[POS[3]] planes of the global volume, as by
+ * merge_planes().
+ *
+ * Returns
+ * -------
+ * Size of the compressed data read in bytes.
+ */
+double merge_frames(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        const int *nxs, const int *nys, const int *nzs)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+
+    int nxg = 0, nyg = 0, nzmax = 0, x0, y0;
+    int i, k, ip, jp, kp;
+    float *slab, *gplane, *vol;
+    long long nframe;
+    double nbytes = 0.0;
+
+    for (ip = 0; ip < NPROCX; ip++) nxg += nxs[ip];
+    for (jp = 0; jp < NPROCY; jp++) nyg += nys[jp];
+    for (kp = 0; kp < NPROCZ; kp++) nzmax = max(nzmax, nzs[kp]);
+    slab = vector(0, nxg * nyg * nzmax - 1);
+    gplane = vector(0, nxg * nyg - 1);
+
+    for (kp = 0; kp <= NPROCZ - 1; kp++) {
+        /* the volumes of the PEs one after the other */
+        vol = slab;
+        for (ip = 0; ip <= NPROCX - 1; ip++)
+            for (jp = 0; jp <= NPROCY - 1; jp++) {
+                nframe = snap_compress_read(fp[jp][ip][kp], vol, nxs[ip],
+                        nys[jp], nzs[kp]);
+                if (nframe < 0)
+                    err("Could not read a compressed snapshot of PE %d.%d.%d "
+                            "(SNAP_COMPRESS=0 during the run?)", ip, jp, kp);
+                nbytes += (double) nframe;
+                vol += nxs[ip] * nys[jp] * nzs[kp];
+            }
+        for (k = 0; k < nzs[kp]; k++) {
+            vol = slab;
+            for (ip = 0, x0 = 0; ip <= NPROCX - 1; x0 += nxs[ip++])
+                for (jp = 0, y0 = 0; jp <= NPROCY - 1; y0 += nys[jp++]) {
+                    for (i = 0; i < nxs[ip]; i++)
+                        memcpy(&gplane[(x0 + i) * nyg + y0],
+                                &vol[(k * nxs[ip] + i) * nys[jp]],
+                                (size_t) nys[jp] * sizeof(float));
+                    vol += nxs[ip] * nys[jp] * nzs[kp];
+                }
+            writedsk_block(fpout, gplane, nxg * nyg, 3);
+        }
+    }
+
+    free_vector(slab, 0, nxg * nyg * nzmax - 1);
+    free_vector(gplane, 0, nxg * nyg - 1);
+    return nbytes;
+}
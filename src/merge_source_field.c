@@ -8,14 +8,13 @@
  */
 void merge_source_field(char source_field_file[STRING_SIZE], int format) {
 	extern int NXG, NYG, MYID, NPROCX, NPROCY, NPROCZ;
-	extern int NX, NY, NZ, NPROC, IDX, IDY, IDZ;
+	extern int NPROC, IDX, IDY, IDZ, OFFX[], OFFY[], OFFZ[];
 	extern FILE *FP;
 
 
 	char file[STRING_SIZE];
 	FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], *fp_out;
-	int i, j, k, ip, jp, kp;
-	float a;
+	int ip, jp, kp, nxs[NPROCX_MAX], nys[NPROCY_MAX], nzs[NPROCZ_MAX];
 
 
 	if ((NPROCX>NPROCX_MAX)||(NPROCY>NPROCY_MAX)||(NPROCZ>NPROCZ_MAX))
@@ -42,15 +41,10 @@ void merge_source_field(char source_field_file[STRING_SIZE], int format) {
 	fprintf(FP, " ... finished. \n");
 	fprintf(FP, " Copying...");
 
-	for (kp = 0; kp <= NPROCZ-1; kp++)
-		for (k = 1; k <= NZ; k += IDZ)
-			for (ip = 0; ip <= NPROCX-1; ip++)
-				for (i = 1; i <= NX; i += IDX)
-					for (jp = 0; jp <= NPROCY-1; jp++)
-						for (j = 1; j <= NY; j += IDY){
-							a = readdsk(fp[jp][ip][kp],format);
-							writedsk(fp_out, a, format);
-						}
+	decomp_samples(OFFX, NPROCX, IDX, nxs);
+	decomp_samples(OFFY, NPROCY, IDY, nys);
+	decomp_samples(OFFZ, NPROCZ, IDZ, nzs);
+	merge_planes(fp, fp_out, nxs, nys, nzs, format);
 
 	fprintf(FP," finished. \n");
 
@@ -12,7 +12,8 @@ float ***  taus, float ***  taup, float *  eta){
 	/* extern variables */
 
 	extern float DT, DH, *FL, TAU, TS;
-	extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], L, MYID;
+	extern int NXG, NYG, NZG, POS[4], L, MYID;
+	extern int OFFX[], OFFY[], OFFZ[];
 	extern char  MFILE[STRING_SIZE];
 	
 	/* local variables */
@@ -74,12 +75,12 @@ float ***  taus, float ***  taup, float *  eta){
 
 				/* only the PE which belongs to the current global gridpoint 
 				  is saving model parameters in his local arrays */
-				if ((POS[1]==((i-1)/NX)) && 
-				    (POS[2]==((j-1)/NY)) && 
-				    (POS[3]==((k-1)/NZ))){
-					ii=i-POS[1]*NX;
-					jj=j-POS[2]*NY;
-					kk=k-POS[3]*NZ;
+				if ((i>OFFX[POS[1]]) && (i<=OFFX[POS[1]+1]) && 
+				    (j>OFFY[POS[2]]) && (j<=OFFY[POS[2]+1]) && 
+				    (k>OFFZ[POS[3]]) && (k<=OFFZ[POS[3]+1])){
+					ii=i-OFFX[POS[1]];
+					jj=j-OFFY[POS[2]];
+					kk=k-OFFZ[POS[3]];
 
 					taus[jj][ii][kk]=ts;
 					taup[jj][ii][kk]=tp;
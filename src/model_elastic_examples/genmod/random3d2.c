@@ -8,7 +8,8 @@
 void model(float  ***  prho, float ***  ppi, float ***  pu){
 
 	/* extern variables */
-	extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], MYID;
+	extern int NXG, NYG, NZG, POS[4], MYID;
+	extern int OFFX[], OFFY[], OFFZ[];
 	extern float DH;
 
 	/* local variables */
@@ -48,13 +49,13 @@ void model(float  ***  prho, float ***  ppi, float ***  pu){
 								
 				/* only the PE which belongs to the current global gridpoint 
 				  is saving model parameters in his local arrays */
-				if ((POS[1]==((i-1)/NX)) && 
-				    (POS[2]==((j-1)/NY)) && 
-				    (POS[3]==((k-1)/NZ))){
+				if ((i>OFFX[POS[1]]) && (i<=OFFX[POS[1]+1]) && 
+				    (j>OFFY[POS[2]]) && (j<=OFFY[POS[2]+1]) && 
+				    (k>OFFZ[POS[3]]) && (k<=OFFZ[POS[3]+1])){
 
-					ii=i-POS[1]*NX;
-					jj=j-POS[2]*NY;
-					kk=k-POS[3]*NZ;
+					ii=i-OFFX[POS[1]];
+					jj=j-OFFY[POS[2]];
+					kk=k-OFFZ[POS[3]];
 
 					pu[jj][ii][kk]=vs*vs*rho;
 					prho[jj][ii][kk]=1.0/rho;
@@ -17,6 +17,7 @@ void model_elastic(float ***rho, float ***pi, float ***u, float ***C11, float **
     /* extern variables */
     extern float DY;
     extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], L, MYID;
+    extern int OFFX[], OFFY[], OFFZ[];
     extern char MFILE[STRING_SIZE];
     extern int WRITE_MODELFILES;
     extern int READMOD;
@@ -177,13 +178,13 @@ void model_elastic(float ***rho, float ***pi, float ***u, float ***C11, float **
                     /* only the PE which belongs to the current global gridpoint
 					 * is saving model parameters in his local arrays */
 
-                    if ((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ)))
+                    if ((i > OFFX[POS[1]]) && (i <= OFFX[POS[1] + 1]) &&
+                        (j > OFFY[POS[2]]) && (j <= OFFY[POS[2] + 1]) &&
+                        (k > OFFZ[POS[3]]) && (k <= OFFZ[POS[3] + 1]))
                     {
-                        ii = i - POS[1] * NX;
-                        jj = j - POS[2] * NY;
-                        kk = k - POS[3] * NZ;
+                        ii = i - OFFX[POS[1]];
+                        jj = j - OFFY[POS[2]];
+                        kk = k - OFFZ[POS[3]];
 
                         // leftovers from isotropic case -- necessary for PML
                         u[jj][ii][kk] = muv;
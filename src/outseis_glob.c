@@ -14,18 +14,57 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 		int **recpos, int **recpos_loc, int ntr, float ** srcpos,
 		int nsrc, int ns, int seis_form[6], int ishot, int comp){
 
+	outseis_glob_header(fpdata, ntr, ns, seis_form);
+	outseis_glob_traces(fp, fpdata, section, recpos, recpos_loc, 1, ntr, ntr,
+			srcpos, nsrc, ns, seis_form, ishot, comp);
+	fclose(fpdata);
+}
+
+
+/* Write the file headers preceding the traces, only SEG-Y files have ones. */
+void  outseis_glob_header(FILE *fpdata, int ntr, int ns, int seis_form[6]){
+
+	extern int NDT, SOFI3DVERS;
+	extern float DT;
+	extern char FILEINP[STRING_SIZE];
+
+	extern int DDN_wsegytxth(FILE * outstream, int asciiebcdic, char * kindofdata, char * infilename, int ns, float dt, int ndt);
+	extern int DDN_wsegybinh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int ns, 
+			float dt, int ndt, int ntrpr, int nart);
+
+	char kindofdata[STRING_SIZE];
+
+	if ((seis_form[0]!=0) && (seis_form[0]!=4) && (seis_form[0]!=5)) return;
+
+	strncpy(kindofdata,"synthetic seismograms modeled by SOFI3D",STRING_SIZE);
+	if (SOFI3DVERS==33)
+		strncat(kindofdata," (3D isotropic elastic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
+	else if (SOFI3DVERS==32)
+		strncat(kindofdata," (3D isotropic acoustic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
+	kindofdata[STRING_SIZE-1]='\0';
+
+	DDN_wsegytxth(fpdata, seis_form[1], kindofdata, (char *)FILEINP, ns, DT, NDT);
+	DDN_wsegybinh(fpdata, seis_form[2], seis_form[3], seis_form[4], ns, DT, NDT, ntr, 0);
+}
+
+
+/* Write the traces tr1..tr2 of ntr traces, section[1..tr2-tr1+1][1..ns],
+   after the file headers (outseis_glob_header). The traces of a file can so
+   be written in portions (SEIS_BLOCK, see seis_stream.c) or by the PEs
+   recording them (SEIS_MPIIO, see seis_mpiio.c), which is not possible for
+   ASCII output with one column per trace. */
+void  outseis_glob_traces(FILE *fp, FILE *fpdata, float **section,
+		int **recpos, int **recpos_loc, int tr1, int tr2, int ntr, float ** srcpos,
+		int nsrc, int ns, int seis_form[6], int ishot, int comp){
+
 	/* declaration of extern variables */
-	extern int NDT,NDTSHIFT, SOFI3DVERS;
+	extern int NDT,NDTSHIFT;
 	extern float  DX, DY, DZ, TIME, DT, REFREC[4];
-	extern char FILEINP[STRING_SIZE];
 
 	extern int ASCIIEBCDIC,LITTLEBIG,IEEEIBM;
 
 	/* declaration of extern functions from rwsegy.c */
 
-	extern int DDN_wsegytxth(FILE * outstream, int asciiebcdic, char * kindofdata, char * infilename, int ns, float dt, int ndt);
-	extern int DDN_wsegybinh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int ns, 
-			float dt, int ndt, int ntrpr, int nart);
 	extern int DDN_wbindata(FILE * outstream, int outlen, float * indata, int inlen, int first, 
 			int step, int padding, int lbendian, int ieeeibm, int meterfeet);
 	extern int DDN_wtxtdata(FILE * outstream, int outlen, float * indata, int inlen, int first, int step, int padding, int asciiebcdic, int meterfeet, char * dataformat, char * dataseperator, char * dataendmark);
@@ -35,25 +74,14 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 			int nsrc, float xcoo, float ycoo);
 
 	/* declaration of local variables */
-	int i,j, * pint;
+	int i,j, * pint, off=tr1-1;
 	segy tr;
 	int tracl ;
 	float xr, yr, zr, y, z, scalefac, tfloat;
 	float XS=0.0, YS=0.0, ZS=0.0;
 	const float scale=3.0;
-	char kindofdata[STRING_SIZE];
-	char * infilename;
 	float indatap[ns];
 
-	infilename=(char *)FILEINP;
-
-	strncpy(kindofdata,"synthetic seismograms modeled by SOFI3D",STRING_SIZE);
-	if (SOFI3DVERS==33)
-		strncat(kindofdata," (3D isotropic elastic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
-	else if (SOFI3DVERS==32)
-		strncat(kindofdata," (3D isotropic acoustic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
-	kindofdata[STRING_SIZE-1]='\0';
-
 
 	/* if there are more than one source position/coordinate specified
 	 * in SOURCE_FILE, only the first position is written into trace header fields,
@@ -68,25 +96,23 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 	case 4 :
 	case 5 :
 		/* fprintf(stderr,"BEEN HERE !!!\n")  */
-		DDN_wsegytxth(fpdata, seis_form[1], kindofdata, infilename,ns,DT,NDT);
-		DDN_wsegybinh(fpdata, seis_form[2], seis_form[3], seis_form[4], ns, DT, NDT, ntr, 0);
-		for(tracl=1;tracl<=ntr;tracl++){
+		for(tracl=tr1;tracl<=tr2;tracl++){
 			DDN_wtraceh(fpdata, seis_form[2], seis_form[3], seis_form[4], 1, ns, DT*NDT, DT*NDTSHIFT, 0.0, tracl, recpos_loc[4][tracl], nsrc, 
 					tracl, comp, 1, ntr, recpos, recpos_loc, srcpos, nsrc, 0, 0);
-			for(j=0;j<ns;j++) indatap[j]=section[tracl][j+1];
+			for(j=0;j<ns;j++) indatap[j]=section[tracl-off][j+1];
 			DDN_wbindata(fpdata, ns, indatap, ns, 0, 1, 0, seis_form[2], seis_form[3], seis_form[4]);
 		}
 		break;
 	case 1 : /* SU caution: allows IBM floats!*/ 
-		for(tracl=1;tracl<=ntr;tracl++){
+		for(tracl=tr1;tracl<=tr2;tracl++){
 			DDN_wtraceh(fpdata, seis_form[2], seis_form[3], seis_form[4], 0, ns, DT*NDT, DT*NDTSHIFT, 0.0, tracl, recpos_loc[4][tracl], nsrc, 
 					tracl, comp, 1, ntr, recpos, recpos_loc, srcpos, nsrc, 0, 0);
-			for(j=0;j<ns;j++) indatap[j]=section[tracl][j+1];
+			for(j=0;j<ns;j++) indatap[j]=section[tracl-off][j+1];
 			DDN_wbindata(fpdata, ns, indatap, ns, 0, 1, 0, seis_form[2], seis_form[3], seis_form[4]);
 		}
 		break;
 	case 7 : /* SU ~ (IEEE) SEGY without file-headers and slightly modified trace headers (original version) */
-		for(tracl=1;tracl<=ntr;tracl++){ 
+		for(tracl=tr1;tracl<=tr2;tracl++){ 
 			xr=recpos[1][recpos_loc[4][tracl]]*DX;
 			yr=recpos[2][recpos_loc[4][tracl]]*DY;
 			zr=recpos[3][recpos_loc[4][tracl]]*DZ;
@@ -126,55 +152,55 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 			tr.f2=0.0;
 
 			fwrite(&tr,240,1,fpdata);
-			if (seis_form[3]) for(j=0;j<ns;j++) tr.data[j]=section[tracl][j+1]/0.3048; /* FEET */
-			else for(j=0;j<ns;j++) tr.data[j]=section[tracl][j+1];
+			if (seis_form[3]) for(j=0;j<ns;j++) tr.data[j]=section[tracl-off][j+1]/0.3048; /* FEET */
+			else for(j=0;j<ns;j++) tr.data[j]=section[tracl-off][j+1];
 			fwrite(tr.data,4,ns,fpdata);
 		}
 		break;
 	case 6 : /* pseudo-SU (segy-traces headers & traces) rwsegy.c */
-		for(tracl=1;tracl<=ntr;tracl++){
+		for(tracl=tr1;tracl<=tr2;tracl++){
 			DDN_wtraceh(fpdata, seis_form[2], seis_form[3], seis_form[4], 1, ns, DT*NDT, DT*NDTSHIFT, 0.0, tracl, recpos_loc[4][tracl], nsrc, 
 					tracl, comp, 1, ntr, recpos, recpos_loc, srcpos, nsrc, 0, 0);
-			for(j=0;j<ns;j++) indatap[j]=section[tracl][j+1];
+			for(j=0;j<ns;j++) indatap[j]=section[tracl-off][j+1];
 			DDN_wbindata(fpdata, ns, indatap, ns, 0, 1, 0, seis_form[2], seis_form[3], seis_form[4]);
 		}
 		break;
 	case 2 :if (ASCIIEBCDIC==seis_form[1]){
 		if (seis_form[4]==1) /*OUTPUT IN FEET*/ switch(seis_form[3]){
 		case 1:	for(j=1;j<=ns;j++){         /*ASCII ONE COLUMN PER TRACE */
-			for(i=1;i<=ntr;i++) fprintf(fpdata,"%e\t", section[i][j]/0.3048);
+			for(i=tr1;i<=tr2;i++) fprintf(fpdata,"%e\t", section[i-off][j]/0.3048);
 			fprintf(fpdata,"\n");
 		}
 		break;
-		case 2: for(i=1;i<=ntr;i++) /*ASCII ONE LINE*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e ",section[i][j]/0.3048);
+		case 2: for(i=tr1;i<=tr2;i++) /*ASCII ONE LINE*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e ",section[i-off][j]/0.3048);
 		break;
-		case 3: for(i=1;i<=ntr;i++){         /*ASCII ONE LINE PER RECEIVER */
-			for(j=1;j<=ns;j++) fprintf(fpdata,"%e\t", section[i][j]/0.3048);
+		case 3: for(i=tr1;i<=tr2;i++){         /*ASCII ONE LINE PER RECEIVER */
+			for(j=1;j<=ns;j++) fprintf(fpdata,"%e\t", section[i-off][j]/0.3048);
 			fprintf(fpdata,"\n");
 		}
 		break;
-		default:for(i=1;i<=ntr;i++) /*ASCII ONE COLUMN*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e\n",section[i][j]/0.3048);
+		default:for(i=tr1;i<=tr2;i++) /*ASCII ONE COLUMN*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e\n",section[i-off][j]/0.3048);
 		}
 		else /*OUTPUT IN METER*/ switch(seis_form[3]){
 		case 1:	for(j=1;j<=ns;j++){         /*ASCII ONE COLUMN PER TRACE */
-			for(i=1;i<=ntr;i++) fprintf(fpdata,"%e\t", section[i][j]);
+			for(i=tr1;i<=tr2;i++) fprintf(fpdata,"%e\t", section[i-off][j]);
 			fprintf(fpdata,"\n");
 		}
 		break;
-		case 2: for(i=1;i<=ntr;i++) /*ASCII ONE LINE*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e ",section[i][j]);
+		case 2: for(i=tr1;i<=tr2;i++) /*ASCII ONE LINE*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e ",section[i-off][j]);
 		break;
-		case 3: for(i=1;i<=ntr;i++){         /*ASCII ONE LINE PER RECEIVER */
-			for(j=1;j<=ns;j++) fprintf(fpdata,"%e\t", section[i][j]);
+		case 3: for(i=tr1;i<=tr2;i++){         /*ASCII ONE LINE PER RECEIVER */
+			for(j=1;j<=ns;j++) fprintf(fpdata,"%e\t", section[i-off][j]);
 			fprintf(fpdata,"\n");
 		}
 		break;
-		default:for(i=1;i<=ntr;i++) /*ASCII ONE COLUMN*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e\n",section[i][j]);
+		default:for(i=tr1;i<=tr2;i++) /*ASCII ONE COLUMN*/ for(j=1;j<=ns;j++) fprintf(fpdata,"%e\n",section[i-off][j]);
 		}
 	}
 	else{
 		switch(seis_form[3]){
 		case 1:for(j=1;j<=ns;j++){         /*ASCII ONE COLUMN PER TRACE */
-			for(i=1;i<=ntr;i++) fprintf(fpdata,"%e\t", section[i][j]);
+			for(i=tr1;i<=tr2;i++) fprintf(fpdata,"%e\t", section[i-off][j]);
 			fprintf(fpdata,"\n");
 		}
 		break;
@@ -193,30 +219,30 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 		case 3 :                             /*BINARY */
 			if ((seis_form[3]==IEEEIBM)&&(seis_form[2]==LITTLEBIG)){ /* OUTPUT NATIVE FLOATS */
 				if (seis_form[4]==1){ /*OUTPUT IN FEET*/
-					for(i=1;i<=ntr;i++) for(j=1;j<=ns;j++){
-						tfloat=section[i][j]/0.3048;
+					for(i=tr1;i<=tr2;i++) for(j=1;j<=ns;j++){
+						tfloat=section[i-off][j]/0.3048;
 						fwrite(&tfloat,sizeof(float),1,fpdata);
 					}
 				}
-				else for(i=1;i<=ntr;i++) for(j=1;j<=ns;j++) fwrite(&section[i][j],sizeof(float),1,fpdata);
+				else for(i=tr1;i<=tr2;i++) for(j=1;j<=ns;j++) fwrite(&section[i-off][j],sizeof(float),1,fpdata);
 			}
 			else {
 				if ((seis_form[3]==IEEEIBM)&&(seis_form[2]!=LITTLEBIG)) /* SWAP FLOATS */ {
-					if (seis_form[4]==1) /*OUTPUT IN FEET*/ for(i=1;i<=ntr;i++) for(j=1;j<=ns;j++){
-						tfloat=section[i][j]/0.3048;
+					if (seis_form[4]==1) /*OUTPUT IN FEET*/ for(i=tr1;i<=tr2;i++) for(j=1;j<=ns;j++){
+						tfloat=section[i-off][j]/0.3048;
 						pint=(int *) &tfloat;
 						*pint=((*pint>>24)&0xff)|((*pint&0xff)<<24)|((*pint>>8)&0xff00)|((*pint&0xff00)<<8);
 						fwrite(&tfloat,sizeof(float),1,fpdata);
 					}
-					else for(i=1;i<=ntr;i++) for(j=1;j<=ns;j++){
-						tfloat=section[i][j];
+					else for(i=tr1;i<=tr2;i++) for(j=1;j<=ns;j++){
+						tfloat=section[i-off][j];
 						pint=(int *) &tfloat;
 						*pint=((*pint>>24)&0xff)|((*pint&0xff)<<24)|((*pint>>8)&0xff00)|((*pint&0xff00)<<8);
 						fwrite(&tfloat,sizeof(float),1,fpdata);
 					}
 				}
 				else
-					for(i=1;i<=ntr;i++) for(j=1;j<=ns;j++)		DDN_wbindata(fpdata,1,&section[i][j],1,0,1,0,seis_form[2],seis_form[3],seis_form[4]); /* probably extremely slow !!! */
+					for(i=tr1;i<=tr2;i++) for(j=1;j<=ns;j++)		DDN_wbindata(fpdata,1,&section[i-off][j],1,0,1,0,seis_form[2],seis_form[3],seis_form[4]); /* probably extremely slow !!! */
 			}	
 	}
 	break;
@@ -225,6 +251,4 @@ void  outseis_glob(FILE *fp, FILE *fpdata, float **section,
 		fprintf(fp," Don't know data format for seismograms !\n");
 		fprintf(fp," No output written. ");
 	}
-
-	fclose(fpdata);
 }
@@ -6,6 +6,9 @@
 
 #include "fd.h"
 #include "globvar.h"      /* definition of global variables  */
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 int main(int argc, char **argv) {
@@ -24,6 +27,11 @@ char cline[256];
 char *fileinp="";
 FILE *fvpmod, *frhomod,*fvpmpart, *frhompart, * fpsrc, *fpr, *fshift;
 
+#ifdef _OPENMP
+/* serial program, the threaded allocation in util.c uses one thread */
+omp_set_num_threads(1);
+#endif
+
 if (argc != 2) {
     exit(1);    
 }
@@ -1,207 +1,147 @@
 /* ----------------------------------------------------------------------
  * reads checkpoint file for the continuation of a simulation
+ *
+ * The header of the checkpoint must match the grid, the decomposition and
+ * the numerical parameters of the simulation and the checksum the data,
+ * see save_checkpoint.c for the format.
  ----------------------------------------------------------------------*/
 #include "data_structures.h"
 #include "fd.h"
 #include "globvar.h"
 
 
-static void read_value(float *dst, FILE *fp);
-
-void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Velocity *v,
-                     Tensor3d *s,
-		     Tensor3d *r,
-		     float *** psi_sxx_x, float *** psi_sxy_x, float *** psi_sxz_x, float *** psi_sxy_y,
-		     float *** psi_syy_y, float *** psi_syz_y, float *** psi_sxz_z, float *** psi_syz_z, float *** psi_szz_z,
-                     float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
-                     float *** psi_vxz, float *** psi_vyz, float *** psi_vzz) {
-
-	int i,j,k;
-	char myid[5];
-	FILE *fp;
-	char checkptfile[STRING_SIZE];
-	extern int MYID;
-	extern int ABS_TYPE, NX,NY,NZ,FW,POS[4],NPROCX,NPROCY,NPROCZ,FREE_SURF;
-	extern int L;
-	extern char  CHECKPTFILE[STRING_SIZE];
-        float ***vx = v->x;
-        float ***vy = v->y;
-        float ***vz = v->z;
-
-        float ***sxx = s->xx;
-        float ***syy = s->yy;
-        float ***szz = s->zz;
-        float ***sxy = s->xy;
-        float ***syz = s->yz;
-        float ***sxz = s->xz;
-
-        float ***rxx = r->xx;
-        float ***ryy = r->yy;
-        float ***rzz = r->zz;
-        float ***rxy = r->xy;
-        float ***ryz = r->yz;
-        float ***rxz = r->xz;
-	
-	sprintf(checkptfile,"%s",CHECKPTFILE);
-	sprintf(myid,".%d",MYID);
-	strcat(checkptfile,myid);
-
-
-
-	fp=fopen(checkptfile,"rb");
-	if (fp==NULL) {
-		err("CHECKPTFILE can't be opened !");
-	}
-
-	for (j=ny1; j<=ny2; j++) {
-		for (i=nx1; i<=nx2; i++) {
-			for (k=nz1; k<=nz2; k++) {
-				read_value(&vx[j][i][k], fp);
-				read_value(&vy[j][i][k], fp);
-				read_value(&vz[j][i][k], fp);
-
-				read_value(&sxx[j][i][k], fp);
-				read_value(&syy[j][i][k], fp);
-				read_value(&szz[j][i][k], fp);
-				read_value(&sxy[j][i][k], fp);
-				read_value(&syz[j][i][k], fp);
-				read_value(&sxz[j][i][k], fp);
-			}
-		}
-	}
-
-	
-    // Viscoelastic data.
-	if (L) {
-		for (j=1; j<=NY; j++) {
-			for (i=1; i<=NX; i++) {
-				for (k=1; k<=NZ; k++) {
-					read_value(&rxx[j][i][k], fp);
-					read_value(&ryy[j][i][k], fp);
-					read_value(&rzz[j][i][k], fp);
-					read_value(&rxy[j][i][k], fp);
-					read_value(&ryz[j][i][k], fp);
-					read_value(&rxz[j][i][k], fp);
-				}
-			}
-		}
-	}
-	
-	
-	
-	if (ABS_TYPE == 1) {
-		if (POS[1]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxx_x[j][i][k], fp);
-						read_value(&psi_sxy_x[j][i][k], fp);
-						read_value(&psi_sxz_x[j][i][k], fp);
-
-						read_value(&psi_vxx[j][i][k], fp);
-						read_value(&psi_vyx[j][i][k], fp);
-						read_value(&psi_vzx[j][i][k], fp);
-					}
-				}
-			}
-		}
-
-		if (POS[1]==NPROCX-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=FW+1; i<=2*FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxx_x[j][i][k], fp);
-						read_value(&psi_sxy_x[j][i][k], fp);
-						read_value(&psi_sxz_x[j][i][k], fp);
-
-						read_value(&psi_vxx[j][i][k], fp);
-						read_value(&psi_vyx[j][i][k], fp);
-						read_value(&psi_vzx[j][i][k], fp);
-					}
-				}
-			}
-		}
-
-		if (POS[2]==0 && FREE_SURF==0) {
-			for (j=1; j<=FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxy_y[j][i][k], fp);
-						read_value(&psi_syy_y[j][i][k], fp);
-						read_value(&psi_syz_y[j][i][k], fp);
-
-						read_value(&psi_vxy[j][i][k], fp);
-						read_value(&psi_vyy[j][i][k], fp);
-						read_value(&psi_vzy[j][i][k], fp);
-					}
-				}
-			}
-		}
-		if (POS[2]==NPROCY-1) {
-			for (j=FW+1; j<=2*FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxy_y[j][i][k], fp);
-						read_value(&psi_syy_y[j][i][k], fp);
-						read_value(&psi_syz_y[j][i][k], fp);
-
-						read_value(&psi_vxy[j][i][k], fp);
-						read_value(&psi_vyy[j][i][k], fp);
-						read_value(&psi_vzy[j][i][k], fp);
-					}
-				}
-			}
-		}
-
-		if (POS[3]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=FW; k++) {
-						read_value(&psi_sxz_z[j][i][k], fp);
-						read_value(&psi_syz_z[j][i][k], fp);
-						read_value(&psi_szz_z[j][i][k], fp);
-
-						read_value(&psi_vxz[j][i][k], fp);
-						read_value(&psi_vyz[j][i][k], fp);
-						read_value(&psi_vzz[j][i][k], fp);
-					}
-				}
-			}
-		}
-		if (POS[3]==NPROCZ-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=FW+1; k<=2*FW; k++) {
-						read_value(&psi_sxz_z[j][i][k], fp);
-						read_value(&psi_syz_z[j][i][k], fp);
-						read_value(&psi_szz_z[j][i][k], fp);
-
-						read_value(&psi_vxz[j][i][k], fp);
-						read_value(&psi_vyz[j][i][k], fp);
-						read_value(&psi_vzz[j][i][k], fp);
-					}
-				}
-			}
-		}
-	} // end if (ABS_TYPE == 1)
-
-	fclose(fp);
+#define CHECK(FIELD, NAME) \
+    if (h->FIELD != e->FIELD) \
+        err("Checkpoint file %s does not match the simulation: %s is %d " \
+            "instead of %d", file, NAME, (int) h->FIELD, (int) e->FIELD)
+
+
+/*
+ * Terminate if the header `h` read from `file` does not match the header
+ * `e` of the simulation.
+ */
+static void check_header(const char *file, const CheckpointHeader *h,
+        const CheckpointHeader *e)
+{
+    if (memcmp(h->magic, e->magic, sizeof(h->magic)))
+        err("%s is not a checkpoint file of this program", file);
+    CHECK(version, "version");
+    CHECK(nx, "NX");
+    CHECK(ny, "NY");
+    CHECK(nz, "NZ");
+    CHECK(pos[0], "POS[1]");
+    CHECK(pos[1], "POS[2]");
+    CHECK(pos[2], "POS[3]");
+    CHECK(nprocx, "NPROCX");
+    CHECK(nprocy, "NPROCY");
+    CHECK(nprocz, "NPROCZ");
+    CHECK(fdorder, "FDORDER");
+    CHECK(fdorder_time, "FDORDER_TIME");
+    CHECK(nrelax, "L");
+    CHECK(abs_type, "ABS_TYPE");
+    CHECK(fw, "FW");
+    CHECK(free_surf, "FREE_SURF");
+    CHECK(ntr, "number of receivers");
+    CHECK(ns, "number of seismogram samples");
+    if (h->nfloat != e->nfloat)
+        err("Checkpoint file %s does not match the simulation: %lld "
+            "instead of %lld values", file, (long long) h->nfloat,
+            (long long) e->nfloat);
 }
 
-/**
- * Read a float value from file fp and write it into dst.
+
+/*
+ * Restore the state of the simulation.
+ *
+ * Parameters
+ * ----------
+ * c :
+ *     State of the simulation, the fields are overwritten and the counters
+ *     of the time loop set.
+ *
+ * Returns
+ * -------
+ * Time step after which the checkpoint was saved.
  */
-static void read_value(float *dst, FILE *fp)
+int read_checkpoint(Checkpoint *c)
 {
+    extern int CHECKPT_MPIIO;
     extern char CHECKPTFILE[STRING_SIZE];
 
-    size_t nelems = fread(dst, sizeof(float), 1, fp);
-
-    if (nelems != 1) {
-        char msg[STRING_SIZE];
-        sprintf(msg,
-                "Error occurred while reading from a checkpoint file '%s'",
-                CHECKPTFILE);
-        err(msg);
+    CheckpointField f[CHECKPOINT_FIELDS_MAX];
+    CheckpointHeader h, e;
+    char file[STRING_SIZE + 8];
+    float *buf;
+    size_t nread;
+    int nf, nt[2];
+
+    nf = checkpoint_fields(c, f);
+    checkpoint_header(c, &e);
+    buf = (float *) malloc((size_t) e.nfloat * sizeof(float) + 1);
+    if (!buf) err("allocation failure in function read_checkpoint() ");
+
+    if (!CHECKPT_MPIIO) {
+        FILE *fp;
+
+        sprintf(file, "%s.%d", CHECKPTFILE, checkpoint_rank());
+        fp = fopen(file, "rb");
+        if (fp == NULL) err("Could not open checkpoint file %s", file);
+        if (fread(&h, sizeof(h), 1, fp) != 1)
+            err("Could not read the header of checkpoint file %s", file);
+        check_header(file, &h, &e);
+        nread = fread(buf, sizeof(float), (size_t) e.nfloat, fp);
+        fclose(fp);
+    } else {
+        MPI_File fh;
+        MPI_Offset off;
+        MPI_Status status;
+        size_t m, nchunk;
+        int count;
+
+        strcpy(file, CHECKPTFILE);
+        off = checkpoint_offset(sizeof(e) + (size_t) e.nfloat * sizeof(float));
+        if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_RDONLY,
+                    MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+            err("Could not open checkpoint file %s", file);
+        memset(&h, 0, sizeof(h));
+        MPI_File_read_at(fh, off, &h, (int) sizeof(h), MPI_BYTE, &status);
+        check_header(file, &h, &e);
+        off += (MPI_Offset) sizeof(h);
+        nread = 0;
+        for (m = 0; m < (size_t) e.nfloat; m += nchunk) {
+            nchunk = (size_t) e.nfloat - m;
+            if (nchunk > (1u << 28)) nchunk = 1u << 28;
+            MPI_File_read_at(fh, off + (MPI_Offset) (m * sizeof(float)),
+                    &buf[m], (int) nchunk, MPI_FLOAT, &status);
+            MPI_Get_count(&status, MPI_FLOAT, &count);
+            nread += (size_t) count;
+        }
+        MPI_File_close(&fh);
     }
+
+    if (nread != (size_t) e.nfloat)
+        err("Checkpoint file %s is truncated", file);
+    if (checkpoint_checksum(buf, (size_t) e.nfloat) != h.checksum)
+        err("Checksum of checkpoint file %s is wrong", file);
+
+    /* a job terminated while the files of the PEs were written by the
+       threads may leave files of two checkpoints */
+    nt[0] = -h.nt;
+    nt[1] = h.nt;
+    MPI_Allreduce(MPI_IN_PLACE, nt, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (nt[0] != -nt[1])
+        err("Checkpoint files %s were saved after different time steps "
+            "(%d and %d)", file, -nt[0], nt[1]);
+
+    checkpoint_copy(f, nf, buf, 0);
+    free(buf);
+
+    c->nt = h.nt;
+    c->ishot = h.ishot;
+    c->lsnap = h.lsnap;
+    c->nsnap = h.nsnap;
+    c->lsamp = h.lsamp;
+    c->nlsamp = h.nlsamp;
+
+    return c->nt;
 }
@@ -51,6 +51,27 @@ int SOFI3DVERS; /* version of SOFI3D 33: current 3D isotropic elastic (SSG), ver
 
 // MPI variables
 int NP, NPSP, NPROC, NPROCX, NPROCY, NPROCZ, MYID, IENDX, IENDY, IENDZ;
+int OVERLAP_COMM=0; /* overlap the exchange of the wavefield with the update of the subdomain interior */
+int PERSISTENT_COMM=0; /* exchange the wavefield with persistent MPI requests, see comm_ini.c */
+int THREADS=1; /* number of OpenMP threads per MPI process */
+int SIMD=SIMD_AVX512; /* highest instruction set of the vectorized kernels, see enum.h */
+int TILE_X=0, TILE_Y=0, TILE_Z=0; /* tile sizes of the update loops, 0: no tiling, see tiles.c */
+int TILE_AUTO=0; /* choose TILE_X and TILE_Z from the L2 cache size */
+int TIME_BLOCK=1; /* time steps per sweep of the acoustic program, see tblock_acoustic.c */
+int MAT_PRECISION=MAT_FP32; /* storage of the material parameters, see enum.h and mat16.c */
+int MAT_COMPRESS=0; /* table of distinct media and index volume, see mat_table.c */
+int SNAP_MPIIO=0; /* write the snapshots into one file per component with MPI-IO, see snap_write.c */
+int SNAP_ASYNC=0; /* write the snapshots on an I/O thread, see snap_async.c */
+int SNAP_COMPRESS=0; /* compression of the snapshots of the PEs, see snap_compress.c */
+float SNAP_TOL=0.0; /* error bound of the lossy snapshot compression */
+char SNAP_PLAN[STRING_SIZE]=""; /* planes and boxes written instead of the whole model, see snap_plan.c */
+int CHECKPT_INC=0; /* time steps between periodic checkpoints, see save_checkpoint.c */
+int CHECKPT_MPIIO=0; /* write the checkpoint into one file with MPI-IO */
+int SEIS_BLOCK=0; /* seismogram samples kept in memory per trace, see seis_stream.c */
+int SEIS_MPIIO=0; /* each PE writes its seismogram traces with MPI-IO, see seis_mpiio.c */
+int DECOMP=0; /* sizes of the sub grids, 0: equal, 1: balanced cost, see decomp.c */
+float DECOMP_CPML=2.0; /* extra cost of a grid point in the CPML frame for DECOMP=1 */
+int OFFX[NPROCX_MAX + 1], OFFY[NPROCY_MAX + 1], OFFZ[NPROCZ_MAX + 1]; /* global grid points before the sub grid of each PE position */
 int POS[4], INDEX[7];
 const int TAG1 = 1, TAG2 = 2, TAG3 = 3, TAG4 = 4, TAG5 = 5, TAG6 = 6;
 
@@ -82,11 +103,14 @@ void read_par_json(FILE *fp, char *fileinp)
     extern float REC_ARRAY_DEPTH, REC_ARRAY_DIST;
     extern int SEISMO, NDT, NDTSHIFT, NGEOPH, SEIS_FORMAT[6], FREE_SURF, READMOD, READREC, RUN_MULTIPLE_SHOTS;
     extern int BOUNDARY, REC_ARRAY, LOG, IDX, IDY, IDZ, ABS_TYPE, WRITE_MODELFILES;
-    extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING, FPML, VPPML, NPOWER, K_MAX_CPML;
+    extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING, FPML, VPPML, NPOWER, K_MAX_CPML, SNAP_TOL, DECOMP_CPML;
     extern char MFILE[STRING_SIZE], SIGNAL_FILE[STRING_SIZE], LOG_FILE[STRING_SIZE], CHECKPTFILE[STRING_SIZE];
     extern char SNAP_FILE[STRING_SIZE], SOURCE_FILE[STRING_SIZE], REC_FILE[STRING_SIZE];
-    extern char SEIS_FILE[STRING_SIZE];
+    extern char SEIS_FILE[STRING_SIZE], SNAP_PLAN[STRING_SIZE];
     extern int NPROCX, NPROCY, NPROCZ, CHECKPTREAD, CHECKPTWRITE, OUTNTIMESTEPINFO, OUTSOURCEWAVELET;
+    extern int OVERLAP_COMM, PERSISTENT_COMM, THREADS, SIMD, DECOMP;
+    extern int TILE_X, TILE_Y, TILE_Z, TILE_AUTO, TIME_BLOCK, MAT_PRECISION, MAT_COMPRESS;
+    extern int SNAP_MPIIO, SNAP_ASYNC, SNAP_COMPRESS, CHECKPT_INC, CHECKPT_MPIIO, SEIS_BLOCK, SEIS_MPIIO;
     extern int ASCIIEBCDIC, LITTLEBIG, IEEEIBM;
 
     // Model parameters for model generation.
@@ -145,6 +169,87 @@ void read_par_json(FILE *fp, char *fileinp)
         err("Variable NPROCY could not be retrieved from the json input file!");
     if (get_int_from_objectlist("NPROCZ", number_readobjects, &NPROCZ, varname_list, value_list))
         err("Variable NPROCY could not be retrieved from the json input file!");
+    if (get_int_from_objectlist("DECOMP", number_readobjects, &DECOMP, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "DECOMP");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    else if (DECOMP == 1)
+    {
+        if (get_float_from_objectlist("DECOMP_CPML", number_readobjects, &DECOMP_CPML, varname_list, value_list))
+        {
+            strcpy(varname_tmp1, "DECOMP_CPML");
+            strcpy(value_tmp1, "2.0");
+            add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+        }
+    }
+    if (get_int_from_objectlist("OVERLAP_COMM", number_readobjects, &OVERLAP_COMM, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "OVERLAP_COMM");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("PERSISTENT_COMM", number_readobjects, &PERSISTENT_COMM, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "PERSISTENT_COMM");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("THREADS", number_readobjects, &THREADS, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "THREADS");
+        strcpy(value_tmp1, "1");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("SIMD", number_readobjects, &SIMD, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "SIMD");
+        strcpy(value_tmp1, "2");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_X", number_readobjects, &TILE_X, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_X");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_Y", number_readobjects, &TILE_Y, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_Y");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_Z", number_readobjects, &TILE_Z, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_Z");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_AUTO", number_readobjects, &TILE_AUTO, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_AUTO");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TIME_BLOCK", number_readobjects, &TIME_BLOCK, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TIME_BLOCK");
+        strcpy(value_tmp1, "1");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("MAT_PRECISION", number_readobjects, &MAT_PRECISION, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "MAT_PRECISION");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("MAT_COMPRESS", number_readobjects, &MAT_COMPRESS, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "MAT_COMPRESS");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
     /*note that "y" is used for the vertical coordinate */
     if (get_int_from_objectlist("FDORDER", number_readobjects, &FDORDER, varname_list, value_list))
         err("Variable FDORDER could not be retrieved from the json input file!");
@@ -192,6 +297,33 @@ void read_par_json(FILE *fp, char *fileinp)
                 err("Variable TSNAPINC could not be retrieved from the json input file!");
             if (get_string_from_objectlist("SNAP_FILE", number_readobjects, SNAP_FILE, varname_list, value_list))
                 err("Variable SNAP_FILE could not be retrieved from the json input file!");
+            if (get_int_from_objectlist("SNAP_MPIIO", number_readobjects, &SNAP_MPIIO, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_MPIIO");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (get_int_from_objectlist("SNAP_ASYNC", number_readobjects, &SNAP_ASYNC, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_ASYNC");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (get_int_from_objectlist("SNAP_COMPRESS", number_readobjects, &SNAP_COMPRESS, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_COMPRESS");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (SNAP_COMPRESS >= 2)
+                if (get_float_from_objectlist("SNAP_TOL", number_readobjects, &SNAP_TOL, varname_list, value_list))
+                    err("Variable SNAP_TOL could not be retrieved from the json input file!");
+            if (get_string_from_objectlist("SNAP_PLAN", number_readobjects, SNAP_PLAN, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_PLAN");
+                strcpy(value_tmp1, "");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
         }
     }
     /* increments are read in any case, because they will be also used as increment for model output */
@@ -329,6 +461,18 @@ void read_par_json(FILE *fp, char *fileinp)
                     SEIS_FORMAT[5] = 0;
                 }
             }
+            if (get_int_from_objectlist("SEIS_BLOCK", number_readobjects, &SEIS_BLOCK, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SEIS_BLOCK");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (get_int_from_objectlist("SEIS_MPIIO", number_readobjects, &SEIS_MPIIO, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SEIS_MPIIO");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
         }
     }
 
@@ -630,6 +774,18 @@ void read_par_json(FILE *fp, char *fileinp)
         err("Variable CHECKPTREAD could not be retrieved from the json input file!");
     if (get_int_from_objectlist("CHECKPTWRITE", number_readobjects, &CHECKPTWRITE, varname_list, value_list))
         err("Variable CHECKPTWRITE could not be retrieved from the json input file!");
+    if (get_int_from_objectlist("CHECKPT_INC", number_readobjects, &CHECKPT_INC, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "CHECKPT_INC");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("CHECKPT_MPIIO", number_readobjects, &CHECKPT_MPIIO, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "CHECKPT_MPIIO");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
     if (get_int_from_objectlist("OUT_TIMESTEP_INFO", number_readobjects, &OUTNTIMESTEPINFO, varname_list, value_list))
     {
         strcpy(varname_tmp1, "OUT_TIMESTEP_INFO");
@@ -765,20 +921,108 @@ void read_par_json(FILE *fp, char *fileinp)
     // Check that the grid size is large enough for the given width
     // of the boundary frame.
     {
-        if (NX / (float) NPROCX < FW) {
+        if (NPROCX && (NX / (float) NPROCX < FW)) {
             err("Local grid resolution along X-axis %d is smaller than "
                 "boundary width (FW=%d)", (int) (NX / (float) NPROCX), FW);
         }
-        if (NY / (float) NPROCY < FW) {
+        if (NPROCY && (NY / (float) NPROCY < FW)) {
             err("Local grid resolution along Y-axis NY=%d is smaller than "
                 "boundary width (FW=%d)", (int) (NY / (float) NPROCY), FW);
         }
-        if (NZ / (float) NPROCZ < FW) {
+        if (NPROCZ && (NZ / (float) NPROCZ < FW)) {
             err("Local grid resolution along Z-axis NZ=%d is smaller than "
                 "boundary width (FW=%d)", (int) (NZ / (float) NPROCZ), FW);
         }
     }
 
+    // The random source is applied to the whole local grid at once
+    // and cannot be split into boundary shell and core.
+    if (OVERLAP_COMM && (SOURCE_TYPE == SOURCE_TYPE_RANDOM)) {
+        warning("OVERLAP_COMM is not supported for the random source "
+                "(SOURCE_TYPE=0), using the blocking exchange instead.");
+        OVERLAP_COMM = 0;
+    }
+
+    if ((DECOMP < 0) || (DECOMP > 1))
+        err("DECOMP=%d, must be 0 (sub grids of equal size) or 1 (balanced cost)",
+            DECOMP);
+    if (DECOMP_CPML < 0.0)
+        err("DECOMP_CPML=%f, the extra cost of the CPML frame must not be negative",
+            DECOMP_CPML);
+
+    if (THREADS < 1)
+        err("THREADS=%d, the number of threads per MPI process must be "
+            "at least 1", THREADS);
+#ifndef _OPENMP
+    if (THREADS > 1) {
+        warning("THREADS > 1 requires a build with OpenMP support, "
+                "using one thread per MPI process.");
+        THREADS = 1;
+    }
+#endif
+
+    if ((SIMD < SIMD_NONE) || (SIMD > SIMD_AVX512))
+        err("SIMD=%d, must be 0 (scalar), 1 (up to AVX2) or 2 (up to AVX-512)",
+            SIMD);
+
+    if ((TILE_X < 0) || (TILE_Y < 0) || (TILE_Z < 0))
+        err("TILE_X=%d, TILE_Y=%d, TILE_Z=%d, tile sizes must not be negative",
+            TILE_X, TILE_Y, TILE_Z);
+
+    if (TIME_BLOCK < 1)
+        err("TIME_BLOCK=%d, the number of time steps per sweep must be at least 1",
+            TIME_BLOCK);
+
+    if ((MAT_PRECISION < MAT_FP32) || (MAT_PRECISION > MAT_BF16))
+        err("MAT_PRECISION=%d, must be 0 (FP32), 1 (FP16) or 2 (BF16)",
+            MAT_PRECISION);
+
+    if ((MAT_COMPRESS < 0) || (MAT_COMPRESS > 1))
+        err("MAT_COMPRESS=%d, must be 0 (dense arrays) or 1 (table of media)",
+            MAT_COMPRESS);
+    if (MAT_COMPRESS && (MAT_PRECISION != MAT_FP32))
+        err("MAT_COMPRESS=1 cannot be combined with MAT_PRECISION=%d",
+            MAT_PRECISION);
+
+    if ((SNAP_MPIIO < 0) || (SNAP_MPIIO > 1))
+        err("SNAP_MPIIO=%d, must be 0 (one file per PE) or 1 (one file per component)",
+            SNAP_MPIIO);
+    if (SNAP && SNAP_MPIIO && (SNAP_FORMAT != 3))
+        err("SNAP_MPIIO=1 requires binary snapshots (SNAP_FORMAT=3)");
+    if ((SNAP_ASYNC < 0) || (SNAP_ASYNC > 1))
+        err("SNAP_ASYNC=%d, must be 0 (synchronous) or 1 (I/O thread)",
+            SNAP_ASYNC);
+    if ((SNAP_COMPRESS < 0) || (SNAP_COMPRESS > 3))
+        err("SNAP_COMPRESS=%d, must be 0 (none), 1 (lossless), 2 (absolute "
+            "error bound) or 3 (relative error bound)", SNAP_COMPRESS);
+    if (SNAP && SNAP_COMPRESS && ((SNAP_FORMAT != 3) || SNAP_MPIIO))
+        err("SNAP_COMPRESS>0 requires binary snapshots (SNAP_FORMAT=3) "
+            "with one file per PE (SNAP_MPIIO=0)");
+    if (SNAP && (SNAP_COMPRESS >= 2) && !(SNAP_TOL > 0.0))
+        err("SNAP_TOL=%e, the error bound of SNAP_COMPRESS=%d must be positive",
+            SNAP_TOL, SNAP_COMPRESS);
+    if (SNAP && SNAP_PLAN[0] && ((SNAP_FORMAT != 3) || SNAP_COMPRESS))
+        err("SNAP_PLAN requires binary snapshots (SNAP_FORMAT=3) without "
+            "compression (SNAP_COMPRESS=0)");
+
+    if (CHECKPT_INC < 0)
+        err("CHECKPT_INC=%d, must be 0 (no periodic checkpoints) or positive",
+            CHECKPT_INC);
+    if ((CHECKPT_MPIIO < 0) || (CHECKPT_MPIIO > 1))
+        err("CHECKPT_MPIIO=%d, must be 0 (one file per PE) or 1 (one file)",
+            CHECKPT_MPIIO);
+
+    if (SEIS_BLOCK < 0)
+        err("SEIS_BLOCK=%d, must be 0 (whole seismograms in memory) or positive",
+            SEIS_BLOCK);
+    if (SEISMO && SEIS_BLOCK && (SEIS_FORMAT[0] == 2))
+        err("SEIS_BLOCK>0 requires SU, SEG-Y or binary seismograms (SEIS_FORMAT=2 is ASCII)");
+    if ((SEIS_MPIIO < 0) || (SEIS_MPIIO > 1))
+        err("SEIS_MPIIO=%d, must be 0 (PE 0 writes) or 1 (all PEs write)",
+            SEIS_MPIIO);
+    if (SEISMO && SEIS_MPIIO && (SEIS_FORMAT[0] == 2))
+        err("SEIS_MPIIO=1 requires SU, SEG-Y or binary seismograms (SEIS_FORMAT=2 is ASCII)");
+
     /*=================================
       TODO: Check why this if executes even when RSF=0 in the json file.
       =================================*/
@@ -44,3 +44,47 @@ float readdsk(FILE *fp_in, int format)
 
     return amp;
 }
+
+
+/*
+ * Read `n` float values from a given file into `buf`.
+ *
+ * Binary data are read with one call of fread, so that reading is limited
+ * by the bandwidth of the file system rather than by the calls of libc.
+ * The formats are the same as for readdsk(). The values are not converted:
+ * model and snapshot files hold native floats, byte swapping and IBM
+ * floats are only needed for SEG-Y and are done by segy_conv.c.
+ *
+ * fp_in   Pointer to the opened file
+ * buf     Values read, buf[0..n-1]
+ * n       Number of values
+ * format  File format
+ */
+void readdsk_block(FILE *fp_in, float *buf, int n, int format)
+{
+    int m;
+
+    switch (format) {
+        case FILE_FORMAT_SU:
+            err(" Sorry, SU-format for snapshots not implemented yet. \n");
+            break;
+        case FILE_FORMAT_ASCII:
+            for (m = 0; m < n; m++) {
+                if (fscanf(fp_in, "%e\n", &buf[m]) != 1) {
+                    err("[%s] Could not read an amplitude "
+                        "from a file in ASCII format\n", __func__);
+                }
+            }
+            break;
+        case FILE_FORMAT_BINARY:
+            if (fread(buf, sizeof(float), (size_t) n, fp_in) != (size_t) n) {
+                err("[%s] Could not read %d amplitudes "
+                    "from a file in binary format\n", __func__, n);
+            }
+            break;
+
+        default:
+            err("[%s] Unsupported file format. "
+                "Supported formats are SU, ASCII, and BINARY", __func__);
+    }
+}
@@ -2,6 +2,8 @@
  *   Read elastic model properties (vp,vs,density) from files
  *   if L>0 damping model (qp and qs) are from file read, too
  *
+ *   The files are read collectively with MPI-IO, each PE reads only its
+ *   sub grid (see readmod_mpiio.c).
  *  ----------------------------------------------------------------------*/
 #include <stdbool.h>
 
@@ -16,7 +18,7 @@ void readmod(float ***rho, float ***pi, float ***u,
 {
     // Global variables.
     extern float DT, *FL, TAU, TS, FREF;
-    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], L, MYID;
+    extern int NX, NY, NZ, L, MYID;
     extern int WRITE_MODELFILES;
     extern char MFILE[STRING_SIZE];
     extern FILE *FP;
@@ -32,11 +34,12 @@ void readmod(float ***rho, float ***pi, float ***u,
     float *pts = NULL, sumu = 0.0, sumpi = 0.0, ws = 0.0;
     float ***pwavemod = NULL, ***swavemod = NULL;
     float ***qpmod = NULL, ***qsmod = NULL;
-    int i, j, k, l, ii, jj, kk;
+    int l, ii, jj, kk, n, nzmax;
 
-    FILE *fp_vs, *fp_vp, *fp_rho, *fp_qp = NULL, *fp_qs = NULL;
-    FILE *fp_C11, *fp_C22, *fp_C33, *fp_C44, *fp_C55, *fp_C66;
-    FILE *fp_C12, *fp_C13, *fp_C23;
+    ModelFile fp_vs, fp_vp, fp_rho;
+    ModelFile fp_qp = {MPI_FILE_NULL, NULL, 0}, fp_qs = {MPI_FILE_NULL, NULL, 0};
+    ModelFile fp_C11, fp_C22, fp_C33, fp_C44, fp_C55, fp_C66;
+    ModelFile fp_C12, fp_C13, fp_C23;
 
     char filename[STRING_SIZE];
 
@@ -57,21 +60,18 @@ void readmod(float ***rho, float ***pi, float ***u,
     char fname_delxy[STRING_SIZE];
     char fname_gamx[STRING_SIZE];
     char fname_gamy[STRING_SIZE];
-    FILE *fp_epsx;
-    FILE *fp_epsy;
-    FILE *fp_delx;
-    FILE *fp_dely;
-    FILE *fp_delxy;
-    FILE *fp_gamx;
-    FILE *fp_gamy;
+    ModelFile fp_epsx;
+    ModelFile fp_epsy;
+    ModelFile fp_delx;
+    ModelFile fp_dely;
+    ModelFile fp_delxy;
+    ModelFile fp_gamx;
+    ModelFile fp_gamy;
 
     bool flag_velocity_files_avail = false;
     bool flag_cij_files_avail = false;
 
 
-    /* choose data format: ASCII: format=2, BINARY: format=3*/
-    const int format = 3;
-
     /*internal switch for writing all models to file (WRITE_MODELFILES=1)
 	 * or just density (WRITE_MODELFILES=0)
 	 * BE AWARE that the output of additional models besides density
@@ -93,8 +93,8 @@ void readmod(float ***rho, float ***pi, float ***u,
     char fname_rho[STRING_SIZE];
     sprintf(fname_rho, "%s.rho", MFILE);
     fprintf(FP, "\tDensity: %s\n\n", fname_rho);
-    fp_rho = fopen(fname_rho, "r");
-    if (fp_rho == NULL) {
+    modfile_open(&fp_rho, fname_rho);
+    if (fp_rho.plane == NULL) {
         err("Could not open model file containing density field!");
     }
 
@@ -103,24 +103,24 @@ void readmod(float ***rho, float ***pi, float ***u,
         char fname_vp[STRING_SIZE];
         sprintf(fname_vp, "%s.vp", MFILE);
         fprintf(FP, "\tP-wave velocities: %s\n", fname_vp);
-        fp_vp = fopen(fname_vp, "r");
+        modfile_open(&fp_vp, fname_vp);
 
         char fname_vs[STRING_SIZE];
         sprintf(fname_vs, "%s.vs", MFILE);
         fprintf(FP, "\tS-wave velocities: %s\n", fname_vs);
-        fp_vs = fopen(fname_vs, "r");
+        modfile_open(&fp_vs, fname_vs);
 
         // Checking that either model files for Vp and Vs are both present
         // or both absent, otherwise terminate with error.
-        if (fp_vp != NULL && fp_vs != NULL) {
+        if (fp_vp.plane != NULL && fp_vs.plane != NULL) {
             flag_velocity_files_avail = true;
             fprintf(FP,
                     "\tBoth P- and S-wave velocity models are readable\n\n"
             );
-        } else if (fp_vp == NULL && fp_vs != NULL) {
+        } else if (fp_vp.plane == NULL && fp_vs.plane != NULL) {
             err("Could not open model file for P-velocity "
                 "but model file for S-velocity is available.");
-        } else if (fp_vp != NULL && fp_vs == NULL) {
+        } else if (fp_vp.plane != NULL && fp_vs.plane == NULL) {
             err("Could not open model file for S-velocity "
                 "but model file for P-velocity is available.");
         } else {
@@ -137,31 +137,31 @@ void readmod(float ***rho, float ***pi, float ***u,
 
         sprintf(fname_epsx, "%s.epsx", MFILE);
         fprintf(FP, "\tepsx field: %s\n", fname_epsx);
-        fp_epsx = fopen(fname_epsx, "r");
+        modfile_open(&fp_epsx, fname_epsx);
 
         sprintf(fname_epsy, "%s.epsy", MFILE);
         fprintf(FP, "\tepsy field: %s\n", fname_epsy);
-        fp_epsy = fopen(fname_epsy, "r");
+        modfile_open(&fp_epsy, fname_epsy);
 
         sprintf(fname_delx, "%s.delx", MFILE);
         fprintf(FP, "\tdelx field: %s\n", fname_delx);
-        fp_delx = fopen(fname_delx, "r");
+        modfile_open(&fp_delx, fname_delx);
 
         sprintf(fname_dely, "%s.dely", MFILE);
         fprintf(FP, "\tdely field: %s\n", fname_dely);
-        fp_dely = fopen(fname_dely, "r");
+        modfile_open(&fp_dely, fname_dely);
 
         sprintf(fname_delxy, "%s.delxy", MFILE);
         fprintf(FP, "\tdelxy field: %s\n", fname_delxy);
-        fp_delxy = fopen(fname_delxy, "r");
+        modfile_open(&fp_delxy, fname_delxy);
 
         sprintf(fname_gamx, "%s.gamx", MFILE);
         fprintf(FP, "\tgamx field: %s\n", fname_gamx);
-        fp_gamx = fopen(fname_gamx, "r");
+        modfile_open(&fp_gamx, fname_gamx);
 
         sprintf(fname_gamy, "%s.gamy", MFILE);
         fprintf(FP, "\tgamy field: %s\n", fname_gamy);
-        fp_gamy = fopen(fname_gamy, "r");
+        modfile_open(&fp_gamy, fname_gamy);
     }
 
 
@@ -173,47 +173,47 @@ void readmod(float ***rho, float ***pi, float ***u,
     {
         sprintf(fname_C11, "%s.C11", MFILE);
         fprintf(FP, "\tC11 model: %s\n", fname_C11);
-        fp_C11 = fopen(fname_C11, "r");
+        modfile_open(&fp_C11, fname_C11);
 
         sprintf(fname_C22, "%s.C22", MFILE);
         fprintf(FP, "\tC22: %s\n", fname_C22);
-        fp_C22 = fopen(fname_C22, "r");
+        modfile_open(&fp_C22, fname_C22);
 
         sprintf(fname_C33, "%s.C33", MFILE);
         fprintf(FP, "\tC33: %s\n", fname_C33);
-        fp_C33 = fopen(fname_C33, "r");
+        modfile_open(&fp_C33, fname_C33);
 
         sprintf(fname_C44, "%s.C44", MFILE);
         fprintf(FP, "\tC44: %s\n", fname_C44);
-        fp_C44 = fopen(fname_C44, "r");
+        modfile_open(&fp_C44, fname_C44);
 
         sprintf(fname_C55, "%s.C55", MFILE);
         fprintf(FP, "\tC55: %s\n", fname_C55);
-        fp_C55 = fopen(fname_C55, "r");
+        modfile_open(&fp_C55, fname_C55);
 
         sprintf(fname_C66, "%s.C66", MFILE);
         fprintf(FP, "\tC66: %s\n", fname_C66);
-        fp_C66 = fopen(fname_C66, "r");
+        modfile_open(&fp_C66, fname_C66);
 
         sprintf(fname_C12, "%s.C12", MFILE);
         fprintf(FP, "\tC12: %s\n", fname_C12);
-        fp_C12 = fopen(fname_C12, "r");
+        modfile_open(&fp_C12, fname_C12);
 
         sprintf(fname_C13, "%s.C13", MFILE);
         fprintf(FP, "\tC13: %s\n", fname_C13);
-        fp_C13 = fopen(fname_C13, "r");
+        modfile_open(&fp_C13, fname_C13);
 
         sprintf(fname_C23, "%s.C23", MFILE);
         fprintf(FP, "\tC23: %s\n", fname_C23);
-        fp_C23 = fopen(fname_C23, "r");
+        modfile_open(&fp_C23, fname_C23);
 
-        bool readable_1 = fp_C11 != NULL && fp_C22 != NULL && fp_C33 != NULL;
-        bool readable_2 = fp_C44 != NULL && fp_C55 != NULL && fp_C66 != NULL;
-        bool readable_3 = fp_C12 != NULL && fp_C13 != NULL && fp_C23 != NULL;
+        bool readable_1 = fp_C11.plane != NULL && fp_C22.plane != NULL && fp_C33.plane != NULL;
+        bool readable_2 = fp_C44.plane != NULL && fp_C55.plane != NULL && fp_C66.plane != NULL;
+        bool readable_3 = fp_C12.plane != NULL && fp_C13.plane != NULL && fp_C23.plane != NULL;
 
-        bool noreadable_1 = fp_C11 == NULL && fp_C22 == NULL && fp_C33 == NULL;
-        bool noreadable_2 = fp_C44 == NULL && fp_C55 == NULL && fp_C66 == NULL;
-        bool noreadable_3 = fp_C12 == NULL && fp_C13 == NULL && fp_C23 == NULL;
+        bool noreadable_1 = fp_C11.plane == NULL && fp_C22.plane == NULL && fp_C33.plane == NULL;
+        bool noreadable_2 = fp_C44.plane == NULL && fp_C55.plane == NULL && fp_C66.plane == NULL;
+        bool noreadable_3 = fp_C12.plane == NULL && fp_C13.plane == NULL && fp_C23.plane == NULL;
 
         if (readable_1 && readable_2 && readable_3) {
             flag_cij_files_avail = true;
@@ -223,15 +223,15 @@ void readmod(float ***rho, float ***pi, float ***u,
             fprintf(FP, "All Cij models are not readable\n\n");
         } else {
             fprintf(FP, "Some Cij models are readable and some are not\n");
-            if (fp_C11 == NULL) err("Could not open model file for C11!");
-            if (fp_C22 == NULL) err("Could not open model file for C22!");
-            if (fp_C33 == NULL) err("Could not open model file for C33!");
-            if (fp_C44 == NULL) err("Could not open model file for C44!");
-            if (fp_C55 == NULL) err("Could not open model file for C55!");
-            if (fp_C66 == NULL) err("Could not open model file for C66!");
-            if (fp_C12 == NULL) err("Could not open model file for C12!");
-            if (fp_C13 == NULL) err("Could not open model file for C13!");
-            if (fp_C23 == NULL) err("Could not open model file for C23!");
+            if (fp_C11.plane == NULL) err("Could not open model file for C11!");
+            if (fp_C22.plane == NULL) err("Could not open model file for C22!");
+            if (fp_C33.plane == NULL) err("Could not open model file for C33!");
+            if (fp_C44.plane == NULL) err("Could not open model file for C44!");
+            if (fp_C55.plane == NULL) err("Could not open model file for C55!");
+            if (fp_C66.plane == NULL) err("Could not open model file for C66!");
+            if (fp_C12.plane == NULL) err("Could not open model file for C12!");
+            if (fp_C13.plane == NULL) err("Could not open model file for C13!");
+            if (fp_C23.plane == NULL) err("Could not open model file for C23!");
         }
     }
 
@@ -245,51 +245,79 @@ void readmod(float ***rho, float ***pi, float ***u,
         float delxy = 0.0f;
         float gamx = 0.0f;
         float gamy = 0.0f;
-        /* loop over global grid */
-        for (k = 1; k <= NZG; k++) {
-            for (i = 1; i <= NXG; i++) {
-                for (j = 1; j <= NYG; j++) {
-                    Rho = readdsk(fp_rho, format);
+        /* loop over the local grid, one plane of each file at a time */
+        nzmax = modfile_planes();
+        for (kk = 1; kk <= nzmax; kk++) {
+            modfile_read(&fp_rho);
+            if (flag_velocity_files_avail) {
+                modfile_read(&fp_vp);
+                modfile_read(&fp_vs);
+            }
+            if (flag_cij_files_avail) {
+                modfile_read(&fp_C11);
+                modfile_read(&fp_C22);
+                modfile_read(&fp_C33);
+                modfile_read(&fp_C44);
+                modfile_read(&fp_C55);
+                modfile_read(&fp_C66);
+                modfile_read(&fp_C12);
+                modfile_read(&fp_C13);
+                modfile_read(&fp_C23);
+            } else {
+                /* files which could not be opened are skipped */
+                modfile_read(&fp_epsx);
+                modfile_read(&fp_epsy);
+                modfile_read(&fp_delx);
+                modfile_read(&fp_dely);
+                modfile_read(&fp_delxy);
+                modfile_read(&fp_gamx);
+                modfile_read(&fp_gamy);
+            }
+            if (kk > NZ) continue;
+            for (ii = 1; ii <= NX; ii++) {
+                for (jj = 1; jj <= NY; jj++) {
+                    n = (ii - 1) * NY + jj - 1;
+                    Rho = fp_rho.plane[n];
 
                     if (flag_velocity_files_avail) {
-                        Vp = readdsk(fp_vp, format);
-                        Vs = readdsk(fp_vs, format);
+                        Vp = fp_vp.plane[n];
+                        Vs = fp_vs.plane[n];
 
                         muv = Vs * Vs * Rho;
                         piv = Vp * Vp * Rho;
                     }
 
                     if (flag_cij_files_avail) {
-                        C_11 = readdsk(fp_C11, format);
-                        C_22 = readdsk(fp_C22, format);
-                        C_33 = readdsk(fp_C33, format);
-                        C_44 = readdsk(fp_C44, format);
-                        C_55 = readdsk(fp_C55, format);
-                        C_66 = readdsk(fp_C66, format);
-                        C_12 = readdsk(fp_C12, format);
-                        C_13 = readdsk(fp_C13, format);
-                        C_23 = readdsk(fp_C23, format);
+                        C_11 = fp_C11.plane[n];
+                        C_22 = fp_C22.plane[n];
+                        C_33 = fp_C33.plane[n];
+                        C_44 = fp_C44.plane[n];
+                        C_55 = fp_C55.plane[n];
+                        C_66 = fp_C66.plane[n];
+                        C_12 = fp_C12.plane[n];
+                        C_13 = fp_C13.plane[n];
+                        C_23 = fp_C23.plane[n];
                     } else {
-                        if (fp_epsx != NULL) {
-                            epsx = readdsk(fp_epsx, format);
+                        if (fp_epsx.plane != NULL) {
+                            epsx = fp_epsx.plane[n];
                         }
-                        if (fp_epsy != NULL) {
-                            epsy = readdsk(fp_epsy, format);
+                        if (fp_epsy.plane != NULL) {
+                            epsy = fp_epsy.plane[n];
                         }
-                        if (fp_delx != NULL) {
-                            delx = readdsk(fp_delx, format);
+                        if (fp_delx.plane != NULL) {
+                            delx = fp_delx.plane[n];
                         }
-                        if (fp_dely != NULL) {
-                            dely = readdsk(fp_dely, format);
+                        if (fp_dely.plane != NULL) {
+                            dely = fp_dely.plane[n];
                         }
-                        if (fp_delxy != NULL) {
-                            delxy = readdsk(fp_delxy, format);
+                        if (fp_delxy.plane != NULL) {
+                            delxy = fp_delxy.plane[n];
                         }
-                        if (fp_gamx != NULL) {
-                            gamx = readdsk(fp_gamx, format);
+                        if (fp_gamx.plane != NULL) {
+                            gamx = fp_gamx.plane[n];
                         }
-                        if (fp_gamy != NULL) {
-                            gamy = readdsk(fp_gamy, format);
+                        if (fp_gamy.plane != NULL) {
+                            gamy = fp_gamy.plane[n];
                         }
                         // clang-format off
                         C_33 = Rho * Vp * Vp;
@@ -307,40 +335,30 @@ void readmod(float ***rho, float ***pi, float ***u,
                         // clang-format on
                     }
 
-                    /* only the PE which belongs to the current global gridpoint
-						is saving model parameters in his local arrays */
-                    if ((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ))) {
-                        ii = i - POS[1] * NX;
-                        jj = j - POS[2] * NY;
-                        kk = k - POS[3] * NZ;
-
-                        rho[jj][ii][kk] = Rho;
+                    rho[jj][ii][kk] = Rho;
 
-                        if (flag_velocity_files_avail) {
-                            u[jj][ii][kk] = muv;
-                            pi[jj][ii][kk] = piv;
-                        }
+                    if (flag_velocity_files_avail) {
+                        u[jj][ii][kk] = muv;
+                        pi[jj][ii][kk] = piv;
+                    }
 
 
-                        C11[jj][ii][kk] = C_11;
-                        C33[jj][ii][kk] = C_22;
-                        C22[jj][ii][kk] = C_33;
+                    C11[jj][ii][kk] = C_11;
+                    C33[jj][ii][kk] = C_22;
+                    C22[jj][ii][kk] = C_33;
 
-                        C44[jj][ii][kk] = C_44;
-                        C66[jj][ii][kk] = C_55;
-                        C55[jj][ii][kk] = C_66;
+                    C44[jj][ii][kk] = C_44;
+                    C66[jj][ii][kk] = C_55;
+                    C55[jj][ii][kk] = C_66;
 
-                        C13[jj][ii][kk] = C_12;
-                        C12[jj][ii][kk] = C_13;
-                        C23[jj][ii][kk] = C_23;
+                    C13[jj][ii][kk] = C_12;
+                    C12[jj][ii][kk] = C_13;
+                    C23[jj][ii][kk] = C_23;
 
 
-                        if (WRITE_MODELFILES) {
-                            pwavemod[jj][ii][kk] = Vp;
-                            swavemod[jj][ii][kk] = Vs;
-                        }
+                    if (WRITE_MODELFILES) {
+                        pwavemod[jj][ii][kk] = Vp;
+                        swavemod[jj][ii][kk] = Vs;
                     }
                 }
             }
@@ -355,13 +373,13 @@ void readmod(float ***rho, float ***pi, float ***u,
         if (TAU == 0.0) {
             fprintf(FP, "\t Qp:\n\t %s.qp\n\n", MFILE);
             sprintf(filename, "%s.qp", MFILE);
-            fp_qp = fopen(filename, "r");
-            if (fp_qp == NULL) err(" Could not open model file for Qp-values ! ");
+            modfile_open(&fp_qp, filename);
+            if (fp_qp.plane == NULL) err(" Could not open model file for Qp-values ! ");
 
             fprintf(FP, "\t Qs:\n\t %s.qs\n\n", MFILE);
             sprintf(filename, "%s.qs", MFILE);
-            fp_qs = fopen(filename, "r");
-            if (fp_qs == NULL) err(" Could not open model file for Qs-values ! ");
+            modfile_open(&fp_qs, filename);
+            if (fp_qs.plane == NULL) err(" Could not open model file for Qs-values ! ");
         }
 
         /* vector for maxwellbodies */
@@ -378,18 +396,26 @@ void readmod(float ***rho, float ***pi, float ***u,
         else
             ws = 2.0 * PI * FREF;
 
-        /* loop over global grid */
-        for (k = 1; k <= NZG; k++) {
-            for (i = 1; i <= NXG; i++) {
-                for (j = 1; j <= NYG; j++) {
-                    Vp = readdsk(fp_vp, format);
-                    Vs = readdsk(fp_vs, format);
-                    Rho = readdsk(fp_rho, format);
+        /* loop over the local grid, one plane of each file at a time */
+        nzmax = modfile_planes();
+        for (kk = 1; kk <= nzmax; kk++) {
+            modfile_read(&fp_vp);
+            modfile_read(&fp_vs);
+            modfile_read(&fp_rho);
+            modfile_read(&fp_qp);
+            modfile_read(&fp_qs);
+            if (kk > NZ) continue;
+            for (ii = 1; ii <= NX; ii++) {
+                for (jj = 1; jj <= NY; jj++) {
+                    n = (ii - 1) * NY + jj - 1;
+                    Vp = fp_vp.plane[n];
+                    Vs = fp_vs.plane[n];
+                    Rho = fp_rho.plane[n];
 
                     /*calculation of taus and taup by read-in q-files*/
                     if (TAU == 0.0) {
-                        Qp = readdsk(fp_qp, format);
-                        Qs = readdsk(fp_qs, format);
+                        Qp = fp_qp.plane[n];
+                        Qs = fp_qs.plane[n];
                     } else {
                         /*constant q (damping) case:*/
                         Qp = 2.0 / TAU;
@@ -406,28 +432,18 @@ void readmod(float ***rho, float ***pi, float ***u,
                     muv = Vs * Vs * Rho / (1.0 + sumu);
                     piv = Vp * Vp * Rho / (1.0 + sumpi);
 
-                    /* only the PE which belongs to the current global gridpoint
-						is saving model parameters in his local arrays */
-                    if ((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ))) {
-                        ii = i - POS[1] * NX;
-                        jj = j - POS[2] * NY;
-                        kk = k - POS[3] * NZ;
+                    u[jj][ii][kk] = muv;
+                    rho[jj][ii][kk] = Rho;
+                    pi[jj][ii][kk] = piv;
 
-                        u[jj][ii][kk] = muv;
-                        rho[jj][ii][kk] = Rho;
-                        pi[jj][ii][kk] = piv;
+                    taus[jj][ii][kk] = 2.0 / Qs;
+                    taup[jj][ii][kk] = 2.0 / Qp;
 
-                        taus[jj][ii][kk] = 2.0 / Qs;
-                        taup[jj][ii][kk] = 2.0 / Qp;
-
-                        if (WRITE_MODELFILES) {
-                            pwavemod[jj][ii][kk] = Vp;
-                            swavemod[jj][ii][kk] = Vs;
-                            qsmod[jj][ii][kk] = 2 / taus[jj][ii][kk];
-                            qpmod[jj][ii][kk] = 2 / taup[jj][ii][kk];
-                        }
+                    if (WRITE_MODELFILES) {
+                        pwavemod[jj][ii][kk] = Vp;
+                        swavemod[jj][ii][kk] = Vs;
+                        qsmod[jj][ii][kk] = 2 / taus[jj][ii][kk];
+                        qpmod[jj][ii][kk] = 2 / taup[jj][ii][kk];
                     }
                 }
             }
@@ -435,13 +451,27 @@ void readmod(float ***rho, float ***pi, float ***u,
     }
 
 
-    fclose(fp_vp);
-    fclose(fp_vs);
-    fclose(fp_rho);
-    if ((L) && (TAU == 0.0)) {
-        fclose(fp_qp);
-        fclose(fp_qs);
-    }
+    modfile_close(&fp_vp);
+    modfile_close(&fp_vs);
+    modfile_close(&fp_rho);
+    modfile_close(&fp_qp);
+    modfile_close(&fp_qs);
+    modfile_close(&fp_epsx);
+    modfile_close(&fp_epsy);
+    modfile_close(&fp_delx);
+    modfile_close(&fp_dely);
+    modfile_close(&fp_delxy);
+    modfile_close(&fp_gamx);
+    modfile_close(&fp_gamy);
+    modfile_close(&fp_C11);
+    modfile_close(&fp_C22);
+    modfile_close(&fp_C33);
+    modfile_close(&fp_C44);
+    modfile_close(&fp_C55);
+    modfile_close(&fp_C66);
+    modfile_close(&fp_C12);
+    modfile_close(&fp_C13);
+    modfile_close(&fp_C23);
 
     /* each PE writes his model to disk */
 
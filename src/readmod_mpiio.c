@@ -0,0 +1,120 @@
+/*------------------------------------------------------------------------
+ *   Parallel input of binary model files with MPI-IO.
+ *
+ *   A model file holds one float per grid point of the global grid in
+ *   native byte order, with y running fastest, then x, then z (the layout
+ *   of writemod/mergemod). Each PE sets a file view with a subarray
+ *   datatype selecting its sub grid, so that a collective read returns
+ *   only the points of the PE; reading plane by plane keeps the buffer
+ *   small. The sub grids may differ in size (DECOMP=1), so every PE calls
+ *   the collective read modfile_planes() times, the largest NZ of the PEs;
+ *   after its last plane a PE reads nothing.
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+
+
+/*
+ * Open a model file on all PEs and set the view to the local sub grid.
+ *
+ * Parameters
+ * ----------
+ * f :
+ *     Model file, `f->fh` is MPI_FILE_NULL if the file is not opened.
+ * filename :
+ *     Name of the file.
+ *
+ * Returns
+ * -------
+ * 1 if the file could be opened on all PEs, 0 otherwise. Terminates
+ * if the file is smaller than the global grid.
+ */
+int modfile_open(ModelFile *f, const char *filename)
+{
+    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4];
+    extern int OFFX[], OFFY[], OFFZ[];
+
+    int gsizes[3] = {NZG, NXG, NYG};
+    int lsizes[3] = {NZ, NX, NY};
+    int starts[3] = {OFFZ[POS[3]], OFFX[POS[1]], OFFY[POS[2]]};
+    int ok, allok;
+    MPI_Datatype block;
+    MPI_Offset size;
+
+    f->fh = MPI_FILE_NULL;
+    f->plane = NULL;
+    f->nread = 0;
+
+    ok = (MPI_File_open(MPI_COMM_WORLD, (char *) filename, MPI_MODE_RDONLY,
+                MPI_INFO_NULL, &f->fh) == MPI_SUCCESS);
+    MPI_Allreduce(&ok, &allok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!allok) {
+        if (ok) MPI_File_close(&f->fh);
+        f->fh = MPI_FILE_NULL;
+        return 0;
+    }
+
+    MPI_File_get_size(f->fh, &size);
+    if (size < (MPI_Offset) NXG * NYG * NZG * (MPI_Offset) sizeof(float))
+        err("Model file %s is smaller than the grid (%d x %d x %d floats)!",
+            filename, NXG, NYG, NZG);
+
+    MPI_Type_create_subarray(3, gsizes, lsizes, starts, MPI_ORDER_C,
+            MPI_FLOAT, &block);
+    MPI_Type_commit(&block);
+    MPI_File_set_view(f->fh, 0, MPI_FLOAT, block, "native", MPI_INFO_NULL);
+    MPI_Type_free(&block);
+
+    f->plane = vector(0, NX * NY - 1);
+    return 1;
+}
+
+
+/*
+ * Number of collective reads of each file, the largest number of planes
+ * (in z) of the sub grids.
+ */
+int modfile_planes(void)
+{
+    extern int NZ;
+
+    int nz = NZ, nzmax;
+
+    MPI_Allreduce(&nz, &nzmax, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    return nzmax;
+}
+
+
+/*
+ * Read the next plane (in z) of the local sub grid into `f->plane`.
+ * Collective; nothing is done if the file is not open. After the last
+ * plane of the sub grid nothing is read, see modfile_planes().
+ */
+void modfile_read(ModelFile *f)
+{
+    extern int NX, NY, NZ;
+
+    MPI_Status status;
+    int count, n;
+
+    if (f->fh == MPI_FILE_NULL) return;
+
+    n = (f->nread++ < NZ) ? NX * NY : 0;
+    MPI_File_read_all(f->fh, f->plane, n, MPI_FLOAT, &status);
+    MPI_Get_count(&status, MPI_FLOAT, &count);
+    if (count != n)
+        err("[%s] Could not read an amplitude from a model file\n", __func__);
+}
+
+
+void modfile_close(ModelFile *f)
+{
+    extern int NX, NY;
+
+    if (f->fh == MPI_FILE_NULL) return;
+
+    MPI_File_close(&f->fh);
+    free_vector(f->plane, 0, NX * NY - 1);
+    f->fh = MPI_FILE_NULL;
+    f->plane = NULL;
+}
@@ -44,6 +44,10 @@ static inline float myfsign(float x){ if (x>0.0) return 1; else if (x<0.0) retur
 	char * e2av(char * inout, int len);
 	float * float2native(float * indata, int len, int lbendian, int ieeeibm, int meterfeet);
 	float * native2float(float * outdata, int len, int lbendian, int ieeeibm, int meterfeet);
+	/* vectorized kernels from segy_conv.c, converting the leading part of a vector */
+	size_t ieee2ibm_simd(int * v, size_t n);
+	size_t ibm2ieee_simd(int * v, size_t n);
+	size_t swap4_simd(int * v, size_t n);
 	/* const int a2etab[128]; */	
 	
 	extern FILE * FP;
@@ -1355,7 +1359,8 @@ int * swap4(int * ip) { /* swap bytes of any 4-bytes pointer */
 
 float * swap4fv(float * fp, int len){/* swap bytes of a vector of 4-bytes floats */
 	int n;
-	for (n=0;n<len;n++) swap4((int *)&fp[n]);
+	n=(len>0) ? (int)swap4_simd((int *)fp,(size_t)len) : 0;
+	for (;n<len;n++) swap4((int *)&fp[n]);
 	return (float *)fp;
 }
 
@@ -1363,8 +1368,7 @@ float * swap4fv(float * fp, int len){/* swap bytes of a vector of 4-bytes floats
 /* converting any 4-byte floats to native 4-byte floats and vice versa (meter (SI system) = native) */
 
 float * float2native(float * indata, int len, int lbendian, int ieeeibm, int meterfeet){
-	int n;
-	if (lbendian!=LITTLEBIG) for (n=0;n<len;n++) swap4((int *) &indata[n]);
+	if (lbendian!=LITTLEBIG) swap4fv(indata, len);
 	if ((!ieeeibm)&&IEEEIBM) ieee2ibmv((int*) indata, len);
 	else if ((ieeeibm)&&(!IEEEIBM)) ibm2ieeev((int*) indata, len);
 	if (meterfeet) m2ft(indata, len);
@@ -1372,11 +1376,10 @@ float * float2native(float * indata, int len, int lbendian, int ieeeibm, int met
 }
 
 float * native2float(float * outdata, int len, int lbendian, int ieeeibm, int meterfeet){
-	int n;
 	if (meterfeet) ft2m(outdata, len);
 	if ((!ieeeibm)&&IEEEIBM) ibm2ieeev((int*) outdata, len);
 	else if ((ieeeibm)&&(!IEEEIBM)) ieee2ibmv((int*) outdata, len);
-	if (lbendian!=LITTLEBIG) for (n=0;n<len;n++) swap4((int *) &outdata[n]);
+	if (lbendian!=LITTLEBIG) swap4fv(outdata, len);
 	return outdata;
 }
 
@@ -1391,7 +1394,8 @@ int * ieee2ibmv(int * ieee, int n) /* converting a vector of ieee floats into ib
 		fprintf(curerr,"Error [ieee2ibm]: sizeof(int)!=4. \n");	return NULL;}
 	if (sizeof(float)!=4) {
 		fprintf(curerr,"Error [ieee2ibm]: sizeof(float)!=4. \n"); return NULL;}			
-	for (i=0;i<n;++i) {
+	i=(n>0) ? (int)ieee2ibm_simd(ieee,(size_t)n) : 0;
+	for (;i<n;++i) {
 		h=ieee[i];
 		if (h) {
 	    		m=(0x007fffff&h)|0x00800000;
@@ -1414,6 +1418,9 @@ int * ibm2ieeev(int * ibm, int n) /* converting a vector of ibm floats into ieee
 	if (sizeof(float)!=4) {
 		fprintf(curerr,"Error [ibm2ieee]: sizeof(float)!=4. \n"); return NULL;}		
 	for (i=0;i<n;++i) {
+		/* the vectorized kernel stops before values it would warn about */
+		i+=(int)ibm2ieee_simd(&ibm[i],(size_t)(n-i));
+		if (i>=n) break;
 		h=ibm[i];		
 	if (h) {
 		m=0x00ffffff&h;
@@ -1,195 +1,370 @@
 /*----------------------------------------------------------------------
  *  saves checkpoint file for a later continuation of a simulation
  *
+ *  The data of a PE consist of a header (CheckpointHeader), which records
+ *  the grid, the decomposition, the numerical parameters and the counters
+ *  of the time loop, followed by the fields of the state (Checkpoint), one
+ *  contiguous slab per field:
+ *
+ *    sxx, syy, szz, sxz, vx, vy, vz, sxy, syz   including the halos
+ *    dv_2, ds_dv_2 ... dv_4, ds_dv_4            FDORDER_TIME > 2
+ *    rxx ... rxz, r_2, r_3, r_4                 L > 0
+ *    psi (18 arrays)                            ABS_TYPE = 1
+ *    seismogram sections of the PE              SEISMO > 0
+ *
+ *  The header holds a checksum of the data. With CHECKPT_MPIIO=0 each PE
+ *  writes the file CHECKPT_FILE.<n>, with CHECKPT_MPIIO=1 all PEs write
+ *  their data in the order of n into the file CHECKPT_FILE, where
+ *  n = POS[1] + NPROCX*(POS[2] + NPROCY*POS[3]) is the position of the PE
+ *  in the decomposition. MPI_Cart_create may assign the positions to
+ *  other ranks in a restarted run, so the ranks are not used.
+ *  A checkpoint is written into a temporary file which replaces the
+ *  previous checkpoint only when it is complete.
+ *
+ *  Periodic checkpoints (CHECKPT_INC) of files per PE are written by a
+ *  thread while the time stepping continues: the state is copied into a
+ *  buffer and the thread writes it. The thread does not call MPI.
  ---------------------------------------------------------------------- */
+
+#include <pthread.h>
+
 #include "data_structures.h"
 #include "fd.h"
 #include "globvar.h"
 
-void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
-        Velocity *v, Tensor3d *s, Tensor3d *r,
-        float *** psi_sxx_x, float *** psi_sxy_x, float *** psi_sxz_x, float *** psi_sxy_y,
-        float *** psi_syy_y, float *** psi_syz_y, float *** psi_sxz_z, float *** psi_syz_z, float *** psi_szz_z,
-        float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
-        float *** psi_vxz, float *** psi_vyz, float *** psi_vzz) {
-
-	int i,j, k;
-	char myid[5];
-	FILE *fp;
-	char checkptfile[STRING_SIZE];
-	extern int MYID;
-	extern int ABS_TYPE, NX,NY,NZ,FW,POS[4],NPROCX,NPROCY,NPROCZ,FREE_SURF;
-	extern int L;
-	extern char  CHECKPTFILE[STRING_SIZE];
-
-        float ***vx = v->x;
-        float ***vy = v->y;
-        float ***vz = v->z;
-
-        float ***sxx = s->xx;
-        float ***syy = s->yy;
-        float ***szz = s->zz;
-        float ***sxy = s->xy;
-        float ***syz = s->yz;
-        float ***sxz = s->xz;
-
-        float ***rxx = r->xx;
-        float ***ryy = r->yy;
-        float ***rzz = r->zz;
-        float ***rxy = r->xy;
-        float ***ryz = r->yz;
-        float ***rxz = r->xz;
-
-	sprintf(checkptfile,"%s",CHECKPTFILE);
-	sprintf(myid,".%d",MYID);
-	strcat(checkptfile,myid);
-
-
-
-	fp=fopen(checkptfile,"wb");
-	if (fp==NULL) {
-		err("CHECKPTFILE can't be opened !");
-	}
-
-
-	for (j=ny1; j<=ny2; j++) {
-		for (i=nx1; i<=nx2; i++) {
-			for (k=nz1; k<=nz2; k++) {
-				fwrite(&vx[j][i][k],sizeof(float),1,fp);
-				fwrite(&vy[j][i][k],sizeof(float),1,fp);
-				fwrite(&vz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxx[j][i][k],sizeof(float),1,fp);
-				fwrite(&syy[j][i][k],sizeof(float),1,fp);
-				fwrite(&szz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxy[j][i][k],sizeof(float),1,fp);
-				fwrite(&syz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxz[j][i][k],sizeof(float),1,fp);
-			}
-		}
-	}
-
-	if (L) {
-		for (j=1; j<=NY; j++) {
-			for (i=1; i<=NX; i++) {
-				for (k=1; k<=NZ; k++) {
-					fwrite(&rxx[j][i][k],sizeof(float),1,fp);
-					fwrite(&ryy[j][i][k],sizeof(float),1,fp);
-					fwrite(&rzz[j][i][k],sizeof(float),1,fp);
-					fwrite(&rxy[j][i][k],sizeof(float),1,fp);
-					fwrite(&ryz[j][i][k],sizeof(float),1,fp);
-					fwrite(&rxz[j][i][k],sizeof(float),1,fp);
-				}
-			}
-		}
-	}
-
-	if (ABS_TYPE == 1) {
-
-		if (POS[1]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxx_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxy_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxz_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzx[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-		if (POS[1]==NPROCX-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=FW+1; i<=2*FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxx_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxy_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxz_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzx[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-		if (POS[2]==0 && FREE_SURF==0) {
-			for (j=1; j<=FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzy[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-		if (POS[2]==NPROCY-1) {
-			for (j=FW+1; j<=2*FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzy[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-		if (POS[3]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=FW; k++) {
-						fwrite(&psi_sxz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_szz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzz[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-		if (POS[3]==NPROCZ-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=FW+1; k<=2*FW; k++) {
-						fwrite(&psi_sxz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_szz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzz[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-	}
-
-	fclose(fp);
 
+/* checkpoint written by the thread */
+static struct {
+    pthread_t thread;
+    int pending, ok;
+    char file[STRING_SIZE];
+    CheckpointHeader h;
+    float *buf;
+} job = {.pending = 0};
+
+
+/*
+ * Fields of the state of a simulation in the order in which they are
+ * saved.
+ *
+ * Returns
+ * -------
+ * Number of fields.
+ */
+int checkpoint_fields(const Checkpoint *c, CheckpointField *f)
+{
+    extern int NX, NY, NZ, POS[4], FDORDER, FDORDER_TIME, L, ABS_TYPE, FW;
+
+    float ***w[3 + 2 + 10 * 3];
+    int n, nw = 0, nf = 0;
+    int h = ((ABS_TYPE == 1) && (FDORDER == 2)) ? FDORDER : FDORDER / 2;
+    /* first row of the arrays, one more row at the free surface */
+    int j1 = (POS[2] == 0) ? -FDORDER / 2 : 1 - h;
+
+#define FIELD(A, J1, J2, I1, I2, K1, K2) do { \
+        f[nf].a = (A); f[nf].m = NULL; \
+        f[nf].j1 = (J1); f[nf].j2 = (J2); f[nf].i1 = (I1); f[nf].i2 = (I2); \
+        f[nf].k1 = (K1); f[nf].k2 = (K2); nf++; } while (0)
+
+    /* wavefield including the halos exchanged between the PEs */
+    FIELD(c->s->xx, 1 - h, NY + h, 1 - h, NX + h, 1 - h, NZ + h);
+    FIELD(c->s->yy, 1 - h, NY + h, 1 - h, NX + h, 1 - h, NZ + h);
+    FIELD(c->s->zz, 1 - h, NY + h, 1 - h, NX + h, 1 - h, NZ + h);
+    FIELD(c->s->xz, 1 - h, NY + h, 1 - h, NX + h, 1 - h, NZ + h);
+    w[nw++] = c->v->x; w[nw++] = c->v->y; w[nw++] = c->v->z;
+    w[nw++] = c->s->xy; w[nw++] = c->s->yz;
+
+    /* history of the Adams-Bashforth method */
+    if (FDORDER_TIME > 2) {
+        const VelocityDerivativesTensor *dv[3] = {c->dv_2, c->dv_3, c->dv_4};
+        const StressDerivativesWrtVelocity *ds[3] = {c->ds_dv_2, c->ds_dv_3,
+            c->ds_dv_4};
+        for (n = 0; n < FDORDER_TIME - 1; n++) {
+            w[nw++] = dv[n]->xyyx; w[nw++] = dv[n]->yzzy;
+            w[nw++] = dv[n]->xzzx; w[nw++] = dv[n]->xxyyzz;
+            w[nw++] = dv[n]->yyzz; w[nw++] = dv[n]->xxzz;
+            w[nw++] = dv[n]->xxyy;
+            w[nw++] = ds[n]->x; w[nw++] = ds[n]->y; w[nw++] = ds[n]->z;
+        }
+    }
+    for (n = 0; n < nw; n++)
+        FIELD(w[n], j1, NY + h, 1 - h, NX + h, 1 - h, NZ + h);
+
+    /* memory variables of the viscoelastic model */
+    if (L) {
+        const Tensor3d *r[4] = {c->r, c->r_2, c->r_3, c->r_4};
+        int nr = (FDORDER_TIME > 2) ? FDORDER_TIME : 1;
+        for (n = 0; n < nr; n++) {
+            FIELD(r[n]->xx, 1, NY, 1, NX, 1, NZ);
+            FIELD(r[n]->yy, 1, NY, 1, NX, 1, NZ);
+            FIELD(r[n]->zz, 1, NY, 1, NX, 1, NZ);
+            FIELD(r[n]->xy, 1, NY, 1, NX, 1, NZ);
+            FIELD(r[n]->yz, 1, NY, 1, NX, 1, NZ);
+            FIELD(r[n]->xz, 1, NY, 1, NX, 1, NZ);
+        }
+    }
+
+    /* memory variables of the CPML */
+    if (ABS_TYPE == 1) {
+        for (n = 0; n < 6; n++) FIELD(c->psi[n], 1, NY, 1, 2 * FW, 1, NZ);
+        for (n = 6; n < 12; n++) FIELD(c->psi[n], 1, 2 * FW, 1, NX, 1, NZ);
+        for (n = 12; n < 18; n++) FIELD(c->psi[n], 1, NY, 1, NX, 1, 2 * FW);
+    }
+
+#undef FIELD
+
+    /* seismograms recorded so far */
+    if (c->ntr > 0)
+        for (n = 0; n < 6; n++)
+            if (c->section[n]) {
+                f[nf].a = NULL;
+                f[nf].m = c->section[n];
+                f[nf].j1 = f[nf].j2 = 0;
+                f[nf].i1 = 1; f[nf].i2 = c->ntr;
+                f[nf].k1 = 1; f[nf].k2 = c->ns;
+                nf++;
+            }
+
+    return nf;
+}
+
+
+/*
+ * Header of the state `c` of this PE, without checksum.
+ */
+void checkpoint_header(const Checkpoint *c, CheckpointHeader *h)
+{
+    extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ;
+    extern int FDORDER, FDORDER_TIME, L, ABS_TYPE, FW, FREE_SURF;
+
+    CheckpointField f[CHECKPOINT_FIELDS_MAX];
+    int n, nf = checkpoint_fields(c, f);
+
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, "ASOFI3D", 8);
+    h->version = CHECKPOINT_VERSION;
+    h->nt = c->nt;
+    h->ishot = c->ishot;
+    h->lsnap = c->lsnap;
+    h->nsnap = c->nsnap;
+    h->lsamp = c->lsamp;
+    h->nlsamp = c->nlsamp;
+    h->nx = NX;
+    h->ny = NY;
+    h->nz = NZ;
+    h->pos[0] = POS[1];
+    h->pos[1] = POS[2];
+    h->pos[2] = POS[3];
+    h->nprocx = NPROCX;
+    h->nprocy = NPROCY;
+    h->nprocz = NPROCZ;
+    h->fdorder = FDORDER;
+    h->fdorder_time = FDORDER_TIME;
+    h->nrelax = L;
+    h->abs_type = ABS_TYPE;
+    h->fw = FW;
+    h->free_surf = FREE_SURF;
+    h->ntr = c->ntr;
+    h->ns = c->ns;
+
+    h->nfloat = 0;
+    for (n = 0; n < nf; n++)
+        h->nfloat += (int64_t) (f[n].j2 - f[n].j1 + 1)
+            * (f[n].i2 - f[n].i1 + 1) * (f[n].k2 - f[n].k1 + 1);
+}
+
+
+/*
+ * Fletcher checksum of the bit patterns of buf[0..n-1].
+ */
+uint64_t checkpoint_checksum(const float *buf, size_t n)
+{
+    uint64_t a = 0, b = 0;
+    uint32_t w;
+    size_t m;
+
+    for (m = 0; m < n; m++) {
+        memcpy(&w, &buf[m], sizeof(w));
+        a = (a + w) % 0xffffffffu;
+        b = (b + a) % 0xffffffffu;
+    }
+    return (b << 32) | a;
+}
+
+
+/*
+ * Copy the fields into the buffer (store=1) or the buffer into the fields
+ * (store=0), one k-line at a time.
+ */
+void checkpoint_copy(const CheckpointField *f, int nf, float *buf, int store)
+{
+    int n, i, j, nk;
+    float *line;
+    size_t m = 0;
+
+    for (n = 0; n < nf; n++) {
+        nk = f[n].k2 - f[n].k1 + 1;
+        for (j = f[n].j1; j <= f[n].j2; j++)
+            for (i = f[n].i1; i <= f[n].i2; i++) {
+                line = (f[n].a) ? &f[n].a[j][i][f[n].k1] : &f[n].m[i][f[n].k1];
+                if (store) memcpy(&buf[m], line, (size_t) nk * sizeof(float));
+                else memcpy(line, &buf[m], (size_t) nk * sizeof(float));
+                m += (size_t) nk;
+            }
+    }
 }
 
 
+/*
+ * Number of the position of this PE in the decomposition, which does not
+ * depend on the placement of the PEs by MPI_Cart_create.
+ */
+int checkpoint_rank(void)
+{
+    extern int POS[4], NPROCX, NPROCY;
 
+    return POS[1] + NPROCX * (POS[2] + NPROCY * POS[3]);
+}
 
 
+/*
+ * Offset of the data of this PE in a checkpoint file written with MPI-IO,
+ * the sum of the sizes of the data of the PEs with lower checkpoint_rank().
+ */
+MPI_Offset checkpoint_offset(size_t size)
+{
+    MPI_Comm comm;
+    long long s = (long long) size, off = 0;
+    int rank = checkpoint_rank();
+
+    MPI_Comm_split(MPI_COMM_WORLD, 0, rank, &comm);
+    MPI_Exscan(&s, &off, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Comm_free(&comm);
+    if (rank == 0) off = 0;
+    return (MPI_Offset) off;
+}
 
 
+/*
+ * Write header and data into a temporary file and rename it to `file`.
+ * Returns 1 on success, 0 otherwise. Does not call MPI.
+ */
+static int write_file(const char *file, const CheckpointHeader *h,
+        const float *buf)
+{
+    char tmp[STRING_SIZE + 8];
+    FILE *fp;
+    int ok;
+
+    sprintf(tmp, "%s.tmp", file);
+    fp = fopen(tmp, "wb");
+    if (fp == NULL) return 0;
+    ok = (fwrite(h, sizeof(*h), 1, fp) == 1) &&
+        (fwrite(buf, sizeof(float), (size_t) h->nfloat, fp)
+         == (size_t) h->nfloat);
+    if (fclose(fp) != 0) ok = 0;
+    if (ok && rename(tmp, file)) ok = 0;
+    return ok;
+}
 
 
+static void *write_thread(void *arg)
+{
+    (void) arg;
 
+    job.ok = write_file(job.file, &job.h, job.buf);
+    free(job.buf);
+    job.buf = NULL;
+    return NULL;
+}
 
 
+/*
+ * Wait until a checkpoint written by the thread is complete.
+ */
+void checkpoint_wait(void)
+{
+    if (!job.pending) return;
 
+    pthread_join(job.thread, NULL);
+    job.pending = 0;
+    if (!job.ok) err("Could not write checkpoint file %s", job.file);
+}
 
 
+/*
+ * Save the state of the simulation.
+ *
+ * Parameters
+ * ----------
+ * c :
+ *     State of the simulation after time step `c->nt`.
+ * async :
+ *     Write the files of the PEs (CHECKPT_MPIIO=0) on a thread while the
+ *     time stepping continues; the checkpoint is complete after the next
+ *     call of checkpoint_wait() or save_checkpoint().
+ */
+void save_checkpoint(const Checkpoint *c, int async)
+{
+    extern int MYID, CHECKPT_MPIIO;
+    extern char CHECKPTFILE[STRING_SIZE];
+
+    CheckpointField f[CHECKPOINT_FIELDS_MAX];
+    CheckpointHeader h;
+    char file[STRING_SIZE + 8];
+    float *buf;
+    int nf;
+
+    /* the buffer of the previous checkpoint is in use until it is written */
+    checkpoint_wait();
+
+    nf = checkpoint_fields(c, f);
+    checkpoint_header(c, &h);
+    buf = (float *) malloc((size_t) h.nfloat * sizeof(float) + 1);
+    if (!buf) err("allocation failure in function save_checkpoint() ");
+    checkpoint_copy(f, nf, buf, 1);
+    h.checksum = checkpoint_checksum(buf, (size_t) h.nfloat);
+
+    if (!CHECKPT_MPIIO) {
+        sprintf(file, "%s.%d", CHECKPTFILE, checkpoint_rank());
+        if (async) {
+            strcpy(job.file, file);
+            job.h = h;
+            job.buf = buf;
+            if (pthread_create(&job.thread, NULL, write_thread, NULL) != 0)
+                err("Could not start the thread writing the checkpoint");
+            job.pending = 1;
+            return;
+        }
+        if (!write_file(file, &h, buf))
+            err("Could not write checkpoint file %s", file);
+        free(buf);
+        return;
+    }
+
+    /* one file, the data of the PEs in the order of checkpoint_rank() */
+    MPI_File fh;
+    MPI_Offset off;
+    size_t m, nchunk;
+
+    off = checkpoint_offset(sizeof(h) + (size_t) h.nfloat * sizeof(float));
+    sprintf(file, "%s.tmp", CHECKPTFILE);
+    if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        err("Could not open checkpoint file %s", file);
+    MPI_File_set_size(fh, 0);
+    MPI_File_write_at(fh, off, &h, (int) sizeof(h), MPI_BYTE,
+            MPI_STATUS_IGNORE);
+    off += (MPI_Offset) sizeof(h);
+    for (m = 0; m < (size_t) h.nfloat; m += nchunk) {
+        nchunk = (size_t) h.nfloat - m;
+        if (nchunk > (1u << 28)) nchunk = 1u << 28;
+        MPI_File_write_at(fh, off + (MPI_Offset) (m * sizeof(float)),
+                &buf[m], (int) nchunk, MPI_FLOAT, MPI_STATUS_IGNORE);
+    }
+    MPI_File_close(&fh);
+    if ((MYID == 0) && rename(file, CHECKPTFILE))
+        err("Could not rename checkpoint file %s", file);
+    MPI_Barrier(MPI_COMM_WORLD);
+    free(buf);
+}
@@ -0,0 +1,286 @@
+/*------------------------------------------------------------------------
+ *   Vectorized conversion of 4-byte floats for SEG-Y/SU output and input:
+ *   IEEE to IBM floats, IBM to IEEE floats and byte swapping.
+ *
+ *   The kernels convert the leading part of a vector with SSE2 (4 values
+ *   per vector) or AVX2 (8 values) and return the number of values
+ *   converted; ieee2ibmv(), ibm2ieeev() and swap4fv() in rwsegy.c convert
+ *   the rest with the scalar code. The results are bit-identical to the
+ *   scalar code for all 2^32 inputs, including its treatment of zeros,
+ *   denormals, infinities and NaNs (checked by segy_conv_bench -check,
+ *   see tests/test_18.sh):
+ *
+ *   ieee2ibm: The IEEE exponent e (bias 127, fraction 1.f) gives the
+ *   exponent d=e-126 of the fraction 0.1f. d is rounded up to a multiple
+ *   of 4 by shifting the 24-bit fraction right by s=(126-e)&3 bits, the
+ *   IBM exponent is d/4+64 (excess 64, base 16).
+ *
+ *   ibm2ieee: The 24-bit IBM fraction m is converted to a float, which is
+ *   exact, and so normalized by the hardware: the float holds the IEEE
+ *   fraction bits and its exponent the number of leading zeros of m.
+ *   Values whose fraction is zero are left to the scalar code, which warns
+ *   about them.
+ *
+ *   The instruction set is chosen at run time; SIMD=0 (see enum.h) selects
+ *   the scalar code.
+ *  ----------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <string.h>
+#include "enum.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/* instruction sets of the kernels */
+enum { CONV_SCALAR, CONV_SSE2, CONV_AVX2 };
+
+
+#ifdef HAVE_X86_SIMD
+
+/* one vector of IEEE floats to IBM floats, integer operations only */
+#define IEEE2IBM(W, PFX, vi) \
+    do { \
+        vi h, e, s, m, d, r, one = PFX##_set1_epi32(1), two = PFX##_set1_epi32(2); \
+        h = PFX##_loadu_si##W((const vi *) &v[i]); \
+        e = PFX##_and_si##W(PFX##_srli_epi32(h, 23), PFX##_set1_epi32(0xff)); \
+        s = PFX##_and_si##W(PFX##_sub_epi32(PFX##_set1_epi32(126), e), \
+                PFX##_set1_epi32(3)); \
+        m = PFX##_or_si##W(PFX##_and_si##W(h, PFX##_set1_epi32(0x007fffff)), \
+                PFX##_set1_epi32(0x00800000)); \
+        r = PFX##_cmpeq_epi32(PFX##_and_si##W(s, one), one); \
+        m = PFX##_or_si##W(PFX##_andnot_si##W(r, m), \
+                PFX##_and_si##W(r, PFX##_srli_epi32(m, 1))); \
+        r = PFX##_cmpeq_epi32(PFX##_and_si##W(s, two), two); \
+        m = PFX##_or_si##W(PFX##_andnot_si##W(r, m), \
+                PFX##_and_si##W(r, PFX##_srli_epi32(m, 2))); \
+        d = PFX##_srai_epi32(PFX##_add_epi32(PFX##_sub_epi32(e, \
+                        PFX##_set1_epi32(126)), s), 2); \
+        d = PFX##_slli_epi32(PFX##_add_epi32(d, PFX##_set1_epi32(64)), 24); \
+        r = PFX##_or_si##W(PFX##_or_si##W(PFX##_and_si##W(h, \
+                        PFX##_set1_epi32((int) 0x80000000)), d), m); \
+        /* zero (+0.0) stays zero */ \
+        r = PFX##_andnot_si##W(PFX##_cmpeq_epi32(h, PFX##_setzero_si##W()), r); \
+        PFX##_storeu_si##W((vi *) &v[i], r); \
+    } while (0)
+
+/* one vector of IBM floats to IEEE floats; stops (break) at a vector with
+   a non-zero value of zero fraction */
+#define IBM2IEEE(W, PFX, vi, MOVEMASK) \
+    { \
+        vi h, m, f, d, r, z, big, small; \
+        h = PFX##_loadu_si##W((const vi *) &v[i]); \
+        m = PFX##_and_si##W(h, PFX##_set1_epi32(0x00ffffff)); \
+        z = PFX##_cmpeq_epi32(h, PFX##_setzero_si##W()); \
+        if (MOVEMASK(PFX##_andnot_si##W(z, PFX##_cmpeq_epi32(m, \
+                                PFX##_setzero_si##W())))) break; \
+        f = PFX##_castps_si##W(PFX##_cvtepi32_ps(m)); \
+        /* d = 4*E-130 - (150 - exponent of m as float) */ \
+        d = PFX##_sub_epi32(PFX##_add_epi32(PFX##_slli_epi32( \
+                        PFX##_and_si##W(PFX##_srli_epi32(h, 24), \
+                            PFX##_set1_epi32(0x7f)), 2), \
+                    PFX##_srli_epi32(f, 23)), PFX##_set1_epi32(280)); \
+        big = PFX##_cmpgt_epi32(d, PFX##_set1_epi32(254)); \
+        small = PFX##_or_si##W(z, PFX##_cmpgt_epi32(PFX##_set1_epi32(1), d)); \
+        r = PFX##_or_si##W(PFX##_slli_epi32(d, 23), \
+                PFX##_and_si##W(f, PFX##_set1_epi32(0x007fffff))); \
+        r = PFX##_or_si##W(PFX##_andnot_si##W(big, r), \
+                PFX##_and_si##W(big, PFX##_set1_epi32(0x7f7fffff))); \
+        r = PFX##_or_si##W(r, PFX##_and_si##W(h, PFX##_set1_epi32((int) 0x80000000))); \
+        r = PFX##_andnot_si##W(small, r); \
+        PFX##_storeu_si##W((vi *) &v[i], r); \
+    }
+
+
+static size_t ieee2ibm_sse2(int *v, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) IEEE2IBM(128, _mm, __m128i);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t ieee2ibm_avx2(int *v, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) IEEE2IBM(256, _mm256, __m256i);
+    return i;
+}
+
+static size_t ibm2ieee_sse2(int *v, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) IBM2IEEE(128, _mm, __m128i, _mm_movemask_epi8)
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t ibm2ieee_avx2(int *v, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) IBM2IEEE(256, _mm256, __m256i, _mm256_movemask_epi8)
+    return i;
+}
+
+static size_t swap4_sse2(int *v, size_t n)
+{
+    const __m128i lo = _mm_set1_epi32(0x00ff00ff);
+    __m128i h;
+    size_t i;
+
+    /* swap the bytes of each 16-bit half, then the halves */
+    for (i = 0; i + 4 <= n; i += 4) {
+        h = _mm_loadu_si128((const __m128i *) &v[i]);
+        h = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(h, 8), lo),
+                _mm_slli_epi16(_mm_and_si128(h, lo), 8));
+        h = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, 0xb1), 0xb1);
+        _mm_storeu_si128((__m128i *) &v[i], h);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t swap4_avx2(int *v, size_t n)
+{
+    const __m256i rev = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+            15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm256_storeu_si256((__m256i *) &v[i], _mm256_shuffle_epi8(
+                    _mm256_loadu_si256((const __m256i *) &v[i]), rev));
+    return i;
+}
+
+#endif
+
+
+/* instruction set chosen by segy_conv_select(), -1 for automatic */
+static int selected = -1;
+
+
+/*
+ * Instruction set of the kernels: the scalar code for SIMD=0, AVX2 if the
+ * CPU supports it, otherwise SSE2 (part of x86-64).
+ */
+static int conv_level(void)
+{
+    extern int SIMD;
+    static int cpu = -1;
+
+    if (selected >= 0) return selected;
+    if (SIMD == SIMD_NONE) return CONV_SCALAR;
+    if (cpu < 0) {
+        cpu = CONV_SCALAR;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        cpu = (__builtin_cpu_supports("avx2")) ? CONV_AVX2 : CONV_SSE2;
+#endif
+    }
+    return cpu;
+}
+
+
+/*
+ * Select the instruction set of the kernels (segy_conv_bench).
+ *
+ * Parameters
+ * ----------
+ * isa :
+ *     "scalar", "sse2" or "avx2", NULL for the automatic choice.
+ *
+ * Returns
+ * -------
+ * 1 on success, 0 if the instruction set is not supported by the CPU.
+ */
+int segy_conv_select(const char *isa)
+{
+    selected = -1;
+    if (isa == NULL) return 1;
+    if (!strcmp(isa, "scalar")) {
+        selected = CONV_SCALAR;
+        return 1;
+    }
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (!strcmp(isa, "sse2")) selected = CONV_SSE2;
+    if (!strcmp(isa, "avx2") && __builtin_cpu_supports("avx2")) selected = CONV_AVX2;
+#endif
+    return (selected >= 0);
+}
+
+
+/* name of the instruction set of the kernels, for log output */
+const char *segy_conv_isa(void)
+{
+    const char *name[3] = {"scalar", "SSE2", "AVX2"};
+
+    return name[conv_level()];
+}
+
+
+/*
+ * Convert IEEE floats (as int bit patterns) to IBM floats in place.
+ *
+ * Returns
+ * -------
+ * Number of leading values converted, the rest is left to the scalar code.
+ */
+size_t ieee2ibm_simd(int *v, size_t n)
+{
+#ifdef HAVE_X86_SIMD
+    switch (conv_level()) {
+    case CONV_AVX2: return ieee2ibm_avx2(v, n);
+    case CONV_SSE2: return ieee2ibm_sse2(v, n);
+    }
+#endif
+    (void) v; (void) n;
+    return 0;
+}
+
+
+/*
+ * Convert IBM floats to IEEE floats in place.
+ *
+ * Returns
+ * -------
+ * Number of leading values converted. The conversion stops before the
+ * vector holding the first non-zero value with a zero fraction.
+ */
+size_t ibm2ieee_simd(int *v, size_t n)
+{
+#ifdef HAVE_X86_SIMD
+    switch (conv_level()) {
+    case CONV_AVX2: return ibm2ieee_avx2(v, n);
+    case CONV_SSE2: return ibm2ieee_sse2(v, n);
+    }
+#endif
+    (void) v; (void) n;
+    return 0;
+}
+
+
+/*
+ * Reverse the byte order of 4-byte values in place.
+ *
+ * Returns
+ * -------
+ * Number of leading values swapped.
+ */
+size_t swap4_simd(int *v, size_t n)
+{
+#ifdef HAVE_X86_SIMD
+    switch (conv_level()) {
+    case CONV_AVX2: return swap4_avx2(v, n);
+    case CONV_SSE2: return swap4_sse2(v, n);
+    }
+#endif
+    (void) v; (void) n;
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*------------------------------------------------------------------------
+ *   Check and benchmark of the float conversions for SEG-Y/SU files
+ *   (rwsegy.c, segy_conv.c).
+ *
+ *   segy_conv_bench -check
+ *       compares the vectorized conversions (SSE2 and, if supported by
+ *       the CPU, AVX2) with the scalar code for all 2^32 bit patterns:
+ *       IEEE to IBM, IBM to IEEE, byte swapping and native2float() and
+ *       float2native() for IBM floats in big endian (SEIS_FORMAT=5).
+ *       Short vectors at all offsets check the remainders. The exit status
+ *       is 1 if any result differs.
+ *
+ *   segy_conv_bench [-mb MB]
+ *       reports the throughput in GB/s (bytes converted per second) of
+ *       each conversion for each instruction set on a buffer of MB
+ *       megabytes (default 64) of seismogram-like samples.
+ *  ----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+
+/* global variables used by rwsegy.c and segy_conv.c */
+FILE *FP = NULL;
+int LITTLEBIG = 0, ASCIIEBCDIC = 0, IEEEIBM = 0, MYID = 0, SIMD = 1;
+
+/* declaration of extern functions from rwsegy.c and segy_conv.c */
+extern float *swap4fv(float *fp, int len);
+extern int *ieee2ibmv(int *ieee, int n);
+extern int *ibm2ieeev(int *ibm, int n);
+extern float *float2native(float *indata, int len, int lbendian, int ieeeibm, int meterfeet);
+extern float *native2float(float *outdata, int len, int lbendian, int ieeeibm, int meterfeet);
+extern int segy_conv_select(const char *isa);
+extern const char *segy_conv_isa(void);
+
+
+#define NCHUNK (1 << 20)
+#define NOPS 5
+
+static const char *isa_name[3] = {"scalar", "sse2", "avx2"};
+static const char *op_name[NOPS] = {"swap4fv", "ieee2ibmv", "ibm2ieeev",
+    "native2float (IBM/BE)", "float2native (IBM/BE)"};
+
+
+/* apply conversion op to v[0..n-1] */
+static void convert(int op, unsigned int *v, int n)
+{
+    switch (op) {
+    case 0: swap4fv((float *) v, n); break;
+    case 1: ieee2ibmv((int *) v, n); break;
+    case 2: ibm2ieeev((int *) v, n); break;
+    case 3: native2float((float *) v, n, !LITTLEBIG, 1, 0); break;
+    case 4: float2native((float *) v, n, !LITTLEBIG, 1, 0); break;
+    }
+}
+
+
+/* compare op with instruction set isa on v[0..n-1] with the result ref of
+   the scalar code, tst is a work array; returns the number of differences */
+static long compare(int op, const char *isa, const unsigned int *v,
+        const unsigned int *ref, unsigned int *tst, int n)
+{
+    long ndiff = 0;
+    int i;
+
+    memcpy(tst, v, (size_t) n * sizeof(int));
+    segy_conv_select(isa);
+    convert(op, tst, n);
+    for (i = 0; i < n; i++)
+        if (ref[i] != tst[i]) {
+            if (ndiff < 5)
+                printf("  %s %s: 0x%08x gives 0x%08x instead of 0x%08x\n",
+                        op_name[op], isa, v[i], tst[i], ref[i]);
+            ndiff++;
+        }
+    return ndiff;
+}
+
+
+/* scalar result of op on v[0..n-1] */
+static void reference(int op, const unsigned int *v, unsigned int *ref, int n)
+{
+    memcpy(ref, v, (size_t) n * sizeof(int));
+    segy_conv_select("scalar");
+    convert(op, ref, n);
+}
+
+
+static int check(void)
+{
+    unsigned int *v, *ref, *tst;
+    unsigned long long k;
+    long ndiff[3];
+    int has[3], nfail = 0, isa, op, i, n, off;
+
+    v = malloc(NCHUNK * sizeof(int));
+    ref = malloc(NCHUNK * sizeof(int));
+    tst = malloc(NCHUNK * sizeof(int));
+    if (!v || !ref || !tst) {
+        fprintf(stderr, "allocation failure\n");
+        return 1;
+    }
+    for (isa = 1; isa < 3; isa++) {
+        has[isa] = segy_conv_select(isa_name[isa]);
+        if (!has[isa]) printf("%s is not supported by this CPU\n", isa_name[isa]);
+    }
+
+    for (op = 0; op < NOPS; op++) {
+        ndiff[1] = ndiff[2] = 0;
+        /* all bit patterns */
+        for (k = 0; k < (1ULL << 32); k += NCHUNK) {
+            for (i = 0; i < NCHUNK; i++) v[i] = (unsigned int) (k + i);
+            reference(op, v, ref, NCHUNK);
+            for (isa = 1; isa < 3; isa++)
+                if (has[isa]) ndiff[isa] += compare(op, isa_name[isa], v, ref, tst, NCHUNK);
+        }
+        /* remainders of the vector loops at all offsets */
+        srand(1);
+        for (n = 0; n < 40; n++)
+            for (off = 0; off < 8; off++) {
+                for (i = 0; i < n + off; i++)
+                    v[i] = ((unsigned int) rand() << 16) ^ (unsigned int) rand();
+                reference(op, v + off, ref, n);
+                for (isa = 1; isa < 3; isa++)
+                    if (has[isa]) ndiff[isa] += compare(op, isa_name[isa], v + off, ref, tst, n);
+            }
+        for (isa = 1; isa < 3; isa++) {
+            if (!has[isa]) continue;
+            printf("%-4s %-22s %s (%ld differences)\n", isa_name[isa],
+                    op_name[op], (ndiff[isa]) ? "FAILED" : "ok", ndiff[isa]);
+            if (ndiff[isa]) nfail++;
+        }
+        fflush(stdout);
+    }
+
+    free(tst);
+    free(ref);
+    free(v);
+    segy_conv_select(NULL);
+    return (nfail > 0);
+}
+
+
+static double seconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1.0e-9 * t.tv_nsec;
+}
+
+
+static int bench(double mb)
+{
+    unsigned int *v, *w;
+    double t, t0, gbs[3][NOPS];
+    int isa, op, i, n, nrep;
+
+    n = (int) (mb * 1048576.0 / sizeof(int));
+    v = malloc((size_t) n * sizeof(int));
+    w = malloc((size_t) n * sizeof(int));
+    if (!v || !w) {
+        fprintf(stderr, "allocation failure\n");
+        return 1;
+    }
+    /* a decaying wavelet as in seismograms */
+    for (i = 0; i < n; i++) {
+        float f = (float) (exp(-1.0e-4 * (i % 10000)) * sin(0.01 * i));
+        memcpy(&v[i], &f, sizeof(float));
+    }
+
+    for (isa = 0; isa < 3; isa++) {
+        for (op = 0; op < NOPS; op++) gbs[isa][op] = 0.0;
+        if (!segy_conv_select(isa_name[isa])) continue;
+        for (op = 0; op < NOPS; op++) {
+            memcpy(w, v, (size_t) n * sizeof(int));
+            /* IBM floats as input of ibm2ieeev */
+            if (op == 2) ieee2ibmv((int *) w, n);
+            for (nrep = 0, t = 0.0; (nrep < 3) || (t < 0.5); nrep++) {
+                t0 = seconds();
+                convert(op, w, n);
+                t += seconds() - t0;
+                /* back to the input of op, not timed */
+                if (op == 1) ibm2ieeev((int *) w, n);
+                if (op == 2) ieee2ibmv((int *) w, n);
+                if (op == 3) float2native((float *) w, n, !LITTLEBIG, 1, 0);
+                if (op == 4) native2float((float *) w, n, !LITTLEBIG, 1, 0);
+            }
+            gbs[isa][op] = (double) nrep * n * sizeof(int) / t / 1.0e9;
+        }
+    }
+
+    printf("GB/s for %.0f MB (%s is used by default)\n", mb, segy_conv_isa());
+    printf("%-24s %10s %10s %10s\n", "", "scalar", "sse2", "avx2");
+    for (op = 0; op < NOPS; op++) {
+        printf("%-24s", op_name[op]);
+        for (isa = 0; isa < 3; isa++)
+            if (gbs[isa][op] > 0.0) printf(" %10.2f", gbs[isa][op]);
+            else printf(" %10s", "-");
+        printf("\n");
+    }
+    segy_conv_select(NULL);
+
+    free(w);
+    free(v);
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    double mb = 64.0;
+    int i;
+
+    FP = stdout;
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-check")) {
+            /* ibm2ieeev() warns about IBM floats with zero fraction */
+            FP = tmpfile();
+            return check();
+        } else if (!strcmp(argv[i], "-mb") && (i + 1 < argc)) {
+            mb = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-check] [-mb MB]\n", argv[0]);
+            return 2;
+        }
+    }
+    return bench(mb);
+}
@@ -0,0 +1,193 @@
+/*------------------------------------------------------------------------
+ *   Parallel output of merged seismograms (SEIS_MPIIO=1).
+ *
+ *   All traces of an SU, SEG-Y or binary file have the same size, so the
+ *   position of a trace in the file follows from its global receiver
+ *   number. Instead of collecting the traces on PE 0 (catseis) each PE
+ *   formats the traces it has recorded, including the trace headers and
+ *   the conversion to IBM floats or big endian, and writes them
+ *   collectively with MPI-IO; an indexed datatype places the traces of a
+ *   PE. PE 0 writes the file headers of SEG-Y files. The files are the same
+ *   as written by saveseis_glob().
+ *  ----------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L /* open_memstream */
+
+#include "fd.h"
+
+
+/*
+ * Format traces into a buffer with outseis_glob_header() (n=0) or
+ * outseis_glob_traces().
+ */
+static char *seis_mpiio_format(float **section, int **recpos, int *traces,
+        int n, int ntr_glob, float **srcpos, int ishot, int ns,
+        int seis_form[6], int comp, size_t *size)
+{
+    extern FILE *FP;
+
+    FILE *fpmem;
+    char *buf = NULL;
+    int k;
+
+    fpmem = open_memstream(&buf, size);
+    if (fpmem == NULL) err("allocation failure in function seis_mpiio_format() ");
+    if (n == 0)
+        outseis_glob_header(fpmem, ntr_glob, ns, seis_form);
+    /* outseis_glob_traces() takes the single trace from row 1 */
+    for (k = 1; k <= n; k++)
+        outseis_glob_traces(FP, fpmem, section + k - 1, recpos, recpos,
+                traces[k], traces[k], ntr_glob, srcpos, 1, ns, seis_form,
+                ishot, comp);
+    if (fclose(fpmem) != 0) err("allocation failure in function seis_mpiio_format() ");
+
+    return buf;
+}
+
+
+/*
+ * Open a seismogram file for all PEs (collective) and write the file
+ * headers.
+ *
+ * Parameters
+ * ----------
+ * file :
+ *     Name of the file, an existing file is truncated.
+ * ntr_glob :
+ *     Number of traces of the file.
+ * hdr :
+ *     Returns the size of the file headers in bytes.
+ */
+MPI_File seis_mpiio_open(char *file, int ntr_glob, int ns, int seis_form[6],
+        MPI_Offset *hdr)
+{
+    extern int MYID;
+
+    MPI_File fh;
+    char *buf;
+    size_t size = 0;
+    long long nbytes;
+
+    if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        err("Could not open seismogram file %s", file);
+    MPI_File_set_size(fh, 0);
+
+    if (MYID == 0) {
+        buf = seis_mpiio_format(NULL, NULL, NULL, 0, ntr_glob, NULL, 0, ns,
+                seis_form, 0, &size);
+        if (size > 0)
+            MPI_File_write_at(fh, 0, buf, (int) size, MPI_BYTE, MPI_STATUS_IGNORE);
+        free(buf);
+    }
+    nbytes = (long long) size;
+    MPI_Bcast(&nbytes, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    *hdr = (MPI_Offset) nbytes;
+
+    return fh;
+}
+
+
+/*
+ * Write the traces of this PE (collective).
+ *
+ * Parameters
+ * ----------
+ * fh, hdr :
+ *     File and size of its headers from seis_mpiio_open().
+ * section :
+ *     Traces of this PE, section[1..n][1..ns]; zeros are set to +0.0.
+ * traces :
+ *     traces[k] is the global number (1..ntr_glob) of section[k],
+ *     ascending.
+ * n :
+ *     Number of traces of this PE.
+ * comp :
+ *     Component written to the trace headers, see outseis_glob().
+ */
+void seis_mpiio_traces(MPI_File fh, MPI_Offset hdr, float **section,
+        int **recpos, int *traces, int n, int ntr_glob, float **srcpos,
+        int ishot, int ns, int seis_form[6], int comp)
+{
+    MPI_Datatype trace, filetype;
+    char *buf = NULL;
+    size_t size = 0;
+    int j, k, *displ = NULL;
+
+    if (n > 0) {
+        /* as catseis(), the IBM conversion of -0.0 is not zero */
+        for (k = 1; k <= n; k++)
+            for (j = 1; j <= ns; j++) section[k][j] += 0.0f;
+        buf = seis_mpiio_format(section, recpos, traces, n, ntr_glob, srcpos,
+                ishot, ns, seis_form, comp, &size);
+        if (size % n)
+            err("seis_mpiio_traces: traces of format %d differ in size", seis_form[0]);
+        displ = ivector(1, n);
+        for (k = 1; k <= n; k++) displ[k] = traces[k] - 1;
+        MPI_Type_contiguous((int) (size / n), MPI_BYTE, &trace);
+        MPI_Type_create_indexed_block(n, 1, &displ[1], trace, &filetype);
+    } else {
+        MPI_Type_contiguous(1, MPI_BYTE, &trace);
+        MPI_Type_dup(trace, &filetype);
+    }
+    MPI_Type_commit(&trace);
+    MPI_Type_commit(&filetype);
+
+    MPI_File_set_view(fh, hdr, MPI_BYTE, filetype, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, buf, n, trace, MPI_STATUS_IGNORE);
+
+    MPI_Type_free(&filetype);
+    MPI_Type_free(&trace);
+    if (n > 0) free_ivector(displ, 1, n);
+    free(buf);
+}
+
+
+/*
+ * Write the merged seismograms of all components (collective), the
+ * parallel counterpart of catseis() and saveseis_glob().
+ *
+ * Parameters
+ * ----------
+ * section :
+ *     Sections of this PE (vx, vy, vz, p, div, curl), [1..ntr][1..ns];
+ *     NULL for components which are not recorded.
+ * recswitch :
+ *     recswitch[i] is 1 if global trace i is recorded by this PE.
+ */
+void saveseis_mpiio(FILE *fp, float **section[6], int **recpos, int *recswitch,
+        int ntr, int ntr_glob, float **srcpos, int ishot, int ns)
+{
+    extern int MYID, SEIS_FORMAT[6];
+
+    const char *comp_name[6] = {"vx", "vy", "vz", "p", "div", "curl"};
+    const int comp[6] = {1, 2, 3, 0, 0, 0};
+    char file[STRING_SIZE];
+    MPI_File fh;
+    MPI_Offset hdr;
+    int c, i, k, present, allpresent, *traces;
+
+    traces = ivector(1, ntr_glob);
+    for (i = 1, k = 0; i <= ntr_glob; i++)
+        if (recswitch[i]) traces[++k] = i;
+    if (k != ntr) err("saveseis_mpiio: %d instead of %d local receivers", k, ntr);
+
+    for (c = 0; c < 6; c++) {
+        /* the components are the same on all PEs with receivers */
+        present = (section[c] != NULL);
+        MPI_Allreduce(&present, &allpresent, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        if (!allpresent) continue;
+
+        seis_glob_file(file, ishot, c + 1);
+        if (MYID == 0)
+            fprintf(fp, "\n All PEs are writing %d seismogram traces (%s) to  %s",
+                    ntr_glob, comp_name[c], file);
+
+        fh = seis_mpiio_open(file, ntr_glob, ns, SEIS_FORMAT, &hdr);
+        seis_mpiio_traces(fh, hdr, section[c], recpos, traces, (present) ? ntr : 0,
+                ntr_glob, srcpos, ishot, ns, SEIS_FORMAT, comp[c]);
+        MPI_File_close(&fh);
+    }
+
+    free_ivector(traces, 1, ntr_glob);
+}
@@ -0,0 +1,204 @@
+/*------------------------------------------------------------------------
+ *   Streaming output of seismograms (SEIS_BLOCK > 0).
+ *
+ *   The seismogram sections of a PE hold only SEIS_BLOCK samples per
+ *   trace. When a block is full, seis_stream_flush() writes it to a
+ *   temporary file of the PE and component, SEIS_FILE_<comp>.blk.<MYID>:
+ *   block b (b=1,2,...) starts at (b-1)*ntr*nb floats and holds the
+ *   samples of the ntr local traces one after the other. A block is
+ *   written at its position, so a run resumed from a checkpoint
+ *   overwrites the blocks written after the checkpoint.
+ *
+ *   After the time loop seis_stream_write() transposes the blocks into
+ *   the output files of catseis()/saveseis_glob(): the global traces are
+ *   processed in groups of about ntr_glob*nb/ns traces, each PE reads its
+ *   traces of a group from the temporary file, catseis() collects them on
+ *   PE 0 and PE 0 appends them to the output file. Seismograms therefore
+ *   need O(ntr * nb) memory instead of O(ntr * ns), and the output files
+ *   are the same as without streaming. With SEIS_MPIIO=1 the PEs write
+ *   their traces of a group themselves (seis_mpiio.c).
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+static const char *comp_name[6] = {"vx", "vy", "vz", "p", "div", "curl"};
+
+
+static void block_file(char *file, int c)
+{
+    extern int MYID;
+    extern char SEIS_FILE[STRING_SIZE];
+
+    sprintf(file, "%s_%s.blk.%d", SEIS_FILE, comp_name[c], MYID);
+}
+
+
+/*
+ * Write one block of the local seismogram sections.
+ *
+ * Parameters
+ * ----------
+ * section :
+ *     Sections of the PE (vx, vy, vz, p, div, curl), [1..ntr][1..nb];
+ *     NULL for components which are not recorded.
+ * ntr :
+ *     Number of local traces.
+ * nb :
+ *     Samples per block (SEIS_BLOCK).
+ * ncol :
+ *     Samples in this block, less than nb for the last block.
+ * iblock :
+ *     Number of the block, the files are truncated for iblock=1.
+ */
+void seis_stream_flush(float **section[6], int ntr, int nb, int ncol,
+        int iblock)
+{
+    char file[STRING_SIZE + 16];
+    FILE *fpblk;
+    int c, itr, ok;
+
+    for (c = 0; c < 6; c++) {
+        if (section[c] == NULL) continue;
+
+        block_file(file, c);
+        fpblk = fopen(file, (iblock == 1) ? "w" : "r+");
+        if (fpblk == NULL) err("Could not open seismogram block file %s", file);
+        ok = !fseek(fpblk, (long) (iblock - 1) * ntr * nb * (long) sizeof(float),
+                SEEK_SET);
+        if (ncol == nb)
+            ok = ok && (fwrite(&section[c][1][1], sizeof(float),
+                        (size_t) ntr * nb, fpblk) == (size_t) ntr * nb);
+        else
+            for (itr = 1; itr <= ntr; itr++)
+                ok = ok && (fwrite(&section[c][itr][1], sizeof(float),
+                            (size_t) ncol, fpblk) == (size_t) ncol);
+        if (fclose(fpblk) != 0) ok = 0;
+        if (!ok) err("Could not write seismogram block file %s", file);
+    }
+}
+
+
+/*
+ * Merge the blocks of all PEs into the seismogram files (collective).
+ *
+ * Parameters
+ * ----------
+ * section :
+ *     Sections of the PE, only used to tell the recorded components.
+ * recswitch :
+ *     recswitch[i] is 1 if global trace i is recorded by this PE.
+ * ntr, ntr_glob :
+ *     Number of local and global traces.
+ * ns :
+ *     Samples per trace.
+ * nb :
+ *     Samples per block.
+ * nrec :
+ *     Samples recorded by this PE, later samples are zero.
+ */
+void seis_stream_write(FILE *fp, float **section[6], int **recpos,
+        int *recswitch, int ntr, int ntr_glob, float **srcpos, int ishot,
+        int ns, int nb, int nrec)
+{
+    extern int MYID, SEIS_FORMAT[6], SEIS_MPIIO;
+
+    const int comp[6] = {1, 2, 3, 0, 0, 0};
+    char file[STRING_SIZE + 16];
+    FILE *fpblk = NULL, *fpout = NULL;
+    MPI_File fh = MPI_FILE_NULL;
+    MPI_Offset hdr = 0;
+    float **gdata, **gfull = NULL;
+    int *gswitch, *gtr, *loc;
+    int c, i, j, b, m, g1, g2, ng, ncol, nblk, present, allpresent;
+    long long ngroup;
+
+    /* traces per group, about as many samples as one block of all traces */
+    ngroup = (long long) ntr_glob * nb / ns;
+    if (ngroup < 1) ngroup = 1;
+    if (ngroup > ntr_glob) ngroup = ntr_glob;
+    ng = (int) ngroup;
+
+    /* local trace number of each global trace */
+    loc = ivector(1, ntr_glob);
+    for (i = 1, m = 0; i <= ntr_glob; i++) loc[i] = (recswitch[i]) ? ++m : 0;
+
+    gswitch = ivector(1, ng);
+    gtr = ivector(1, ng);
+    gdata = fmatrix(1, (ntr < ng) ? ((ntr > 0) ? ntr : 1) : ng, 1, ns);
+    if ((MYID == 0) && !SEIS_MPIIO) gfull = fmatrix(1, ng, 1, ns);
+    nblk = (nrec + nb - 1) / nb;
+
+    for (c = 0; c < 6; c++) {
+        /* the components are the same on all PEs with receivers */
+        present = (section[c] != NULL);
+        MPI_Allreduce(&present, &allpresent, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        if (!allpresent) continue;
+
+        if (present && (nblk > 0)) {
+            block_file(file, c);
+            fpblk = fopen(file, "rb");
+            if (fpblk == NULL) err("Could not open seismogram block file %s", file);
+        }
+        if (SEIS_MPIIO) {
+            seis_glob_file(file, ishot, c + 1);
+            if (MYID == 0)
+                fprintf(fp, "\n All PEs are writing %d seismogram traces (%s) to  %s",
+                        ntr_glob, comp_name[c], file);
+            fh = seis_mpiio_open(file, ntr_glob, ns, SEIS_FORMAT, &hdr);
+        } else if (MYID == 0) {
+            seis_glob_file(file, ishot, c + 1);
+            fprintf(fp, "\n PE 0 is writing %d merged seismogram traces (%s) to  %s",
+                    ntr_glob, comp_name[c], file);
+            fpout = fopen(file, "w");
+            if (fpout == NULL) err("Could not open seismogram file %s", file);
+            outseis_glob_header(fpout, ntr_glob, ns, SEIS_FORMAT);
+        }
+
+        for (g1 = 1; g1 <= ntr_glob; g1 += ng) {
+            g2 = (g1 + ng - 1 < ntr_glob) ? g1 + ng - 1 : ntr_glob;
+
+            /* local traces of the group, block by block */
+            for (i = g1, m = 0; i <= g2; i++) {
+                gswitch[i - g1 + 1] = recswitch[i];
+                if (!recswitch[i]) continue;
+                gtr[++m] = i;
+                for (b = 1; b <= nblk; b++) {
+                    ncol = (b < nblk) ? nb : nrec - (nblk - 1) * nb;
+                    if (fseek(fpblk, ((long) (b - 1) * ntr * nb
+                                    + (long) (loc[i] - 1) * ncol) * (long) sizeof(float),
+                                SEEK_SET) ||
+                            (fread(&gdata[m][(b - 1) * nb + 1], sizeof(float),
+                                   (size_t) ncol, fpblk) != (size_t) ncol))
+                        err("Could not read seismogram block file of %s", comp_name[c]);
+                }
+                for (j = nrec + 1; j <= ns; j++) gdata[m][j] = 0.0;
+            }
+
+            if (SEIS_MPIIO) {
+                seis_mpiio_traces(fh, hdr, gdata, recpos, gtr, m, ntr_glob,
+                        srcpos, ishot, ns, SEIS_FORMAT, comp[c]);
+                continue;
+            }
+            catseis(gdata, gfull, gswitch, g2 - g1 + 1, ns);
+            if (MYID == 0)
+                outseis_glob_traces(fp, fpout, gfull, recpos, recpos, g1, g2,
+                        ntr_glob, srcpos, 1, ns, SEIS_FORMAT, ishot, comp[c]);
+        }
+
+        if (SEIS_MPIIO) MPI_File_close(&fh);
+        else if (MYID == 0) fclose(fpout);
+        if (present && (nblk > 0)) {
+            fclose(fpblk);
+            block_file(file, c);
+            remove(file);
+        }
+    }
+
+    if (gfull) free_matrix(gfull, 1, ng, 1, ns);
+    free_matrix(gdata, 1, (ntr < ng) ? ((ntr > 0) ? ntr : 1) : ng, 1, ns);
+    free_ivector(gtr, 1, ng);
+    free_ivector(gswitch, 1, ng);
+    free_ivector(loc, 1, ntr_glob);
+}
@@ -1,6 +1,6 @@
 /*------------------------------------------------------------------------
  *   store amplitudes (particle velocities or pressure) at receiver positions
-     in arrays
+     in arrays, only receivers with ny1 <= y <= ny2 are stored
  *  ----------------------------------------------------------------------*/
 
 #include "data_structures.h"
@@ -24,7 +24,7 @@ void seismo_acoustic(int lsamp, int ntr, int **recpos,
         float **sectiondiv,
         float **sectioncurl ATTR_UNUSED,
         float **sectionp, 
-        Velocity *v, float ***sxx, float ***pi) {
+        Velocity *v, float ***sxx, float ***pi, int ny1, int ny2) {
 
 	extern int SEISMO;	
 	int  itr, ins, nxrec, nyrec, nzrec, i, j, k;
@@ -47,6 +47,7 @@ void seismo_acoustic(int lsamp, int ntr, int **recpos,
 		nxrec=recpos[1][itr];
 		nyrec=recpos[2][itr];
 		nzrec=recpos[3][itr];
+		if ((nyrec<ny1) || (nyrec>ny2)) continue;
 		switch (SEISMO){                          
 		case 1 : sectionvx[itr][ins]=vx[nyrec][nxrec][nzrec];
 			 sectionvy[itr][ins]=vy[nyrec][nxrec][nzrec];
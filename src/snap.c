@@ -8,39 +8,24 @@
 #include "globvar.h"
 
 
-void snap(FILE *fp, int nt, int nsnap, int format, int type, 
-        Velocity *v, Tensor3d *s,
-        float ***u, float ***pi,
-        int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2, 
-        int ny2, int nz2) {
+/* components of the snapshots and the extensions of their files */
+static const char *comp_name[6] = {"vx", "vy", "vz", "p", "div", "curl"};
 
-	/* 
-	different data formats of output available:
-	format=1  :  SU (IEEE)
-	format=2  :  ASCII
-	format=3  :  BINARY (IEEE)
-	
-	different types:
-	type=1 : values in vx, vy, and vz
-	type=2 : -(sxx+syy+szz) (pressure field)
-	type=3 : divergence of vx, vy and vz (energy of compressional waves)
-	         and curl of vx, vy and vz (energy of shear waves)
-	type=4 : both particle velocities (type=1) and energy (type=3)
-	*/
 
+/*
+ * Samples of component c (see comp_name) at the grid points
+ * [ny1..ny2:idy][nx1..nx2:idx][nz1..nz2:idz], in the order of snap_write().
+ */
+static void snap_fill(float *buf, int c, Velocity *v, Tensor3d *s,
+        float ***u, float ***pi,
+        int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2,
+        int ny2, int nz2) {
 
-	
-	char xfile[STRING_SIZE], yfile[STRING_SIZE], zfile[STRING_SIZE];
-	char rotfile[STRING_SIZE], ext[8], wm[2];
-	char  divfile[STRING_SIZE], pfile[STRING_SIZE];
-	FILE *fpx1, *fpy1, *fpz1, *fpx2, *fpy2, *fpp;
-	int i,j,k;
+	int i,j,k,m;
 	float a=0.0, amp, dh24x, dh24y, dh24z, vyx, vxy, vxx, vyy, vzx, vyz, vxz, vzy, vzz;
 
-
-	extern float DX, DY, DZ, DT;
-	extern char SNAP_FILE[STRING_SIZE];
-	extern int MYID, POS[4], SNAP_PLANE, LOG;
+	extern float DX, DY, DZ;
+	extern int SNAP_PLANE;
 
         float ***vx = v->x;
         float ***vy = v->y;
@@ -50,108 +35,71 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
         float ***syy = s->yy;
         float ***szz = s->zz;
 
-	switch(format){
-	case 1: 
-		sprintf(ext,".su");
-		break;
-	case 2: 
-		sprintf(ext,".asc");
-		break;
-	case 3: 
-		sprintf(ext,".bin");
+	switch(c){
+	case 0 :
+		snap_copy(buf,vx,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
 		break;
-	}
-
-
-	sprintf(xfile,"%s%s.vx.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(yfile,"%s%s.vy.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(zfile,"%s%s.vz.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(divfile,"%s%s.div.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(rotfile,"%s%s.curl.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(pfile,"%s%s.p.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-
-        if (LOG){
-	fprintf(fp,"\n\n PE %d is writing snapshot-data at T=%fs to \n",MYID,nt*DT);}
-
-
-	if (nsnap==1) 
-		sprintf(wm,"w");
-	else 
-		sprintf(wm,"a");
-
-	switch(type){
 	case 1 :
-		fprintf(fp,"\t%s\n", xfile);
-		fprintf(fp,"\t%s\n", yfile);
-		fprintf(fp,"\t%s\n\n", zfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
-			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-				
-			
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					
-					
-				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
+		snap_copy(buf,vy,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
 		break;
 	case 2 :
-		fprintf(fp,"\t%s\n\n", pfile);
-		fpp=fopen(pfile,wm);
+		snap_copy(buf,vz,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+		break;
+	case 3 :
+		m=0;
 		for (k=nz1;k<=nz2;k+=idz)
 			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-					amp=-sxx[j][i][k]-syy[j][i][k]-szz[j][i][k];
-					
-				
-					writedsk(fpp,amp,format);
-
-				}
-		fclose(fpp);
+				for (j=ny1;j<=ny2;j+=idy)
+					buf[m++]=-sxx[j][i][k]-syy[j][i][k]-szz[j][i][k];
 		break;
 	case 4 :
-		fprintf(fp,"\t%s\n", xfile);
-		fprintf(fp,"\t%s\n", yfile);
-		fprintf(fp,"\t%s\n\n", zfile);
-		fprintf(fp,"\t%s\n\n", pfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		fpp=fopen(pfile,wm);
+		dh24x=1.0/DX;
+		dh24y=1.0/DY;
+		dh24z=1.0/DZ;
+		
+		/* output of the divergence of the velocity field according to Dougherty and
+		                  Stephen (PAGEOPH, 1988) */
+		m=0;
 		for (k=nz1;k<=nz2;k+=idz)
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
-					amp=-sxx[j][i][k]-syy[j][i][k]-szz[j][i][k];
-
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					writedsk(fpp,amp,format);
+					vxx=(vx[j][i][k]-vx[j][i-1][k])*(dh24x);
+					vyy=(vy[j][i][k]-vy[j-1][i][k])*(dh24y);
+					vzz=(vz[j][i][k]-vz[j][i][k-1])*(dh24z);
+					
+					/*amp= div(v))*/
+					amp=(vxx+vyy+vzz);
+					
+					switch(SNAP_PLANE){
+					case 1 : /* energy without sign */
+						/* Ep with Ep=pi*amp*amp */
+						a=sqrt((pi[j][i][k])*amp*amp);
+						break;
+					case 2 : /* single force in x */
+						/*sign of div(v) * Ep with Ep=pi*amp*amp */
+						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
+						break;
+					case 3 : /* single force in y */
+						/*sign of div(v) * Ep with Ep=pi*amp*amp */
+						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
+						break;
+					case 4 : /* single force in z */
+						/*sign of div(v) * Ep with Ep=pi*amp*amp */
+						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
+						break;
+					}
 					
+					buf[m++]=a;
 				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
-		fclose(fpp);
-	case 3 :
+		break;
+	case 5 :
 		/* output of the curl of the velocity field according to Dougherty and
 		                  Stephen (PAGEOPH, 1988) */
-		fprintf(fp,"\t%s\n", divfile);
-		fprintf(fp,"\t%s\n\n", rotfile);
-		fpx2=fopen(divfile,wm);
-		fpy2=fopen(rotfile,wm);
-		
 		dh24x=1.0/DX;
 		dh24y=1.0/DY;
 		dh24z=1.0/DZ;
 		
+		m=0;
 		for (k=nz1;k<=nz2;k+=idz)
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
@@ -190,51 +138,95 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
 					
 					}
 					
-					writedsk(fpy2,a,format);
-					   
-
+					buf[m++]=a;
 				}
+		break;
+	}
+}
 
 
+void snap(FILE *fp, int nt, int nsnap, int format, int type, 
+        Velocity *v, Tensor3d *s,
+        float ***u, float ***pi,
+        int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2, 
+        int ny2, int nz2) {
 
-		/* output of the divergence of the velocity field according to Dougherty and
-		                  Stephen (PAGEOPH, 1988) */
-		for (k=nz1;k<=nz2;k+=idz)
-			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-					vxx=(vx[j][i][k]-vx[j][i-1][k])*(dh24x);
-					vyy=(vy[j][i][k]-vy[j-1][i][k])*(dh24y);
-					vzz=(vz[j][i][k]-vz[j][i][k-1])*(dh24z);
-					
-					/*amp= div(v))*/
-					amp=(vxx+vyy+vzz);
-					
-					switch(SNAP_PLANE){
-					case 1 : /* energy without sign */
-						/* Ep with Ep=pi*amp*amp */
-						a=sqrt((pi[j][i][k])*amp*amp);
-						break;
-					case 2 : /* single force in x */
-						/*sign of div(v) * Ep with Ep=pi*amp*amp */
-						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
-						break;
-					case 3 : /* single force in y */
-						/*sign of div(v) * Ep with Ep=pi*amp*amp */
-						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
-						break;
-					case 4 : /* single force in z */
-						/*sign of div(v) * Ep with Ep=pi*amp*amp */
-						a=fsign(amp)*sqrt((pi[j][i][k])*amp*amp);
-						break;
-					}
-					
-					writedsk(fpx2,a,format);
-				}
+	/* 
+	different data formats of output available:
+	format=1  :  SU (IEEE)
+	format=2  :  ASCII
+	format=3  :  BINARY (IEEE)
+	
+	different types:
+	type=1 : values in vx, vy, and vz
+	type=2 : -(sxx+syy+szz) (pressure field)
+	type=3 : divergence of vx, vy and vz (energy of compressional waves)
+	         and curl of vx, vy and vz (energy of shear waves)
+	type=4 : both particle velocities (type=1) and energy (type=3)
+	*/
 
-		fclose(fpx2);
-		fclose(fpy2);
+	/* components of the types in the order of output, see comp_name */
+	const int ncomp[5] = {0, 3, 1, 2, 6};
+	const int comps[5][6] = {{0}, {0, 1, 2}, {3}, {5, 4}, {0, 1, 2, 3, 5, 4}};
+
+	char pefile[STRING_SIZE], mfile[STRING_SIZE], ext[8];
+	int c,n,ip,np,nxs,nys,nzs,bx1,bx2,by1,by2,bz1,bz2;
+	float *buf;
+	double time0;
+
+
+	extern float DT;
+	extern char SNAP_FILE[STRING_SIZE];
+	extern int MYID, POS[4], LOG;
+
+	switch(format){
+	case 1: 
+		sprintf(ext,".su");
+		break;
+	case 2: 
+		sprintf(ext,".asc");
+		break;
+	case 3: 
+		sprintf(ext,".bin");
 		break;
 	}
-}
 
+        if (LOG){
+	fprintf(fp,"\n\n PE %d is writing snapshot-data at T=%fs to \n",MYID,nt*DT);}
 
+	time0=MPI_Wtime();
+
+	/* samples of this PE, see snap_write() */
+	nxs=(nx2-nx1)/idx+1;
+	nys=(ny2-ny1)/idy+1;
+	nzs=(nz2-nz1)/idz+1;
+	buf=vector(0,nxs*nys*nzs-1);
+
+	for (n=0;n<ncomp[type];n++){
+		c=comps[type][n];
+		/* files of this PE (merged by snapmerge) and merged files (SNAP_MPIIO=1) */
+		sprintf(pefile,"%s%s.%s.%i.%i.%i",SNAP_FILE,ext,comp_name[c],POS[1],POS[2],POS[3]);
+		sprintf(mfile,"%s%s.%s",SNAP_FILE,ext,comp_name[c]);
+
+		if (!snap_plan_n()){
+			snap_fill(buf,c,v,s,u,pi,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+			snap_write(fp,pefile,mfile,nsnap,format,buf,nxs,nys,nzs);
+			continue;
+		}
+
+		/* planes and boxes of SNAP_PLAN at full resolution, see snap_plan.c */
+		for (ip=0;ip<snap_plan_n();ip++){
+			np=snap_plan_box(ip,&bx1,&bx2,&by1,&by2,&bz1,&bz2);
+			if (np>nxs*nys*nzs){
+				free_vector(buf,0,nxs*nys*nzs-1);
+				nxs=np; nys=nzs=1;
+				buf=vector(0,np-1);
+			}
+			if (np>0) snap_fill(buf,c,v,s,u,pi,1,1,1,bx1,by1,bz1,bx2,by2,bz2);
+			snap_plan_write(fp,ip,mfile,nsnap,buf);
+		}
+	}
+
+	free_vector(buf,0,nxs*nys*nzs-1);
+	snap_async_exposed(MPI_Wtime()-time0);
+}
@@ -8,6 +8,43 @@
 #include "globvar.h"
 
 
+/* components of the snapshots, the extensions of the files of the PEs
+   and of the merged files */
+static const char *pe_name[4] = {"x", "z", "y", "p"};
+static const char *comp_name[4] = {"vx", "vy", "vz", "p"};
+
+
+/*
+ * Samples of component c (see comp_name) at the grid points
+ * [ny1..ny2:idy][nx1..nx2:idx][nz1..nz2:idz], in the order of snap_write().
+ */
+static void snap_fill_acoustic(float *buf, int c, Velocity *v, float ***sxx,
+int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2,
+int ny2, int nz2) {
+
+	int i,j,k,m;
+
+	switch(c){
+	case 0 :
+		snap_copy(buf,v->x,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+		break;
+	case 1 :
+		snap_copy(buf,v->y,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+		break;
+	case 2 :
+		snap_copy(buf,v->z,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+		break;
+	case 3 :
+		m=0;
+		for (k=nz1;k<=nz2;k+=idz)
+			for (i=nx1;i<=nx2;i+=idx)
+				for (j=ny1;j<=ny2;j+=idy)
+					buf[m++]=-3.0*sxx[j][i][k];
+		break;
+	}
+}
+
+
 void snap_acoustic(FILE *fp, int nt, int nsnap, int format, int type, 
 Velocity *v, float ***sxx,
 int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2, 
@@ -27,24 +64,21 @@ int ny2, int nz2) {
 	type=4 : both particle velocities (type=1) and energy (type=3)
 	*/
 
+	/* components of the types in the order of output, see comp_name
+	   (no divergence and curl in the acoustic case) */
+	const int ncomp[5] = {0, 3, 1, 0, 4};
+	const int comps[5][4] = {{0}, {0, 1, 2}, {3}, {0}, {0, 1, 2, 3}};
 
-	
-	char xfile[STRING_SIZE], yfile[STRING_SIZE], zfile[STRING_SIZE];
-	char rotfile[STRING_SIZE], ext[8], wm[2];
-	char  divfile[STRING_SIZE], pfile[STRING_SIZE];
-	FILE *fpx1, *fpy1, *fpz1, *fpp /*, *fpx2, *fpy2*/;
-	int i,j,k;
-	float /*a=0.0,*/ amp; /* dh24x, dh24y, dh24z, vyx, vxy, vxx, vyy, vzx, vyz, vxz, vzy, vzz not used here*/
+	char pefile[STRING_SIZE], mfile[STRING_SIZE], ext[8];
+	int c,n,ip,np,nxs,nys,nzs,bx1,bx2,by1,by2,bz1,bz2;
+	float *buf;
+	double time0;
 
 
 	extern float /*DX, DY, DZ,*/ DT;
 	extern char SNAP_FILE[STRING_SIZE];
 	extern int MYID, POS[4], LOG; /* SNAP_PLANE not used here*/
 
-        float ***vx = v->x;
-        float ***vy = v->y;
-        float ***vz = v->z;
-
 
 	switch(format){
 	case 1: 
@@ -58,87 +92,42 @@ int ny2, int nz2) {
 		break;
 	}
 
-
-	sprintf(xfile,"%s%s.x.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(yfile,"%s%s.z.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(zfile,"%s%s.y.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(divfile,"%s%s.div.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(rotfile,"%s%s.rot.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(pfile,"%s%s.p.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-
         if (LOG){
 	fprintf(fp,"\n\n PE %d is writing snapshot-data at T=%fs to \n",MYID,nt*DT);}
 
-
-	if (nsnap==1) 
-		sprintf(wm,"w");
-	else 
-		sprintf(wm,"a");
-
-	switch(type){
-	case 1 :
-		fprintf(fp,"\t%s\n", xfile);
-		fprintf(fp,"\t%s\n", yfile);
-		fprintf(fp,"\t%s\n\n", zfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
-			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-				
-			
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					
-					
-				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
-		break;
-	case 2 :
-		fprintf(fp,"\t%s\n\n", pfile);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
-			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-					amp=-3.0*sxx[j][i][k];
-					
-				
-					writedsk(fpp,amp,format);
-
-				}
-		fclose(fpp);
-		break;
-	case 4 :
-		fprintf(fp,"\t%s\n", xfile);
-		fprintf(fp,"\t%s\n", yfile);
-		fprintf(fp,"\t%s\n\n", zfile);
-		fprintf(fp,"\t%s\n\n", pfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
-			for (i=nx1;i<=nx2;i+=idx)
-				for (j=ny1;j<=ny2;j+=idy){
-					amp=-3.0*sxx[j][i][k];
-
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					
-					writedsk(fpp,amp,format);
-				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
-		fclose(fpp);
-		break;
-		
+	time0=MPI_Wtime();
+
+	/* samples of this PE, see snap_write() */
+	nxs=(nx2-nx1)/idx+1;
+	nys=(ny2-ny1)/idy+1;
+	nzs=(nz2-nz1)/idz+1;
+	buf=vector(0,nxs*nys*nzs-1);
+
+	for (n=0;n<ncomp[type];n++){
+		c=comps[type][n];
+		/* files of this PE and merged files (SNAP_MPIIO=1) */
+		sprintf(pefile,"%s%s.%s.%i%i%i",SNAP_FILE,ext,pe_name[c],POS[1],POS[2],POS[3]);
+		sprintf(mfile,"%s%s.%s",SNAP_FILE,ext,comp_name[c]);
+
+		if (!snap_plan_n()){
+			snap_fill_acoustic(buf,c,v,sxx,idx,idy,idz,nx1,ny1,nz1,nx2,ny2,nz2);
+			snap_write(fp,pefile,mfile,nsnap,format,buf,nxs,nys,nzs);
+			continue;
+		}
+
+		/* planes and boxes of SNAP_PLAN at full resolution, see snap_plan.c */
+		for (ip=0;ip<snap_plan_n();ip++){
+			np=snap_plan_box(ip,&bx1,&bx2,&by1,&by2,&bz1,&bz2);
+			if (np>nxs*nys*nzs){
+				free_vector(buf,0,nxs*nys*nzs-1);
+				nxs=np; nys=nzs=1;
+				buf=vector(0,np-1);
+			}
+			if (np>0) snap_fill_acoustic(buf,c,v,sxx,1,1,1,bx1,by1,bz1,bx2,by2,bz2);
+			snap_plan_write(fp,ip,mfile,nsnap,buf);
+		}
 	}
-}
-
 
+	free_vector(buf,0,nxs*nys*nzs-1);
+	snap_async_exposed(MPI_Wtime()-time0);
+}
@@ -0,0 +1,255 @@
+/*------------------------------------------------------------------------
+ *   Asynchronous output of snapshots on an I/O thread (SNAP_ASYNC=1).
+ *
+ *   snap_write() hands the samples of a snapshot component to the I/O
+ *   thread instead of writing them itself: the samples are copied into a
+ *   staging buffer, which is queued and written to the file of the PE by
+ *   the thread while the time stepping continues. The components are
+ *   written in the order in which they are queued, so the files are the
+ *   same as with synchronous output. Compressed snapshots (SNAP_COMPRESS>0)
+ *   are also compressed by the thread.
+ *
+ *   At most SNAP_ASYNC_SLOTS snapshots are staged (double buffering): a
+ *   new snapshot waits until the thread has written all components of the
+ *   snapshot before the previous one. The thread does not call MPI, so
+ *   MPI_THREAD_FUNNELED is sufficient. The collective writes of
+ *   SNAP_MPIIO=1 cannot be done by the thread; the output is then
+ *   synchronous.
+ *
+ *   The I/O time is split into the exposed part, which the time stepping
+ *   spends in snap() (staging, waiting for a free buffer, synchronous
+ *   writes), and the hidden part, which the thread spends writing while
+ *   the time stepping continues.
+ *  ----------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <time.h>
+
+#include "fd.h"
+
+
+#define SNAP_ASYNC_SLOTS 2
+
+
+typedef struct SnapJob {
+    char file[STRING_SIZE];
+    int nsnap, format, nxs, nys, nzs;
+    float *buf;
+    struct SnapJob *next;
+} SnapJob;
+
+
+static pthread_t thread;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+/* queue of staged components, the head is removed after it is written */
+static SnapJob *head = NULL, *tail = NULL;
+static int active = 0, quit = 0;
+static char failed[STRING_SIZE] = "";
+
+/* seconds written by the thread, waited for by the time stepping and
+   spent in snap() */
+static double time_write = 0.0, time_wait = 0.0, time_exposed = 0.0;
+
+
+static double wall_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+
+static void *snap_async_thread(void *arg)
+{
+    SnapJob *job;
+    double t0;
+    int ok;
+
+    (void) arg;
+
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while ((head == NULL) && (!quit))
+            pthread_cond_wait(&cond, &lock);
+        if (head == NULL) break;
+        job = head;
+        pthread_mutex_unlock(&lock);
+
+        t0 = wall_time();
+        ok = snap_write_pe(job->file, job->nsnap, job->format, job->buf,
+                job->nxs, job->nys, job->nzs);
+
+        pthread_mutex_lock(&lock);
+        time_write += wall_time() - t0;
+        if ((!ok) && (failed[0] == '\0')) strcpy(failed, job->file);
+        head = job->next;
+        if (head == NULL) tail = NULL;
+        free(job->buf);
+        free(job);
+        pthread_cond_broadcast(&cond);
+    }
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+
+/* called with the lock held */
+static void check_failed(void)
+{
+    if (failed[0] != '\0') {
+        pthread_mutex_unlock(&lock);
+        err("Could not write snapshot file %s", failed);
+    }
+}
+
+
+/*
+ * Start the I/O thread if snapshots are written asynchronously.
+ */
+void snap_async_start(void)
+{
+    extern int SNAP, SNAP_ASYNC, SNAP_MPIIO, MYID;
+
+    if ((!SNAP) || (!SNAP_ASYNC) || active) return;
+
+    if (SNAP_MPIIO) {
+        if (MYID == 0)
+            warning("SNAP_ASYNC=1 is ignored with SNAP_MPIIO=1, the collective "
+                    "writes are done by the time stepping.");
+        return;
+    }
+
+    quit = 0;
+    if (pthread_create(&thread, NULL, snap_async_thread, NULL) != 0)
+        err("Could not start the I/O thread for snapshots (SNAP_ASYNC=1)");
+    active = 1;
+}
+
+
+/*
+ * Queue the samples of one snapshot component for the I/O thread.
+ *
+ * Parameters
+ * ----------
+ * pefile :
+ *     File of this PE.
+ * nsnap :
+ *     Number of the snapshot, the file is truncated for nsnap=1.
+ * format :
+ *     Format of the snapshot data (2 or 3).
+ * buf :
+ *     Samples, copied into a staging buffer.
+ * nxs, nys, nzs :
+ *     Number of samples in x, y and z.
+ *
+ * Returns
+ * -------
+ * 1 if the samples were queued, 0 if the I/O thread is not running.
+ */
+int snap_async_submit(const char *pefile, int nsnap, int format,
+        const float *buf, int nxs, int nys, int nzs)
+{
+    SnapJob *job;
+    double t0;
+    int n = nxs * nys * nzs;
+
+    if (!active) return 0;
+
+    job = (SnapJob *) malloc(sizeof(SnapJob));
+    if (job) job->buf = (float *) malloc((size_t) n * sizeof(float));
+    if ((!job) || (!job->buf))
+        err("allocation failure in function snap_async_submit() ");
+    strncpy(job->file, pefile, STRING_SIZE - 1);
+    job->file[STRING_SIZE - 1] = '\0';
+    job->nsnap = nsnap;
+    job->format = format;
+    job->nxs = nxs;
+    job->nys = nys;
+    job->nzs = nzs;
+    job->next = NULL;
+    memcpy(job->buf, buf, (size_t) n * sizeof(float));
+
+    pthread_mutex_lock(&lock);
+    check_failed();
+    /* wait for a free staging buffer */
+    t0 = wall_time();
+    while ((head != NULL) && (head->nsnap <= nsnap - SNAP_ASYNC_SLOTS))
+        pthread_cond_wait(&cond, &lock);
+    time_wait += wall_time() - t0;
+    check_failed();
+
+    if (tail) tail->next = job;
+    else head = job;
+    tail = job;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+
+    return 1;
+}
+
+
+/*
+ * Wait until all queued snapshots are written.
+ */
+void snap_async_wait(void)
+{
+    double t0;
+
+    if (!active) return;
+
+    t0 = wall_time();
+    pthread_mutex_lock(&lock);
+    while (head != NULL)
+        pthread_cond_wait(&cond, &lock);
+    check_failed();
+    pthread_mutex_unlock(&lock);
+    t0 = wall_time() - t0;
+
+    time_wait += t0;
+    time_exposed += t0;
+}
+
+
+/*
+ * Write the queued snapshots and stop the I/O thread.
+ */
+void snap_async_stop(void)
+{
+    snap_async_wait();
+    if (!active) return;
+
+    pthread_mutex_lock(&lock);
+    quit = 1;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    pthread_join(thread, NULL);
+    active = 0;
+}
+
+
+/*
+ * Add seconds spent by the time stepping on snapshot output.
+ */
+void snap_async_exposed(double t)
+{
+    time_exposed += t;
+}
+
+
+/*
+ * Return the hidden and exposed snapshot output time in seconds since the
+ * last call and reset the counters. Call after snap_async_wait().
+ */
+void snap_async_times(double *hidden, double *exposed)
+{
+    pthread_mutex_lock(&lock);
+    *hidden = time_write - time_wait;
+    if (*hidden < 0.0) *hidden = 0.0;
+    *exposed = time_exposed;
+    time_write = time_wait = time_exposed = 0.0;
+    pthread_mutex_unlock(&lock);
+}
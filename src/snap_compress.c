@@ -0,0 +1,557 @@
+/*------------------------------------------------------------------------
+ *   Compressed snapshots (SNAP_COMPRESS > 0, binary snapshots with one
+ *   file per PE).
+ *
+ *   Each snapshot component of a PE is compressed as one 3-D block of
+ *   nzs * nxs * nys samples (y fastest, see snap_write()) and appended to
+ *   the file of the PE as a frame: a header (SnapFrame) followed by the
+ *   compressed data. snapmerge (merge.c) decompresses the frames and
+ *   writes the same merged binary files as for uncompressed snapshots.
+ *
+ *   SNAP_COMPRESS=1, lossless: the four bytes of the floats are split into
+ *   four byte planes (shuffle), so that the slowly varying sign and
+ *   exponent bytes form long runs, and the planes are compressed with an
+ *   LZ77 coder (literal runs and matches of at least 4 bytes within the
+ *   last 64 KiB, coded as in LZ4).
+ *
+ *   SNAP_COMPRESS=2 (3), lossy with the absolute (relative) error bound
+ *   eps=SNAP_TOL (SNAP_TOL times the largest absolute value of the
+ *   component on the PE): the samples are quantized with a step of about
+ *   2*eps, predicted from the quantized neighbours in x, y and z (Lorenzo
+ *   predictor) and the residuals are stored with the bit width of the
+ *   largest residual of each block of 8x8x8 samples; blocks of zeros take
+ *   one byte. The decompressed values differ by at most eps from the
+ *   original ones; blocks holding values for which this cannot be
+ *   guaranteed (NaN, infinite or too large for the quantization) are
+ *   stored uncompressed.
+ *
+ *   The functions do not call MPI, so that the I/O thread of SNAP_ASYNC=1
+ *   can compress and write the snapshots.
+ *  ----------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include "fd.h"
+
+
+#define LZ_HASH_BITS 16
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+#define SZ_BLOCK 8
+#define SZ_RAW 255
+#define SZ_QMAX (1 << 27)
+/* quantization step 2*SZ_MARGIN*eps, the margin leaves room for the
+   rounding of the decompressed values to float */
+#define SZ_MARGIN 0.999
+
+
+/* header of a compressed snapshot component */
+typedef struct {
+    char magic[4];      /* "ASZ1" */
+    int method;         /* 1: lossless, 2: lossy */
+    int nxs, nys, nzs;  /* samples in x, y and z */
+    int reserved;
+    double step;        /* quantization step of the lossy method */
+    long long nbytes;   /* size of the compressed data */
+} SnapFrame;
+
+
+/*------------------------------------------------------------------------
+ *   LZ77 coder (lossless method)
+ *  ----------------------------------------------------------------------*/
+
+static size_t lz_bound(size_t n)
+{
+    return n + n / 255 + 16;
+}
+
+
+static uint32_t read32(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+/* extension bytes of a length of at least 15 */
+static unsigned char *lz_length(unsigned char *op, size_t len)
+{
+    len -= 15;
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char) len;
+    return op;
+}
+
+
+/* one sequence: nlit literals followed by a match of mlen bytes (mlen=0
+   for the last sequence) */
+static unsigned char *lz_sequence(unsigned char *op, const unsigned char *lit,
+        size_t nlit, size_t offset, size_t mlen)
+{
+    unsigned char *token = op++;
+
+    *token = (unsigned char) (((nlit >= 15) ? 15 : nlit) << 4);
+    if (nlit >= 15) op = lz_length(op, nlit);
+    memcpy(op, lit, nlit);
+    op += nlit;
+    if (mlen) {
+        *op++ = (unsigned char) (offset & 0xff);
+        *op++ = (unsigned char) (offset >> 8);
+        mlen -= LZ_MIN_MATCH;
+        *token |= (unsigned char) ((mlen >= 15) ? 15 : mlen);
+        if (mlen >= 15) op = lz_length(op, mlen);
+    }
+    return op;
+}
+
+
+/* compress in[0..n-1] into out[0..lz_bound(n)-1], returns the size or 0
+   on allocation failure */
+static size_t lz_compress(const unsigned char *in, size_t n, unsigned char *out)
+{
+    const unsigned char *ip = in, *anchor = in, *end = in + n, *ref;
+    unsigned char *op = out;
+    size_t *table, len;
+    uint32_t seq, h;
+
+    table = (size_t *) calloc((size_t) 1 << LZ_HASH_BITS, sizeof(size_t));
+    if (table == NULL) return 0;
+
+    while ((size_t) (end - ip) >= LZ_MIN_MATCH) {
+        seq = read32(ip);
+        h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+        /* positions are stored plus one, 0 marks an empty entry */
+        ref = (table[h]) ? in + table[h] - 1 : NULL;
+        table[h] = (size_t) (ip - in) + 1;
+        if (ref && (ip - ref <= LZ_MAX_OFFSET) && (read32(ref) == seq)) {
+            for (len = LZ_MIN_MATCH; (ip + len < end) && (ref[len] == ip[len]); len++);
+            op = lz_sequence(op, anchor, (size_t) (ip - anchor),
+                    (size_t) (ip - ref), len);
+            ip += len;
+            anchor = ip;
+        } else {
+            ip++;
+        }
+    }
+    op = lz_sequence(op, anchor, (size_t) (end - anchor), 0, 0);
+
+    free(table);
+    return (size_t) (op - out);
+}
+
+
+/* read the extension bytes of a length, returns 0 at the end of the input */
+static int lz_read_length(const unsigned char **ip, const unsigned char *iend,
+        size_t *len)
+{
+    unsigned char b;
+
+    do {
+        if (*ip >= iend) return 0;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 1;
+}
+
+
+/* decompress in[0..nin-1] into out[0..n-1], returns 0 for corrupt data */
+static int lz_decompress(const unsigned char *in, size_t nin, unsigned char *out,
+        size_t n)
+{
+    const unsigned char *ip = in, *iend = in + nin;
+    size_t o = 0, len, offset;
+    unsigned char token;
+
+    while (ip < iend) {
+        token = *ip++;
+        len = token >> 4;
+        if ((len == 15) && !lz_read_length(&ip, iend, &len)) return 0;
+        if ((len > (size_t) (iend - ip)) || (len > n - o)) return 0;
+        memcpy(out + o, ip, len);
+        ip += len;
+        o += len;
+        /* the last sequence has no match */
+        if (o == n) return (ip == iend);
+
+        if (iend - ip < 2) return 0;
+        offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > o)) return 0;
+        len = token & 15;
+        if ((len == 15) && !lz_read_length(&ip, iend, &len)) return 0;
+        len += LZ_MIN_MATCH;
+        if (len > n - o) return 0;
+        /* byte by byte, the match may overlap the output */
+        for (; len > 0; len--, o++) out[o] = out[o - offset];
+    }
+    return (o == n);
+}
+
+
+static unsigned char *lossless_compress(const float *buf, size_t n, size_t *size)
+{
+    const unsigned char *b = (const unsigned char *) buf;
+    unsigned char *planes, *out;
+    size_t i;
+    int p;
+
+    planes = (unsigned char *) malloc(4 * n + 1);
+    out = (unsigned char *) malloc(lz_bound(4 * n));
+    if ((planes == NULL) || (out == NULL)) {
+        free(planes);
+        free(out);
+        return NULL;
+    }
+    for (p = 0; p < 4; p++)
+        for (i = 0; i < n; i++) planes[p * n + i] = b[4 * i + p];
+    *size = lz_compress(planes, 4 * n, out);
+    free(planes);
+    if (*size == 0) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+
+static int lossless_decompress(const unsigned char *in, size_t nin, float *buf,
+        size_t n)
+{
+    unsigned char *b = (unsigned char *) buf, *planes;
+    size_t i;
+    int p, ok;
+
+    planes = (unsigned char *) malloc(4 * n + 1);
+    if (planes == NULL) return 0;
+    ok = lz_decompress(in, nin, planes, 4 * n);
+    if (ok)
+        for (p = 0; p < 4; p++)
+            for (i = 0; i < n; i++) b[4 * i + p] = planes[p * n + i];
+    free(planes);
+    return ok;
+}
+
+
+/*------------------------------------------------------------------------
+ *   Block-wise quantization (lossy method)
+ *  ----------------------------------------------------------------------*/
+
+/* Lorenzo prediction of the quantized sample (k,i,j) from its neighbours
+   with smaller indices, which are zero outside the volume */
+static int lorenzo(const int *q, int nxs, int nys, int k, int i, int j)
+{
+    size_t m = ((size_t) k * nxs + i) * nys + j, di = nys, dk = (size_t) nxs * nys;
+    int p = 0;
+
+    if (j) p += q[m - 1];
+    if (i) p += q[m - di];
+    if (k) p += q[m - dk];
+    if (i && j) p -= q[m - di - 1];
+    if (k && j) p -= q[m - dk - 1];
+    if (k && i) p -= q[m - dk - di];
+    if (k && i && j) p += q[m - dk - di - 1];
+    return p;
+}
+
+
+/* loop over the samples of the block starting at (k0,i0,j0) */
+#define FOR_BLOCK(k, i, j) \
+    for (k = k0; k < ((k0 + SZ_BLOCK < nzs) ? k0 + SZ_BLOCK : nzs); k++) \
+        for (i = i0; i < ((i0 + SZ_BLOCK < nxs) ? i0 + SZ_BLOCK : nxs); i++) \
+            for (j = j0; j < ((j0 + SZ_BLOCK < nys) ? j0 + SZ_BLOCK : nys); j++)
+
+#define FOR_BLOCKS \
+    for (k0 = 0; k0 < nzs; k0 += SZ_BLOCK) \
+        for (i0 = 0; i0 < nxs; i0 += SZ_BLOCK) \
+            for (j0 = 0; j0 < nys; j0 += SZ_BLOCK)
+
+
+static unsigned char *lossy_compress(const float *buf, int nxs, int nys, int nzs,
+        double eps, double step, size_t *size)
+{
+    size_t n = (size_t) nxs * nys * nzs, m, nblocks;
+    unsigned char *out, *op, *flag;
+    uint32_t z[SZ_BLOCK * SZ_BLOCK * SZ_BLOCK], zmax;
+    uint64_t acc;
+    double x;
+    int *q, i, j, k, i0, j0, k0, b, c, nb, bits, nacc;
+
+    nblocks = (size_t) ((nzs + SZ_BLOCK - 1) / SZ_BLOCK)
+        * ((nxs + SZ_BLOCK - 1) / SZ_BLOCK) * ((nys + SZ_BLOCK - 1) / SZ_BLOCK);
+    q = (int *) malloc(n * sizeof(int) + 1);
+    flag = (unsigned char *) malloc(nblocks + 1);
+    out = (unsigned char *) malloc(nblocks + 4 * n + 1);
+    if ((q == NULL) || (flag == NULL) || (out == NULL)) {
+        free(q);
+        free(flag);
+        free(out);
+        return NULL;
+    }
+
+    /* quantization, blocks which are stored uncompressed hold q=0 */
+    b = 0;
+    FOR_BLOCKS {
+        flag[b] = 0;
+        FOR_BLOCK(k, i, j) {
+            m = ((size_t) k * nxs + i) * nys + j;
+            x = buf[m] / step;
+            if (!(fabs(x) < SZ_QMAX)) {
+                flag[b] = SZ_RAW;
+                continue;
+            }
+            q[m] = (int) lrint(x);
+            /* the error bound also holds after rounding to float */
+            if (fabs((double) (float) (q[m] * step) - buf[m]) > eps)
+                flag[b] = SZ_RAW;
+        }
+        if (flag[b] == SZ_RAW)
+            FOR_BLOCK(k, i, j) q[((size_t) k * nxs + i) * nys + j] = 0;
+        b++;
+    }
+
+    /* residuals of the prediction, bit packed per block */
+    op = out;
+    b = 0;
+    FOR_BLOCKS {
+        if (flag[b++] == SZ_RAW) {
+            *op++ = SZ_RAW;
+            FOR_BLOCK(k, i, j) {
+                memcpy(op, &buf[((size_t) k * nxs + i) * nys + j], sizeof(float));
+                op += sizeof(float);
+            }
+            continue;
+        }
+        nb = 0;
+        zmax = 0;
+        FOR_BLOCK(k, i, j) {
+            c = q[((size_t) k * nxs + i) * nys + j] - lorenzo(q, nxs, nys, k, i, j);
+            /* zigzag: small residuals of both signs give small codes */
+            z[nb] = ((uint32_t) c << 1) ^ (uint32_t) -(c < 0);
+            zmax |= z[nb++];
+        }
+        for (bits = 0; zmax; bits++) zmax >>= 1;
+        *op++ = (unsigned char) bits;
+        acc = 0;
+        nacc = 0;
+        for (c = 0; (c < nb) && bits; c++) {
+            acc |= (uint64_t) z[c] << nacc;
+            for (nacc += bits; nacc >= 8; nacc -= 8) {
+                *op++ = (unsigned char) (acc & 0xff);
+                acc >>= 8;
+            }
+        }
+        if (nacc > 0) *op++ = (unsigned char) acc;
+    }
+
+    *size = (size_t) (op - out);
+    free(flag);
+    free(q);
+    return out;
+}
+
+
+static int lossy_decompress(const unsigned char *in, size_t nin, float *buf,
+        int nxs, int nys, int nzs, double step)
+{
+    const unsigned char *ip = in, *iend = in + nin;
+    size_t n = (size_t) nxs * nys * nzs, m;
+    uint64_t acc;
+    uint32_t zz;
+    int *q, i, j, k, i0, j0, k0, nb, bits, nacc, ok = 1;
+
+    q = (int *) malloc(n * sizeof(int) + 1);
+    if (q == NULL) return 0;
+
+    FOR_BLOCKS {
+        if (ip >= iend) {
+            ok = 0;
+            break;
+        }
+        bits = *ip++;
+        nb = ((((k0 + SZ_BLOCK < nzs) ? SZ_BLOCK : nzs - k0)
+                    * ((i0 + SZ_BLOCK < nxs) ? SZ_BLOCK : nxs - i0))
+                * ((j0 + SZ_BLOCK < nys) ? SZ_BLOCK : nys - j0));
+        if (bits == SZ_RAW) {
+            if ((size_t) (iend - ip) < (size_t) nb * sizeof(float)) {
+                ok = 0;
+                break;
+            }
+            FOR_BLOCK(k, i, j) {
+                m = ((size_t) k * nxs + i) * nys + j;
+                memcpy(&buf[m], ip, sizeof(float));
+                ip += sizeof(float);
+                q[m] = 0;
+            }
+            continue;
+        }
+        if ((bits > 31) || ((size_t) (iend - ip) < ((size_t) nb * bits + 7) / 8)) {
+            ok = 0;
+            break;
+        }
+        acc = 0;
+        nacc = 0;
+        FOR_BLOCK(k, i, j) {
+            while (nacc < bits) {
+                acc |= (uint64_t) *ip++ << nacc;
+                nacc += 8;
+            }
+            zz = (uint32_t) (acc & ((1ULL << bits) - 1));
+            acc >>= bits;
+            nacc -= bits;
+            m = ((size_t) k * nxs + i) * nys + j;
+            q[m] = (int) (zz >> 1) ^ -(int) (zz & 1);
+            q[m] += lorenzo(q, nxs, nys, k, i, j);
+            buf[m] = (float) (q[m] * step);
+        }
+    }
+
+    free(q);
+    return ok && (ip == iend);
+}
+
+
+/*------------------------------------------------------------------------
+ *   Frames
+ *  ----------------------------------------------------------------------*/
+
+/* read the header of a frame, returns 0 at the end of the file or for
+   corrupt data */
+static int frame_header(FILE *fp, SnapFrame *f)
+{
+    if (fread(f, sizeof(SnapFrame), 1, fp) != 1) return 0;
+    return (!memcmp(f->magic, "ASZ1", 4)) && (f->nbytes >= 0);
+}
+
+
+/* skip one frame, returns 0 if the file ends before */
+static int frame_skip(FILE *fp)
+{
+    SnapFrame f;
+
+    return frame_header(fp, &f) && !fseek(fp, (long) f.nbytes, SEEK_CUR);
+}
+
+
+/*
+ * Compress one snapshot component and write it to the file of this PE.
+ *
+ * Parameters
+ * ----------
+ * pefile :
+ *     File of this PE.
+ * nsnap :
+ *     Number of the snapshot. The file is truncated for nsnap=1, otherwise
+ *     the frame is written after the first nsnap-1 frames and the file is
+ *     truncated after it, so that a run resumed from a checkpoint
+ *     overwrites the snapshots written after the checkpoint.
+ * buf :
+ *     Samples of this PE, see snap_write().
+ * nxs, nys, nzs :
+ *     Number of samples in x, y and z.
+ *
+ * Returns
+ * -------
+ * 1 on success, 0 if the file could not be read or written.
+ */
+int snap_compress_pe(const char *pefile, int nsnap, const float *buf,
+        int nxs, int nys, int nzs)
+{
+    extern int SNAP_COMPRESS;
+    extern float SNAP_TOL;
+
+    SnapFrame f;
+    FILE *fpout;
+    unsigned char *data;
+    size_t n = (size_t) nxs * nys * nzs, size = 0, i;
+    double amax = 0.0, eps;
+    int ok = 1, isnap;
+
+    memset(&f, 0, sizeof(f));
+    memcpy(f.magic, "ASZ1", 4);
+    f.nxs = nxs;
+    f.nys = nys;
+    f.nzs = nzs;
+    if (SNAP_COMPRESS == 1) {
+        f.method = 1;
+        data = lossless_compress(buf, n, &size);
+    } else {
+        f.method = 2;
+        eps = SNAP_TOL;
+        if (SNAP_COMPRESS == 3) {
+            for (i = 0; i < n; i++)
+                if (isfinite(buf[i]) && (fabs(buf[i]) > amax)) amax = fabs(buf[i]);
+            /* any step for a component which is zero */
+            eps = (amax > 0.0) ? SNAP_TOL * amax : 1.0;
+        }
+        f.step = 2.0 * SZ_MARGIN * eps;
+        data = lossy_compress(buf, nxs, nys, nzs, eps, f.step, &size);
+    }
+    if (data == NULL) return 0;
+    f.nbytes = (long long) size;
+
+    if (nsnap > 1) {
+        fpout = fopen(pefile, "r+");
+        for (isnap = 1; fpout && ok && (isnap < nsnap); isnap++)
+            ok = frame_skip(fpout);
+    } else {
+        fpout = fopen(pefile, "w");
+    }
+    if (fpout == NULL) ok = 0;
+    if (ok) {
+        ok = (fwrite(&f, sizeof(SnapFrame), 1, fpout) == 1) &&
+            (fwrite(data, 1, size, fpout) == size) && !fflush(fpout);
+        /* frames of a previous run after this one */
+        ok = ok && !ftruncate(fileno(fpout), (off_t) ftell(fpout));
+    }
+    if (fpout && (fclose(fpout) != 0)) ok = 0;
+    free(data);
+    return ok;
+}
+
+
+/*
+ * Read and decompress the next snapshot component from the file of a PE.
+ *
+ * Parameters
+ * ----------
+ * fp :
+ *     File of the PE.
+ * buf :
+ *     Returns the samples, see snap_write().
+ * nxs, nys, nzs :
+ *     Number of samples in x, y and z, must match the frame.
+ *
+ * Returns
+ * -------
+ * Size of the frame in bytes, -1 if the file ends or the frame is corrupt.
+ */
+long long snap_compress_read(FILE *fp, float *buf, int nxs, int nys, int nzs)
+{
+    SnapFrame f;
+    unsigned char *data;
+    size_t n = (size_t) nxs * nys * nzs;
+    int ok;
+
+    if (!frame_header(fp, &f) || (f.nxs != nxs) || (f.nys != nys) || (f.nzs != nzs))
+        return -1;
+    data = (unsigned char *) malloc((size_t) f.nbytes + 1);
+    if (data == NULL) return -1;
+    ok = (fread(data, 1, (size_t) f.nbytes, fp) == (size_t) f.nbytes);
+    if (ok && (f.method == 1))
+        ok = lossless_decompress(data, (size_t) f.nbytes, buf, n);
+    else if (ok && (f.method == 2))
+        ok = lossy_decompress(data, (size_t) f.nbytes, buf, nxs, nys, nzs, f.step);
+    else
+        ok = 0;
+    free(data);
+
+    return (ok) ? (long long) sizeof(SnapFrame) + f.nbytes : -1;
+}
@@ -0,0 +1,226 @@
+/*------------------------------------------------------------------------
+ *   Snapshots of planes and boxes (SNAP_PLAN).
+ *
+ *   Instead of the whole model, decimated by IDX, IDY and IDZ, only the
+ *   planes and boxes listed in SNAP_PLAN are written, at the full grid
+ *   resolution. The items of the list are separated by semicolons, each
+ *   item gives the grid points (global, starting at 1) of one or more
+ *   axes, separated by slashes (the json parser allows neither commas nor
+ *   blanks in values); an axis which is not given is taken completely:
+ *
+ *       "SNAP_PLAN" : "y=1;x=100;z=120;x=50:150/y=1:80/z=60:180"
+ *
+ *   gives the surface, the planes x=100 and z=120 and a box. The plan is
+ *   set up once by snap_plan_init(): the part of each item within the
+ *   subdomain of this PE and a subarray datatype which places this part
+ *   in the item. The PEs write their parts collectively with MPI-IO into
+ *   one file per item and component, SNAP_FILE.bin.<comp>.<tag>, where the
+ *   tag is the plane (e.g. x100) or box<n> for the n-th item. Each
+ *   snapshot holds the samples of the item with z slowest and y fastest,
+ *   as the files of snapmerge, and is appended to the previous ones.
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+
+
+typedef struct {
+    char tag[16];
+    int g1[3], g2[3];       /* global grid points in x, y and z */
+    int l1[3], l2[3];       /* local grid points, empty if l1 > l2 */
+    int n;                  /* samples of this PE */
+    MPI_Offset volume;      /* samples of the item */
+    MPI_Datatype block;     /* part of this PE within the item */
+} SnapItem;
+
+
+static SnapItem *item = NULL;
+static int nitem = 0;
+
+
+/* parse one item of the plan into the global box of p */
+static void snap_plan_item(char *s, SnapItem *p, int n, const int ng[3])
+{
+    const char *axes = "xyz";
+    char axis;
+    int a, b, d, len, given[3] = {0, 0, 0};
+
+    for (d = 0; d < 3; d++) {
+        p->g1[d] = 1;
+        p->g2[d] = ng[d];
+    }
+    while (sscanf(s, " %c =%d%n", &axis, &a, &len) == 2) {
+        s += len;
+        b = a;
+        if ((*s == ':') && (sscanf(s + 1, "%d%n", &b, &len) == 1)) s += len + 1;
+        if (*s == '/') s++;
+        if (strchr(axes, axis) == NULL)
+            err("SNAP_PLAN: unknown axis %c in item %d, must be x, y or z", axis, n);
+        d = (int) (strchr(axes, axis) - axes);
+        if ((a < 1) || (b < a) || (b > ng[d]))
+            err("SNAP_PLAN: %c=%d:%d in item %d is not within 1:%d", axis, a, b,
+                    n, ng[d]);
+        if (given[d]++)
+            err("SNAP_PLAN: axis %c is given twice in item %d", axis, n);
+        p->g1[d] = a;
+        p->g2[d] = b;
+    }
+    if (sscanf(s, " %c", &axis) == 1)
+        err("SNAP_PLAN: cannot read item %d at '%s'", n, s);
+    if (given[0] + given[1] + given[2] == 0)
+        err("SNAP_PLAN: item %d is empty", n);
+
+    /* planes are named after their axis and grid point */
+    sprintf(p->tag, "box%d", n);
+    for (d = 0; d < 3; d++)
+        if ((given[d]) && (given[0] + given[1] + given[2] == 1) && (p->g1[d] == p->g2[d]))
+            sprintf(p->tag, "%c%d", axes[d], p->g1[d]);
+}
+
+
+/*
+ * Set up the snapshot plan from SNAP_PLAN, after the domain
+ * decomposition. No plan is used if SNAP_PLAN is empty.
+ */
+void snap_plan_init(FILE *fp)
+{
+    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], MYID;
+    extern int OFFX[], OFFY[], OFFZ[];
+    extern char SNAP_PLAN[STRING_SIZE];
+
+    char plan[STRING_SIZE], *s, c;
+    const int nl[3] = {NX, NY, NZ};
+    const int ng[3] = {NXG, NYG, NZG};
+    int gsizes[3], lsizes[3], starts[3], off[3], d, k, empty;
+    SnapItem *p;
+
+    nitem = 0;
+    if (SNAP_PLAN[0] == '\0') return;
+
+    strcpy(plan, SNAP_PLAN);
+    for (s = plan, k = 1; *s; s++) k += (*s == ';');
+    item = (SnapItem *) malloc((size_t) k * sizeof(SnapItem));
+    if (item == NULL) err("allocation failure in function snap_plan_init() ");
+
+    for (s = strtok(plan, ";"); s != NULL; s = strtok(NULL, ";")) {
+        /* blank items, e.g. after a trailing semicolon */
+        if (sscanf(s, " %c", &c) != 1) continue;
+        p = &item[nitem];
+        snap_plan_item(s, p, ++nitem, ng);
+
+        /* part of this PE */
+        off[0] = OFFX[POS[1]];
+        off[1] = OFFY[POS[2]];
+        off[2] = OFFZ[POS[3]];
+        empty = 0;
+        p->volume = 1;
+        for (d = 0; d < 3; d++) {
+            p->l1[d] = ((p->g1[d] - off[d] > 1) ? p->g1[d] - off[d] : 1);
+            p->l2[d] = ((p->g2[d] - off[d] < nl[d]) ? p->g2[d] - off[d] : nl[d]);
+            if (p->l1[d] > p->l2[d]) empty = 1;
+            p->volume *= p->g2[d] - p->g1[d] + 1;
+        }
+
+        /* z slowest, y fastest */
+        for (d = 0; d < 3; d++) {
+            k = (d == 0) ? 1 : ((d == 1) ? 2 : 0);
+            gsizes[k] = p->g2[d] - p->g1[d] + 1;
+            lsizes[k] = p->l2[d] - p->l1[d] + 1;
+            starts[k] = p->l1[d] + off[d] - p->g1[d];
+        }
+        if (empty) {
+            p->n = 0;
+            MPI_Type_contiguous(1, MPI_FLOAT, &p->block);
+        } else {
+            p->n = lsizes[0] * lsizes[1] * lsizes[2];
+            MPI_Type_create_subarray(3, gsizes, lsizes, starts, MPI_ORDER_C,
+                    MPI_FLOAT, &p->block);
+        }
+        MPI_Type_commit(&p->block);
+
+        if (MYID == 0)
+            fprintf(fp, " Snapshot plan: %-8s x=%d:%d y=%d:%d z=%d:%d (n1=%d, n2=%d, n3=%d)\n",
+                    p->tag, p->g1[0], p->g2[0], p->g1[1], p->g2[1], p->g1[2],
+                    p->g2[2], gsizes[2], gsizes[1], gsizes[0]);
+    }
+}
+
+
+/* number of items of the snapshot plan, 0 if no plan is used */
+int snap_plan_n(void)
+{
+    return nitem;
+}
+
+
+/*
+ * Part of item ip (0..snap_plan_n()-1) of the snapshot plan within the
+ * subdomain of this PE, in local grid points.
+ *
+ * Returns
+ * -------
+ * Number of samples of this PE, 0 if the item does not intersect the
+ * subdomain.
+ */
+int snap_plan_box(int ip, int *nx1, int *nx2, int *ny1, int *ny2, int *nz1,
+        int *nz2)
+{
+    SnapItem *p = &item[ip];
+
+    *nx1 = p->l1[0];
+    *nx2 = p->l2[0];
+    *ny1 = p->l1[1];
+    *ny2 = p->l2[1];
+    *nz1 = p->l1[2];
+    *nz2 = p->l2[2];
+    return p->n;
+}
+
+
+/*
+ * Write one snapshot component of item ip (collective).
+ *
+ * Parameters
+ * ----------
+ * fp :
+ *     Log file.
+ * mfile :
+ *     File name of the component for the whole model, the tag of the item
+ *     is appended.
+ * nsnap :
+ *     Number of the snapshot, the file is truncated for nsnap=1.
+ * buf :
+ *     Samples of this PE in the box of snap_plan_box(), z slowest, y
+ *     fastest.
+ */
+void snap_plan_write(FILE *fp, int ip, const char *mfile, int nsnap,
+        const float *buf)
+{
+    SnapItem *p = &item[ip];
+    char file[STRING_SIZE + 32];
+    MPI_File fh;
+
+    sprintf(file, "%s.%s", mfile, p->tag);
+    if (p->n > 0) fprintf(fp, "\t%s\n", file);
+    if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        err("Could not open snapshot file %s", file);
+    if (nsnap == 1) MPI_File_set_size(fh, 0);
+
+    MPI_File_set_view(fh, (MPI_Offset) (nsnap - 1) * p->volume
+            * (MPI_Offset) sizeof(float), MPI_FLOAT, p->block, "native",
+            MPI_INFO_NULL);
+    MPI_File_write_all(fh, (void *) buf, p->n, MPI_FLOAT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+}
+
+
+/* free the datatypes of the snapshot plan */
+void snap_plan_free(void)
+{
+    int ip;
+
+    for (ip = 0; ip < nitem; ip++) MPI_Type_free(&item[ip].block);
+    free(item);
+    item = NULL;
+    nitem = 0;
+}
@@ -0,0 +1,148 @@
+/*------------------------------------------------------------------------
+ *   Output of one component of a snapshot.
+ *
+ *   SNAP_MPIIO=0: each PE appends its samples to a file of its own,
+ *   which snapmerge (merge.c) combines after the run.
+ *
+ *   SNAP_MPIIO=1: all PEs write collectively with MPI-IO into the file
+ *   snapmerge would produce. The samples of a PE form a block of the
+ *   global snapshot (z slowest, y fastest); a subarray datatype places
+ *   the block and each snapshot is appended after the previous ones.
+ *
+ *   With SNAP_ASYNC=1 the files of the PEs are written by an I/O thread,
+ *   see snap_async.c. With SNAP_COMPRESS>0 the snapshots in the files of
+ *   the PEs are compressed, see snap_compress.c.
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+
+
+/*
+ * Write the samples of one snapshot component.
+ *
+ * Parameters
+ * ----------
+ * fp :
+ *     Log file.
+ * pefile :
+ *     File of this PE (SNAP_MPIIO=0).
+ * mfile :
+ *     Merged file of all PEs (SNAP_MPIIO=1).
+ * nsnap :
+ *     Number of the snapshot, the files are truncated for nsnap=1.
+ * format :
+ *     Format of the snapshot data, only binary (3) with SNAP_MPIIO=1.
+ * buf :
+ *     Samples of this PE, buf[(k * nxs + i) * nys + j] for the k-th,
+ *     i-th and j-th sample in z, x and y.
+ * nxs, nys, nzs :
+ *     Number of samples of this PE in x, y and z, every IDX-th, IDY-th
+ *     and IDZ-th grid point of its sub grid.
+ */
+void snap_write(FILE *fp, const char *pefile, const char *mfile, int nsnap,
+        int format, const float *buf, int nxs, int nys, int nzs)
+{
+    extern int SNAP_MPIIO, NPROCX, NPROCY, NPROCZ, POS[4], IDX, IDY, IDZ;
+    extern int OFFX[], OFFY[], OFFZ[];
+
+    int n = nxs * nys * nzs;
+    int nsx[NPROCX_MAX], nsy[NPROCY_MAX], nsz[NPROCZ_MAX], p;
+
+    if (!SNAP_MPIIO) {
+        fprintf(fp, "\t%s\n", pefile);
+        if (((format == 2) || (format == 3)) &&
+                snap_async_submit(pefile, nsnap, format, buf, nxs, nys, nzs))
+            return;
+        if (!snap_write_pe(pefile, nsnap, format, buf, nxs, nys, nzs))
+            err("Could not write snapshot file %s", pefile);
+        return;
+    }
+
+    /* the block of this PE follows the samples of the PEs before it */
+    int gsizes[3], lsizes[3] = {nzs, nxs, nys}, starts[3] = {0, 0, 0};
+    MPI_Datatype block;
+    MPI_Offset disp;
+    MPI_File fh;
+
+    gsizes[0] = decomp_samples(OFFZ, NPROCZ, IDZ, nsz);
+    gsizes[1] = decomp_samples(OFFX, NPROCX, IDX, nsx);
+    gsizes[2] = decomp_samples(OFFY, NPROCY, IDY, nsy);
+    for (p = 0; p < POS[3]; p++) starts[0] += nsz[p];
+    for (p = 0; p < POS[1]; p++) starts[1] += nsx[p];
+    for (p = 0; p < POS[2]; p++) starts[2] += nsy[p];
+
+    fprintf(fp, "\t%s\n", mfile);
+    if (MPI_File_open(MPI_COMM_WORLD, (char *) mfile,
+                MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh)
+            != MPI_SUCCESS)
+        err("Could not open snapshot file %s", mfile);
+    if (nsnap == 1) MPI_File_set_size(fh, 0);
+
+    disp = (MPI_Offset) (nsnap - 1) * gsizes[0] * gsizes[1] * gsizes[2]
+        * (MPI_Offset) sizeof(float);
+    MPI_Type_create_subarray(3, gsizes, lsizes, starts, MPI_ORDER_C,
+            MPI_FLOAT, &block);
+    MPI_Type_commit(&block);
+    MPI_File_set_view(fh, disp, MPI_FLOAT, block, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, (void *) buf, n, MPI_FLOAT, MPI_STATUS_IGNORE);
+    MPI_Type_free(&block);
+    MPI_File_close(&fh);
+}
+
+
+/*
+ * Write the samples of one snapshot component to the file of this PE.
+ * Binary snapshots are written at the position of snapshot `nsnap`, so
+ * that a run resumed from a checkpoint overwrites the snapshots written
+ * after the checkpoint. Binary snapshots are compressed with
+ * SNAP_COMPRESS>0. Does not call MPI, so that it can be used by the I/O
+ * thread.
+ *
+ * Returns
+ * -------
+ * 1 on success, 0 if the file could not be opened or written.
+ */
+int snap_write_pe(const char *pefile, int nsnap, int format,
+        const float *buf, int nxs, int nys, int nzs)
+{
+    extern int SNAP_COMPRESS;
+
+    FILE *fpout;
+    int n = nxs * nys * nzs, ok;
+
+    if ((format == 3) && SNAP_COMPRESS)
+        return snap_compress_pe(pefile, nsnap, buf, nxs, nys, nzs);
+
+    if ((format == 3) && (nsnap > 1)) {
+        fpout = fopen(pefile, "r+");
+        if (fpout == NULL) return 0;
+        if (fseek(fpout, (long) (nsnap - 1) * n * (long) sizeof(float),
+                    SEEK_SET)) {
+            fclose(fpout);
+            return 0;
+        }
+    } else {
+        fpout = fopen(pefile, (nsnap == 1) ? "w" : "a");
+        if (fpout == NULL) return 0;
+    }
+    writedsk_block(fpout, buf, n, format);
+    ok = !ferror(fpout);
+    if (fclose(fpout) != 0) ok = 0;
+    return ok;
+}
+
+
+/*
+ * Copy the samples a[ny1..ny2:idy][nx1..nx2:idx][nz1..nz2:idz] of a field
+ * into the buffer of snap_write().
+ */
+void snap_copy(float *buf, float ***a, int idx, int idy, int idz,
+        int nx1, int ny1, int nz1, int nx2, int ny2, int nz2)
+{
+    int i, j, k, m = 0;
+
+    for (k = nz1; k <= nz2; k += idz)
+        for (i = nx1; i <= nx2; i += idx)
+            for (j = ny1; j <= ny2; j += idy)
+                buf[m++] = a[j][i][k];
+}
@@ -7,6 +7,9 @@
 
 #include "fd.h"
 #include "globvar.h" /* definition of global variables  */
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 void _usage()
@@ -36,9 +39,11 @@ static int snapmerge(int argc, char **argv)
     FILE *fp_param;
 
     _usage();
-    if (argc != 2) {
+    if ((argc != 2) && (argc != 3)) {
         printf("USAGE:\n");
-        printf("    snapmerge <path-to-parameter-file>\n");
+        printf("    snapmerge <path-to-parameter-file> [<number-of-PEs>]\n");
+        printf("The number of PEs of the simulation is required if NPROCX,\n"
+               "NPROCY or NPROCZ is 0 (automatic domain decomposition).\n");
         exit(1);
     }
 
@@ -61,12 +66,19 @@ static int snapmerge(int argc, char **argv)
     //read json formated input file
     read_par_json(FP, fileinp);
 
+    /* number of PEs along the axes as chosen by the simulation */
+    if (!NPROCX || !NPROCY || !NPROCZ) {
+        if (argc != 3)
+            err("NPROCX, NPROCY or NPROCZ is 0, please give the number of "
+                "PEs of the simulation as second argument");
+        decomp_procs(atoi(argv[2]), 3 * FDORDER - 3);
+    }
+
     NXG = NX;
     NYG = NY;
     NZG = NZ;
-    NX = NXG / NPROCX;
-    NY = NYG / NPROCY;
-    NZ = NZG / NPROCZ;
+    /* sub grids of the PEs as in the simulation */
+    decomp(NXG, NYG, NZG);
 
     if (TSNAP2 > TIME) {
         fprintf(FP,
@@ -76,6 +88,17 @@ static int snapmerge(int argc, char **argv)
         TSNAP2 = TIME;
     }
 
+    if (SNAP_MPIIO) {
+        printf("SNAP_MPIIO=1: the snapshots were written to merged files "
+               "during the simulation, nothing to do.\n");
+        return 0;
+    }
+    if (SNAP_PLAN[0]) {
+        printf("SNAP_PLAN: the planes and boxes were written to merged files "
+               "during the simulation, nothing to do.\n");
+        return 0;
+    }
+
     nsnap = 1 + floor((TSNAP2 - TSNAP1) / TSNAPINC);
     fprintf(FP, "Number of snapshots to be saved: nsnap = %d\n", nsnap);
 
@@ -110,5 +133,9 @@ static int snapmerge(int argc, char **argv)
 
 int main(int argc, char **argv)
 {
+#ifdef _OPENMP
+    /* serial program, the threaded allocation in util.c uses one thread */
+    omp_set_num_threads(1);
+#endif
     snapmerge(argc, argv);
 }
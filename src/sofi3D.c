@@ -11,9 +11,13 @@
  *
  *  ----------------------------------------------------------------------*/
 #include "data_structures.h"
+#include "enum.h"
 #include "fd.h"
 #include "globvar.h"
 //#include "openacc.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 int main(int argc, char **argv)
@@ -22,8 +26,13 @@ int main(int argc, char **argv)
     int RTM_FLAG = 0;
     int ns, nt, nseismograms = 0, nf1, nf2;
     int lsnap, nsnap = 0, lsamp = 0, nlsamp = 0, buffsize;
+    int nsec, seis_stream;
     int ntr = 0, ntr_loc = 0, ntr_glob = 0, nsrc = 0, nsrc_loc = 0;
     int ishot, nshots;
+    /* state saved in checkpoints, first shot and time step after reading a
+       checkpoint and shot whose wavefield is restored from it */
+    Checkpoint ckpt;
+    int ishot0 = 1, nt0 = 1, ckpt_shot = 0, ckpt_continue = 0;
 
     // Sizes of arrays containing 3D data.
     // "R" - rows, "C" - columns, "D" - depth.
@@ -37,7 +46,11 @@ int main(int argc, char **argv)
     double *time_v_update, *time_s_update, *time_s_exchange, *time_v_exchange, *time_timestep;
     int *xb, *yb, *zb, l;
 
-    float ***absorb_coeff = NULL;
+    /* Absorbing frame (ABS_TYPE=2). */
+    AbsorbFrame absorb_frame;
+    /* Boxes of the CPML frame (ABS_TYPE=1). */
+    CpmlBox cpml[27];
+    int ncpml = 0;
 
     /* Stress tensor. */
     Tensor3d s;
@@ -85,6 +98,8 @@ int main(int argc, char **argv)
     float ***C66ipjp, ***C44jpkp, ***C55ipkp, ***tausipjp = NULL, ***tausjpkp = NULL, ***tausipkp = NULL, ***rjp, ***rkp, ***rip;
 
     OrthoPar op;
+    OrthoPar16 op16;
+    MatTable mtab;
 
     // Global sources positions, local sources positions.
     float **srcpos = NULL, **srcpos_loc = NULL, **srcpos1 = NULL;
@@ -109,6 +124,28 @@ int main(int argc, char **argv)
     float ***sbuffertop_to_bot, ***sbufferbot_to_top;
     float ***sbufferfro_to_bac, ***sbufferbac_to_fro;
 
+    // Receive buffers and requests for the non-blocking exchange
+    // (OVERLAP_COMM, PERSISTENT_COMM).
+    float ***rbufferlef_to_rig = NULL, ***rbufferrig_to_lef = NULL;
+    float ***rbuffertop_to_bot = NULL, ***rbufferbot_to_top = NULL;
+    float ***rbufferfro_to_bac = NULL, ***rbufferbac_to_fro = NULL;
+    float ***rsbufferlef_to_rig = NULL, ***rsbufferrig_to_lef = NULL;
+    float ***rsbuffertop_to_bot = NULL, ***rsbufferbot_to_top = NULL;
+    float ***rsbufferfro_to_bac = NULL, ***rsbufferbac_to_fro = NULL;
+    MPI_Request vreq[2 * REQUEST_COUNT], sreq[2 * REQUEST_COUNT];
+
+    // Boundary shell and core of the local grid (OVERLAP_COMM),
+    // see split_shell.c. Index 6 of the boxes is the core.
+    int vw[7], sw[7], b;
+    GridBox vbox[7], sbox[7], ssrcbox[2];
+    // Sources of the velocity boxes; stress sources of shell (0) and core (1).
+    PointSources vsrc[7], ssrc[2];
+    // Cache tiles of the core (OVERLAP_COMM) or of the whole local grid,
+    // see tiles.c, and the velocity sources of the tiles.
+    int tile[4], nvtile = 0, nstile = 0;
+    GridBox vmain, smain, *vtile = NULL, *stile = NULL;
+    PointSources *vtsrc = NULL;
+
     // Seismogram data collected from all MPI processes.
     float **seismo_fulldata = NULL;
     int *recswitch = NULL;
@@ -132,7 +169,9 @@ int main(int argc, char **argv)
     // MYID is initialized to the index of the process (from 0 to NP-1).
     extern int NP;
     extern int MYID;
-    MPI_Init(&argc, &argv);
+    // Only the master thread calls MPI (THREADS > 1).
+    int thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
     MPI_Comm_size(MPI_COMM_WORLD, &NP);
     MPI_Comm_rank(MPI_COMM_WORLD, &MYID);
 
@@ -178,6 +217,14 @@ int main(int argc, char **argv)
     /* PE 0 will broadcast the parameters to all others PEs */
     exchange_par();
 
+    /* Set the number of threads before any wavefield is allocated,
+       so that the pages are first touched by the thread updating them. */
+#ifdef _OPENMP
+    if ((THREADS > 1) && (thread_level < MPI_THREAD_FUNNELED) && (MYID == 0))
+        warning("The MPI library does not support MPI_THREAD_FUNNELED.");
+    omp_set_num_threads(THREADS);
+#endif
+
     /* Print info on log-files to stdout */
     if (MYID == 0)
         note(stdout);
@@ -211,7 +258,9 @@ int main(int argc, char **argv)
 
     fprintf(FP, " This is the log-file generated by PE %d \n\n", MYID);
 
-    /* domain decomposition */
+    /* domain decomposition, NPROCX, NPROCY or NPROCZ set to 0 are chosen
+       for the nf1+nf2 values exchanged per grid point of a face (see below) */
+    decomp_procs(NP, 3 * FDORDER - 3);
     initproc();
 
     /* set some time counters */
@@ -233,10 +282,25 @@ int main(int argc, char **argv)
         err(" Check Sampling rate for seismogram output (NDT)!");
     }
 
+    /* samples per trace held in memory, the sections are written to disk in
+       blocks of nsec samples if SEIS_BLOCK is smaller than ns (seis_stream.c) */
+    seis_stream = (SEISMO && (SEIS_BLOCK > 0) && (SEIS_BLOCK < ns));
+    nsec = (seis_stream) ? SEIS_BLOCK : ns;
+
     /* output of parameters to stdout: */
     if (MYID == 0)
         writepar(FP, ns);
 
+    /* vectorized kernels are only available for the elastic case with
+       FDORDER_TIME=2, see update_simd.c */
+    if ((MYID == 0) && (L == 0) && (FDORDER_TIME == 2))
+    {
+        if (simd_level() == SIMD_AVX512)
+            fprintf(FP, " Using AVX-512 kernels for the update of stress and particle velocities.\n");
+        else if (simd_level() == SIMD_AVX2)
+            fprintf(FP, " Using AVX2 kernels for the update of stress and particle velocities.\n");
+    }
+
     /* NXG, NYG NZG denote size of the entire (global) grid */
     NXG = NX;
     NYG = NY;
@@ -247,6 +311,16 @@ int main(int argc, char **argv)
     NY = IENDY;
     NZ = IENDZ;
 
+    /* tile sizes for the update loops */
+    if (TILE_AUTO)
+        tile_auto();
+    tile[1] = TILE_X;
+    tile[2] = TILE_Y;
+    tile[3] = TILE_Z;
+    if ((MYID == 0) && (TILE_X || TILE_Y || TILE_Z))
+        fprintf(FP, " Update loops are split into tiles of %d x %d x %d grid points (0 = whole subdomain).\n",
+                TILE_X, TILE_Y, TILE_Z);
+
     /* compute receiver locations within each subgrid and
        store local receiver coordinates in recpos_loc */
     if (SEISMO)
@@ -328,9 +402,14 @@ int main(int argc, char **argv)
         }
     }
 
-    memseismograms = nseismograms * ntr_glob * ns * fac2 + nseismograms * ntr * ns * fac2;
+    /* local sections, and the global section collected on PE 0 */
+    memseismograms = nseismograms * ntr * nsec * fac2;
+    if ((SEISMO) && (MYID == 0) && (!seis_stream) && (!SEIS_MPIIO))
+        memseismograms += ntr_glob * ns * fac2;
     membuffer = (2.0 * (3.0 * FDORDER / 2 - 1) * (NY * NZ + NX * NZ + NY * NX) + 2.0 * (3.0 * FDORDER / 2 - 2) * (NY * NZ + NX * NZ + NY * NX)) * fac2;
     membuffer = 4.0 * 6.0 * ((NX * NZ) + (NY * NZ) + (NX * NY)) * fac2;
+    if ((OVERLAP_COMM) || (PERSISTENT_COMM))
+        membuffer *= 2.0;
     if (ABS_TYPE == 1)
         memcpml = 2.0 * FW * 6.0 * (NY * NZ + NX * NZ + NY * NX) * fac2 + 24.0 * 2.0 * FW * fac2;
     buffsize = (FDORDER)*4.0 * 6.0 * (max((NX * NZ), max((NY * NZ), (NX * NY)))) * sizeof(MPI_FLOAT);
@@ -409,13 +488,13 @@ int main(int argc, char **argv)
         }
     }
 
-    s.xy = f3tensor(NRL, NRH, NCL, NCH, NDL, NDH);
-    s.yz = f3tensor(NRL, NRH, NCL, NCH, NDL, NDH);
+    s.xy = f3tensor_aligned(NRL, NRH, NCL, NCH, NDL, NDH);
+    s.yz = f3tensor_aligned(NRL, NRH, NCL, NCH, NDL, NDH);
 
-    s.xz = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.xx = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.yy = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.zz = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    s.xz = f3tensor_aligned(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    s.xx = f3tensor_aligned(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    s.yy = f3tensor_aligned(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    s.zz = f3tensor_aligned(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
 
     xb = ivector(0, 1);
     yb = ivector(0, 1);
@@ -439,40 +518,38 @@ int main(int argc, char **argv)
         }
 
         /* memory allocation for static (model) arrays */
-        taus = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        taup = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        tausipjp = f3tensor(1, NY, 1, NX, 1, NZ);
-        tausjpkp = f3tensor(1, NY, 1, NX, 1, NZ);
-        tausipkp = f3tensor(1, NY, 1, NX, 1, NZ);
+        taus = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        taup = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        tausipjp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+        tausjpkp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+        tausipkp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
         eta = vector(1, L);
     }
 
     /* memory allocation for static (model) arrays */
-    rho = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    pi = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    rho = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    pi = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
     // adding Cij variables by VK
-    C11 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C12 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C13 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C22 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C23 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C33 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C44 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C55 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C66 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C11 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C12 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C13 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C22 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C23 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C33 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C44 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C55 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    C66 = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
 
     // still keeping u = mu and pi = lambda + 2*mu (just in case) ;)
-    u = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-
-    absorb_coeff = f3tensor(1, NY, 1, NX, 1, NZ);
+    u = f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1);
 
     /* averaged material parameters */
-    C66ipjp = f3tensor(1, NY, 1, NX, 1, NZ);
-    C44jpkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    C55ipkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rjp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rip = f3tensor(1, NY, 1, NX, 1, NZ);
+    C66ipjp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+    C44jpkp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+    C55ipkp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+    rjp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+    rkp = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
+    rip = f3tensor_aligned(1, NY, 1, NX, 1, NZ);
 
     /* memory allocation for CPML variables*/
     if (ABS_TYPE == 1)
@@ -545,8 +622,25 @@ int main(int argc, char **argv)
     sbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf2);
     sbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf1);
 
+    if ((OVERLAP_COMM) || (PERSISTENT_COMM))
+    {
+        rbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf1);
+        rbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf2);
+        rbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf1);
+        rbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf2);
+        rbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf1);
+        rbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf2);
+
+        rsbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf2);
+        rsbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf1);
+        rsbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf2);
+        rsbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf1);
+        rsbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf2);
+        rsbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf1);
+    }
+
     /* allocate buffer for seismogram output, merged seismogram section of all PEs */
-    if (SEISMO)
+    if ((SEISMO) && (MYID == 0) && (!seis_stream) && (!SEIS_MPIIO))
         seismo_fulldata = fmatrix(1, ntr_glob, 1, ns);
 
     /* allocate buffer for seismogram output, seismogram section of each PE */
@@ -555,33 +649,64 @@ int main(int argc, char **argv)
         switch (SEISMO)
         {
             case 1: /* particle velocities only */
-                sectionvx = fmatrix(1, ntr, 1, ns);
-                sectionvy = fmatrix(1, ntr, 1, ns);
-                sectionvz = fmatrix(1, ntr, 1, ns);
+                sectionvx = fmatrix(1, ntr, 1, nsec);
+                sectionvy = fmatrix(1, ntr, 1, nsec);
+                sectionvz = fmatrix(1, ntr, 1, nsec);
                 break;
             case 2: /* pressure only */
-                sectionp = fmatrix(1, ntr, 1, ns);
+                sectionp = fmatrix(1, ntr, 1, nsec);
                 break;
             case 3: /* curl and div only */
-                sectioncurl = fmatrix(1, ntr, 1, ns);
-                sectiondiv = fmatrix(1, ntr, 1, ns);
+                sectioncurl = fmatrix(1, ntr, 1, nsec);
+                sectiondiv = fmatrix(1, ntr, 1, nsec);
                 break;
             case 4: /* everything */
-                sectionvx = fmatrix(1, ntr, 1, ns);
-                sectionvy = fmatrix(1, ntr, 1, ns);
-                sectionvz = fmatrix(1, ntr, 1, ns);
-                sectioncurl = fmatrix(1, ntr, 1, ns);
-                sectiondiv = fmatrix(1, ntr, 1, ns);
-                sectionp = fmatrix(1, ntr, 1, ns);
+                sectionvx = fmatrix(1, ntr, 1, nsec);
+                sectionvy = fmatrix(1, ntr, 1, nsec);
+                sectionvz = fmatrix(1, ntr, 1, nsec);
+                sectioncurl = fmatrix(1, ntr, 1, nsec);
+                sectiondiv = fmatrix(1, ntr, 1, nsec);
+                sectionp = fmatrix(1, ntr, 1, nsec);
                 break;
         }
     }
+
+    memset(&ckpt, 0, sizeof(ckpt));
+    ckpt.v = &v;
+    ckpt.s = &s;
+    ckpt.r = &r;
+    ckpt.r_2 = &r_2;
+    ckpt.r_3 = &r_3;
+    ckpt.r_4 = &r_4;
+    ckpt.dv_2 = &dv_2;
+    ckpt.dv_3 = &dv_3;
+    ckpt.dv_4 = &dv_4;
+    ckpt.ds_dv_2 = &ds_dv_2;
+    ckpt.ds_dv_3 = &ds_dv_3;
+    ckpt.ds_dv_4 = &ds_dv_4;
+    {
+        float ***psi[18] = {psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_vxx, psi_vyx, psi_vzx,
+            psi_sxy_y, psi_syy_y, psi_syz_y, psi_vxy, psi_vyy, psi_vzy,
+            psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxz, psi_vyz, psi_vzz};
+        memcpy(ckpt.psi, psi, sizeof(psi));
+    }
+    ckpt.section[0] = sectionvx;
+    ckpt.section[1] = sectionvy;
+    ckpt.section[2] = sectionvz;
+    ckpt.section[3] = sectionp;
+    ckpt.section[4] = sectiondiv;
+    ckpt.section[5] = sectioncurl;
+    ckpt.ntr = ntr;
+    ckpt.ns = nsec;
+
     int irtm;
     for (irtm = 0; irtm <= RTM_FLAG; irtm++)
     {
         if (irtm>0)
         {
             lsnap =  iround(TSNAP1 / DT);
+            ishot0 = nt0 = 1;
+            ckpt_shot = ckpt_continue = 0;
         }
         if (MYID == 0)
             fprintf(FP, " ... memory allocation for PE %d was successfull.\n\n", MYID);
@@ -697,11 +822,11 @@ int main(int argc, char **argv)
             CPML_coeff(K_x, alpha_prime_x, a_x, b_x, K_x_half, alpha_prime_x_half, a_x_half, b_x_half, K_y, alpha_prime_y, a_y, b_y, K_y_half, alpha_prime_y_half, a_y_half, b_y_half, K_z, alpha_prime_z, a_z, b_z, K_z_half, alpha_prime_z_half, a_z_half, b_z_half);
         }
 
-        /* calculate 3-D array for exponential damping of reflections
-           at the edges of the numerical mesh */
-        if (ABS_TYPE == 2)
+        /* calculate the profiles for exponential damping of reflections
+           at the edges of the numerical mesh, they do not change with irtm */
+        if ((ABS_TYPE == 2) && (irtm == 0))
         {
-            absorb(absorb_coeff);
+            absorb(&absorb_frame, 0);
         }
 
         /* For the calculation of the material parameters between gridpoints
@@ -715,7 +840,7 @@ int main(int argc, char **argv)
 
         MPI_Barrier(MPI_COMM_WORLD);
 
-        if (CHECKPTREAD)
+        if (CHECKPTREAD && (irtm == 0))
         {
             if (MYID == 0)
             {
@@ -723,30 +848,48 @@ int main(int argc, char **argv)
                 fprintf(FP, " Reading wavefield from check-point file %s \n", CHECKPTFILE);
             }
 
-            read_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
-                    psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
-                    psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+            if (read_checkpoint(&ckpt) < NT)
+            {
+                /* resume the interrupted shot after the saved time step */
+                ishot0 = ckpt_shot = ckpt.ishot;
+                nt0 = ckpt.nt + 1;
+                lsnap = ckpt.lsnap;
+                nsnap = ckpt.nsnap;
+            }
+            else
+            {
+                /* continue the propagation of the final wavefield without sources */
+                ckpt_continue = 1;
+            }
             MPI_Barrier(MPI_COMM_WORLD);
             if (MYID == 0)
             {
                 time4 = MPI_Wtime();
                 fprintf(FP, " finished (real time: %4.2f s).\n", time4 - time3);
+                if (!ckpt_continue)
+                    fprintf(FP, " Resuming shot %d at time step %d.\n", ishot0, nt0);
             }
         }
 
         /* comunication initialisation for persistent communication */
-        /*comm_ini(bufferlef_to_rig, bufferrig_to_lef,
-          buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac,
-          bufferbac_to_fro, req_send, req_rec);
-
-          comm_ini_s(sbufferlef_to_rig, sbufferrig_to_lef,
-          sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-          sbufferbac_to_fro, sreq_send, sreq_rec);*/
+        if (PERSISTENT_COMM)
+        {
+            comm_ini(nf1, nf2, bufferlef_to_rig, bufferrig_to_lef,
+                    buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+                    rbufferlef_to_rig, rbufferrig_to_lef,
+                    rbuffertop_to_bot, rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+
+            comm_ini(nf2, nf1, sbufferlef_to_rig, sbufferrig_to_lef,
+                    sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro,
+                    rsbufferlef_to_rig, rsbufferrig_to_lef,
+                    rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+        }
 
         /* initialisation of PML and ABS domain */
         if (ABS_TYPE == 1)
         {
             CPML_ini_elastic(xb, yb, zb);
+            ncpml = CPML_boxes(xb, yb, zb, 0, cpml);
         }
 
         if (ABS_TYPE == 2)
@@ -786,8 +929,108 @@ int main(int argc, char **argv)
         op.C44jpkp = C44jpkp;
         op.C55ipkp = C55ipkp;
 
+        /* 16-bit storage of the material parameters of the vectorized
+           kernels; the FP32 stiffnesses are only kept for the CPML frame,
+           the density is still needed by the force sources in update_v() */
+        if (MAT_PRECISION != MAT_FP32)
+        {
+            if ((L > 0) || (FDORDER_TIME != 2) || (simd_level() == SIMD_NONE))
+            {
+                if (MYID == 0)
+                    warning("MAT_PRECISION > 0 requires L=0, FDORDER_TIME=2 and the AVX2/AVX-512 kernels, using FP32 material parameters.");
+                MAT_PRECISION = MAT_FP32;
+            }
+            else
+            {
+                mat16_pack(&op, rjp, rkp, rip, &op16, MAT_PRECISION);
+                if (!update_simd_mat16(&op16))
+                    err("No vector kernel for MAT_PRECISION=%d on this CPU.", MAT_PRECISION);
+                if (ABS_TYPE != 1)
+                {
+                    free_f3tensor_aligned(C11, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C12, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C13, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C22, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C23, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C33, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C66ipjp, 1, NY, 1, NX, 1, NZ);
+                    free_f3tensor_aligned(C44jpkp, 1, NY, 1, NX, 1, NZ);
+                    free_f3tensor_aligned(C55ipkp, 1, NY, 1, NX, 1, NZ);
+                    C11 = C12 = C13 = C22 = C23 = C33 = NULL;
+                    C66ipjp = C44jpkp = C55ipkp = NULL;
+                    op.C11 = op.C12 = op.C13 = op.C22 = op.C23 = op.C33 = NULL;
+                    op.C66ipjp = op.C44jpkp = op.C55ipkp = NULL;
+                }
+                if (MYID == 0)
+                    fprintf(FP, " Material parameters of the update kernels stored with 16 bits (MAT_PRECISION=%d).\n",
+                            MAT_PRECISION);
+            }
+        }
+
+        /* table of distinct media plus index volume for the vectorized
+           kernels; C44, C55, C66 and rho are not read in the time loop,
+           the FP32 stiffnesses are only kept for the CPML frame and the
+           density for the force sources in update_v() */
+        mtab.nmedia = 0;
+        if (MAT_COMPRESS)
+        {
+            if ((L > 0) || (FDORDER_TIME != 2) || (simd_level() == SIMD_NONE))
+            {
+                if (MYID == 0)
+                    warning("MAT_COMPRESS=1 requires L=0, FDORDER_TIME=2 and the AVX2/AVX-512 kernels, using dense material parameters.");
+                MAT_COMPRESS = 0;
+            }
+            else if (!mat_table_build(&op, rjp, rkp, rip, &mtab))
+            {
+                fprintf(FP, " PE %d: more than %d media, using dense material parameters.\n",
+                        MYID, MAT_MEDIA_MAX);
+            }
+            else
+            {
+                if (!update_simd_table(&mtab))
+                    err("No vector kernel for MAT_COMPRESS=1 on this CPU.");
+                free_f3tensor_aligned(C44, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                free_f3tensor_aligned(C55, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                free_f3tensor_aligned(C66, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                free_f3tensor_aligned(rho, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                C44 = C55 = C66 = rho = NULL;
+                op.C44 = op.C55 = op.C66 = op.rho = NULL;
+                if (ABS_TYPE != 1)
+                {
+                    free_f3tensor_aligned(C11, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C12, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C13, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C22, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C23, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C33, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                    free_f3tensor_aligned(C66ipjp, 1, NY, 1, NX, 1, NZ);
+                    free_f3tensor_aligned(C44jpkp, 1, NY, 1, NX, 1, NZ);
+                    free_f3tensor_aligned(C55ipkp, 1, NY, 1, NX, 1, NZ);
+                    C11 = C12 = C13 = C22 = C23 = C33 = NULL;
+                    C66ipjp = C44jpkp = C55ipkp = NULL;
+                    op.C11 = op.C12 = op.C13 = op.C22 = op.C23 = op.C33 = NULL;
+                    op.C66ipjp = op.C44jpkp = op.C55ipkp = NULL;
+                }
+                fprintf(FP, " PE %d: %d media, index volume with %d byte(s) per grid point (MAT_COMPRESS=1).\n",
+                        MYID, mtab.nmedia, (mtab.idx8 != NULL) ? 1 : 2);
+            }
+        }
+
+        for (b = 0; b < 7; b++)
+            vsrc[b].nsrc = 0;
+        ssrc[0].nsrc = ssrc[1].nsrc = 0;
+
+        /* planes and boxes of the snapshots (SNAP_PLAN) */
+        if (SNAP)
+            snap_plan_init(FP);
+
+        /* I/O thread for the snapshots (SNAP_ASYNC=1) */
+        snap_async_start();
+
         for (ishot = 1; ishot <= nshots; ishot++)
         {
+            if (ishot < ishot0)
+                continue;
             fprintf(FP, "\n MYID=%d *****  Starting simulation for shot %d of %d  ********** \n", MYID, ishot, nshots);
             for (nt = 1; nt <= 6; nt++)
                 srcpos1[nt][1] = srcpos[nt][ishot];
@@ -821,8 +1064,73 @@ int main(int argc, char **argv)
                 output_source_signal(fopen(source_signal_file, "w"), signals, NT, 1);
             }
 
+            /* split the local grid into boundary shell and core */
+            if (OVERLAP_COMM)
+            {
+                free_shell_sources(7, vsrc);
+                free_shell_sources(2, ssrc);
+
+                shell_width(vw, 0);
+                shell_boxes(xb, yb, zb, vw, vbox);
+                shell_sources(7, vbox, 0, srcpos_loc, signals, nsrc_loc, stype_loc, vsrc);
+
+                /* the free surface reads the stresses down to row FDORDER/2+1 */
+                shell_width(sw, ((FREE_SURF) && (POS[2] == 0)) ? FDORDER / 2 + 1 : 0);
+                shell_fit_sources(xb, yb, zb, sw, srcpos_loc, nsrc_loc);
+                shell_boxes(xb, yb, zb, sw, sbox);
+
+                /* box 0 is empty, stress sources outside the core go to the shell */
+                ssrcbox[0].nx1 = ssrcbox[0].ny1 = ssrcbox[0].nz1 = 1;
+                ssrcbox[0].nx2 = ssrcbox[0].ny2 = ssrcbox[0].nz2 = 0;
+                ssrcbox[1] = sbox[6];
+                shell_sources(2, ssrcbox, 1, srcpos_loc, signals, nsrc_loc, stype_loc, ssrc);
+            }
+
+            /* split the core or the whole local grid into cache tiles */
+            if (nvtile > 1)
+                free_shell_sources(nvtile, vtsrc);
+            free(vtsrc);
+            free(vtile);
+            free(stile);
+            if (OVERLAP_COMM)
+            {
+                vmain = vbox[6];
+                smain = sbox[6];
+            }
+            else
+            {
+                vmain.nx1 = smain.nx1 = xb[0];
+                vmain.nx2 = smain.nx2 = xb[1];
+                vmain.ny1 = smain.ny1 = yb[0];
+                vmain.ny2 = smain.ny2 = yb[1];
+                vmain.nz1 = smain.nz1 = zb[0];
+                vmain.nz2 = smain.nz2 = zb[1];
+            }
+            nvtile = tile_boxes(&vmain, tile, &vtile);
+            nstile = tile_boxes(&smain, tile, &stile);
+            vtsrc = (PointSources *)malloc(nvtile * sizeof(PointSources));
+            if (vtsrc == NULL)
+                err("allocation failure for the sources of the tiles");
+            if (nvtile > 1)
+            {
+                if (OVERLAP_COMM)
+                    shell_sources(nvtile, vtile, 0, vsrc[6].srcpos, vsrc[6].signals, vsrc[6].nsrc, vsrc[6].stype, vtsrc);
+                else
+                    shell_sources(nvtile, vtile, 0, srcpos_loc, signals, nsrc_loc, stype_loc, vtsrc);
+            }
+            else if (OVERLAP_COMM)
+                vtsrc[0] = vsrc[6];
+            else
+            {
+                /* a single tile uses the sources of the subdomain, no copy */
+                vtsrc[0].srcpos = srcpos_loc;
+                vtsrc[0].signals = signals;
+                vtsrc[0].nsrc = nsrc_loc;
+                vtsrc[0].stype = stype_loc;
+            }
+
             /* initialize wavefield with zero */
-            if ((L == 1) && (ABS_TYPE == 2) && (CHECKPTREAD == 0))
+            if ((L == 1) && (ABS_TYPE == 2) && (!ckpt_continue && (ishot != ckpt_shot)))
             {
                 zero(1 - FDORDER / 2, NX + FDORDER / 2, 1 - FDORDER / 2, NY + FDORDER / 2, 1 - FDORDER / 2, NZ + FDORDER / 2, &v, &s, &dv,
                         &dv_2, &dv_3, &dv_4,
@@ -830,14 +1138,14 @@ int main(int argc, char **argv)
                         &r, &r_2, &r_3, &r_4);
             }
 
-            if ((L == 0) && (ABS_TYPE == 2) && (CHECKPTREAD == 0))
+            if ((L == 0) && (ABS_TYPE == 2) && (!ckpt_continue && (ishot != ckpt_shot)))
             {
                 zero_elastic(1 - FDORDER / 2, NX + FDORDER / 2, 1 - FDORDER / 2, NY + FDORDER / 2, 1 - FDORDER / 2, NZ + FDORDER / 2,
                         &v, &s,
                         &dv, &dv_2, &dv_3, &dv_4,
                         &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
             }
-            if ((ABS_TYPE == 1) && (CHECKPTREAD == 0))
+            if ((ABS_TYPE == 1) && (!ckpt_continue && (ishot != ckpt_shot)))
             {
                 zero_elastic_CPML(NX, NY, NZ, &v, &s, &r,
                         psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz,
@@ -849,6 +1157,11 @@ int main(int argc, char **argv)
 
             lsamp = NDTSHIFT + 1;
             nlsamp = 1;
+            if (ishot == ckpt_shot)
+            {
+                lsamp = ckpt.lsamp;
+                nlsamp = ckpt.nlsamp;
+            }
 
 
 
@@ -891,7 +1204,11 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
 
 
 
-            for (nt = 1; nt <= NT; nt++)
+            for (nt = 1; nt < ((ishot == ckpt_shot) ? nt0 : 1); nt++)
+                time_v_update[nt] = time_s_update[nt] = time_v_exchange[nt]
+                    = time_s_exchange[nt] = time_timestep[nt] = 0.0;
+
+            for (; nt <= NT; nt++)
             {
                 time_v_update[nt] = 0.0;
                 time_s_update[nt] = 0.0;
@@ -910,14 +1227,27 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
                     }
 
                 /* update of particle velocities */
-                time_v_update[nt] = update_v(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt,
-                        &v, &s,
-                        rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, absorb_coeff, stype_loc,
-                        &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                if (OVERLAP_COMM)
+                {
+                    /* boundary shell first, the core is updated during the exchange */
+                    for (b = 0; b < 6; b++)
+                        time_v_update[nt] += update_v(vbox[b].nx1, vbox[b].nx2, vbox[b].ny1, vbox[b].ny2, vbox[b].nz1, vbox[b].nz2, nt,
+                                &v, &s,
+                                rjp, rkp, rip, vsrc[b].srcpos, vsrc[b].signals, vsrc[b].nsrc, &absorb_frame, vsrc[b].stype,
+                                &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                }
+                else
+                {
+                    for (b = 0; b < nvtile; b++)
+                        time_v_update[nt] += update_v(vtile[b].nx1, vtile[b].nx2, vtile[b].ny1, vtile[b].ny2, vtile[b].nz1, vtile[b].nz2, nt,
+                                &v, &s,
+                                rjp, rkp, rip, vtsrc[b].srcpos, vtsrc[b].signals, vtsrc[b].nsrc, &absorb_frame, vtsrc[b].stype,
+                                &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                }
 
                 if (ABS_TYPE == 1)
                 {
-                    update_v_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                    update_v_CPML(ncpml, cpml, nt, &v,
                             &s,
                             rjp, rkp, rip,
                             K_x, a_x, b_x, K_x_half, a_x_half, b_x_half,
@@ -926,6 +1256,30 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
                             psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z);
                 };
 
+                if (OVERLAP_COMM)
+                {
+                    time_v_exchange[nt] = exchange_v_start(
+                            nt, &v,
+                            bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+                            bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+                            rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                            rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+
+                    for (b = 0; b < nvtile; b++)
+                        time_v_update[nt] += update_v(vtile[b].nx1, vtile[b].nx2, vtile[b].ny1, vtile[b].ny2, vtile[b].nz1, vtile[b].nz2, nt,
+                                &v, &s,
+                                rjp, rkp, rip, vtsrc[b].srcpos, vtsrc[b].signals, vtsrc[b].nsrc, &absorb_frame, vtsrc[b].stype,
+                                &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                }
+
+                /* damping of the stresses after the velocity stencil has read them */
+                if (ABS_TYPE == 2)
+                    absorb_s(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], &s, &absorb_frame);
+
+                if (LOG)
+                    if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                        fprintf(FP, " Real time for particle velocity update: \t %4.2f s.\n", time_v_update[nt]);
+
                 // Shift spatial derivatives of the stress one time step back.
                 if (FDORDER_TIME == 4)
                 {
@@ -963,42 +1317,151 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
 
                 /* exchange values of particle velocities at grid boundaries between PEs */
 
-                time_v_exchange[nt] = exchange_v(
-                        nt, &v,
-                        bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
-                        bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+                if ((!OVERLAP_COMM) && (PERSISTENT_COMM))
+                    time_v_exchange[nt] = exchange_v_start(
+                            nt, &v,
+                            bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+                            bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+                            rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                            rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+
+                if ((OVERLAP_COMM) || (PERSISTENT_COMM))
+                    time_v_exchange[nt] += exchange_v_finish(
+                            nt, &v,
+                            rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                            rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+                else
+                    time_v_exchange[nt] = exchange_v(
+                            nt, &v,
+                            bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+                            bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
 
                 /* update of components of stress tensor */
 
-                /* update NON PML boundaries */
-                if (L > 0)
+                if (OVERLAP_COMM)
                 {
-                    time_s_update[nt] = update_s(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                            &s, &r,
-                            pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta,
-                            &dv, &dv_2, &dv_3, &dv_4,
-                            &r_2, &r_3, &r_4);
-                    if (ABS_TYPE == 1)
-                        update_s_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                    /* boundary shell, its sources and the free surface first */
+                    for (b = 0; b < 6; b++)
+                    {
+                        if (L > 0)
+                            time_s_update[nt] += update_s(sbox[b].nx1, sbox[b].nx2, sbox[b].ny1, sbox[b].ny2, sbox[b].nz1, sbox[b].nz2, nt, &v,
+                                    &s, &r,
+                                    pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta,
+                                    &dv, &dv_2, &dv_3, &dv_4,
+                                    &r_2, &r_3, &r_4);
+                        else
+                            time_s_update[nt] += update_s_elastic(sbox[b].nx1, sbox[b].nx2, sbox[b].ny1, sbox[b].ny2, sbox[b].nz1, sbox[b].nz2, nt, &v,
+                                    &s,
+                                    pi, u, &op,
+                                    &dv, &dv_2, &dv_3, &dv_4);
+                    }
+                }
+                else
+                {
+                    /* update NON PML boundaries */
+                    for (b = 0; b < nstile; b++)
+                    {
+                        if (L > 0)
+                            time_s_update[nt] += update_s(stile[b].nx1, stile[b].nx2, stile[b].ny1, stile[b].ny2, stile[b].nz1, stile[b].nz2, nt, &v,
+                                    &s, &r,
+                                    pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta,
+                                    &dv, &dv_2, &dv_3, &dv_4,
+                                    &r_2, &r_3, &r_4);
+                        else
+                            time_s_update[nt] += update_s_elastic(stile[b].nx1, stile[b].nx2, stile[b].ny1, stile[b].ny2, stile[b].nz1, stile[b].nz2, nt, &v,
+                                    &s,
+                                    pi, u, &op,
+                                    &dv, &dv_2, &dv_3, &dv_4);
+                    }
+                }
+
+                if (ABS_TYPE == 1)
+                {
+                    if (L > 0)
+                        update_s_CPML(ncpml, cpml, nt, &v,
                                 &s, &r, pi, u,
                                 C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta, K_x, a_x, b_x, K_x_half, a_x_half,
                                 b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
                                 psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
-                }
-                else
-                {
-                    time_s_update[nt] = update_s_elastic(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                            &s,
-                            pi, u, &op,
-                            &dv, &dv_2, &dv_3, &dv_4);
-                    if (ABS_TYPE == 1)
-                        update_s_CPML_elastic(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                    else
+                        update_s_CPML_elastic(ncpml, cpml, nt, &v,
                                 &s, &op,
                                 K_x, a_x, b_x, K_x_half, a_x_half,
                                 b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
                                 psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
                 }
 
+                if (OVERLAP_COMM)
+                {
+                    if (!ckpt_continue)
+                    {
+                        psource(nt, &s, ssrc[0].srcpos, ssrc[0].signals, ssrc[0].nsrc, ssrc[0].stype);
+                        eqsource(nt, &s, ssrc[0].srcpos, ssrc[0].signals, ssrc[0].nsrc, ssrc[0].stype,
+                                amon, str, dip, rake);
+                        source_moment_tensor(nt, &s, ssrc[0].srcpos,
+                                ssrc[0].signals, ssrc[0].nsrc, ssrc[0].stype);
+                    }
+
+                    /* The memory variables are rotated below, after the core
+                     * update. The free surface must see the tensor which
+                     * becomes `r` by this rotation. */
+                    if ((FREE_SURF) && (POS[2] == 0))
+                    {
+                        if (L)
+                            surface(1, u, pi, taus, taup, eta, &s,
+                                    ((L == 1) && (FDORDER_TIME == 4)) ? &r_4 : ((L == 1) && (FDORDER_TIME == 3)) ? &r_3 : &r,
+                                    &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
+                        else
+                            surface_elastic(1, u, pi, &s, &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
+                    }
+
+                    time_s_exchange[nt] = exchange_s_start(
+                            nt, &s,
+                            sbufferlef_to_rig, sbufferrig_to_lef,
+                            sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
+                            sbufferbac_to_fro,
+                            rsbufferlef_to_rig, rsbufferrig_to_lef,
+                            rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                            rsbufferbac_to_fro, sreq);
+
+                    /* core of the subdomain and its sources */
+                    for (b = 0; b < nstile; b++)
+                    {
+                        if (L > 0)
+                            time_s_update[nt] += update_s(stile[b].nx1, stile[b].nx2, stile[b].ny1, stile[b].ny2, stile[b].nz1, stile[b].nz2, nt, &v,
+                                    &s, &r,
+                                    pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta,
+                                    &dv, &dv_2, &dv_3, &dv_4,
+                                    &r_2, &r_3, &r_4);
+                        else
+                            time_s_update[nt] += update_s_elastic(stile[b].nx1, stile[b].nx2, stile[b].ny1, stile[b].ny2, stile[b].nz1, stile[b].nz2, nt, &v,
+                                    &s,
+                                    pi, u, &op,
+                                    &dv, &dv_2, &dv_3, &dv_4);
+                    }
+
+                    if (!ckpt_continue)
+                    {
+                        psource(nt, &s, ssrc[1].srcpos, ssrc[1].signals, ssrc[1].nsrc, ssrc[1].stype);
+                        eqsource(nt, &s, ssrc[1].srcpos, ssrc[1].signals, ssrc[1].nsrc, ssrc[1].stype,
+                                amon, str, dip, rake);
+                        source_moment_tensor(nt, &s, ssrc[1].srcpos,
+                                ssrc[1].signals, ssrc[1].nsrc, ssrc[1].stype);
+                    }
+
+                    time_s_exchange[nt] += exchange_s_finish(
+                            nt, &s,
+                            rsbufferlef_to_rig, rsbufferrig_to_lef,
+                            rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                            rsbufferbac_to_fro, sreq);
+                }
+
+                if (LOG)
+                    if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                        fprintf(FP, " Real time for stress tensor update: \t\t %4.2f s.\n", time_s_update[nt]);
+
                 // Shift spatial derivatives of velocity one time step back.
                 if (FDORDER_TIME == 4)
                 {
@@ -1130,45 +1593,68 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
                     }
                 }
 
-                /* explosive source */
-                if (!CHECKPTREAD)
+                if (!OVERLAP_COMM)
                 {
-                    psource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc);
-                    /* eqsource is a implementation of moment tensor points sources. */
-                    eqsource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc,
-                            amon, str, dip, rake);
+                    /* explosive source */
+                    if (!ckpt_continue)
+                    {
+                        psource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc);
+                        /* eqsource is a implementation of moment tensor points sources. */
+                        eqsource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc,
+                                amon, str, dip, rake);
 
-                    source_moment_tensor(nt, &s, srcpos_loc,
-                            signals, nsrc_loc, stype_loc);
+                        source_moment_tensor(nt, &s, srcpos_loc,
+                                signals, nsrc_loc, stype_loc);
 
-                    source_random(nt, &s, source_field);
-                }
+                        source_random(nt, &s, source_field);
+                    }
 
-                /* stress free surface ? */
-                if ((FREE_SURF) && (POS[2] == 0))
-                {
-                    if (L)
-                        surface(1, u, pi, taus, taup, eta, &s, &r, &v, K_x, a_x, b_x,
-                                K_z, a_z, b_z, psi_vxx, psi_vzz);
+                    /* stress free surface ? */
+                    if ((FREE_SURF) && (POS[2] == 0))
+                    {
+                        if (L)
+                            surface(1, u, pi, taus, taup, eta, &s, &r, &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
+                        else
+                            surface_elastic(1, u, pi, &s, &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
+                    }
+
+                    /* exchange values of stress at boundaries between PEs */
+                    if (PERSISTENT_COMM)
+                    {
+                        time_s_exchange[nt] = exchange_s_start(
+                                nt, &s,
+                                sbufferlef_to_rig, sbufferrig_to_lef,
+                                sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
+                                sbufferbac_to_fro,
+                                rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                rsbufferbac_to_fro, sreq);
+                        time_s_exchange[nt] += exchange_s_finish(
+                                nt, &s,
+                                rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                rsbufferbac_to_fro, sreq);
+                    }
                     else
-                        surface_elastic(1, u, pi, &s, &v, K_x, a_x, b_x,
-                                K_z, a_z, b_z, psi_vxx, psi_vzz);
+                        time_s_exchange[nt] = exchange_s(
+                                nt, &s,
+                                sbufferlef_to_rig, sbufferrig_to_lef,
+                                sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
+                                sbufferbac_to_fro);
                 }
 
-                /* exchange values of stress at boundaries between PEs */
-                time_s_exchange[nt] = exchange_s(
-                        nt, &s,
-                        sbufferlef_to_rig, sbufferrig_to_lef,
-                        sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-                        sbufferbac_to_fro);
-
                 /* store amplitudes at receivers in e.g. sectionvx, sectionvz, sectiondiv, ...*/
                 if ((SEISMO) && (ntr > 0) && (nt == lsamp))
                 {
-                    seismo(nlsamp, ntr, recpos_loc, sectionvx, sectionvy, sectionvz,
+                    seismo((seis_stream) ? (nlsamp - 1) % nsec + 1 : nlsamp, ntr, recpos_loc,
+                            sectionvx, sectionvy, sectionvz,
                             sectiondiv, sectioncurl, sectionp, &v, &s, pi, u);
                     nlsamp++;
                     lsamp += NDT;
+                    if ((seis_stream) && ((nlsamp - 1) % nsec == 0))
+                        seis_stream_flush(ckpt.section, ntr, nsec, nsec, (nlsamp - 1) / nsec);
                 }
 
                 /* save snapshot in file */
@@ -1180,6 +1666,20 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
                     lsnap = lsnap + iround(TSNAPINC / DT);
                 }
 
+                /* periodic checkpoint, written while the time stepping continues */
+                if (CHECKPTWRITE && (CHECKPT_INC > 0) && (nt % CHECKPT_INC == 0) && (nt < NT))
+                {
+                    ckpt.nt = nt;
+                    ckpt.ishot = ishot;
+                    ckpt.lsnap = lsnap;
+                    ckpt.nsnap = nsnap;
+                    ckpt.lsamp = lsamp;
+                    ckpt.nlsamp = nlsamp;
+                    save_checkpoint(&ckpt, !CHECKPT_MPIIO);
+                    if (LOG && (MYID == 0))
+                        fprintf(FP, " Checkpoint of time step %d saved to %s \n", nt, CHECKPTFILE);
+                }
+
                 if (LOG)
                     if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
                     {
@@ -1191,11 +1691,31 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
             } /* end of loop over timesteps */
             /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 
+            /* write the snapshots still queued for the I/O thread */
+            snap_async_wait();
+
             fprintf(FP, "\n\n *********** Finish TIME STEPPING ****************\n");
             fprintf(FP, " **************************************************\n\n");
 
             /* write seismograms to file(s) */
-            if (SEISMO)
+            if (seis_stream)
+            {
+                /* last, partial block, then merge the blocks of all PEs */
+                if ((ntr > 0) && ((nlsamp - 1) % nsec))
+                    seis_stream_flush(ckpt.section, ntr, nsec, (nlsamp - 1) % nsec,
+                            (nlsamp - 1) / nsec + 1);
+                seis_stream_write(FP, ckpt.section, recpos, recswitch, ntr, ntr_glob,
+                        srcpos, ishot, ns, nsec, nlsamp - 1);
+                fprintf(FP, "\n\n");
+            }
+            else if ((SEISMO) && (SEIS_MPIIO))
+            {
+                /* each PE writes its traces */
+                saveseis_mpiio(FP, ckpt.section, recpos, recswitch, ntr, ntr_glob,
+                        srcpos, ishot, ns);
+                fprintf(FP, "\n\n");
+            }
+            else if (SEISMO)
             {
                 /* merge of seismogram data from all PE and output data collectively */
                 switch (SEISMO)
@@ -1273,9 +1793,13 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
             fprintf(FP, " Saving wavefield to check-point file %s \n", CHECKPTFILE);
         }
 
-        save_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
-                psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
-                psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+        ckpt.nt = NT;
+        ckpt.ishot = nshots;
+        ckpt.lsnap = lsnap;
+        ckpt.nsnap = nsnap;
+        ckpt.lsamp = lsamp;
+        ckpt.nlsamp = nlsamp;
+        save_checkpoint(&ckpt, 0);
         MPI_Barrier(MPI_COMM_WORLD);
         if (MYID == 0)
         {
@@ -1312,13 +1836,13 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
         }
     }
 
-    free_f3tensor(s.xy, NRL, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.yz, NRL, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.xy, NRL, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.yz, NRL, NRH, NCL, NCH, NDL, NDH);
 
-    free_f3tensor(s.xz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.xx, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.yy, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.zz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.xz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.xx, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.yy, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+    free_f3tensor_aligned(s.zz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
 
     if (ABS_TYPE == 1)
     {
@@ -1384,41 +1908,62 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
             }
         }
 
-        free_f3tensor(taus, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        free_f3tensor(taup, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(taus, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(taup, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
         free_vector(eta, 1, L);
-        free_f3tensor(tausipjp, 1, NY, 1, NX, 1, NZ);
-        free_f3tensor(tausjpkp, 1, NY, 1, NX, 1, NZ);
-        free_f3tensor(tausipkp, 1, NY, 1, NX, 1, NZ);
+        free_f3tensor_aligned(tausipjp, 1, NY, 1, NX, 1, NZ);
+        free_f3tensor_aligned(tausjpkp, 1, NY, 1, NX, 1, NZ);
+        free_f3tensor_aligned(tausipkp, 1, NY, 1, NX, 1, NZ);
     }
 
     //isotropic parameters releasing
 
-    free_f3tensor(rho, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(pi, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(u, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    if (rho != NULL)
+        free_f3tensor_aligned(rho, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    free_f3tensor_aligned(pi, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    free_f3tensor_aligned(u, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
 
     //anisotropic parameters releasing
 
-    free_f3tensor(C11, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C12, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C13, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C22, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C23, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C33, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C44, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C55, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C66, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(absorb_coeff, 1, NY, 1, NX, 1, NZ);
+    if (MAT_PRECISION != MAT_FP32)
+    {
+        update_simd_mat16(NULL);
+        mat16_free(&op16);
+    }
+    if (mtab.nmedia > 0)
+    {
+        update_simd_table(NULL);
+        mat_table_free(&mtab);
+    }
+    if (C11 != NULL)
+    {
+        free_f3tensor_aligned(C11, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C12, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C13, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C22, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C23, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C33, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    }
+    if (C44 != NULL)
+    {
+        free_f3tensor_aligned(C44, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C55, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        free_f3tensor_aligned(C66, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    }
+    if (ABS_TYPE == 2)
+        absorb_free(&absorb_frame);
 
     /* averaged material parameters */
-    free_f3tensor(C66ipjp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(C44jpkp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(C55ipkp, 1, NY, 1, NX, 1, NZ);
+    if (C66ipjp != NULL)
+    {
+        free_f3tensor_aligned(C66ipjp, 1, NY, 1, NX, 1, NZ);
+        free_f3tensor_aligned(C44jpkp, 1, NY, 1, NX, 1, NZ);
+        free_f3tensor_aligned(C55ipkp, 1, NY, 1, NX, 1, NZ);
+    }
 
-    free_f3tensor(rjp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(rkp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(rip, 1, NY, 1, NX, 1, NZ);
+    free_f3tensor_aligned(rjp, 1, NY, 1, NX, 1, NZ);
+    free_f3tensor_aligned(rkp, 1, NY, 1, NX, 1, NZ);
+    free_f3tensor_aligned(rip, 1, NY, 1, NX, 1, NZ);
 
     if (nsrc_loc > 0)
     {
@@ -1440,6 +1985,41 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
     free_f3tensor(sbufferfro_to_bac, 1, NY, 1, NX, 1, nf2);
     free_f3tensor(sbufferbac_to_fro, 1, NY, 1, NX, 1, nf1);
 
+    if (PERSISTENT_COMM)
+    {
+        comm_free(vreq);
+        comm_free(sreq);
+    }
+
+    if (OVERLAP_COMM)
+    {
+        free_shell_sources(7, vsrc);
+        free_shell_sources(2, ssrc);
+    }
+
+    if (nvtile > 1)
+        free_shell_sources(nvtile, vtsrc);
+    free(vtsrc);
+    free(vtile);
+    free(stile);
+
+    if ((OVERLAP_COMM) || (PERSISTENT_COMM))
+    {
+        free_f3tensor(rbufferlef_to_rig, 1, NY, 1, NZ, 1, nf1);
+        free_f3tensor(rbufferrig_to_lef, 1, NY, 1, NZ, 1, nf2);
+        free_f3tensor(rbuffertop_to_bot, 1, NX, 1, NZ, 1, nf1);
+        free_f3tensor(rbufferbot_to_top, 1, NX, 1, NZ, 1, nf2);
+        free_f3tensor(rbufferfro_to_bac, 1, NY, 1, NX, 1, nf1);
+        free_f3tensor(rbufferbac_to_fro, 1, NY, 1, NX, 1, nf2);
+
+        free_f3tensor(rsbufferlef_to_rig, 1, NY, 1, NZ, 1, nf2);
+        free_f3tensor(rsbufferrig_to_lef, 1, NY, 1, NZ, 1, nf1);
+        free_f3tensor(rsbuffertop_to_bot, 1, NX, 1, NZ, 1, nf2);
+        free_f3tensor(rsbufferbot_to_top, 1, NX, 1, NZ, 1, nf1);
+        free_f3tensor(rsbufferfro_to_bac, 1, NY, 1, NX, 1, nf2);
+        free_f3tensor(rsbufferbac_to_fro, 1, NY, 1, NX, 1, nf1);
+    }
+
     /* free memory for global receiver source positions */
     if (SEISMO > 0)
     {
@@ -1449,32 +2029,34 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
     /* free memory for global source positions */
     free_matrix(srcpos, 1, 6, 1, nsrc);
 
+    if (seismo_fulldata)
+        free_matrix(seismo_fulldata, 1, ntr_glob, 1, ns);
+
     if ((ntr > 0) && (SEISMO > 0))
     {
         free_imatrix(recpos_loc, 1, 3, 1, ntr);
-        free_matrix(seismo_fulldata, 1, ntr_glob, 1, ns);
 
         switch (SEISMO)
         {
             case 1: /* particle velocities only */
-                free_matrix(sectionvx, 1, ntr, 1, ns);
-                free_matrix(sectionvy, 1, ntr, 1, ns);
-                free_matrix(sectionvz, 1, ntr, 1, ns);
+                free_matrix(sectionvx, 1, ntr, 1, nsec);
+                free_matrix(sectionvy, 1, ntr, 1, nsec);
+                free_matrix(sectionvz, 1, ntr, 1, nsec);
                 break;
             case 2: /* pressure only */
-                free_matrix(sectionp, 1, ntr, 1, ns);
+                free_matrix(sectionp, 1, ntr, 1, nsec);
                 break;
             case 3: /* curl and div only */
-                free_matrix(sectioncurl, 1, ntr, 1, ns);
-                free_matrix(sectiondiv, 1, ntr, 1, ns);
+                free_matrix(sectioncurl, 1, ntr, 1, nsec);
+                free_matrix(sectiondiv, 1, ntr, 1, nsec);
                 break;
             case 4: /* everything */
-                free_matrix(sectionvx, 1, ntr, 1, ns);
-                free_matrix(sectionvy, 1, ntr, 1, ns);
-                free_matrix(sectionvz, 1, ntr, 1, ns);
-                free_matrix(sectionp, 1, ntr, 1, ns);
-                free_matrix(sectioncurl, 1, ntr, 1, ns);
-                free_matrix(sectiondiv, 1, ntr, 1, ns);
+                free_matrix(sectionvx, 1, ntr, 1, nsec);
+                free_matrix(sectionvy, 1, ntr, 1, nsec);
+                free_matrix(sectionvz, 1, ntr, 1, nsec);
+                free_matrix(sectionp, 1, ntr, 1, nsec);
+                free_matrix(sectioncurl, 1, ntr, 1, nsec);
+                free_matrix(sectiondiv, 1, ntr, 1, nsec);
                 break;
         }
     }
@@ -1496,6 +2078,9 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
     free_ivector(yb, 0, 1);
     free_ivector(zb, 0, 1);
 
+    snap_async_stop();
+    snap_plan_free();
+
     /* free timing arrays */
     free_dvector(time_v_update, 1, NT);
     free_dvector(time_s_update, 1, NT);
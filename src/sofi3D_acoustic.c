@@ -26,13 +26,18 @@
 #include "fd.h"
 #include "globvar.h"
 #include "data_structures.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 int main(int argc, char **argv){
 	int ns, nt, nseismograms=0, nf1, nf2, i;
 	int lsnap, nsnap=0, lsamp=0, nlsamp=0, buffsize;
 	int ntr=0, ntr_loc=0, ntr_glob=0, nsrc=0, nsrc_loc=0, ishot, nshots, h;
+	int ng, nm, na, ntb=0, ntb1=1, lout;
 
 	double 	time0=0.0, time1=0.0, time2=0.0, time3=0.03, time4=0.0;
+	double tbtime, tbexch;
 	double * time_v_update, * time_s_update, * time_s_exchange,* time_v_exchange, * time_timestep;
 	int * xa, * xb, * ya, * yb, * za, * zb;
 	float  ***  sxx=NULL;
@@ -40,17 +45,14 @@ int main(int argc, char **argv){
 	v.x = NULL;
         v.y = NULL;
         v.z = NULL;
-	float  ***  sxx1=NULL, ***  syy1=NULL, ***  szz1=NULL;
-	float  ***  vx1=NULL, ***  vy1=NULL, ***  vz1=NULL;
-
-	float  ***  sxx2=NULL, ***  syy2=NULL, ***  szz2=NULL;
-	float  ***  vx2=NULL, ***  vy2=NULL, ***  vz2=NULL;
-
-	float  ***  sxx3=NULL, ***  syy3=NULL, ***  szz3=NULL;
-	float  ***  vx3=NULL, ***  vy3=NULL, ***  vz3=NULL;
+	/* PML-splitting variables of the PML blocks 1..BLOCK (at most 6) */
+	float  ***  sxx1[7], ***  sxx2[7], ***  sxx3[7];
+	float  ***  vx1[7], ***  vy2[7], ***  vz3[7];
+	double npml=0.0;
 
 	float  ***  rho, ***  pi;
-	float  *** absorb_coeff=NULL, *** absorb_coeffx=NULL, *** absorb_coeffy=NULL, *** absorb_coeffz=NULL;
+	float  *** absorb_coeffx=NULL, *** absorb_coeffy=NULL, *** absorb_coeffz=NULL;
+	AbsorbFrame absorb_frame;
 	float  ** srcpos=NULL, **srcpos_loc=NULL, ** srcpos1=NULL, ** signals=NULL;
 	int    ** recpos=NULL, ** recpos_loc=NULL;
 	float  ** sectionvx=NULL, ** sectionvy=NULL, ** sectionvz=NULL, ** sectionp=NULL,
@@ -63,6 +65,21 @@ int main(int argc, char **argv){
 	float *** sbuffertop_to_bot, *** sbufferbot_to_top;
 	float *** sbufferfro_to_bac, *** sbufferbac_to_fro;
 
+	/* receive buffers and requests for PERSISTENT_COMM */
+	float *** rbufferlef_to_rig=NULL, *** rbufferrig_to_lef=NULL;
+	float *** rbuffertop_to_bot=NULL, *** rbufferbot_to_top=NULL;
+	float *** rbufferfro_to_bac=NULL, *** rbufferbac_to_fro=NULL;
+
+	float *** rsbufferlef_to_rig=NULL, *** rsbufferrig_to_lef=NULL;
+	float *** rsbuffertop_to_bot=NULL, *** rsbufferbot_to_top=NULL;
+	float *** rsbufferfro_to_bac=NULL, *** rsbufferbac_to_fro=NULL;
+
+	MPI_Request vreq[2*REQUEST_COUNT], sreq[2*REQUEST_COUNT];
+
+	/* sources of the local grid and its ghost zone for TIME_BLOCK>1 */
+	PointSources tbsrc;
+	float *** halo[2];
+	tbsrc.nsrc=0;
 
 	float ** seismo_fulldata=NULL;
 	int * recswitch=NULL;
@@ -75,8 +92,10 @@ int main(int argc, char **argv){
 	/*char cline[256];*/
 	FILE * fpsrc=NULL;
 
-	/* Initialize MPI environment */
-	MPI_Init(&argc,&argv);
+	/* Initialize MPI environment, only the master thread calls MPI
+	   (I/O thread of SNAP_ASYNC=1) */
+	int thread_level;
+	MPI_Init_thread(&argc,&argv,MPI_THREAD_FUNNELED,&thread_level);
 	MPI_Comm_size(MPI_COMM_WORLD,&NP);
 	MPI_Comm_rank(MPI_COMM_WORLD,&MYID);
 
@@ -118,6 +137,15 @@ int main(int argc, char **argv){
 	/* PE 0 will broadcast the parameters to all others PEs */
 	exchange_par();
 
+	/* Set the number of threads before any wavefield is allocated (the
+	   allocation and the absorbing frame are threaded), otherwise each PE
+	   would use all cores of the node. */
+#ifdef _OPENMP
+	if ((THREADS > 1) && (thread_level < MPI_THREAD_FUNNELED) && (MYID == 0))
+		warning("The MPI library does not support MPI_THREAD_FUNNELED.");
+	omp_set_num_threads(THREADS);
+#endif
+
 	if (MYID == 0) note(stdout);
 
 	sprintf(ext,".%i",MYID);  
@@ -137,7 +165,9 @@ int main(int argc, char **argv){
 
 	fprintf(FP," This is the log-file generated by PE %d \n\n",MYID);
 
-	/* domain decomposition */
+	/* domain decomposition, NPROCX, NPROCY or NPROCZ set to 0 are chosen
+	   for the nf1+nf2 values exchanged per grid point of a face (see below) */
+	decomp_procs(NP,FDORDER-1);
 	initproc();
 
 	/* set some time counters */
@@ -160,6 +190,28 @@ int main(int argc, char **argv){
 	NY = IENDY;
 	NZ = IENDZ;
 
+	if ((MAT_PRECISION>0) && (MYID==0))
+		warning(" MAT_PRECISION is only supported by the elastic program and is ignored. ");
+	if ((MAT_COMPRESS>0) && (MYID==0))
+		warning(" MAT_COMPRESS is only supported by the elastic program and is ignored. ");
+	if ((SEIS_BLOCK>0) && (MYID==0))
+		warning(" SEIS_BLOCK is only supported by the elastic program and is ignored. ");
+
+	/* temporal blocking: the wavefield and the model get a ghost zone
+	   of TIME_BLOCK*FDORDER points, see tblock_acoustic.c (ABS_TYPE=2
+	   only, checked by checkfd_acoustic) */
+	if ((TIME_BLOCK>1) && (ABS_TYPE==2)){
+		ng=tblock_width();
+		nm=ng;
+		na=ng;
+		if (MYID==0) fprintf(FP," Temporal blocking of %d time steps, ghost zone of %d grid points.\n",TIME_BLOCK,ng);
+	}
+	else {
+		ng=FDORDER/2;
+		nm=1;
+		na=0;
+	}
+
 	/* compute receiver locations within each subgrid and
 	   store local receiver coordinates in recpos_loc */	
 	if (SEISMO){
@@ -173,7 +225,7 @@ int main(int argc, char **argv){
 
 
 	/* allocate buffer for seismogram output, merged seismogram section of all PEs */
-	if (SEISMO) seismo_fulldata=fmatrix(1,ntr_glob,1,ns);
+	if ((SEISMO) && (MYID==0) && (!SEIS_MPIIO)) seismo_fulldata=fmatrix(1,ntr_glob,1,ns);
 
 	/* allocate buffer for seismogram output, seismogram section of each PE */
 	/* allocation of memory for seismogramm merge */
@@ -194,15 +246,42 @@ int main(int argc, char **argv){
 	break;
 	}
 
+	/* PML indices*/
+	xa=ivector(0,6);
+	xb=ivector(0,6);
+	ya=ivector(0,6);
+	yb=ivector(0,6);
+	za=ivector(0,6);
+	zb=ivector(0,6);
+
+	/* initialisation of PML and ABS domain */
+	if(ABS_TYPE==1){    
+		PML_ini_acoustic(xa,xb,ya,yb,za,zb);
+		printf("BLOCK = %d \n",BLOCK);
+		/* grid points of the PML blocks */
+		for(h=1;h<=BLOCK;h++)
+			npml+=(double)(xb[h]-xa[h]+1)*(yb[h]-ya[h]+1)*(zb[h]-za[h]+1);
+	}
+
+	if(ABS_TYPE==2){    
+		xa[0]=1;
+		xb[0]=NX;
+		ya[0]=1;
+		yb[0]=NY;
+		za[0]=1;
+		zb[0]=NZ;
+	}
+
 	/*allocate memory for dynamic, static and buffer arrays */
-	fac1=(NZ+FDORDER)*(NY+FDORDER)*(NX+FDORDER);
+	fac1=(NZ+2*ng)*(NY+2*ng)*(NX+2*ng);
 	fac2=sizeof(float)*pow(2.0,-20.0);
 
 	if(ABS_TYPE==1){ 
-		memdyn=22.0*fac1*fac2;
+		memdyn=(4.0*fac1+6.0*npml)*fac2;
 		memmodel=5.0*fac1*fac2;
 		memseismograms=nseismograms*ntr*ns*fac2;
 		membuffer=2.0*5.0*((NX*NZ)+(NY*NZ)+(NX*NY))*fac2;
+		if (PERSISTENT_COMM) membuffer*=2.0;
 		buffsize=(FDORDER/2)*4.0*6.0*(max((NX*NZ),max((NY*NZ),(NX*NY))))*sizeof(MPI_FLOAT);
 		memtotal=memdyn+memmodel+memseismograms+membuffer+(buffsize*pow(2.0,-20.0));
 
@@ -222,9 +301,10 @@ int main(int argc, char **argv){
 
 	if(ABS_TYPE==2){
 		memdyn=4.0*fac1*fac2;
-		memmodel=3.0*fac1*fac2;
+		memmodel=2.0*fac1*fac2;
 		memseismograms=nseismograms*ntr*ns*fac2;
 		membuffer=2.0*5.0*((NX*NZ)+(NY*NZ)+(NX*NY))*fac2;
+		if (PERSISTENT_COMM) membuffer*=2.0;
 		buffsize=(FDORDER/2)*4.0*6.0*(max((NX*NZ),max((NY*NZ),(NX*NY))))*sizeof(MPI_FLOAT);
 		memtotal=memdyn+memmodel+memseismograms+membuffer+(buffsize*pow(2.0,-20.0));
 
@@ -257,48 +337,27 @@ int main(int argc, char **argv){
 
 
 	/* memory allocation for dynamic (wavefield) arrays */
-	v.x  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	v.y  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	v.z  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	sxx =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
+	v.x  =  f3tensor(1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	v.y  =  f3tensor(1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	v.z  =  f3tensor(1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	sxx =  f3tensor(1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
 
 
 	/* memory allocation for static (model) arrays */
-	rho =  f3tensor(0,NY+1,0,NX+1,0,NZ+1);
-	pi  =  f3tensor(0,NY+1,0,NX+1,0,NZ+1);
-	absorb_coeff=  f3tensor(1,NY,1,NX,1,NZ);
+	rho =  f3tensor(1-nm,NY+nm,1-nm,NX+nm,1-nm,NZ+nm);
+	pi  =  f3tensor(1-nm,NY+nm,1-nm,NX+nm,1-nm,NZ+nm);
 
-	/* PML indices*/
-	xa=ivector(0,5);
-	xb=ivector(0,5);
-	ya=ivector(0,5);
-	yb=ivector(0,5);
-	za=ivector(0,5);
-	zb=ivector(0,5);
-
-	/* memory allocation for PML-splitting variables */
+	/* memory allocation for PML-splitting variables, the split fields are
+	   only used within the PML blocks and keep the indices of the grid */
 	if(ABS_TYPE==1){
-
-		vx1  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vy1  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vz1  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		sxx1 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		syy1 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		szz1 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-
-		vx2  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vy2  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vz2  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		sxx2 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		syy2 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		szz2 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-
-		vx3  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vy3  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		vz3  =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		sxx3 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		syy3 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		szz3 =  f3tensor(1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
+		for(h=1;h<=BLOCK;h++){
+			vx1[h]  =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			vy2[h]  =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			vz3[h]  =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			sxx1[h] =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			sxx2[h] =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			sxx3[h] =  f3tensor(ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+		}
 
 		absorb_coeffx=  f3tensor(1,NY,1,NX,1,NZ);
 		absorb_coeffy=  f3tensor(1,NY,1,NX,1,NZ);
@@ -330,6 +389,22 @@ int main(int argc, char **argv){
 	sbufferfro_to_bac = f3tensor(1,NY,1,NX,1,nf2);
 	sbufferbac_to_fro = f3tensor(1,NY,1,NX,1,nf1);
 
+	if (PERSISTENT_COMM){
+		rbufferlef_to_rig = f3tensor(1,NY,1,NZ,1,nf1);
+		rbufferrig_to_lef = f3tensor(1,NY,1,NZ,1,nf2);
+		rbuffertop_to_bot = f3tensor(1,NX,1,NZ,1,nf1);
+		rbufferbot_to_top = f3tensor(1,NX,1,NZ,1,nf2);
+		rbufferfro_to_bac = f3tensor(1,NY,1,NX,1,nf1);
+		rbufferbac_to_fro = f3tensor(1,NY,1,NX,1,nf2);
+
+		rsbufferlef_to_rig = f3tensor(1,NY,1,NZ,1,nf2);
+		rsbufferrig_to_lef = f3tensor(1,NY,1,NZ,1,nf1);
+		rsbuffertop_to_bot = f3tensor(1,NX,1,NZ,1,nf2);
+		rsbufferbot_to_top = f3tensor(1,NX,1,NZ,1,nf1);
+		rsbufferfro_to_bac = f3tensor(1,NY,1,NX,1,nf2);
+		rsbufferbac_to_fro = f3tensor(1,NY,1,NX,1,nf1);
+	}
+
 	if ((ntr>0)){
 		switch (SEISMO){
 		case 1 : /* particle velocities only */
@@ -367,25 +442,11 @@ int main(int argc, char **argv){
 		absorb_PML(absorb_coeffx, absorb_coeffy, absorb_coeffz);
 	}
 
-	/* calculate 3-D array for exponential damping of reflections
-	   at the edges of the numerical mesh (ABS-boundary) */
+	/* calculate the profiles for exponential damping of reflections
+	   at the edges of the numerical mesh (ABS-boundary), including the
+	   ghost zone of the time blocks */
 	if(ABS_TYPE==2){
-		absorb(absorb_coeff);
-	}
-
-	/* initialisation of PML and ABS domain */
-	if(ABS_TYPE==1){    
-		PML_ini_acoustic(xa,xb,ya,yb,za,zb);
-		printf("BLOCK = %d \n",BLOCK);
-	}
-
-	if(ABS_TYPE==2){    
-		xa[0]=1;
-		xb[0]=NX;
-		ya[0]=1;
-		yb[0]=NY;
-		za[0]=1;
-		zb[0]=NZ;
+		absorb(&absorb_frame,na);
 	}
 
 
@@ -439,6 +500,26 @@ int main(int argc, char **argv){
 
 	if (RUN_MULTIPLE_SHOTS) nshots=nsrc; else nshots=1;	
 
+	/* planes and boxes of the snapshots (SNAP_PLAN) */
+	if (SNAP) snap_plan_init(FP);
+
+	/* I/O thread for the snapshots (SNAP_ASYNC=1) */
+	snap_async_start();
+
+	/* comunication initialisation for persistent communication, the
+	   requests are used for all shots and freed after the last one */
+	if (PERSISTENT_COMM){
+		comm_ini(nf1, nf2, bufferlef_to_rig, bufferrig_to_lef,
+				buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+				rbufferlef_to_rig, rbufferrig_to_lef,
+				rbuffertop_to_bot, rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+
+		comm_ini(nf2, nf1, sbufferlef_to_rig, sbufferrig_to_lef,
+				sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro,
+				rsbufferlef_to_rig, rsbufferrig_to_lef,
+				rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+	}
+
 	for (ishot=1;ishot<=nshots;ishot++){
 
 		fprintf(FP,"\n MYID=%d *****  Starting simulation for shot %d of %d  ********** \n",MYID,ishot,nshots);
@@ -474,6 +555,11 @@ int main(int argc, char **argv){
 		for example, are required on the local grid. These are now copied from the
 		neighbouring grids */
 		matcopy_acoustic(rho,pi);
+		if (TIME_BLOCK>1){
+			halo[0]=rho;
+			halo[1]=pi;
+			exchange_halo(2,halo,nm);
+		}
 
 
 		/* spatial averaging of material parameters, i.e. density */
@@ -495,23 +581,20 @@ int main(int argc, char **argv){
 
 
 
-		/* comunication initialisation for persistent communication */
-		/*comm_ini(bufferlef_to_rig, bufferrig_to_lef,
-	    buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac,
-	    bufferbac_to_fro, req_send, req_rec);
-
-	comm_ini_acoustic(sbufferlef_to_rig, sbufferrig_to_lef,
-	    sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-	    sbufferbac_to_fro, sreq_send, sreq_rec);*/
-
-
-
 		/* calculate wavelet for each source point */
 		signals=wavelet(srcpos_loc,nsrc_loc);
+		if (TIME_BLOCK>1){
+			free_shell_sources(1,&tbsrc);
+			if (RUN_MULTIPLE_SHOTS) tblock_sources(srcpos1,1,stype,&tbsrc);
+			else tblock_sources(srcpos,nsrc,stype,&tbsrc);
+		}
 
 
 		/* initialize wavefield with zero */
-		zero_acoustic(1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2, &v,sxx);
+		zero_acoustic(1-ng,NX+ng,1-ng,NY+ng,1-ng,NZ+ng, &v,sxx);
+		if(ABS_TYPE==1)
+			for(h=1;h<=BLOCK;h++)
+				zero_PML_acoustic(xa[h],xb[h],ya[h],yb[h],za[h],zb[h],vx1[h],vy2[h],vz3[h],sxx1[h],sxx2[h],sxx3[h]);
 
 		/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 		/* start of loop over time steps */
@@ -524,6 +607,8 @@ int main(int argc, char **argv){
 
 		lsamp=NDTSHIFT+1;
 		nlsamp=1;
+		ntb=0;
+		tbtime=tbexch=0.0;
 		for (nt=1;nt<=NT;nt++){
 
 			time_v_update[nt]=0.0;
@@ -532,12 +617,32 @@ int main(int argc, char **argv){
 			/* Check if simulation is still stable */
 			if (isnan(v.y[NY/2][NX/2][NZ/2])) err(" Simulation is unstable !");
 
-			if (LOG)
-				if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
-					fprintf(FP,"\n Computing timestep %d of %d for shot %d \n",nt,NT,ishot);
-					time0=MPI_Wtime();
+			lout=(LOG && (MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0);
+			if (lout) {
+				fprintf(FP,"\n Computing timestep %d of %d for shot %d \n",nt,NT,ishot);
+				time0=MPI_Wtime();
+			}
+
+			/* temporal blocking: the time steps nt...ntb in a single sweep,
+			   a snapshot step ends a block */
+			if (TIME_BLOCK>1){
+				if (nt==ntb+1){
+					ntb1=nt;
+					ntb=min(NT,nt+TIME_BLOCK-1);
+					if ((SNAP) && (lsnap>=nt) && (lsnap<ntb) && (lsnap<=TSNAP2/DT)) ntb=lsnap;
+
+					tbtime=tblock_acoustic(nt,ntb,lsamp,nlsamp,&v,sxx,rho,pi,&absorb_frame,&tbsrc,
+							ntr,recpos_loc,sectionvx,sectionvy,sectionvz,sectiondiv,sectioncurl,sectionp,&tbexch);
 				}
 
+				/* the time is distributed evenly over the time steps of the block */
+				time_v_update[nt]=0.5*tbtime/(ntb-ntb1+1);
+				time_s_update[nt]=0.5*tbtime/(ntb-ntb1+1);
+				time_v_exchange[nt]=tbexch/(ntb-ntb1+1);
+				time_s_exchange[nt]=0.0;
+				if (lout) fprintf(FP," Real time for wavefield update: \t %4.2f s.\n",time_v_update[nt]+time_s_update[nt]);
+			}
+
 			/* update PML boundaries */
 			/* --------------------- */
 			/* if BLOCK == 3 == corner, == 1 == face, == 2 == edge */
@@ -546,87 +651,131 @@ int main(int argc, char **argv){
 			/*if((ABS_TYPE == 1)&&((BLOCK == 3)||(BLOCK == 1)||(BLOCK == 2))){*/
 
 
-			if((ABS_TYPE == 1)&&(BLOCK != 0)){
+			if((TIME_BLOCK==1)&&(ABS_TYPE == 1)&&(BLOCK != 0)){
 
 				/* update of particle velocities */
 
 				/* update NON PML boundaries */
-				time_v_update[nt]+=update_v_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],nt, &v,sxx,rho,srcpos_loc,signals,nsrc_loc,absorb_coeff,stype_loc);
+				time_v_update[nt]+=update_v_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],nt, &v,sxx,rho,srcpos_loc,signals,nsrc_loc,&absorb_frame,stype_loc);
+				if (lout) fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time_v_update[nt]);
 
 
 				/* update PML boundaries */
 				for(h=1;h<=BLOCK;h++){
 
 					time_v_update[nt]+=update_v_acoustic_PML(xa[h],xb[h],ya[h],yb[h],za[h],zb[h],nt, &v, sxx,
-							vx1,vy2,vz3,rho,srcpos_loc,signals,nsrc_loc,absorb_coeffx,
+							vx1[h],vy2[h],vz3[h],rho,srcpos_loc,signals,nsrc_loc,absorb_coeffx,
 							absorb_coeffy,absorb_coeffz,stype_loc);
 				}
 
 				/* exchange values of particle velocities at grid boundaries between PEs */
-				time_v_exchange[nt]=exchange_v(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
-						bufferfro_to_bac, bufferbac_to_fro);
+				if (PERSISTENT_COMM){
+					time_v_exchange[nt]=exchange_v_start(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+							bufferfro_to_bac, bufferbac_to_fro, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+							rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+					time_v_exchange[nt]+=exchange_v_finish(nt, &v, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+							rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+				}
+				else
+					time_v_exchange[nt]=exchange_v(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+							bufferfro_to_bac, bufferbac_to_fro);
 
 
 				/* update of components of stress tensor */
 
 				/* update NON PML boundaries */
-				time_s_update[nt]+=update_s_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],nt,&v,sxx,pi);
+				time_s_update[nt]+=update_s_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],&v,sxx,pi);
+				if (lout) fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time_s_update[nt]);
 
 				/* update PML boundaries */
 				for(h=1;h<=BLOCK;h++){
 
 					time_s_update[nt]+=update_s_acoustic_PML(xa[h],xb[h],ya[h],yb[h],za[h],zb[h],nt,&v,sxx,
-							sxx1,sxx2,sxx3,pi,absorb_coeffx,absorb_coeffy,absorb_coeffz);
+							sxx1[h],sxx2[h],sxx3[h],pi,absorb_coeffx,absorb_coeffy,absorb_coeffz);
 				}
 
 				/* exchange values of stress at boundaries between PEs */
-				time_s_exchange[nt]=exchange_s_acoustic(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
-						sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro);
+				if (PERSISTENT_COMM){
+					time_s_exchange[nt]=exchange_s_acoustic_start(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
+							sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro,
+							rsbufferlef_to_rig, rsbufferrig_to_lef, rsbuffertop_to_bot,
+							rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+					time_s_exchange[nt]+=exchange_s_acoustic_finish(nt,sxx,rsbufferlef_to_rig, rsbufferrig_to_lef,
+							rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+				}
+				else
+					time_s_exchange[nt]=exchange_s_acoustic(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
+							sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro);
 
 			}
 
 			/* if BLOCK == 0 == calculation area or old ABS-Boundary*/
 			/* -----------------------------------------------------*/
 
-			if((BLOCK == 0)||(ABS_TYPE==2)){
+			if((TIME_BLOCK==1)&&((BLOCK == 0)||(ABS_TYPE==2))){
 
 				/* update of particle velocities */
 
 				/* update NON PML boundaries */
 				time_v_update[nt]+=update_v_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],nt,&v,sxx,
-						rho,srcpos_loc,signals,nsrc_loc,absorb_coeff, stype_loc);
+						rho,srcpos_loc,signals,nsrc_loc,&absorb_frame, stype_loc);
+				if (ABS_TYPE==2)
+					absorb_s_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],sxx,&absorb_frame);
+				if (lout) fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time_v_update[nt]);
 
 
 				/* exchange values of particle velocities at grid boundaries between PEs */
-				time_v_exchange[nt]=exchange_v(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
-						bufferfro_to_bac, bufferbac_to_fro);
+				if (PERSISTENT_COMM){
+					time_v_exchange[nt]=exchange_v_start(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+							bufferfro_to_bac, bufferbac_to_fro, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+							rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+					time_v_exchange[nt]+=exchange_v_finish(nt, &v, rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+							rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro, vreq);
+				}
+				else
+					time_v_exchange[nt]=exchange_v(nt, &v, bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+							bufferfro_to_bac, bufferbac_to_fro);
 
 				/* update of components of stress tensor */
 
 				/* update NON PML boundaries */
-				time_s_update[nt]+=update_s_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],nt,&v,sxx,pi);
+				time_s_update[nt]+=update_s_acoustic(xa[0],xb[0],ya[0],yb[0],za[0],zb[0],&v,sxx,pi);
+				if (lout) fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time_s_update[nt]);
 
 
 				/* exchange values of stress at boundaries between PEs */
-				time_s_exchange[nt]=exchange_s_acoustic(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
-						sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro);
+				if (PERSISTENT_COMM){
+					time_s_exchange[nt]=exchange_s_acoustic_start(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
+							sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro,
+							rsbufferlef_to_rig, rsbufferrig_to_lef, rsbuffertop_to_bot,
+							rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+					time_s_exchange[nt]+=exchange_s_acoustic_finish(nt,sxx,rsbufferlef_to_rig, rsbufferrig_to_lef,
+							rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro, sreq);
+				}
+				else
+					time_s_exchange[nt]=exchange_s_acoustic(nt,sxx,sbufferlef_to_rig, sbufferrig_to_lef,
+							sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro);
 
 			}
 
-			/* explosive source */
-			if (!CHECKPTREAD)
-				psource_acoustic(nt,sxx,srcpos_loc,signals,nsrc_loc,stype_loc);
+			if (TIME_BLOCK==1){
+				/* explosive source */
+				if (!CHECKPTREAD)
+					psource_acoustic(nt,sxx,srcpos_loc,signals,nsrc_loc,stype_loc);
 
 
-			/* stress free surface ? */
-			if ((FREE_SURF) && (POS[2]==0))
-				surface_acoustic(1,pi,sxx, &v);
+				/* stress free surface ? */
+				if ((FREE_SURF) && (POS[2]==0))
+					surface_acoustic(1,1,NX,1,NZ,pi,sxx, &v);
+			}
 
 
-			/* store amplitudes at receivers in sectionvx-sectionvz */
+			/* store amplitudes at receivers in sectionvx-sectionvz,
+			   already done by tblock_acoustic for TIME_BLOCK>1 */
 			if ((SEISMO) && (ntr>0) && (nt==lsamp)){
-				seismo_acoustic(nlsamp,ntr,recpos_loc,sectionvx,sectionvy,sectionvz,
-						sectiondiv,sectioncurl,sectionp, &v,sxx,pi);
+				if (TIME_BLOCK==1)
+					seismo_acoustic(nlsamp,ntr,recpos_loc,sectionvx,sectionvy,sectionvz,
+							sectiondiv,sectioncurl,sectionp, &v,sxx,pi,1,NY);
 				nlsamp++;
 				lsamp+=NDT;
 			}
@@ -638,24 +787,33 @@ int main(int argc, char **argv){
 				lsnap=lsnap+iround(TSNAPINC/DT);
 			}
 
-			if (LOG)
-				if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
-					time3=MPI_Wtime();
-					time_timestep[nt]=(time3-time0);
-					fprintf(FP," total real time for timestep %d : \t\t %4.2f s.\n",nt,time3-time0);
-				}
+			if (lout) {
+				time3=MPI_Wtime();
+				time_timestep[nt]=(time3-time0);
+				fprintf(FP," total real time for timestep %d : \t\t %4.2f s.\n",nt,time3-time0);
+			}
 
 
 
 
 		} /* end of loop over timesteps */
 		/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+
+		/* write the snapshots still queued for the I/O thread */
+		snap_async_wait();
+
 		fprintf(FP, "\n\n *********** Finish TIME STEPPING ****************\n");
 		fprintf(FP, " **************************************************\n\n");
 
 
 		/* write seismograms to file(s) */
-		if (SEISMO){
+		if ((SEISMO) && (SEIS_MPIIO)){
+			/* each PE writes its traces */
+			float **section[6]={sectionvx, sectionvy, sectionvz, sectionp, sectiondiv, sectioncurl};
+			saveseis_mpiio(FP,section,recpos,recswitch,ntr,ntr_glob,srcpos,ishot,ns);
+			fprintf(FP, "\n\n");
+		}
+		else if (SEISMO){
 			/* merge of seismogram data from all PE and output data collectively */
 			switch (SEISMO){
 			case 1 : /* particle velocities only */
@@ -727,35 +885,23 @@ int main(int argc, char **argv){
 	}*/
 
 	/*de-allocation of memory */
-	free_f3tensor(v.x,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	free_f3tensor(v.y,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	free_f3tensor(v.z,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-	free_f3tensor(sxx,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
+	free_f3tensor(v.x,1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	free_f3tensor(v.y,1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	free_f3tensor(v.z,1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
+	free_f3tensor(sxx,1-ng,NY+ng,1-ng,NX+ng,1-ng,NZ+ng);
 
-	free_f3tensor(rho,0,NY+1,0,NX+1,0,NZ+1);
-	free_f3tensor(pi,0,NY+1,0,NX+1,0,NZ+1);
+	free_f3tensor(rho,1-nm,NY+nm,1-nm,NX+nm,1-nm,NZ+nm);
+	free_f3tensor(pi,1-nm,NY+nm,1-nm,NX+nm,1-nm,NZ+nm);
 
 	if(ABS_TYPE==1){
-		free_f3tensor(vx1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vy1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vz1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(sxx1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(syy1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(szz1,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-
-		free_f3tensor(vx2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vy2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vz2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(sxx2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(syy2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(szz2,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-
-		free_f3tensor(vx3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vy3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(vz3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(sxx3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(syy3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
-		free_f3tensor(szz3,1-FDORDER/2,NY+FDORDER/2,1-FDORDER/2,NX+FDORDER/2,1-FDORDER/2,NZ+FDORDER/2);
+		for(h=1;h<=BLOCK;h++){
+			free_f3tensor(vx1[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			free_f3tensor(vy2[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			free_f3tensor(vz3[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			free_f3tensor(sxx1[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			free_f3tensor(sxx2[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+			free_f3tensor(sxx3[h],ya[h],yb[h],xa[h],xb[h],za[h],zb[h]);
+		}
 
 		free_f3tensor(absorb_coeffx,1,NY,1,NX,1,NZ);
 		free_f3tensor(absorb_coeffy,1,NY,1,NX,1,NZ);
@@ -764,8 +910,9 @@ int main(int argc, char **argv){
 
 
 	if(ABS_TYPE==2){
-		free_f3tensor(absorb_coeff,1,NY,1,NX,1,NZ);
+		absorb_free(&absorb_frame);
 	}
+	free_shell_sources(1,&tbsrc);
 
 	if (nsrc_loc>0){	
 		free_matrix(signals,1,nsrc_loc,1,NT);
@@ -787,6 +934,25 @@ int main(int argc, char **argv){
 	free_f3tensor(sbufferfro_to_bac,1,NY,1,NX,1,nf2);
 	free_f3tensor(sbufferbac_to_fro,1,NY,1,NX,1,nf1);
 
+	if (PERSISTENT_COMM){
+		comm_free(vreq);
+		comm_free(sreq);
+
+		free_f3tensor(rbufferlef_to_rig,1,NY,1,NZ,1,nf1);
+		free_f3tensor(rbufferrig_to_lef,1,NY,1,NZ,1,nf2);
+		free_f3tensor(rbuffertop_to_bot,1,NX,1,NZ,1,nf1);
+		free_f3tensor(rbufferbot_to_top,1,NX,1,NZ,1,nf2);
+		free_f3tensor(rbufferfro_to_bac,1,NY,1,NX,1,nf1);
+		free_f3tensor(rbufferbac_to_fro,1,NY,1,NX,1,nf2);
+
+		free_f3tensor(rsbufferlef_to_rig,1,NY,1,NZ,1,nf2);
+		free_f3tensor(rsbufferrig_to_lef,1,NY,1,NZ,1,nf1);
+		free_f3tensor(rsbuffertop_to_bot,1,NX,1,NZ,1,nf2);
+		free_f3tensor(rsbufferbot_to_top,1,NX,1,NZ,1,nf1);
+		free_f3tensor(rsbufferfro_to_bac,1,NY,1,NX,1,nf2);
+		free_f3tensor(rsbufferbac_to_fro,1,NY,1,NX,1,nf1);
+	}
+
 
 	/* free memory for global source positions */
 	free_imatrix(recpos,1,3,1,ntr_glob);
@@ -795,8 +961,9 @@ int main(int argc, char **argv){
 	free_matrix(srcpos,1,6,1,nsrc);
 
 
+	if (seismo_fulldata) free_matrix(seismo_fulldata,1,ntr_glob,1,ns);
+
 	if ((ntr>0) && (SEISMO)){	
-		free_matrix(seismo_fulldata,1,ntr_glob,1,ns);
 		free_imatrix(recpos_loc,1,3,1,ntr);
 
 		switch (SEISMO){
@@ -840,15 +1007,18 @@ int main(int argc, char **argv){
 
 
 	/* free PML indices */
-	free_ivector(xa,0,5);
-	free_ivector(xb,0,5);
-	free_ivector(ya,0,5);
-	free_ivector(yb,0,5);
-	free_ivector(za,0,5);
-	free_ivector(zb,0,5);
+	free_ivector(xa,0,6);
+	free_ivector(xb,0,6);
+	free_ivector(ya,0,6);
+	free_ivector(yb,0,6);
+	free_ivector(za,0,6);
+	free_ivector(zb,0,6);
 	free_ivector(stype,1,nsrc);
 	free_ivector(stype_loc,1,nsrc);
 
+	snap_async_stop();
+	snap_plan_free();
+
 	/* free timing arrays */
 	free_dvector(time_v_update,1,NT);
 	free_dvector(time_s_update,1,NT);
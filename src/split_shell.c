@@ -0,0 +1,281 @@
+/*
+ * Partitioning of the local grid into the boundary shell and the core.
+ *
+ * With OVERLAP_COMM the wavefield is updated in two phases: first the
+ * layers next to the faces which are exchanged with the neighbouring PEs
+ * (the shell), then - while the messages are in flight - the remaining
+ * core of the subdomain. Every grid point and every point source is
+ * updated exactly once and in the same order as in the single-sweep
+ * update, so both modes give bit-identical results.
+ */
+#include "data_structures.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+/*
+ * Clip the core box against the interior box [xb, yb, zb].
+ * The core may become empty, but never overlaps the shell.
+ */
+static void core_box(int *xb, int *yb, int *zb, int *w, GridBox *core)
+{
+    extern int NX, NY, NZ;
+
+    core->nx1 = max(xb[0], w[1] + 1);
+    core->nx1 = min(core->nx1, xb[1] + 1);
+    core->nx2 = min(xb[1], NX - w[2]);
+    core->nx2 = max(core->nx2, core->nx1 - 1);
+
+    core->ny1 = max(yb[0], w[3] + 1);
+    core->ny1 = min(core->ny1, yb[1] + 1);
+    core->ny2 = min(yb[1], NY - w[4]);
+    core->ny2 = max(core->ny2, core->ny1 - 1);
+
+    core->nz1 = max(zb[0], w[5] + 1);
+    core->nz1 = min(core->nz1, zb[1] + 1);
+    core->nz2 = min(zb[1], NZ - w[6]);
+    core->nz2 = max(core->nz2, core->nz1 - 1);
+}
+
+
+/*
+ * Compute the width of the shell at each face of the local grid.
+ *
+ * Parameters
+ * ----------
+ * w :
+ *     Output, w[1..6] are the widths at the left, right, top, bottom,
+ *     front and back face (same order as INDEX).
+ *     Only the FDORDER/2 layers which are sent to a neighbour
+ *     (see exchange_v.c, exchange_s.c) belong to the shell.
+ * wtop :
+ *     Minimum width at the top face, e.g. the layers touched by the
+ *     free surface condition.
+ */
+void shell_width(int *w, int wtop)
+{
+    extern int FDORDER, BOUNDARY, NPROCX, NPROCY, NPROCZ, POS[4];
+
+    int fdoh = FDORDER / 2;
+
+    w[1] = (BOUNDARY || (POS[1] != 0)) ? fdoh : 0;
+    w[2] = (BOUNDARY || (POS[1] != NPROCX - 1)) ? fdoh : 0;
+    w[3] = (BOUNDARY || (POS[2] != 0)) ? fdoh : 0;
+    w[4] = (BOUNDARY || (POS[2] != NPROCY - 1)) ? fdoh : 0;
+    w[5] = (BOUNDARY || (POS[3] != 0)) ? fdoh : 0;
+    w[6] = (BOUNDARY || (POS[3] != NPROCZ - 1)) ? fdoh : 0;
+
+    if (w[3] < wtop) w[3] = wtop;
+}
+
+
+/*
+ * Widen the shell until no source footprint crosses the core boundary.
+ *
+ * Stress sources (eqsource.c, source_moment_tensor.c) modify the points
+ * [i-1..i] x [j-1..j] x [k-1..k]. They are added after the stencil update
+ * of all these points, hence a source must be handled either completely
+ * in the shell phase or completely in the core phase.
+ *
+ * Parameters
+ * ----------
+ * xb, yb, zb :
+ *     Interior box which is updated by the FD stencil.
+ * w :
+ *     Shell widths, see `shell_width`. Widened on output.
+ * srcpos_loc :
+ *     Local source positions.
+ * nsrc :
+ *     Number of local sources.
+ */
+void shell_fit_sources(int *xb, int *yb, int *zb, int *w,
+        float **srcpos_loc, int nsrc)
+{
+    extern int NX, NY, NZ;
+
+    GridBox core;
+    int l, i, j, k, changed;
+
+    do {
+        changed = 0;
+        core_box(xb, yb, zb, w, &core);
+        if ((core.nx1 > core.nx2) || (core.ny1 > core.ny2) || (core.nz1 > core.nz2))
+            break;
+
+        for (l = 1; l <= nsrc; l++) {
+            i = (int)srcpos_loc[1][l];
+            j = (int)srcpos_loc[2][l];
+            k = (int)srcpos_loc[3][l];
+
+            /* footprint does not touch the core */
+            if ((i < core.nx1) || (i - 1 > core.nx2) ||
+                (j < core.ny1) || (j - 1 > core.ny2) ||
+                (k < core.nz1) || (k - 1 > core.nz2))
+                continue;
+
+            if (i - 1 < core.nx1) { w[1] = i; changed = 1; }
+            if (i > core.nx2) { w[2] = NX - i + 2; changed = 1; }
+            if (j - 1 < core.ny1) { w[3] = j; changed = 1; }
+            if (j > core.ny2) { w[4] = NY - j + 2; changed = 1; }
+            if (k - 1 < core.nz1) { w[5] = k; changed = 1; }
+            if (k > core.nz2) { w[6] = NZ - k + 2; changed = 1; }
+        }
+    } while (changed);
+}
+
+
+/*
+ * Split the interior box into six shell slabs and the core.
+ *
+ * Parameters
+ * ----------
+ * xb, yb, zb :
+ *     Interior box which is updated by the FD stencil
+ *     (whole subdomain or the part inside the CPML frame).
+ * w :
+ *     Shell widths, see `shell_width`.
+ * box :
+ *     Output, box[0..5] are the top, bottom, left, right, front and
+ *     back slabs, box[6] is the core. The seven boxes do not overlap and
+ *     together cover the interior box; some of them may be empty.
+ */
+void shell_boxes(int *xb, int *yb, int *zb, int *w, GridBox *box)
+{
+    GridBox core;
+    int b;
+
+    core_box(xb, yb, zb, w, &core);
+
+    for (b = 0; b < 7; b++)
+        box[b] = core;
+
+    /* top and bottom slabs span the whole interior box */
+    box[0].ny1 = yb[0];
+    box[0].ny2 = core.ny1 - 1;
+    box[1].ny1 = core.ny2 + 1;
+    box[1].ny2 = yb[1];
+    for (b = 0; b < 2; b++) {
+        box[b].nx1 = xb[0];
+        box[b].nx2 = xb[1];
+        box[b].nz1 = zb[0];
+        box[b].nz2 = zb[1];
+    }
+
+    /* left and right slabs between top and bottom */
+    box[2].nx1 = xb[0];
+    box[2].nx2 = core.nx1 - 1;
+    box[3].nx1 = core.nx2 + 1;
+    box[3].nx2 = xb[1];
+    for (b = 2; b < 4; b++) {
+        box[b].nz1 = zb[0];
+        box[b].nz2 = zb[1];
+    }
+
+    /* front and back slabs between left and right */
+    box[4].nz1 = zb[0];
+    box[4].nz2 = core.nz1 - 1;
+    box[5].nz1 = core.nz2 + 1;
+    box[5].nz2 = zb[1];
+}
+
+
+/*
+ * Distribute the local point sources over boxes.
+ *
+ * A source at (i, j, k) belongs to the first box which contains
+ * its whole footprint [i-fp..i] x [j-fp..j] x [k-fp..k].
+ * Sources which are not contained in any box (e.g. inside the CPML frame)
+ * are assigned to box 0. The original order is kept within each box.
+ *
+ * Parameters
+ * ----------
+ * nbox :
+ *     Number of boxes.
+ * box :
+ *     Boxes box[0..nbox-1].
+ * fp :
+ *     Extent of the source footprint in negative direction of each axis.
+ * srcpos_loc, signals, nsrc, stype :
+ *     Local sources.
+ * ps :
+ *     Output, sources of box b are copied to ps[b].
+ */
+void shell_sources(int nbox, GridBox *box, int fp,
+        float **srcpos_loc, float **signals, int nsrc, int *stype,
+        PointSources *ps)
+{
+    extern int NT;
+
+    int *owner = NULL;
+    int b, l, m, n, t, i, j, k;
+
+    if (nsrc > 0)
+        owner = ivector(1, nsrc);
+
+    for (b = 0; b < nbox; b++)
+        ps[b].nsrc = 0;
+
+    for (l = 1; l <= nsrc; l++) {
+        i = (int)srcpos_loc[1][l];
+        j = (int)srcpos_loc[2][l];
+        k = (int)srcpos_loc[3][l];
+
+        owner[l] = 0;
+        for (b = 0; b < nbox; b++) {
+            if ((i - fp >= box[b].nx1) && (i <= box[b].nx2) &&
+                (j - fp >= box[b].ny1) && (j <= box[b].ny2) &&
+                (k - fp >= box[b].nz1) && (k <= box[b].nz2)) {
+                owner[l] = b;
+                break;
+            }
+        }
+        ps[owner[l]].nsrc++;
+    }
+
+    for (b = 0; b < nbox; b++) {
+        n = ps[b].nsrc;
+        ps[b].srcpos = NULL;
+        ps[b].signals = NULL;
+        ps[b].stype = NULL;
+        if (n == 0) continue;
+
+        ps[b].srcpos = fmatrix(1, 6, 1, n);
+        ps[b].signals = fmatrix(1, n, 1, NT);
+        ps[b].stype = ivector(1, n);
+
+        m = 0;
+        for (l = 1; l <= nsrc; l++) {
+            if (owner[l] != b) continue;
+            m++;
+            for (t = 1; t <= 6; t++)
+                ps[b].srcpos[t][m] = srcpos_loc[t][l];
+            for (t = 1; t <= NT; t++)
+                ps[b].signals[m][t] = signals[l][t];
+            ps[b].stype[m] = stype[l];
+        }
+    }
+
+    if (nsrc > 0)
+        free_ivector(owner, 1, nsrc);
+}
+
+
+/*
+ * Free the source subsets created by `shell_sources`.
+ */
+void free_shell_sources(int nbox, PointSources *ps)
+{
+    extern int NT;
+
+    int b, n;
+
+    for (b = 0; b < nbox; b++) {
+        n = ps[b].nsrc;
+        if (n == 0) continue;
+
+        free_matrix(ps[b].srcpos, 1, 6, 1, n);
+        free_matrix(ps[b].signals, 1, n, 1, NT);
+        free_ivector(ps[b].stype, 1, n);
+        ps[b].nsrc = 0;
+    }
+}
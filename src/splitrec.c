@@ -11,7 +11,8 @@
 int **splitrec(int **recpos,int *ntr_loc, int ntr, int *recswitch)
 {
 
-	extern int IENDX, IENDY, IENDZ, MYID, POS[4];
+	extern int NPROCX, NPROCY, NPROCZ, MYID, POS[4];
+	extern int OFFX[], OFFY[], OFFZ[];
 	extern FILE *FP;
 
 	int a,b,c,i=0,j,k;
@@ -20,17 +21,17 @@ int **splitrec(int **recpos,int *ntr_loc, int ntr, int *recswitch)
 
 	for (j=1;j<=ntr;j++) {
 		recswitch[j] = 0;
-		a=(recpos[1][j]-1)/IENDX;
-		b=(recpos[2][j]-1)/IENDY;
-		c=(recpos[3][j]-1)/IENDZ;
+		a=decomp_owner(OFFX,NPROCX,recpos[1][j]);
+		b=decomp_owner(OFFY,NPROCY,recpos[2][j]);
+		c=decomp_owner(OFFZ,NPROCZ,recpos[3][j]);
 
 
 		if ((POS[1]==a)&&(POS[2]==b)&&(POS[3]==c)) {
 			recswitch[j] = 1;
 			i++; /* determination of number of receivers per PE */
-			recpos_dummy[1][i] = ((recpos[1][j]-1)%IENDX)+1;
-			recpos_dummy[2][i] = ((recpos[2][j]-1)%IENDY)+1;
-			recpos_dummy[3][i] = ((recpos[3][j]-1)%IENDZ)+1;
+			recpos_dummy[1][i] = recpos[1][j]-OFFX[a];
+			recpos_dummy[2][i] = recpos[2][j]-OFFY[b];
+			recpos_dummy[3][i] = recpos[3][j]-OFFZ[c];
 			recpos_dummy[4][i] = j;
 		}
 	}
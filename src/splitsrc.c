@@ -10,7 +10,8 @@
 float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype)
 {
 
-	extern int IENDX, IENDY, IENDZ, MYID, POS[4];
+	extern int NPROCX, NPROCY, NPROCZ, MYID, POS[4];
+	extern int OFFX[], OFFY[], OFFZ[];
 	extern float DX, DY, DZ;
 	extern FILE *FP;
 
@@ -21,16 +22,16 @@ float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *s
 	stype_dummy  = ivector(1,nsrc);
 
 	for (j=1;j<=nsrc;j++) {
-		a=(iround(srcpos[1][j]/DX)-1)/IENDX;
-		b=(iround(srcpos[2][j]/DY)-1)/IENDY;
-		c=(iround(srcpos[3][j]/DZ)-1)/IENDZ;
+		a=decomp_owner(OFFX,NPROCX,iround(srcpos[1][j]/DX));
+		b=decomp_owner(OFFY,NPROCY,iround(srcpos[2][j]/DY));
+		c=decomp_owner(OFFZ,NPROCZ,iround(srcpos[3][j]/DZ));
 
 
 		if ((POS[1]==a)&&(POS[2]==b)&&(POS[3]==c)) {
 			i++;
-			srcpos_dummy[1][i] = (float)(((iround(srcpos[1][j]/DX)-1)%IENDX)+1);
-			srcpos_dummy[2][i] = (float)(((iround(srcpos[2][j]/DY)-1)%IENDY)+1);
-			srcpos_dummy[3][i] = (float)(((iround(srcpos[3][j]/DZ)-1)%IENDZ)+1);
+			srcpos_dummy[1][i] = (float)(iround(srcpos[1][j]/DX)-OFFX[a]);
+			srcpos_dummy[2][i] = (float)(iround(srcpos[2][j]/DY)-OFFY[b]);
+			srcpos_dummy[3][i] = (float)(iround(srcpos[3][j]/DZ)-OFFZ[c]);
 			srcpos_dummy[4][i] = srcpos[4][j];
 			srcpos_dummy[5][i] = srcpos[5][j];
 			srcpos_dummy[6][i] = srcpos[6][j];
@@ -14,7 +14,9 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
         float * K_x, float * a_x, float * b_x, float * K_z, float * a_z, float * b_z, 
         float *** psi_vxx, float *** psi_vzz ) {
 
-	int i, k ,j, fdoh,m, h1;
+	int i, k ,j, fdoh,m, h1, ib, nbox;
+	int xb[2], yb[2], zb[2];
+	CpmlBox box[27];
 	float  vxx, vyy, vzz;
 	float b, d, e, f, g, h, dthalbe; /* variables "dh24x, dh24y, dh24z" removed, not in use */
 
@@ -33,8 +35,8 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
         float ***rzz = r->zz;
             
 
-	extern int NX, NZ, L, FDORDER, FDCOEFF;
-	extern int ABS_TYPE, POS[4],FW, NPROCX, NPROCZ;
+	extern int NX, NY, NZ, L, FDORDER, FDCOEFF;
+	extern int ABS_TYPE;
 	register float b1, b2, b3, b4, b5, b6;
 	extern float DT, DX, DY, DZ;
 
@@ -42,6 +44,14 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 
 	dthalbe=DT/2.0;
 	fdoh=FDORDER/2;
+
+	/* the CPML corrections (FDORDER 2 and 4) are applied box by box, see
+	   CPML_boxes */
+	xb[0]=1; xb[1]=NX;
+	zb[0]=1; zb[1]=NZ;
+	if (ABS_TYPE==1) CPML_ini_elastic(xb, yb, zb);
+	yb[0]=1; yb[1]=NY;
+	nbox=CPML_boxes(xb, yb, zb, 1, box);
         
 	
 	switch (FDORDER){
@@ -51,8 +61,11 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 		
 	if(FDCOEFF==2){b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/ 
 		
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (ib=0;ib<nbox;ib++){
+		const int cx=box[ib].cx, cz=box[ib].cz, ox=box[ib].ox, oz=box[ib].oz;
+
+	for (k=box[ib].box.nz1;k<=box[ib].box.nz2;k++){
+		for (i=box[ib].box.nx1;i<=box[ib].box.nx2;i++){
 		
 		
 			/*Mirroring the components of the stress tensor to make
@@ -73,28 +86,15 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
                         vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+b2*(vy[j+1][i][k]-vy[j-2][i][k]))/DY;
 			vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+b2*(vz[j][i][k+1]-vz[j][i][k-2]))/DZ;
 			
-			if (ABS_TYPE==1){
-				if((POS[1]==0) && (i<=FW)){
-					psi_vxx[j][i][k] = b_x[i] * psi_vxx[j][i][k] + a_x[i] * vxx;
-					vxx = vxx / K_x[i] + psi_vxx[j][i][k];
-				}
-				if((POS[1]==NPROCX-1) && (i>=NX-FW+1)){
-					h1 = i-NX+2*FW;
-
-					psi_vxx[j][h1][k] = b_x[h1] * psi_vxx[j][h1][k] + a_x[h1] * vxx;
-					vxx = vxx /K_x[h1] + psi_vxx[j][h1][k];
-				}
-				if((POS[3]==0) && (k<=FW)){
-					psi_vzz[j][i][k] = b_z[k] * psi_vzz[j][i][k] + a_z[k] * vzz;
-					vzz = vzz / K_z[k] + psi_vzz[j][i][k];					  
-					}
-				if((POS[3]==NPROCZ-1) && (k>=NZ-FW+1)){
-
-					h1 = (k-NZ+2*FW);
-					psi_vzz[j][i][h1] = b_z[h1] * psi_vzz[j][i][h1] + a_z[h1] * vzz;
-				      vzz = vzz / K_z[h1] + psi_vzz[j][i][h1];
-				}
-					
+			if (cx){
+				h1 = i-ox;
+				psi_vxx[j][h1][k] = b_x[h1] * psi_vxx[j][h1][k] + a_x[h1] * vxx;
+				vxx = vxx / K_x[h1] + psi_vxx[j][h1][k];
+			}
+			if (cz){
+				h1 = k-oz;
+				psi_vzz[j][i][h1] = b_z[h1] * psi_vzz[j][i][h1] + a_z[h1] * vzz;
+				vzz = vzz / K_z[h1] + psi_vzz[j][i][h1];
 			}
 			
 			
@@ -120,6 +120,7 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 			
 		}
 	}
+	}
    break;
    
    case 4 :
@@ -129,8 +130,11 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 		if(FDCOEFF==2){
 		b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/ 
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (ib=0;ib<nbox;ib++){
+		const int cx=box[ib].cx, cz=box[ib].cz, ox=box[ib].ox, oz=box[ib].oz;
+
+	for (k=box[ib].box.nz1;k<=box[ib].box.nz2;k++){
+		for (i=box[ib].box.nx1;i<=box[ib].box.nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -159,28 +163,15 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 			vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+b2*(vy[j+1][i][k]-vy[j-2][i][k]))/DY;
 			vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+b2*(vz[j][i][k+1]-vz[j][i][k-2]))/DZ;
 			
-			if (ABS_TYPE==1){
-				if((POS[1]==0) && (i<=FW)){
-					psi_vxx[j][i][k] = b_x[i] * psi_vxx[j][i][k] + a_x[i] * vxx;
-					vxx = vxx / K_x[i] + psi_vxx[j][i][k];
-				}
-				if((POS[1]==NPROCX-1) && (i>=NX-FW+1)){
-					h1 = i-NX+2*FW;
-
-					psi_vxx[j][h1][k] = b_x[h1] * psi_vxx[j][h1][k] + a_x[h1] * vxx;
-					vxx = vxx /K_x[h1] + psi_vxx[j][h1][k];
-				}
-				if((POS[3]==0) && (k<=FW)){
-					psi_vzz[j][i][k] = b_z[k] * psi_vzz[j][i][k] + a_z[k] * vzz;
-					vzz = vzz / K_z[k] + psi_vzz[j][i][k];					  
-					}
-				if((POS[3]==NPROCZ-1) && (k>=NZ-FW+1)){
-
-					h1 = (k-NZ+2*FW);
-					psi_vzz[j][i][h1] = b_z[h1] * psi_vzz[j][i][h1] + a_z[h1] * vzz;
-				      vzz = vzz / K_z[h1] + psi_vzz[j][i][h1];
-				}
-					
+			if (cx){
+				h1 = i-ox;
+				psi_vxx[j][h1][k] = b_x[h1] * psi_vxx[j][h1][k] + a_x[h1] * vxx;
+				vxx = vxx / K_x[h1] + psi_vxx[j][h1][k];
+			}
+			if (cz){
+				h1 = k-oz;
+				psi_vzz[j][i][h1] = b_z[h1] * psi_vzz[j][i][h1] + a_z[h1] * vzz;
+				vzz = vzz / K_z[h1] + psi_vzz[j][i][h1];
 			}
 			
 			/* partially updating sxx and szz in the same way*/
@@ -203,6 +194,7 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
 			szz[j][i][k]+=(dthalbe*rzz[j][i][k]);
 		}
 	}
+	}
    break;
    
    case 6 :
@@ -1,5 +1,5 @@
 /*------------------------------------------------------------------------
- *   stress free surface condition
+ *   stress free surface condition at gridpoints [nx1...nx2][ndepth][nz1...nz2]
  *
  *  ----------------------------------------------------------------------*/
 
@@ -7,7 +7,8 @@
 #include "fd.h"
 #include "globvar.h"
 
-void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
+void surface_acoustic(int ndepth, int nx1, int nx2, int nz1, int nz2,
+		float *** pi, float *** sxx, Velocity *v){
 
 	int i, k ,j, m, fdoh;
 	float  vxx, vyy, vzz;
@@ -18,7 +19,7 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
         float ***vz = v->z;
 	
 
-	extern int NX, NZ, FDCOEFF, FDORDER;
+	extern int FDCOEFF, FDORDER;
 	extern float DT, DX, DY, DZ;
         register float b1, b2, b3, b4, b5, b6, dx, dy, dz;
 	
@@ -33,8 +34,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		dy=DT/DY;
 		dz=DT/DZ;
 		
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -71,8 +72,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		if(FDCOEFF==2){
 		b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/ 
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -111,8 +112,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		 if(FDCOEFF==2){
 		 b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -156,8 +157,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		 if(FDCOEFF==2){
 		 b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/                
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -202,8 +203,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		if(FDCOEFF==2){
 		b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/               
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
@@ -256,8 +257,8 @@ void surface_acoustic(int ndepth,  float *** pi, float *** sxx, Velocity *v){
 		if(FDCOEFF==2){
 		b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 	
-	for (k=1;k<=NZ;k++){
-		for (i=1;i<=NX;i++){
+	for (k=nz1;k<=nz2;k++){
+		for (i=nx1;i<=nx2;i++){
 
 
 			/*Mirroring the components of the stress tensor to make
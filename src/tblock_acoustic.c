@@ -0,0 +1,507 @@
+/*------------------------------------------------------------------------
+ *   Temporal blocking of the time loop of the acoustic program
+ *   (TIME_BLOCK > 1).
+ *
+ *   The wavefield is exchanged between PEs only every TIME_BLOCK time
+ *   steps, but with a ghost zone of NG = TIME_BLOCK*FDORDER grid points.
+ *   Within a block each PE also updates the part of the ghost zone which
+ *   is still valid; it shrinks by FDORDER/2 points per half step. The
+ *   ghost points are updated exactly like on the PE they belong to
+ *   (point sources, absorbing frame and free surface included), so the
+ *   result does not depend on the domain decomposition.
+ *
+ *   The time steps of a block are advanced in a single sweep over the
+ *   planes j (wavefront): plane j of time step m is updated as soon as
+ *   the planes of time step m-1 it depends on are done. The planes which
+ *   are in flight for all steps of the block fit into the cache for
+ *   moderate grid sizes, so the wavefield is loaded from memory about
+ *   once per block instead of twice per time step.
+ *  ----------------------------------------------------------------------*/
+
+#include "data_structures.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+/* point source of the ghost zone in global order, for sorting by y */
+typedef struct {
+    int x, y, z, l;
+} GhostSource;
+
+
+/*
+ * 1 if the local grid has a neighbour at face f = 1...6 (order of INDEX:
+ * left, right, top, bottom, front, back), i.e. if the ghost zone at this
+ * face is exchanged. The global grid is periodic in x and z for BOUNDARY=1.
+ */
+static int has_neighbour(int f)
+{
+    extern int POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY;
+
+    switch (f) {
+    case 1: return (BOUNDARY || (POS[1] != 0));
+    case 2: return (BOUNDARY || (POS[1] != NPROCX - 1));
+    case 3: return (POS[2] != 0);
+    case 4: return (POS[2] != NPROCY - 1);
+    case 5: return (BOUNDARY || (POS[3] != 0));
+    case 6: return (BOUNDARY || (POS[3] != NPROCZ - 1));
+    }
+    return 0;
+}
+
+
+/*
+ * Local grid extended by e points at the faces with a neighbour.
+ */
+static void tblock_box(int e, GridBox *box)
+{
+    extern int NX, NY, NZ;
+
+    box->nx1 = 1 - (has_neighbour(1) ? e : 0);
+    box->nx2 = NX + (has_neighbour(2) ? e : 0);
+    box->ny1 = 1 - (has_neighbour(3) ? e : 0);
+    box->ny2 = NY + (has_neighbour(4) ? e : 0);
+    box->nz1 = 1 - (has_neighbour(5) ? e : 0);
+    box->nz2 = NZ + (has_neighbour(6) ? e : 0);
+}
+
+
+/*
+ * Width of the ghost zone of wavefield and model for TIME_BLOCK > 1.
+ * The layers of the ghost zone are copied from the direct neighbours only,
+ * so the local grid must be at least as large in each direction with a
+ * neighbour.
+ */
+int tblock_width(void)
+{
+    extern int NX, NY, NZ, FDORDER, TIME_BLOCK;
+
+    int ng = TIME_BLOCK * FDORDER;
+
+    if (((NX < ng) && (has_neighbour(1) || has_neighbour(2))) ||
+        ((NY < ng) && (has_neighbour(3) || has_neighbour(4))) ||
+        ((NZ < ng) && (has_neighbour(5) || has_neighbour(6))))
+        err("TIME_BLOCK=%d requires local grids of at least %d points "
+            "(TIME_BLOCK*FDORDER) in each direction, reduce TIME_BLOCK or NPROCX/Y/Z",
+            TIME_BLOCK, ng);
+
+    return ng;
+}
+
+
+/*
+ * Copy the part lo...hi of array a into buf (unpack=0) or back (unpack=1).
+ * Index 1, 2, 3 of lo and hi are x, y, z.
+ */
+static void halo_copy(float ***a, int *lo, int *hi, float *buf, int unpack)
+{
+    int i, j, k;
+    size_t l = 0;
+
+    for (j = lo[2]; j <= hi[2]; j++)
+        for (i = lo[1]; i <= hi[1]; i++)
+            for (k = lo[3]; k <= hi[3]; k++) {
+                if (unpack)
+                    a[j][i][k] = buf[l++];
+                else
+                    buf[l++] = a[j][i][k];
+            }
+}
+
+
+/*
+ * Exchange a ghost zone of width w of n arrays with the neighbouring PEs.
+ *
+ * The arrays must be allocated with the index range [1-w...N+w] in each
+ * direction. The directions are exchanged one after the other (x, y, z),
+ * each including the ghost zone of the previous ones, so that edges and
+ * corners of the ghost zone are filled as well.
+ *
+ * Returns
+ * -------
+ * Real time for the exchange if LOG is set.
+ */
+double exchange_halo(int n, float ****a, int w)
+{
+    extern int NX, NY, NZ, INDEX[7], LOG;
+    extern const int TAG1, TAG2;
+
+    int size[4], lo[4], hi[4];
+    int d, f, b, count, maxcount = 0;
+    float *sbuf, *rbuf;
+    double time1 = 0.0;
+    MPI_Status status;
+
+    if (LOG) time1 = MPI_Wtime();
+
+    size[1] = NX;
+    size[2] = NY;
+    size[3] = NZ;
+
+    /* size of the ghost layer of width w across direction d */
+    for (d = 1; d <= 3; d++) {
+        count = n * w;
+        for (f = 1; f <= 3; f++)
+            if (f != d) count *= size[f] + 2 * w;
+        maxcount = max(maxcount, count);
+    }
+    sbuf = (float *)malloc(maxcount * sizeof(float));
+    rbuf = (float *)malloc(maxcount * sizeof(float));
+    if ((sbuf == NULL) || (rbuf == NULL))
+        err("allocation failure in function exchange_halo()");
+
+    for (d = 1; d <= 3; d++) {
+        count = n * w;
+        for (f = 1; f <= 3; f++) {
+            lo[f] = 1 - w;
+            hi[f] = size[f] + w;
+            if (f != d) count *= size[f] + 2 * w;
+        }
+
+        /* to the lower neighbour (face 2d-1), from the upper one (face 2d) */
+        lo[d] = 1;
+        hi[d] = w;
+        for (b = 0; b < n; b++)
+            halo_copy(a[b], lo, hi, sbuf + b * count / n, 0);
+        MPI_Sendrecv(sbuf, count, MPI_FLOAT,
+                has_neighbour(2 * d - 1) ? INDEX[2 * d - 1] : MPI_PROC_NULL, TAG1,
+                rbuf, count, MPI_FLOAT,
+                has_neighbour(2 * d) ? INDEX[2 * d] : MPI_PROC_NULL, TAG1,
+                MPI_COMM_WORLD, &status);
+        if (has_neighbour(2 * d)) {
+            lo[d] = size[d] + 1;
+            hi[d] = size[d] + w;
+            for (b = 0; b < n; b++)
+                halo_copy(a[b], lo, hi, rbuf + b * count / n, 1);
+        }
+
+        /* to the upper neighbour, from the lower one */
+        lo[d] = size[d] - w + 1;
+        hi[d] = size[d];
+        for (b = 0; b < n; b++)
+            halo_copy(a[b], lo, hi, sbuf + b * count / n, 0);
+        MPI_Sendrecv(sbuf, count, MPI_FLOAT,
+                has_neighbour(2 * d) ? INDEX[2 * d] : MPI_PROC_NULL, TAG2,
+                rbuf, count, MPI_FLOAT,
+                has_neighbour(2 * d - 1) ? INDEX[2 * d - 1] : MPI_PROC_NULL, TAG2,
+                MPI_COMM_WORLD, &status);
+        if (has_neighbour(2 * d - 1)) {
+            lo[d] = 1 - w;
+            hi[d] = 0;
+            for (b = 0; b < n; b++)
+                halo_copy(a[b], lo, hi, rbuf + b * count / n, 1);
+        }
+    }
+
+    free(sbuf);
+    free(rbuf);
+
+    return LOG ? MPI_Wtime() - time1 : 0.0;
+}
+
+
+static int compare_ghost_source(const void *p1, const void *p2)
+{
+    const GhostSource *s1 = p1, *s2 = p2;
+
+    if (s1->y != s2->y) return (s1->y < s2->y) ? -1 : 1;
+    return (s1->l < s2->l) ? -1 : (s1->l > s2->l);
+}
+
+
+/*
+ * Point sources of the local grid and of its ghost zone for TIME_BLOCK > 1.
+ *
+ * Parameters
+ * ----------
+ * srcpos, nsrc, stype :
+ *     Global source positions as passed to `splitsrc`.
+ * ps :
+ *     Output, sources in the layout of `splitsrc` (local grid coordinates,
+ *     which may lie in the ghost zone) with their signals, sorted by y.
+ *     Sources at the same grid point keep their order. With periodic
+ *     boundaries a source can appear twice. Free with `free_shell_sources`.
+ */
+void tblock_sources(float **srcpos, int nsrc, int *stype, PointSources *ps)
+{
+    extern int NX, NY, NZ, NXG, NZG, POS[4], BOUNDARY, TIME_BLOCK, FDORDER;
+    extern int OFFX[], OFFY[], OFFZ[];
+    extern float DX, DY, DZ;
+    extern FILE *FP;
+
+    GhostSource *gs = NULL;
+    GridBox box;
+    int l, n = 0, sx, sz, x, y, z, m;
+
+    tblock_box(TIME_BLOCK * FDORDER, &box);
+
+    if (nsrc > 0) {
+        /* at most 9 copies of a source with periodic boundaries */
+        gs = (GhostSource *)malloc(9 * nsrc * sizeof(GhostSource));
+        if (gs == NULL) err("allocation failure in function tblock_sources()");
+    }
+
+    for (l = 1; l <= nsrc; l++) {
+        y = iround(srcpos[2][l] / DY) - OFFY[POS[2]];
+        for (sx = -BOUNDARY; sx <= BOUNDARY; sx++)
+            for (sz = -BOUNDARY; sz <= BOUNDARY; sz++) {
+                x = iround(srcpos[1][l] / DX) - OFFX[POS[1]] + sx * NXG;
+                z = iround(srcpos[3][l] / DZ) - OFFZ[POS[3]] + sz * NZG;
+                if ((x < box.nx1) || (x > box.nx2) || (y < box.ny1) || (y > box.ny2) ||
+                    (z < box.nz1) || (z > box.nz2))
+                    continue;
+                gs[n].x = x;
+                gs[n].y = y;
+                gs[n].z = z;
+                gs[n].l = l;
+                n++;
+            }
+    }
+
+    if (n > 0) qsort(gs, n, sizeof(GhostSource), compare_ghost_source);
+
+    ps->nsrc = n;
+    ps->srcpos = NULL;
+    ps->signals = NULL;
+    ps->stype = NULL;
+    if (n > 0) {
+        ps->srcpos = fmatrix(1, 6, 1, n);
+        ps->stype = ivector(1, n);
+        for (m = 1; m <= n; m++) {
+            l = gs[m - 1].l;
+            ps->srcpos[1][m] = (float)gs[m - 1].x;
+            ps->srcpos[2][m] = (float)gs[m - 1].y;
+            ps->srcpos[3][m] = (float)gs[m - 1].z;
+            ps->srcpos[4][m] = srcpos[4][l];
+            ps->srcpos[5][m] = srcpos[5][l];
+            ps->srcpos[6][m] = srcpos[6][l];
+            ps->stype[m] = stype[l];
+        }
+        ps->signals = wavelet(ps->srcpos, n);
+    }
+    free(gs);
+
+    fprintf(FP, " Number of sources in the local grid and its ghost zone: %d \n", n);
+}
+
+
+/*
+ * Sources of ps inside box, in the order of ps. The signals are shared
+ * with ps. Free with `free_box_sources`.
+ */
+static void box_sources(PointSources *ps, GridBox *box, PointSources *sub)
+{
+    int l, m, n = 0, x, y, z;
+
+    for (l = 1; l <= ps->nsrc; l++) {
+        x = (int)ps->srcpos[1][l];
+        y = (int)ps->srcpos[2][l];
+        z = (int)ps->srcpos[3][l];
+        if ((x >= box->nx1) && (x <= box->nx2) && (y >= box->ny1) && (y <= box->ny2) &&
+            (z >= box->nz1) && (z <= box->nz2))
+            n++;
+    }
+
+    sub->nsrc = n;
+    if (n == 0) return;
+
+    sub->srcpos = fmatrix(1, 6, 1, n);
+    sub->stype = ivector(1, n);
+    /* row pointers only, index 0 is not used */
+    sub->signals = (float **)malloc((n + 1) * sizeof(float *));
+    if (sub->signals == NULL) err("allocation failure in function box_sources()");
+
+    n = 0;
+    for (l = 1; l <= ps->nsrc; l++) {
+        x = (int)ps->srcpos[1][l];
+        y = (int)ps->srcpos[2][l];
+        z = (int)ps->srcpos[3][l];
+        if ((x >= box->nx1) && (x <= box->nx2) && (y >= box->ny1) && (y <= box->ny2) &&
+            (z >= box->nz1) && (z <= box->nz2)) {
+            n++;
+            for (m = 1; m <= 6; m++)
+                sub->srcpos[m][n] = ps->srcpos[m][l];
+            sub->signals[n] = ps->signals[l];
+            sub->stype[n] = ps->stype[l];
+        }
+    }
+}
+
+
+static void free_box_sources(PointSources *sub)
+{
+    if (sub->nsrc == 0) return;
+
+    free_matrix(sub->srcpos, 1, 6, 1, sub->nsrc);
+    free_ivector(sub->stype, 1, sub->nsrc);
+    free(sub->signals);
+}
+
+
+/*
+ * The next sources of sub (sorted by y) up to plane ny2. cur is the index
+ * of the first source which has not been returned yet, rows holds the row
+ * pointers of part->srcpos.
+ */
+static void plane_sources(PointSources *sub, int *cur, int ny2, float **rows,
+        PointSources *part)
+{
+    int first = *cur, m;
+
+    while ((*cur <= sub->nsrc) && ((int)sub->srcpos[2][*cur] <= ny2))
+        (*cur)++;
+
+    part->nsrc = *cur - first;
+    part->srcpos = NULL;
+    part->signals = NULL;
+    part->stype = NULL;
+    if (part->nsrc == 0) return;
+
+    for (m = 1; m <= 6; m++)
+        rows[m] = sub->srcpos[m] + first - 1;
+    part->srcpos = rows;
+    part->signals = sub->signals + first - 1;
+    part->stype = sub->stype + first - 1;
+}
+
+
+/*
+ * Advance the wavefield from time step nt1 to nt2 (at most TIME_BLOCK
+ * steps) with ABS_TYPE=2.
+ *
+ * Does the work of update_v_acoustic, absorb_s_acoustic,
+ * update_s_acoustic, exchange_v/exchange_s_acoustic, psource_acoustic,
+ * surface_acoustic and seismo_acoustic of the time loop in sofi3D_acoustic.c
+ * for these time steps, with the same result.
+ *
+ * Parameters
+ * ----------
+ * nt1, nt2 :
+ *     First and last time step of the block.
+ * lsamp, nlsamp :
+ *     Next time step with a seismogram sample at or after nt1 and the index
+ *     of this sample.
+ * v, sxx, rho, pi :
+ *     Wavefield and model, allocated with a ghost zone of TIME_BLOCK*FDORDER
+ *     points, the model is valid in the ghost zone.
+ * absorb_frame :
+ *     Absorbing frame, defined in the same ghost zone.
+ * ps :
+ *     Sources of the local grid and its ghost zone, see `tblock_sources`.
+ * ntr, recpos_loc, sectionvx, ..., sectionp :
+ *     Local receivers and seismograms as for `seismo_acoustic`.
+ * time_exchange :
+ *     Output, real time for the exchange of the ghost zone if LOG is set.
+ *
+ * Returns
+ * -------
+ * Real time for the update of the wavefield if LOG is set.
+ */
+double tblock_acoustic(int nt1, int nt2, int lsamp, int nlsamp,
+        Velocity *v, float ***sxx, float ***rho, float ***pi, const AbsorbFrame *absorb_frame,
+        PointSources *ps, int ntr, int **recpos_loc,
+        float **sectionvx, float **sectionvy, float **sectionvz,
+        float **sectiondiv, float **sectioncurl, float **sectionp,
+        double *time_exchange)
+{
+    extern int FDORDER, TIME_BLOCK, FREE_SURF, POS[4], SEISMO, NDT, LOG, CHECKPTREAD;
+
+    int nb = nt2 - nt1 + 1, fdoh = FDORDER / 2, lag = FDORDER - 1;
+    int vdone[nb], sdone[nb], rdone[nb], vcur[nb], scur[nb], surf[nb];
+    GridBox bv[nb], bs[nb], box;
+    PointSources sv[nb], ss[nb], part;
+    float *rows[7], ***halo[4];
+    int m, nt, f, hi, all;
+    double time1 = 0.0;
+
+    /* The wavefield is valid in the whole ghost zone after the exchange.
+     * Step m updates the particle velocities in bv[m] and the pressure in
+     * bs[m], each FDORDER/2 points smaller than the box before. */
+    halo[0] = v->x;
+    halo[1] = v->y;
+    halo[2] = v->z;
+    halo[3] = sxx;
+    *time_exchange = exchange_halo(4, halo, TIME_BLOCK * FDORDER);
+
+    if (LOG) time1 = MPI_Wtime();
+
+    for (m = 0; m < nb; m++) {
+        tblock_box((2 * (nb - 1 - m) + 1) * fdoh, &bv[m]);
+        tblock_box(2 * (nb - 1 - m) * fdoh, &bs[m]);
+        box_sources(ps, &bv[m], &sv[m]);
+        box_sources(ps, &bs[m], &ss[m]);
+        vdone[m] = bv[m].ny1 - 1;
+        sdone[m] = bs[m].ny1 - 1;
+        rdone[m] = 0;
+        vcur[m] = scur[m] = 1;
+        surf[m] = !((FREE_SURF) && (POS[2] == 0));
+    }
+
+    /* Plane f is the front of the particle velocities of step 0. Step m
+     * follows FDORDER-1 planes behind step m-1, the pressure of each step
+     * FDORDER/2-1 planes behind its particle velocities:
+     * - the particle velocities at plane j read the pressure of the step
+     *   before at planes j-FDORDER/2+1 ... j+FDORDER/2,
+     * - the pressure at plane j reads the particle velocities at planes
+     *   j-FDORDER/2 ... j+FDORDER/2-1,
+     * so each plane is overwritten only after all planes which read its
+     * old value are done. */
+    f = bv[0].ny1 - 1;
+    do {
+        f++;
+        all = 1;
+        for (m = 0; m < nb; m++) {
+            nt = nt1 + m;
+
+            hi = min(f - m * lag, bv[m].ny2);
+            if (hi > vdone[m]) {
+                box = bv[m];
+                box.ny1 = vdone[m] + 1;
+                box.ny2 = hi;
+                plane_sources(&sv[m], &vcur[m], hi, rows, &part);
+                update_v_acoustic(box.nx1, box.nx2, box.ny1, box.ny2, box.nz1, box.nz2, nt,
+                        v, sxx, rho, part.srcpos, part.signals, part.nsrc, absorb_frame, part.stype);
+                vdone[m] = hi;
+            }
+
+            hi = min(f - m * lag - (fdoh - 1), bs[m].ny2);
+            if (hi > sdone[m]) {
+                box = bs[m];
+                box.ny1 = sdone[m] + 1;
+                box.ny2 = hi;
+                absorb_s_acoustic(box.nx1, box.nx2, box.ny1, box.ny2, box.nz1, box.nz2,
+                        sxx, absorb_frame);
+                update_s_acoustic(box.nx1, box.nx2, box.ny1, box.ny2, box.nz1, box.nz2,
+                        v, sxx, pi);
+                plane_sources(&ss[m], &scur[m], hi, rows, &part);
+                if ((!CHECKPTREAD) && (part.nsrc > 0))
+                    psource_acoustic(nt, sxx, part.srcpos, part.signals, part.nsrc, part.stype);
+                sdone[m] = hi;
+            }
+
+            /* the free surface reads the pressure down to plane FDORDER/2+1 */
+            if ((!surf[m]) && (sdone[m] >= min(fdoh + 1, bs[m].ny2))) {
+                surface_acoustic(1, bs[m].nx1, bs[m].nx2, bs[m].nz1, bs[m].nz2, pi, sxx, v);
+                surf[m] = 1;
+            }
+
+            /* seismogram samples of the planes which are complete */
+            if ((SEISMO) && (ntr > 0) && (surf[m]) && (nt >= lsamp) &&
+                (((nt - lsamp) % NDT) == 0) && (sdone[m] > rdone[m])) {
+                seismo_acoustic(nlsamp + (nt - lsamp) / NDT, ntr, recpos_loc,
+                        sectionvx, sectionvy, sectionvz, sectiondiv, sectioncurl, sectionp,
+                        v, sxx, pi, rdone[m] + 1, sdone[m]);
+                rdone[m] = sdone[m];
+            }
+
+            if ((sdone[m] < bs[m].ny2) || (!surf[m])) all = 0;
+        }
+    } while (!all);
+
+    for (m = 0; m < nb; m++) {
+        free_box_sources(&sv[m]);
+        free_box_sources(&ss[m]);
+    }
+
+    return LOG ? MPI_Wtime() - time1 : 0.0;
+}
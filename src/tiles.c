@@ -0,0 +1,132 @@
+/*
+ * Cache tiles of the update loops.
+ *
+ * The update functions sweep j -> i -> k over the box they are given.
+ * For large subdomains the FDORDER planes in j which a stencil reads do
+ * not fit into the L2 cache, so every plane is loaded from memory again
+ * for each of its FDORDER uses. With TILE_X, TILE_Y, TILE_Z the box is
+ * split into tiles and the update functions are called for one tile after
+ * the other. Tiling in x (and z) keeps the planes of a tile in the cache
+ * while j streams through it. Every grid point and point source is still
+ * updated exactly once, so the results do not depend on the tile size.
+ */
+#include <unistd.h>
+
+#include "data_structures.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+/* L2 cache size in bytes assumed if it cannot be determined */
+#define TILE_L2_DEFAULT (1024 * 1024)
+
+
+/*
+ * Size of the L2 cache of the calling core in bytes.
+ */
+static long l2_cache_size(void)
+{
+    long size = 0;
+
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (size <= 0) {
+        FILE *fp = fopen("/sys/devices/system/cpu/cpu0/cache/index2/size", "r");
+        char unit = 'K';
+        if (fp) {
+            if (fscanf(fp, "%ld%c", &size, &unit) < 1) size = 0;
+            fclose(fp);
+        }
+        if (unit == 'K') size *= 1024;
+        if (unit == 'M') size *= 1024 * 1024;
+    }
+    if (size <= 0) size = TILE_L2_DEFAULT;
+    return size;
+}
+
+
+/*
+ * Choose TILE_X and TILE_Z from the size of the L2 cache (TILE_AUTO).
+ *
+ * The stress update reads FDORDER planes in j of three velocity
+ * components and one plane of about 18 further arrays (stress,
+ * stiffness, density) per grid point of a tile. Half of the L2 cache
+ * is reserved for these planes. Full rows in z are kept if possible,
+ * because they are the unit-stride direction of the vectorized loops.
+ * Must be called after NX, NY, NZ have been set to the local grid size.
+ */
+void tile_auto(void)
+{
+    extern int NX, NZ, FDORDER, TILE_X, TILE_Y, TILE_Z;
+
+    long area = l2_cache_size() / 2 / (sizeof(float) * (3 * FDORDER + 18));
+    int tx, tz = NZ;
+
+    tx = (int)(area / tz);
+    if (tx < FDORDER) {
+        tx = FDORDER;
+        /* shorter rows, but a multiple of the AVX-512 vector length */
+        tz = max(16, (int)(area / tx) / 16 * 16);
+    }
+
+    TILE_X = (tx < NX) ? tx : 0;
+    TILE_Y = 0;
+    TILE_Z = (tz < NZ) ? tz : 0;
+}
+
+
+/*
+ * Split a box into tiles.
+ *
+ * Parameters
+ * ----------
+ * box :
+ *     Box to be split, may be empty.
+ * tile :
+ *     tile[1..3] are the tile sizes in x, y and z, 0 means no splitting
+ *     along this axis.
+ * tiles :
+ *     Output, newly allocated array of the tiles. The tiles do not overlap
+ *     and cover the box. Tiles which share the same x and z range follow
+ *     each other, j (y) varies fastest. Free with `free`.
+ *
+ * Returns
+ * -------
+ * Number of tiles.
+ */
+int tile_boxes(GridBox *box, int *tile, GridBox **tiles)
+{
+    int n[4], t[4], lo[4], hi[4];
+    int a, ix, iy, iz, m;
+
+    lo[1] = box->nx1; hi[1] = box->nx2;
+    lo[2] = box->ny1; hi[2] = box->ny2;
+    lo[3] = box->nz1; hi[3] = box->nz2;
+
+    for (a = 1; a <= 3; a++) {
+        t[a] = hi[a] - lo[a] + 1;
+        if ((tile[a] > 0) && (tile[a] < t[a])) t[a] = tile[a];
+        if (t[a] < 1) t[a] = 1;
+        n[a] = (hi[a] - lo[a] + t[a]) / t[a];
+        if (n[a] < 1) n[a] = 1;
+    }
+
+    *tiles = (GridBox *)malloc(n[1] * n[2] * n[3] * sizeof(GridBox));
+    if (*tiles == NULL) err("allocation failure in function tile_boxes()");
+
+    m = 0;
+    for (ix = 0; ix < n[1]; ix++)
+        for (iz = 0; iz < n[3]; iz++)
+            for (iy = 0; iy < n[2]; iy++) {
+                (*tiles)[m].nx1 = lo[1] + ix * t[1];
+                (*tiles)[m].nx2 = min(hi[1], lo[1] + (ix + 1) * t[1] - 1);
+                (*tiles)[m].ny1 = lo[2] + iy * t[2];
+                (*tiles)[m].ny2 = min(hi[2], lo[2] + (iy + 1) * t[2] - 1);
+                (*tiles)[m].nz1 = lo[3] + iz * t[3];
+                (*tiles)[m].nz2 = min(hi[3], lo[3] + (iz + 1) * t[3] - 1);
+                m++;
+            }
+
+    return m;
+}
@@ -12,13 +12,14 @@ void timing(double * time_v_update,  double * time_s_update, double * time_s_exc
             double * time_timestep, int ishot){
 
 
-extern int NT, RUN_MULTIPLE_SHOTS;
+extern int NT, RUN_MULTIPLE_SHOTS, SNAP;
 extern FILE *FP; 
 extern char LOG_FILE[STRING_SIZE];
 
 char T_FILE[STRING_SIZE];
 FILE *fp;
 int nt;
+double time_snap_hidden, time_snap_exposed;
 double 	time_av_v_update=0.0, time_av_s_update=0.0, time_av_v_exchange=0.0, time_av_s_exchange=0.0, time_av_timestep=0.0, 
 	stdev_v_update=0.0, stdev_s_update=0.0, stdev_s_exchange=0.0, stdev_v_exchange=0.0, stdev_timestep=0.0;
 
@@ -62,6 +63,15 @@ double 	time_av_v_update=0.0, time_av_s_update=0.0, time_av_v_exchange=0.0, time
 	fprintf(FP,"   stress exchange:  \t %6.3f seconds +/- %6.3f per cent  \n",time_av_s_exchange, stdev_s_exchange);
 	fprintf(FP,"   timestep:  \t\t %6.3f seconds +/- %6.3f per cent  \n",time_av_timestep, stdev_timestep);
 
+	/* snapshot output of PE 0: hidden by the I/O thread and exposed to the
+	   time stepping (SNAP_ASYNC) */
+	if (SNAP){
+		snap_async_times(&time_snap_hidden, &time_snap_exposed);
+		fprintf(FP," Snapshot output (PE 0): \n");
+		fprintf(FP,"   hidden by I/O thread: \t %6.3f seconds \n",time_snap_hidden);
+		fprintf(FP,"   exposed to timestepping: \t %6.3f seconds \n",time_snap_exposed);
+	}
+
 
 	/* output of timings to ASCII file (for later performance analysis) */
 	if (RUN_MULTIPLE_SHOTS) 
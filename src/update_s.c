@@ -54,7 +54,6 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
 
     extern float DT, DX, DY, DZ;
     extern int L, MYID, FDORDER,FDORDER_TIME, LOG, FDCOEFF;
-    extern FILE *FP;
     extern int OUTNTIMESTEPINFO;
 
     float ***vx = v->x;
@@ -177,8 +176,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -278,8 +286,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -378,8 +395,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -505,8 +531,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -642,8 +677,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -792,8 +836,17 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, \
+        sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, \
+        vxxyyzz_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, l, b, c, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 /* spatial derivatives of the components of the velocities
@@ -949,6 +1002,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     
                 case 2 :
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1075,6 +1145,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1205,6 +1292,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1359,6 +1463,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1523,6 +1644,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1701,6 +1839,23 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, \
+        vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, \
+        vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, rxx_j_i, \
+        ryy_j_i, rzz_j_i, rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, \
+        rxy_j_i_2, ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, \
+        ryz_j_i_3, rxz_j_i_3, vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, \
+        vxxzz_j_i, vxxyy_j_i, vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, \
+        vyyzz_j_i_2, vxxzz_j_i_2, vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, \
+        vxxyyzz_j_i_3, vyyzz_j_i_3, vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, \
+        vyz, vzx, vzy, vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, \
+        fjpkp, fipkp, g, f, vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, \
+        vdiag, l, n1, n2, n3, n4, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1886,6 +2041,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     
                 case 2 :
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2019,6 +2195,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2155,6 +2352,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2314,6 +2532,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2485,6 +2724,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2668,6 +2928,27 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, rxx_j, ryy_j, rzz_j, rxy_j, ryz_j, rxz_j, rxx_j_2, ryy_j_2, rzz_j_2, \
+        rxy_j_2, ryz_j_2, rxz_j_2, rxx_j_3, ryy_j_3, rzz_j_3, rxy_j_3, ryz_j_3, rxz_j_3, \
+        rxx_j_4, ryy_j_4, rzz_j_4, rxy_j_4, ryz_j_4, rxz_j_4, vxyyx_j, vyzzy_j, vxzzx_j, \
+        vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, \
+        vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, \
+        vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, \
+        vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, rxx_j_i, ryy_j_i, rzz_j_i, \
+        rxy_j_i, ryz_j_i, rxz_j_i, rxx_j_i_2, ryy_j_i_2, rzz_j_i_2, rxy_j_i_2, \
+        ryz_j_i_2, rxz_j_i_2, rxx_j_i_3, ryy_j_i_3, rzz_j_i_3, rxy_j_i_3, ryz_j_i_3, \
+        rxz_j_i_3, rxx_j_i_4, ryy_j_i_4, rzz_j_i_4, rxy_j_i_4, ryz_j_i_4, rxz_j_i_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, sumrxy, sumryz, sumrxz, sumrxx, sumryy, sumrzz, fipjp, fjpkp, fipkp, g, f, \
+        vxyyx_T2, vyzzy_T2, vxzzx_T2, vyyzz_T2, vxxzz_T2, vxxyy_T2, vdiag, l, n1, n2, \
+        n3, n4, n5, dipjp, djpkp, dipkp, d, e)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2859,7 +3140,6 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
 		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
 			time2=MPI_Wtime();
 			time=time2-time1;
-			fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time);
 		}
 	return time;
 
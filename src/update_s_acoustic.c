@@ -11,14 +11,12 @@
 #include "globvar.h"
 
 
-double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
+double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		Velocity *v, float *** sxx, float ***  pi){
 
 
 	extern float DT, DX, DY, DZ;
-	extern int MYID, FDORDER, LOG, FDCOEFF;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
+	extern int FDORDER, LOG, FDCOEFF;
 
 	register int i, j, k;
 	double time=0.0, time1=0.0, time2=0.0;
@@ -30,8 +28,7 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
         float ***vy = v->y;
         float ***vz = v->z;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+	if (LOG) time1=MPI_Wtime();
 
 	switch (FDORDER){
 	case 2 :
@@ -240,12 +237,10 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 		break;
 	} /* end of switch (FDORDER) */
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
-			time2=MPI_Wtime();
-			time=time2-time1;
-			fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time);
-		}
+	if (LOG) {
+		time2=MPI_Wtime();
+		time=time2-time1;
+	}
 	return time;
 
 }
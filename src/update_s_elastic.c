@@ -23,7 +23,6 @@ double update_s_elastic(
 {
     extern float DT, DX, DY, DZ;
     extern int MYID, FDORDER, FDORDER_TIME, LOG, FDCOEFF;
-    extern FILE *FP;
     extern int OUTNTIMESTEPINFO;
 
     float ***vx = v->x;
@@ -98,6 +97,10 @@ double update_s_elastic(
     {
         case 2:
 
+            /* AVX2/AVX-512 kernels, see update_simd.c */
+            if (update_s_elastic_simd(nx1, nx2, ny1, ny2, nz1, nz2, v, s, op))
+                break;
+
             switch (FDORDER)
             {
                 case 2:
@@ -109,6 +112,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -119,6 +126,9 @@ double update_s_elastic(
                         {
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k = nz1; k <= nz2; k++)
                             {
@@ -143,6 +153,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent collapse(3)
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -150,6 +164,9 @@ double update_s_elastic(
                         for (i = nx1; i <= nx2; i++)
                         {
                             //#pragma acc loop independent
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -194,6 +211,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -204,6 +225,9 @@ double update_s_elastic(
                         {
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k = nz1; k <= nz2; k++)
                             {
@@ -285,6 +309,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -389,6 +417,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -399,6 +431,9 @@ double update_s_elastic(
                         {
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k = nz1; k <= nz2; k++)
                             {
@@ -505,6 +540,10 @@ double update_s_elastic(
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, e)
 #endif
                     for (j = ny1; j <= ny2; j++)
                     {
@@ -515,6 +554,9 @@ double update_s_elastic(
                         {
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k = nz1; k <= nz2; k++)
                             {
@@ -618,6 +660,17 @@ double update_s_elastic(
             {
                 case 2:
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -666,6 +719,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -718,6 +774,17 @@ double update_s_elastic(
                         b2 = -0.046414;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -766,6 +833,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -820,6 +890,17 @@ double update_s_elastic(
                         b3 = 0.0081781;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -868,6 +949,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -959,6 +1043,17 @@ double update_s_elastic(
                         b4 = -0.0026274;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1007,6 +1102,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1110,6 +1208,17 @@ double update_s_elastic(
                         b5 = 0.001191;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1158,6 +1267,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1274,6 +1386,17 @@ double update_s_elastic(
                         b6 = -0.00066667;
                     }
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, c66ipjp, \
+        c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1322,6 +1445,9 @@ double update_s_elastic(
                             vxxzz_j_i_3 = *(vxxzz_j_3 + i);
                             vxxyy_j_i_3 = *(vxxyy_j_3 + i);
 
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1439,6 +1565,19 @@ double update_s_elastic(
             {
                 case 2:
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1499,6 +1638,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1551,6 +1693,19 @@ double update_s_elastic(
                         b2 = -0.046414;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1611,6 +1766,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1665,6 +1823,19 @@ double update_s_elastic(
                         b3 = 0.0081781;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1725,6 +1896,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1816,6 +1990,19 @@ double update_s_elastic(
                         b4 = -0.0026274;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1876,6 +2063,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -1979,6 +2169,19 @@ double update_s_elastic(
                         b5 = 0.001191;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -2039,6 +2242,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -2155,6 +2361,19 @@ double update_s_elastic(
                         b6 = -0.00066667;
                     }
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, vxyyx_j, vyzzy_j, vxzzx_j, vxxyyzz_j, vyyzz_j, vxxzz_j, vxxyy_j, \
+        vxyyx_j_2, vyzzy_j_2, vxzzx_j_2, vxxyyzz_j_2, vyyzz_j_2, vxxzz_j_2, vxxyy_j_2, \
+        vxyyx_j_3, vyzzy_j_3, vxzzx_j_3, vxxyyzz_j_3, vyyzz_j_3, vxxzz_j_3, vxxyy_j_3, \
+        vxyyx_j_4, vyzzy_j_4, vxzzx_j_4, vxxyyzz_j_4, vyyzz_j_4, vxxzz_j_4, vxxyy_j_4, \
+        vxyyx_j_i, vyzzy_j_i, vxzzx_j_i, vxxyyzz_j_i, vyyzz_j_i, vxxzz_j_i, vxxyy_j_i, \
+        vxyyx_j_i_2, vyzzy_j_i_2, vxzzx_j_i_2, vxxyyzz_j_i_2, vyyzz_j_i_2, vxxzz_j_i_2, \
+        vxxyy_j_i_2, vxyyx_j_i_3, vyzzy_j_i_3, vxzzx_j_i_3, vxxyyzz_j_i_3, vyyzz_j_i_3, \
+        vxxzz_j_i_3, vxxyy_j_i_3, vxyyx_j_i_4, vyzzy_j_i_4, vxzzx_j_i_4, vxxyyzz_j_i_4, \
+        vyyzz_j_i_4, vxxzz_j_i_4, vxxyy_j_i_4, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, \
+        vzz, c66ipjp, c44jpkp, c55ipkp, g, f, vdiag)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -2215,6 +2434,9 @@ double update_s_elastic(
                             vyyzz_j_i_4 = *(vyyzz_j_4 + i);
                             vxxzz_j_i_4 = *(vxxzz_j_4 + i);
                             vxxyy_j_i_4 = *(vxxyy_j_4 + i);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k = nz1; k <= nz2; k++)
                             {
                                 /* spatial derivatives of the components of the velocities
@@ -2327,7 +2549,6 @@ double update_s_elastic(
         {
             time2 = MPI_Wtime();
             time = time2 - time1;
-            fprintf(FP, " Real time for stress tensor update: \t\t %4.2f s.\n", time);
         }
     return time;
 }
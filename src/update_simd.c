@@ -0,0 +1,426 @@
+/*------------------------------------------------------------------------
+ *   Explicitly vectorized update of stress and particle velocities
+ *   for FDORDER_TIME=2 (elastic, orthorhombic) using AVX2 or AVX-512.
+ *
+ *   The kernels process 8 (AVX2) or 16 (AVX-512) points along k at once.
+ *   All stencils are evaluated in the same order as in update_s_elastic()
+ *   and update_v(), and no fused multiply-add is used, so the results are
+ *   bit-identical to the scalar code. The scalar code remains the reference
+ *   and is used if the CPU supports neither instruction set or if SIMD=0.
+ *
+ *   With MAT_PRECISION > 0 the kernels read the material parameters from
+ *   16-bit arrays registered by `update_simd_mat16` (see mat16.c) and
+ *   convert them to floats in registers. With MAT_COMPRESS=1 they gather
+ *   the material parameters from a table of media registered by
+ *   `update_simd_table` (see mat_table.c).
+ *  ----------------------------------------------------------------------*/
+
+#include "data_structures.h"
+#include "enum.h"
+#include "fd.h"
+#include "globvar.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+
+/* material parameters in 16-bit storage, NULL for FP32 */
+static const OrthoPar16 *mat16 = NULL;
+
+/* table of media and index volume, NULL for dense arrays */
+static const MatTable *mtab = NULL;
+
+
+/*
+ * Taylor (FDCOEFF=1) or Holberg (FDCOEFF=2) coefficients b[1..FDORDER/2]
+ * as in update_s_elastic() and update_v().
+ */
+static void fd_coefficients(float *b)
+{
+    extern int FDORDER, FDCOEFF;
+
+    switch (FDORDER) {
+    case 2:
+        b[1] = 1.0;
+        if (FDCOEFF == 2) b[1] = 1.00100;
+        break;
+    case 4:
+        b[1] = 9.0 / 8.0; b[2] = -1.0 / 24.0;
+        if (FDCOEFF == 2) {
+            b[1] = 1.1382; b[2] = -0.046414;
+        }
+        break;
+    case 6:
+        b[1] = 75.0 / 64.0; b[2] = -25.0 / 384.0; b[3] = 3.0 / 640.0;
+        if (FDCOEFF == 2) {
+            b[1] = 1.1965; b[2] = -0.078804; b[3] = 0.0081781;
+        }
+        break;
+    case 8:
+        b[1] = 1225.0 / 1024.0; b[2] = -245.0 / 3072.0; b[3] = 49.0 / 5120.0;
+        b[4] = -5.0 / 7168.0;
+        if (FDCOEFF == 2) {
+            b[1] = 1.2257; b[2] = -0.099537; b[3] = 0.018063; b[4] = -0.0026274;
+        }
+        break;
+    case 10:
+        b[1] = 19845.0 / 16384.0; b[2] = -735.0 / 8192.0; b[3] = 567.0 / 40960.0;
+        b[4] = -405.0 / 229376.0; b[5] = 35.0 / 294912.0;
+        if (FDCOEFF == 2) {
+            b[1] = 1.2415; b[2] = -0.11231; b[3] = 0.026191; b[4] = -0.0064682;
+            b[5] = 0.001191;
+        }
+        break;
+    case 12:
+        b[1] = 160083.0 / 131072.0; b[2] = -12705.0 / 131072.0;
+        b[3] = 22869.0 / 1310720.0; b[4] = -5445.0 / 1835008.0;
+        b[5] = 847.0 / 2359296.0; b[6] = -63.0 / 2883584;
+        if (FDCOEFF == 2) {
+            b[1] = 1.2508; b[2] = -0.12034; b[3] = 0.032131; b[4] = -0.010142;
+            b[5] = 0.0029857; b[6] = -0.00066667;
+        }
+        break;
+    }
+}
+
+
+/*
+ * Staggered-grid difference of a field at point p along one axis.
+ *
+ * Parameters
+ * ----------
+ * p :
+ *     Pointer to the field at the current grid point.
+ * st :
+ *     Distance between neighbouring points along the axis in floats
+ *     (1 for k, t[j][i+1]-t[j][i] for i, t[j+1][i]-t[j][i] for j).
+ * sh :
+ *     0 for the forward operator p[m]-p[1-m],
+ *     1 for the backward operator p[m-1]-p[-m].
+ * b, n :
+ *     FD coefficients b[1..n], n = FDORDER/2.
+ *
+ * Returns
+ * -------
+ * b[1]*d[1] + ... + b[n]*d[n], summed from left to right as in the
+ * scalar code; for FDORDER=2 the undivided difference d[1].
+ */
+static inline float fd_diff(const float *p, ptrdiff_t st, int sh,
+        const float *b, int n)
+{
+    float d;
+    int m;
+
+    d = p[(1 - sh) * st] - p[-sh * st];
+    if (n == 1) return d;
+
+    d = b[1] * d;
+    for (m = 2; m <= n; m++)
+        d = d + b[m] * (p[(m - sh) * st] - p[(1 - m - sh) * st]);
+    return d;
+}
+
+
+#ifdef HAVE_X86_SIMD
+
+/* AVX2, 8 floats per vector */
+#define SIMD_W 8
+#define SIMD_TARGET "avx2"
+#define SIMD_TARGET16 "avx2,f16c"
+#define SIMD_FN(f) f##_avx2
+#define vf __m256
+#define VLOAD _mm256_loadu_ps
+#define VSTORE _mm256_storeu_ps
+#define VSET1 _mm256_set1_ps
+#define VADD _mm256_add_ps
+#define VSUB _mm256_sub_ps
+#define VMUL _mm256_mul_ps
+#define VDIV _mm256_div_ps
+#define VCVTPH(p) _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) (p)))
+#define VCVTBF(p) _mm256_castsi256_ps(_mm256_slli_epi32( \
+        _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (p))), 16))
+#define vi __m256i
+#define VIDX8(p) _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (p)))
+#define VIDX16(p) _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (p)))
+#define VGATHER(b, x) _mm256_i32gather_ps((b), (x), 4)
+#define SIMD_MAT 0
+#include "update_simd_kernel.h"
+#define SIMD_MAT 1
+#include "update_simd_kernel.h"
+#define SIMD_MAT 2
+#include "update_simd_kernel.h"
+#define SIMD_MAT 3
+#include "update_simd_kernel.h"
+#define SIMD_MAT 4
+#include "update_simd_kernel.h"
+#undef SIMD_W
+#undef SIMD_TARGET
+#undef SIMD_TARGET16
+#undef SIMD_FN
+#undef vf
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VCVTPH
+#undef VCVTBF
+#undef vi
+#undef VIDX8
+#undef VIDX16
+#undef VGATHER
+
+/* AVX-512, 16 floats per vector */
+#define SIMD_W 16
+#define SIMD_TARGET "avx512f"
+#define SIMD_TARGET16 "avx512f"
+#define SIMD_FN(f) f##_avx512
+#define vf __m512
+#define VLOAD _mm512_loadu_ps
+#define VSTORE _mm512_storeu_ps
+#define VSET1 _mm512_set1_ps
+#define VADD _mm512_add_ps
+#define VSUB _mm512_sub_ps
+#define VMUL _mm512_mul_ps
+#define VDIV _mm512_div_ps
+#define VCVTPH(p) _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *) (p)))
+#define VCVTBF(p) _mm512_castsi512_ps(_mm512_slli_epi32( \
+        _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) (p))), 16))
+#define vi __m512i
+#define VIDX8(p) _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) (p)))
+#define VIDX16(p) _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) (p)))
+#define VGATHER(b, x) _mm512_i32gather_ps((x), (b), 4)
+#define SIMD_MAT 0
+#include "update_simd_kernel.h"
+#define SIMD_MAT 1
+#include "update_simd_kernel.h"
+#define SIMD_MAT 2
+#include "update_simd_kernel.h"
+#define SIMD_MAT 3
+#include "update_simd_kernel.h"
+#define SIMD_MAT 4
+#include "update_simd_kernel.h"
+#undef SIMD_W
+#undef SIMD_TARGET
+#undef SIMD_TARGET16
+#undef SIMD_FN
+#undef vf
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VCVTPH
+#undef VCVTBF
+#undef vi
+#undef VIDX8
+#undef VIDX16
+#undef VGATHER
+
+#endif
+
+
+/*
+ * Instruction set used by `update_s_elastic_simd` and `update_v_simd`.
+ *
+ * Returns
+ * -------
+ * SIMD_NONE, SIMD_AVX2 or SIMD_AVX512: the highest level supported by
+ * the CPU (checked with CPUID) and not excluded by the parameter SIMD.
+ */
+int simd_level(void)
+{
+    extern int SIMD;
+    static int level = -1;
+
+    if (level >= 0) return level;
+
+    level = SIMD_NONE;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if ((SIMD >= SIMD_AVX512) && __builtin_cpu_supports("avx512f"))
+        level = SIMD_AVX512;
+    else if ((SIMD >= SIMD_AVX2) && __builtin_cpu_supports("avx2"))
+        level = SIMD_AVX2;
+#endif
+    return level;
+}
+
+
+/*
+ * Let the kernels read the material parameters from 16-bit storage.
+ *
+ * Parameters
+ * ----------
+ * m :
+ *     Material parameters packed by `mat16_pack`, NULL to use the FP32
+ *     arrays again.
+ *
+ * Returns
+ * -------
+ * 1 on success, 0 if no vector kernel is available for the format of `m`
+ * on this CPU; the kernels then keep using the FP32 arrays.
+ */
+int update_simd_mat16(const OrthoPar16 *m)
+{
+    int level = simd_level();
+
+    mat16 = NULL;
+    if (m == NULL) return 1;
+    if (level == SIMD_NONE) return 0;
+#ifdef HAVE_X86_SIMD
+    if ((m->format == MAT_FP16) && (level == SIMD_AVX2) &&
+            !__builtin_cpu_supports("f16c"))
+        return 0;
+#endif
+    mat16 = m;
+    return 1;
+}
+
+
+/*
+ * Let the kernels gather the material parameters from a table of media.
+ *
+ * Parameters
+ * ----------
+ * t :
+ *     Table built by `mat_table_build`, NULL to use the dense arrays again.
+ *
+ * Returns
+ * -------
+ * 1 on success, 0 if no vector kernel is available on this CPU.
+ */
+int update_simd_table(const MatTable *t)
+{
+    mtab = NULL;
+    if (t == NULL) return 1;
+    if (simd_level() == SIMD_NONE) return 0;
+    mtab = t;
+    return 1;
+}
+
+
+/*
+ * Update the stress at gridpoints [nx1...nx2][ny1...ny2][nz1...nz2]
+ * like update_s_elastic() for FDORDER_TIME=2.
+ *
+ * Returns
+ * -------
+ * 1 if the stress was updated, 0 if no vector kernel is available and the
+ * scalar code has to be used.
+ */
+int update_s_elastic_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, OrthoPar *op)
+{
+    extern int FDORDER;
+
+    float b[7];
+    int level = simd_level();
+
+    if ((level == SIMD_NONE) || (nx1 > nx2) || (ny1 > ny2) || (nz1 > nz2))
+        return (level != SIMD_NONE);
+
+    fd_coefficients(b);
+
+#ifdef HAVE_X86_SIMD
+    if (mtab != NULL) {
+        if (level == SIMD_AVX512) {
+            if (mtab->idx8)
+                stress_idx8_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mtab, b, FDORDER / 2);
+            else
+                stress_idx16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mtab, b, FDORDER / 2);
+        } else {
+            if (mtab->idx8)
+                stress_idx8_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mtab, b, FDORDER / 2);
+            else
+                stress_idx16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mtab, b, FDORDER / 2);
+        }
+    } else if (mat16 == NULL) {
+        if (level == SIMD_AVX512)
+            stress_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, b, FDORDER / 2);
+        else
+            stress_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, b, FDORDER / 2);
+    } else if (mat16->format == MAT_FP16) {
+        if (level == SIMD_AVX512)
+            stress_fp16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mat16, b, FDORDER / 2);
+        else
+            stress_fp16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mat16, b, FDORDER / 2);
+    } else {
+        if (level == SIMD_AVX512)
+            stress_bf16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mat16, b, FDORDER / 2);
+        else
+            stress_bf16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, mat16, b, FDORDER / 2);
+    }
+#endif
+    return 1;
+}
+
+
+/*
+ * Update the particle velocities at gridpoints [nx1...nx2][ny1...ny2]
+ * [nz1...nz2] like the FD stencil of update_v() for FDORDER_TIME=2.
+ * Sources and absorbing boundaries are applied by update_v().
+ *
+ * Returns
+ * -------
+ * 1 if the velocities were updated, 0 if the scalar code has to be used.
+ */
+int update_v_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, float ***rjp, float ***rkp, float ***rip)
+{
+    extern int FDORDER;
+
+    float b[7];
+    int level = simd_level();
+
+    if ((level == SIMD_NONE) || (nx1 > nx2) || (ny1 > ny2) || (nz1 > nz2))
+        return (level != SIMD_NONE);
+
+    fd_coefficients(b);
+
+#ifdef HAVE_X86_SIMD
+    if (mtab != NULL) {
+        if (level == SIMD_AVX512) {
+            if (mtab->idx8)
+                velocity_idx8_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                        mtab->rjp, mtab->rkp, mtab->rip, mtab, b, FDORDER / 2);
+            else
+                velocity_idx16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                        mtab->rjp, mtab->rkp, mtab->rip, mtab, b, FDORDER / 2);
+        } else {
+            if (mtab->idx8)
+                velocity_idx8_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                        mtab->rjp, mtab->rkp, mtab->rip, mtab, b, FDORDER / 2);
+            else
+                velocity_idx16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                        mtab->rjp, mtab->rkp, mtab->rip, mtab, b, FDORDER / 2);
+        }
+    } else if (mat16 == NULL) {
+        if (level == SIMD_AVX512)
+            velocity_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip, b, FDORDER / 2);
+        else
+            velocity_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip, b, FDORDER / 2);
+    } else if (mat16->format == MAT_FP16) {
+        if (level == SIMD_AVX512)
+            velocity_fp16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                    &mat16->rjp, &mat16->rkp, &mat16->rip, b, FDORDER / 2);
+        else
+            velocity_fp16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                    &mat16->rjp, &mat16->rkp, &mat16->rip, b, FDORDER / 2);
+    } else {
+        if (level == SIMD_AVX512)
+            velocity_bf16_avx512(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                    &mat16->rjp, &mat16->rkp, &mat16->rip, b, FDORDER / 2);
+        else
+            velocity_bf16_avx2(nx1, nx2, ny1, ny2, nz1, nz2, v, s,
+                    &mat16->rjp, &mat16->rkp, &mat16->rip, b, FDORDER / 2);
+    }
+#endif
+    return 1;
+}
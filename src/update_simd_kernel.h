@@ -0,0 +1,303 @@
+/*------------------------------------------------------------------------
+ *   Vector kernels of update_simd.c for one SIMD width and one storage
+ *   format of the material parameters.
+ *
+ *   This file is included by update_simd.c once per instruction set and
+ *   format with the following macros defined:
+ *   SIMD_W       number of floats per vector
+ *   SIMD_TARGET  target attribute of the kernels, e.g. "avx2"
+ *   SIMD_TARGET16  target attribute of the FP16 kernels, e.g. "avx2,f16c"
+ *   SIMD_FN(f)   name of kernel f for this instruction set
+ *   vf           vector type
+ *   VLOAD, VSTORE, VSET1, VADD, VSUB, VMUL, VDIV
+ *                unaligned load/store, broadcast and arithmetic
+ *   VCVTPH(p), VCVTBF(p)
+ *                load SIMD_W FP16 or BF16 values and convert them to floats
+ *   vi           integer vector type
+ *   VIDX8(p), VIDX16(p), VGATHER(b, x)
+ *                load SIMD_W 8-bit or 16-bit indices as 32-bit integers,
+ *                gather the floats b[x]
+ *   SIMD_MAT     format of the material parameters, 0: FP32 (OrthoPar),
+ *                1: FP16, 2: BF16 (OrthoPar16, see mat16.c), 3, 4: table
+ *                of media with 8-bit or 16-bit index (MatTable, see
+ *                mat_table.c); this macro is undefined at the end of the
+ *                file
+ *
+ *   The distance between neighbouring points in i and j direction is
+ *   taken from one field; all wavefields are allocated with the same
+ *   column and depth ranges (see sofi3D.c).
+ *  ----------------------------------------------------------------------*/
+
+
+/*
+ * KFN(f): name of kernel f for this instruction set and format.
+ * VDEC(a), SDEC(a): material field a at point [j][i][k] as vector of the
+ * SIMD_W points starting there or as scalar.
+ * KIDX_PARAM, KIDX_ARG, KIDX_STRESS, KIDX_LOAD: the index volume `mt` of
+ * the table of media as parameter of the velocity kernels, taken from the material
+ * parameters in the stress kernels, and the indices `vidx` of the SIMD_W
+ * points starting at [j][i][k]; empty for the other formats.
+ */
+#if SIMD_MAT == 1
+#define KFN(f) SIMD_FN(f##_fp16)
+#define KTARGET SIMD_TARGET16
+#define MAT_T OrthoPar16
+#define RHO_T const Mat16Field *
+#define MFIELD(m, f) (&(m)->f)
+#define VDEC(a) VMUL(VCVTPH(&(a)->v[j][i][k]), VSET1((a)->scale))
+#define SDEC(a) (mat16_to_float((a)->v[j][i][k], MAT_FP16) * (a)->scale)
+#elif SIMD_MAT == 2
+#define KFN(f) SIMD_FN(f##_bf16)
+#define KTARGET SIMD_TARGET
+#define MAT_T OrthoPar16
+#define RHO_T const Mat16Field *
+#define MFIELD(m, f) (&(m)->f)
+#define VDEC(a) VCVTBF(&(a)->v[j][i][k])
+#define SDEC(a) mat16_to_float((a)->v[j][i][k], MAT_BF16)
+#elif (SIMD_MAT == 3) || (SIMD_MAT == 4)
+#if SIMD_MAT == 3
+#define KFN(f) SIMD_FN(f##_idx8)
+#define MIDX idx8
+#define VIDX VIDX8
+#else
+#define KFN(f) SIMD_FN(f##_idx16)
+#define MIDX idx16
+#define VIDX VIDX16
+#endif
+#define KTARGET SIMD_TARGET
+#define MAT_T MatTable
+#define RHO_T const float *
+#define MFIELD(m, f) ((m)->f)
+#define KIDX_PARAM , const MatTable *mt
+#define KIDX_ARG , mt
+#define KIDX_STRESS const MatTable *mt = op
+#define KIDX_LOAD const vi vidx = VIDX(&mt->MIDX[j][i][k])
+#define VDEC(a) VGATHER(a, vidx)
+#define SDEC(a) ((a)[mt->MIDX[j][i][k]])
+#else
+#define KFN(f) SIMD_FN(f)
+#define KTARGET SIMD_TARGET
+#define MAT_T OrthoPar
+#define RHO_T float ***
+#define MFIELD(m, f) ((m)->f)
+#define VDEC(a) VLOAD(&(a)[j][i][k])
+#define SDEC(a) ((a)[j][i][k])
+#endif
+
+#ifndef KIDX_PARAM
+#define KIDX_PARAM
+#define KIDX_ARG
+#define KIDX_STRESS
+#define KIDX_LOAD
+#endif
+
+
+#if SIMD_MAT == 0
+/*
+ * Vector version of `fd_diff` in update_simd.c for the SIMD_W points
+ * p[0..SIMD_W-1].
+ */
+__attribute__((target(SIMD_TARGET)))
+static inline vf SIMD_FN(diff)(const float *p, ptrdiff_t st, int sh,
+        const float *b, int n)
+{
+    vf d;
+    int m;
+
+    d = VSUB(VLOAD(p + (1 - sh) * st), VLOAD(p - sh * st));
+    if (n == 1) return d;
+
+    d = VMUL(VSET1(b[1]), d);
+    for (m = 2; m <= n; m++)
+        d = VADD(d, VMUL(VSET1(b[m]),
+                VSUB(VLOAD(p + (m - sh) * st), VLOAD(p + (1 - m - sh) * st))));
+    return d;
+}
+#endif
+
+
+/*
+ * Scalar stress update at one point, used for the remainder of a row
+ * which does not fill a whole vector.
+ */
+__attribute__((target(KTARGET)))
+static inline void KFN(stress_point)(int i, int j, int k, Velocity *v, Tensor3d *s,
+        const MAT_T *op, ptrdiff_t sx, ptrdiff_t sy, const float *b, int n)
+{
+    extern float DT, DX, DY, DZ;
+
+    float vxx, vyy, vzz;
+    float exy, eyz, exz;
+    KIDX_STRESS;
+
+    vxx = fd_diff(&v->x[j][i][k], sx, 1, b, n) / DX;
+    vyy = fd_diff(&v->y[j][i][k], sy, 1, b, n) / DY;
+    vzz = fd_diff(&v->z[j][i][k], 1, 1, b, n) / DZ;
+    exy = fd_diff(&v->x[j][i][k], sy, 0, b, n) / DY + fd_diff(&v->y[j][i][k], sx, 0, b, n) / DX;
+    eyz = fd_diff(&v->y[j][i][k], 1, 0, b, n) / DZ + fd_diff(&v->z[j][i][k], sy, 0, b, n) / DY;
+    exz = fd_diff(&v->x[j][i][k], 1, 0, b, n) / DZ + fd_diff(&v->z[j][i][k], sx, 0, b, n) / DX;
+
+    s->xy[j][i][k] += DT * (SDEC(MFIELD(op, C66ipjp)) * exy);
+    s->yz[j][i][k] += DT * (SDEC(MFIELD(op, C44jpkp)) * eyz);
+    s->xz[j][i][k] += DT * (SDEC(MFIELD(op, C55ipkp)) * exz);
+
+    s->xx[j][i][k] += DT * ((SDEC(MFIELD(op, C11)) * vxx) + (SDEC(MFIELD(op, C12)) * vyy) + (SDEC(MFIELD(op, C13)) * vzz));
+    s->yy[j][i][k] += DT * ((SDEC(MFIELD(op, C12)) * vxx) + (SDEC(MFIELD(op, C22)) * vyy) + (SDEC(MFIELD(op, C23)) * vzz));
+    s->zz[j][i][k] += DT * ((SDEC(MFIELD(op, C13)) * vxx) + (SDEC(MFIELD(op, C23)) * vyy) + (SDEC(MFIELD(op, C33)) * vzz));
+}
+
+
+/*
+ * Scalar velocity update at one point, see `stress_point`.
+ */
+__attribute__((target(KTARGET)))
+static inline void KFN(velocity_point)(int i, int j, int k, Velocity *v, Tensor3d *s,
+        RHO_T rjp, RHO_T rkp, RHO_T rip KIDX_PARAM, float dx, float dy, float dz,
+        ptrdiff_t sx, ptrdiff_t sy, const float *b, int n)
+{
+    v->x[j][i][k] += (dx * fd_diff(&s->xx[j][i][k], sx, 0, b, n) +
+                      dy * fd_diff(&s->xy[j][i][k], sy, 1, b, n) +
+                      dz * fd_diff(&s->xz[j][i][k], 1, 1, b, n)) / SDEC(rip);
+    v->y[j][i][k] += (dy * fd_diff(&s->yy[j][i][k], sy, 0, b, n) +
+                      dx * fd_diff(&s->xy[j][i][k], sx, 1, b, n) +
+                      dz * fd_diff(&s->yz[j][i][k], 1, 1, b, n)) / SDEC(rjp);
+    v->z[j][i][k] += (dz * fd_diff(&s->zz[j][i][k], 1, 0, b, n) +
+                      dx * fd_diff(&s->xz[j][i][k], sx, 1, b, n) +
+                      dy * fd_diff(&s->yz[j][i][k], sy, 1, b, n)) / SDEC(rkp);
+}
+
+
+__attribute__((target(KTARGET)))
+static void KFN(stress)(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, const MAT_T *op, const float *b, int n)
+{
+    extern float DT, DX, DY, DZ;
+
+    float ***vx = v->x, ***vy = v->y, ***vz = v->z;
+    ptrdiff_t sx = vx[1][2] - vx[1][1], sy = vx[2][1] - vx[1][1];
+    int i, j, k;
+    KIDX_STRESS;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(i, k)
+#endif
+    for (j = ny1; j <= ny2; j++) {
+        for (i = nx1; i <= nx2; i++) {
+            const vf dt = VSET1(DT), rdx = VSET1(DX), rdy = VSET1(DY), rdz = VSET1(DZ);
+            vf vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz, exy, eyz, exz;
+            vf c11, c12, c13, c22, c23, c33, t;
+
+            for (k = nz1; k + SIMD_W - 1 <= nz2; k += SIMD_W) {
+                KIDX_LOAD;
+
+                vxx = VDIV(SIMD_FN(diff)(&vx[j][i][k], sx, 1, b, n), rdx);
+                vxy = VDIV(SIMD_FN(diff)(&vx[j][i][k], sy, 0, b, n), rdy);
+                vxz = VDIV(SIMD_FN(diff)(&vx[j][i][k], 1, 0, b, n), rdz);
+                vyx = VDIV(SIMD_FN(diff)(&vy[j][i][k], sx, 0, b, n), rdx);
+                vyy = VDIV(SIMD_FN(diff)(&vy[j][i][k], sy, 1, b, n), rdy);
+                vyz = VDIV(SIMD_FN(diff)(&vy[j][i][k], 1, 0, b, n), rdz);
+                vzx = VDIV(SIMD_FN(diff)(&vz[j][i][k], sx, 0, b, n), rdx);
+                vzy = VDIV(SIMD_FN(diff)(&vz[j][i][k], sy, 0, b, n), rdy);
+                vzz = VDIV(SIMD_FN(diff)(&vz[j][i][k], 1, 1, b, n), rdz);
+
+                exy = VADD(vxy, vyx);
+                eyz = VADD(vyz, vzy);
+                exz = VADD(vxz, vzx);
+
+                t = VMUL(dt, VMUL(VDEC(MFIELD(op, C66ipjp)), exy));
+                VSTORE(&s->xy[j][i][k], VADD(VLOAD(&s->xy[j][i][k]), t));
+                t = VMUL(dt, VMUL(VDEC(MFIELD(op, C44jpkp)), eyz));
+                VSTORE(&s->yz[j][i][k], VADD(VLOAD(&s->yz[j][i][k]), t));
+                t = VMUL(dt, VMUL(VDEC(MFIELD(op, C55ipkp)), exz));
+                VSTORE(&s->xz[j][i][k], VADD(VLOAD(&s->xz[j][i][k]), t));
+
+                c11 = VDEC(MFIELD(op, C11));
+                c12 = VDEC(MFIELD(op, C12));
+                c13 = VDEC(MFIELD(op, C13));
+                c22 = VDEC(MFIELD(op, C22));
+                c23 = VDEC(MFIELD(op, C23));
+                c33 = VDEC(MFIELD(op, C33));
+
+                t = VMUL(dt, VADD(VADD(VMUL(c11, vxx), VMUL(c12, vyy)), VMUL(c13, vzz)));
+                VSTORE(&s->xx[j][i][k], VADD(VLOAD(&s->xx[j][i][k]), t));
+                t = VMUL(dt, VADD(VADD(VMUL(c12, vxx), VMUL(c22, vyy)), VMUL(c23, vzz)));
+                VSTORE(&s->yy[j][i][k], VADD(VLOAD(&s->yy[j][i][k]), t));
+                t = VMUL(dt, VADD(VADD(VMUL(c13, vxx), VMUL(c23, vyy)), VMUL(c33, vzz)));
+                VSTORE(&s->zz[j][i][k], VADD(VLOAD(&s->zz[j][i][k]), t));
+            }
+
+            for (; k <= nz2; k++)
+                KFN(stress_point)(i, j, k, v, s, op, sx, sy, b, n);
+        }
+    }
+}
+
+
+__attribute__((target(KTARGET)))
+static void KFN(velocity)(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, RHO_T rjp, RHO_T rkp, RHO_T rip KIDX_PARAM,
+        const float *b, int n)
+{
+    extern float DT, DX, DY, DZ;
+
+    float cx = DT / DX, cy = DT / DY, cz = DT / DZ;
+    ptrdiff_t sx = s->xx[1][2] - s->xx[1][1], sy = s->xx[2][1] - s->xx[1][1];
+    int i, j, k;
+
+    if (n == 1) {
+        cx *= b[1];
+        cy *= b[1];
+        cz *= b[1];
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(i, k)
+#endif
+    for (j = ny1; j <= ny2; j++) {
+        for (i = nx1; i <= nx2; i++) {
+            const vf dx = VSET1(cx), dy = VSET1(cy), dz = VSET1(cz);
+            vf t1, t2, t3;
+
+            for (k = nz1; k + SIMD_W - 1 <= nz2; k += SIMD_W) {
+                KIDX_LOAD;
+
+                t1 = VMUL(dx, SIMD_FN(diff)(&s->xx[j][i][k], sx, 0, b, n));
+                t2 = VMUL(dy, SIMD_FN(diff)(&s->xy[j][i][k], sy, 1, b, n));
+                t3 = VMUL(dz, SIMD_FN(diff)(&s->xz[j][i][k], 1, 1, b, n));
+                VSTORE(&v->x[j][i][k], VADD(VLOAD(&v->x[j][i][k]),
+                        VDIV(VADD(VADD(t1, t2), t3), VDEC(rip))));
+
+                t1 = VMUL(dy, SIMD_FN(diff)(&s->yy[j][i][k], sy, 0, b, n));
+                t2 = VMUL(dx, SIMD_FN(diff)(&s->xy[j][i][k], sx, 1, b, n));
+                t3 = VMUL(dz, SIMD_FN(diff)(&s->yz[j][i][k], 1, 1, b, n));
+                VSTORE(&v->y[j][i][k], VADD(VLOAD(&v->y[j][i][k]),
+                        VDIV(VADD(VADD(t1, t2), t3), VDEC(rjp))));
+
+                t1 = VMUL(dz, SIMD_FN(diff)(&s->zz[j][i][k], 1, 0, b, n));
+                t2 = VMUL(dx, SIMD_FN(diff)(&s->xz[j][i][k], sx, 1, b, n));
+                t3 = VMUL(dy, SIMD_FN(diff)(&s->yz[j][i][k], sy, 1, b, n));
+                VSTORE(&v->z[j][i][k], VADD(VLOAD(&v->z[j][i][k]),
+                        VDIV(VADD(VADD(t1, t2), t3), VDEC(rkp))));
+            }
+
+            for (; k <= nz2; k++)
+                KFN(velocity_point)(i, j, k, v, s, rjp, rkp, rip KIDX_ARG, cx, cy, cz, sx, sy, b, n);
+        }
+    }
+}
+
+
+#undef KFN
+#undef KTARGET
+#undef MAT_T
+#undef RHO_T
+#undef MFIELD
+#undef VDEC
+#undef SDEC
+#undef KIDX_PARAM
+#undef KIDX_ARG
+#undef KIDX_STRESS
+#undef KIDX_LOAD
+#undef MIDX
+#undef VIDX
+#undef SIMD_MAT
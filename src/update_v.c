@@ -26,8 +26,8 @@
  *      Amplitudes of the sources.
  *  nsrc :
  *      Number of sources.
- *  absorb_coeff :
- *		Absorption coefficient.
+ *  absorb_frame :
+ *      Absorbing frame (ABS_TYPE=2).
  *	stype :
  *      Types of the sources.
  *  ds_dv, ds_dv_2, ds_dv_3, ds_dv_4 :
@@ -38,7 +38,7 @@
 double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		int nt, Velocity *v,
 		Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip,
-		float **  srcpos_loc, float ** signals, int nsrc, float *** absorb_coeff, int * stype,
+		float **  srcpos_loc, float ** signals, int nsrc, const AbsorbFrame *absorb_frame, int * stype,
         StressDerivativesWrtVelocity *ds_dv,
         StressDerivativesWrtVelocity *ds_dv_2,
         StressDerivativesWrtVelocity *ds_dv_3,
@@ -74,7 +74,6 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
     extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
     double time=0.0, time1=0.0, time2=0.0;
     extern int MYID, FDORDER, FDORDER_TIME, LOG, ABS_TYPE, FDCOEFF;
-    extern FILE *FP;
     extern int OUTNTIMESTEPINFO;
 
     int i, j, k, l;
@@ -102,6 +101,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 
         case 2:
 
+            /* AVX2/AVX-512 kernels, see update_simd.c */
+            if (update_v_simd(nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip))
+                break;
+
             switch (FDORDER){
                     
                 case 2 :
@@ -117,11 +120,18 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent collapse(3)
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 //#pragma acc loop independent
                         for (i=nx1;i<=nx2;i++){
 //#pragma acc loop independent
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*b1*(sxx[j][i+1][k]-sxx[j][i][k]);
@@ -164,11 +174,18 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent collapse(3)
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 //#pragma acc loop independent
                         for (i=nx1;i<=nx2;i++){
 //#pragma acc loop independent
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
@@ -211,6 +228,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent     
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 #ifdef _OPENACC
@@ -219,6 +240,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         for (i=nx1;i<=nx2;i++){
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k=nz1;k<=nz2;k++){
                                 
@@ -288,6 +312,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 #ifdef _OPENACC
@@ -296,6 +324,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         for (i=nx1;i<=nx2;i++){
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k=nz1;k<=nz2;k++){
                                 
@@ -374,6 +405,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 #ifdef _OPENACC
@@ -382,6 +417,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         for (i=nx1;i<=nx2;i++){
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k=nz1;k<=nz2;k++){
                                 
@@ -473,6 +511,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
 #endif
                     for (j=ny1;j<=ny2;j++){
 #ifdef _OPENACC
@@ -481,6 +523,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         for (i=nx1;i<=nx2;i++){
 #ifdef _OPENACC
 #pragma acc loop independent
+#endif
+#ifdef _OPENMP
+#pragma omp simd
 #endif
                             for (k=nz1;k<=nz2;k++){
                                 
@@ -498,12 +543,12 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                                             b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
                                             b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
                                 
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
+                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
+                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
+                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
+                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
+                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5])+
+                                            b6*(sxz[j][i][k+5]-sxz[j][i][k-6]));
                                 
                                 
                                 /* updating components of particle velocities */
@@ -584,6 +629,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.00100; } /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -595,6 +647,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*b1*(sxx[j][i+1][k]-sxx[j][i][k]);
@@ -635,6 +690,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -646,6 +708,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
@@ -688,6 +753,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -699,6 +771,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
@@ -765,6 +840,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -776,6 +858,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
                                             b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
@@ -851,6 +936,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -862,6 +954,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
                                             b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
@@ -948,6 +1043,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, svy_j_i_2, svz_j_i_2, svx_j_i_3, \
+        svy_j_i_3, svz_j_i_3, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, \
+        syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -959,6 +1061,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_2=*(svx_j_2+i);svy_j_i_2=*(svy_j_2+i);svz_j_i_2=*(svz_j_2+i);
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
@@ -975,12 +1080,12 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                                             b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
                                             b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
                                 
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
+                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
+                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
+                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
+                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
+                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5])+
+                                            b6*(sxz[j][i][k+5]-sxz[j][i][k-6]));
                                 
                                 syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
                                             b2*(syy[j+2][i][k]-syy[j-1][i][k])+
@@ -1061,6 +1166,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.00100; } /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1073,6 +1185,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*b1*(sxx[j][i+1][k]-sxx[j][i][k]);
@@ -1112,6 +1227,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     b1=9.0/8.0; b2=-1.0/24.0; /* Taylor coefficients*/
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1124,6 +1246,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
                                 sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
@@ -1163,6 +1288,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     b1=75.0/64.0; b2=-25.0/384.0; b3=3.0/640.0; /* Taylor coefficients*/
                     if(FDCOEFF==2){
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1175,6 +1307,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
                                             b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
@@ -1240,6 +1375,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1252,6 +1394,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
                                             b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
@@ -1327,6 +1472,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1339,6 +1491,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
@@ -1426,6 +1581,13 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, svx_j, svy_j, svz_j, svx_j_2, svy_j_2, svz_j_2, svx_j_3, svy_j_3, \
+        svz_j_3, svx_j_4, svy_j_4, svz_j_4, svx_j_i, svy_j_i, svz_j_i, svx_j_i_2, \
+        svy_j_i_2, svz_j_i_2, svx_j_i_3, svy_j_i_3, svz_j_i_3, svx_j_i_4, svy_j_i_4, \
+        svz_j_i_4, sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1438,6 +1600,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                             svx_j_i_3=*(svx_j_3+i);svy_j_i_3=*(svy_j_3+i);svz_j_i_3=*(svz_j_3+i);
                             svx_j_i_4=*(svx_j_4+i);svy_j_i_4=*(svy_j_4+i);svz_j_i_4=*(svz_j_4+i);
                             
+#ifdef _OPENMP
+#pragma omp simd
+#endif
                             for (k=nz1;k<=nz2;k++){
                                 sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
                                             b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
@@ -1453,12 +1618,12 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                                             b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
                                             b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
                                 
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
+                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
+                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
+                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
+                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
+                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5])+
+                                            b6*(sxz[j][i][k+5]-sxz[j][i][k-6]));
                                 
                                 syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
                                             b2*(syy[j+2][i][k]-syy[j-1][i][k])+
@@ -1556,34 +1721,42 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
     }
     
     
-    /* absorbing boundary condition (exponential damping) */
+    /* absorbing boundary condition (exponential damping),
+     * the stress components are damped by `absorb_s` */
     
     if (ABS_TYPE==2){
-        for (j=ny1;j<=ny2;j++){
-            for (i=nx1;i<=nx2;i++){
-                for (k=nz1;k<=nz2;k++){
-                    vx[j][i][k]*=absorb_coeff[j][i][k];
-                    vy[j][i][k]*=absorb_coeff[j][i][k];
-                    vz[j][i][k]*=absorb_coeff[j][i][k];
-                    sxy[j][i][k]*=absorb_coeff[j][i][k];
-                    syz[j][i][k]*=absorb_coeff[j][i][k];
-                    sxz[j][i][k]*=absorb_coeff[j][i][k];
-                    sxx[j][i][k]*=absorb_coeff[j][i][k];
-                    syy[j][i][k]*=absorb_coeff[j][i][k];
-                    szz[j][i][k]*=absorb_coeff[j][i][k];
-                    
-                }
-            }
-        }
+        float ***u[3] = {vx, vy, vz};
+        absorb_damp(absorb_frame, nx1, nx2, ny1, ny2, nz1, nz2, 3, u);
     }
     
     if (LOG) {
         time2=MPI_Wtime();
         time=time2-time1;
-        if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
-            fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time);
-        }
     }
 
     return time;
 }
+
+
+/**
+ * Damp the stress components in the absorbing frame (ABS_TYPE=2).
+ *
+ * Must be called after the velocity update of the whole subdomain,
+ * because the velocity stencil reads the undamped stresses.
+ *
+ * Parameters
+ * ----------
+ *  nx1, nx2, ny1, ny2, nz1, nz2:
+ *      Dimensions of the grid points.
+ *  s :
+ *      Stress tensor.
+ *  absorb_frame :
+ *      Absorbing frame.
+ */
+void absorb_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Tensor3d *s, const AbsorbFrame *absorb_frame) {
+
+    float ***u[6] = {s->xy, s->yz, s->xz, s->xx, s->yy, s->zz};
+
+    absorb_damp(absorb_frame, nx1, nx2, ny1, ny2, nz1, nz2, 6, u);
+}
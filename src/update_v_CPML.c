@@ -3,13 +3,6 @@
 #include "globvar.h"
 
 
-#ifdef __GNUC__
-    #define ATTR_UNUSED __attribute__((unused))
-#else
-    #define ATTR_UNUSED
-#endif
-
-
 /**
  * Correct particle velocity using CPML boundary condition.
  * 
@@ -18,8 +11,8 @@
  * Correction is done for the 4th order spatial FD sheme.
  *
  * Parameters:
- * nx1, nx2, ny1, ny2, nz1, nz2 :
- *     Grid dimensions.
+ * nbox, cpml :
+ *     Boxes of the CPML frame, see `CPML_boxes`.
  * nt :
  *     Time step.
  * v :
@@ -47,7 +40,7 @@
  * https://doi.org/10.1190/1.2757586
  */
 double update_v_CPML(
-        int nx1, int nx2, int ny1, int ny2, int nz1 ATTR_UNUSED, int nz2,
+        int nbox, const CpmlBox *cpml,
 		int nt, Velocity *v,
 		Tensor3d *s,
         float  *** rjp, float  *** rkp, float  *** rip,
@@ -72,12 +65,9 @@ double update_v_CPML(
 	double time=0.0, time1=0.0, time2=0.0;
 	extern int MYID, LOG, FDCOEFF, FDORDER;
 	extern FILE *FP;
-	extern int FREE_SURF;
-	extern int NPROCX, NPROCY, NPROCZ, POS[4];
-	extern int FW, NY, NZ;
 	extern int OUTNTIMESTEPINFO;
 
-	int i, j, k, h1;
+	int b, i, j, k, h;
 	float b1=1.0, b2=0.0, dx, dy, dz;
 	float sxx_x=0.0, sxy_y=0.0, sxz_z=0.0, syy_y=0.0, sxy_x=0.0, syz_z=0.0;
 	float szz_z=0.0, sxz_x=0.0, syz_y=0.0;
@@ -129,104 +119,30 @@ double update_v_CPML(
 
 
 
-	/* boundaries in x-direction */
+	/* faces, edges and corners of the frame, the layers of a box
+	   apply at all its grid points */
+	for (b=0;b<nbox;b++){
+		const int cx=cpml[b].cx, cy=cpml[b].cy, cz=cpml[b].cz;
+		const int ox=cpml[b].ox, oy=cpml[b].oy, oz=cpml[b].oz;
+		const GridBox box=cpml[b].box;
 
-	if (POS[1]==0){
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
 #endif
-		for (j=1;j<=NY;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    private(i, k, sxx_x, sxy_x, sxz_x, sxy_y, syy_y, syz_y, sxz_z, syz_z, szz_z, h)
 #endif
-			for (i=1;i<=FW;i++){
+		for (j=box.ny1;j<=box.ny2;j++){
 #ifdef _OPENACC
 #pragma acc loop independent
 #endif
-				for (k=1;k<=NZ;k++){
-
-					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-					sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-					sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-					syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-					syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-					sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-
-
-					psi_sxx_x[j][i][k] = b_x_half[i] * psi_sxx_x[j][i][k] + a_x_half[i] * sxx_x;
-					sxx_x = sxx_x / K_x_half[i] + psi_sxx_x[j][i][k];
-					psi_sxy_x[j][i][k] = b_x[i] * psi_sxy_x[j][i][k] + a_x[i] * sxy_x;
-					sxy_x = sxy_x / K_x[i] + psi_sxy_x[j][i][k];
-					psi_sxz_x[j][i][k] = b_x[i] * psi_sxz_x[j][i][k] + a_x[i] * sxz_x;
-					sxz_x = sxz_x / K_x[i] + psi_sxz_x[j][i][k];
-
-					if((POS[2]==0 && FREE_SURF==0) && (j<=FW)){
-
-						psi_sxy_y[j][i][k] = b_y[j] * psi_sxy_y[j][i][k] + a_y[j] * sxy_y;
-						sxy_y = sxy_y / K_y[j] + psi_sxy_y[j][i][k];
-						psi_syy_y[j][i][k] = b_y_half[j] * psi_syy_y[j][i][k] + a_y_half[j] * syy_y;
-						syy_y = syy_y / K_y_half[j] + psi_syy_y[j][i][k];
-						psi_syz_y[j][i][k] = b_y[j] * psi_syz_y[j][i][k] + a_y[j] * syz_y;
-						syz_y = syz_y / K_y[j] + psi_syz_y[j][i][k]; 	 }
-
-
-					if((POS[2]==NPROCY-1) && (j>=ny2+1)){
-						h1 = (j-ny2+FW);
-						psi_sxy_y[h1][i][k] = b_y[h1] * psi_sxy_y[h1][i][k] + a_y[h1] * sxy_y;
-						sxy_y = sxy_y / K_y[h1] + psi_sxy_y[h1][i][k];
-						psi_syy_y[h1][i][k] = b_y_half[h1] * psi_syy_y[h1][i][k] + a_y_half[h1] * syy_y;
-						syy_y = syy_y / K_y_half[h1] + psi_syy_y[h1][i][k];
-						psi_syz_y[h1][i][k] = b_y[h1] * psi_syz_y[h1][i][k] + a_y[h1] * syz_y;
-						syz_y = syz_y / K_y[h1] + psi_syz_y[h1][i][k];
-					}
-
-
-					if((POS[3]==0) && (k<=FW)){
-						psi_sxz_z[j][i][k] = b_z[k] * psi_sxz_z[j][i][k] + a_z[k] * sxz_z;
-						sxz_z = sxz_z / K_z[k] + psi_sxz_z[j][i][k];
-						psi_syz_z[j][i][k] = b_z[k] * psi_syz_z[j][i][k] + a_z[k] * syz_z;
-						syz_z = syz_z / K_z[k] + psi_syz_z[j][i][k];
-						psi_szz_z[j][i][k] = b_z_half[k] * psi_szz_z[j][i][k] + a_z_half[k] * szz_z;
-						szz_z = szz_z / K_z_half[k] + psi_szz_z[j][i][k];}
-
-
-					if((POS[3]==NPROCZ-1) && (k>=nz2+1)){
-						h1 = (k-nz2+FW);
-						psi_sxz_z[j][i][h1] = b_z[h1] * psi_sxz_z[j][i][h1] + a_z[h1] * sxz_z;
-						sxz_z = sxz_z / K_z[h1] + psi_sxz_z[j][i][h1];
-						psi_syz_z[j][i][h1] = b_z[h1] * psi_syz_z[j][i][h1] + a_z[h1] * syz_z;
-						syz_z = syz_z / K_z[h1] + psi_syz_z[j][i][h1];
-						psi_szz_z[j][i][h1] = b_z_half[h1] * psi_szz_z[j][i][h1] + a_z_half[h1] * szz_z;
-						szz_z = szz_z / K_z_half[h1] + psi_szz_z[j][i][h1];}
-
-
-					vx[j][i][k]+= (sxx_x + sxy_y + sxz_z)/rip[j][i][k];
-					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-
-				}
-			}
-		}
-	}
-
-	if(POS[1]==NPROCX-1){
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-		for (j=1;j<=NY;j++){
+			for (i=box.nx1;i<=box.nx2;i++){
 #ifdef _OPENACC
 #pragma acc loop independent
 #endif
-			for (i=nx2+1;i<=nx2+FW;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-				for (k=1;k<=NZ;k++){
+				for (k=box.nz1;k<=box.nz2;k++){
 
 					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
 					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
@@ -238,267 +154,39 @@ double update_v_CPML(
 					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
 					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
 
-					h1 = (i-nx2+FW);
-
-					psi_sxx_x[j][h1][k] = b_x_half[h1] * psi_sxx_x[j][h1][k] + a_x_half[h1] * sxx_x;
-					sxx_x = sxx_x / K_x_half[h1] + psi_sxx_x[j][h1][k];
-					psi_sxy_x[j][h1][k] = b_x[h1] * psi_sxy_x[j][h1][k] + a_x[h1] * sxy_x;
-					sxy_x = sxy_x / K_x[h1] + psi_sxy_x[j][h1][k];
-					psi_sxz_x[j][h1][k] = b_x[h1] * psi_sxz_x[j][h1][k] + a_x[h1] * sxz_x;
-					sxz_x = sxz_x / K_x[h1] + psi_sxz_x[j][h1][k];
-
-
-
-					if((POS[2]==0 && FREE_SURF==0) && (j<=FW)){
-						psi_sxy_y[j][i][k] = b_y[j] * psi_sxy_y[j][i][k] + a_y[j] * sxy_y;
-						sxy_y = sxy_y / K_y[j] + psi_sxy_y[j][i][k];
-						psi_syy_y[j][i][k] = b_y_half[j] * psi_syy_y[j][i][k] + a_y_half[j] * syy_y;
-						syy_y = syy_y / K_y_half[j] + psi_syy_y[j][i][k];
-						psi_syz_y[j][i][k] = b_y[j] * psi_syz_y[j][i][k] + a_y[j] * syz_y;
-						syz_y = syz_y / K_y[j] + psi_syz_y[j][i][k]; 	 }
-
-
-					if((POS[2]==NPROCY-1) && (j>=ny2+1)){
-						h1 = (j-ny2+FW);
-						psi_sxy_y[h1][i][k] = b_y[h1] * psi_sxy_y[h1][i][k] + a_y[h1] * sxy_y;
-						sxy_y = sxy_y / K_y[h1] + psi_sxy_y[h1][i][k];
-						psi_syy_y[h1][i][k] = b_y_half[h1] * psi_syy_y[h1][i][k] + a_y_half[h1] * syy_y;
-						syy_y = syy_y / K_y_half[h1] + psi_syy_y[h1][i][k];
-						psi_syz_y[h1][i][k] = b_y[h1] * psi_syz_y[h1][i][k] + a_y[h1] * syz_y;
-						syz_y = syz_y / K_y[h1] + psi_syz_y[h1][i][k];
+					if (cx){
+						h = i-ox;
+						psi_sxx_x[j][h][k] = b_x_half[h] * psi_sxx_x[j][h][k] + a_x_half[h] * sxx_x;
+						sxx_x = sxx_x / K_x_half[h] + psi_sxx_x[j][h][k];
+						psi_sxy_x[j][h][k] = b_x[h] * psi_sxy_x[j][h][k] + a_x[h] * sxy_x;
+						sxy_x = sxy_x / K_x[h] + psi_sxy_x[j][h][k];
+						psi_sxz_x[j][h][k] = b_x[h] * psi_sxz_x[j][h][k] + a_x[h] * sxz_x;
+						sxz_x = sxz_x / K_x[h] + psi_sxz_x[j][h][k];
 					}
 
+					if (cy){
+						h = j-oy;
+						psi_sxy_y[h][i][k] = b_y[h] * psi_sxy_y[h][i][k] + a_y[h] * sxy_y;
+						sxy_y = sxy_y / K_y[h] + psi_sxy_y[h][i][k];
+						psi_syy_y[h][i][k] = b_y_half[h] * psi_syy_y[h][i][k] + a_y_half[h] * syy_y;
+						syy_y = syy_y / K_y_half[h] + psi_syy_y[h][i][k];
+						psi_syz_y[h][i][k] = b_y[h] * psi_syz_y[h][i][k] + a_y[h] * syz_y;
+						syz_y = syz_y / K_y[h] + psi_syz_y[h][i][k];
+					}
 
-					if((POS[3]==0) && (k<=FW)){
-						psi_sxz_z[j][i][k] = b_z[k] * psi_sxz_z[j][i][k] + a_z[k] * sxz_z;
-						sxz_z = sxz_z / K_z[k] + psi_sxz_z[j][i][k];
-						psi_syz_z[j][i][k] = b_z[k] * psi_syz_z[j][i][k] + a_z[k] * syz_z;
-						syz_z = syz_z / K_z[k] + psi_syz_z[j][i][k];
-						psi_szz_z[j][i][k] = b_z_half[k] * psi_szz_z[j][i][k] + a_z_half[k] * szz_z;
-						szz_z = szz_z / K_z_half[k] + psi_szz_z[j][i][k];}
-
-
-					if((POS[3]==NPROCZ-1) && (k>=nz2+1)){
-						h1 = (k-nz2+FW);
-						psi_sxz_z[j][i][h1] = b_z[h1] * psi_sxz_z[j][i][h1] + a_z[h1] * sxz_z;
-						sxz_z = sxz_z / K_z[h1] + psi_sxz_z[j][i][h1];
-						psi_syz_z[j][i][h1] = b_z[h1] * psi_syz_z[j][i][h1] + a_z[h1] * syz_z;
-						syz_z = syz_z / K_z[h1] + psi_syz_z[j][i][h1];
-						psi_szz_z[j][i][h1] = b_z_half[h1] * psi_szz_z[j][i][h1] + a_z_half[h1] * szz_z;
-						szz_z = szz_z / K_z_half[h1] + psi_szz_z[j][i][h1];}
+					if (cz){
+						h = k-oz;
+						psi_sxz_z[j][i][h] = b_z[h] * psi_sxz_z[j][i][h] + a_z[h] * sxz_z;
+						sxz_z = sxz_z / K_z[h] + psi_sxz_z[j][i][h];
+						psi_syz_z[j][i][h] = b_z[h] * psi_syz_z[j][i][h] + a_z[h] * syz_z;
+						syz_z = syz_z / K_z[h] + psi_syz_z[j][i][h];
+						psi_szz_z[j][i][h] = b_z_half[h] * psi_szz_z[j][i][h] + a_z_half[h] * szz_z;
+						szz_z = szz_z / K_z_half[h] + psi_szz_z[j][i][h];
+					}
 
 					vx[j][i][k]+= (sxx_x + sxy_y + sxz_z)/rip[j][i][k];
 					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
 					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-
-				}
-			}
-		}
-	}
-
-	if((POS[2]==0 && FREE_SURF==0)){
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-		for (j=1;j<=FW;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-			for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-				for (k=1;k<=NZ;k++){
-
-					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-					sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-					sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-					syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-					syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-					sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-
-					psi_sxy_y[j][i][k] = b_y[j] * psi_sxy_y[j][i][k] + a_y[j] * sxy_y;
-					sxy_y = sxy_y / K_y[j] + psi_sxy_y[j][i][k];
-
-					psi_syy_y[j][i][k] = b_y_half[j] * psi_syy_y[j][i][k] + a_y_half[j] * syy_y;
-					syy_y = syy_y / K_y_half[j] + psi_syy_y[j][i][k];
-
-					psi_syz_y[j][i][k] = b_y[j] * psi_syz_y[j][i][k] + a_y[j] * syz_y;
-					syz_y = syz_y / K_y[j] + psi_syz_y[j][i][k];
-
-					if((POS[3]==0) && (k<=FW)){
-						psi_sxz_z[j][i][k] = b_z[k] * psi_sxz_z[j][i][k] + a_z[k] * sxz_z;
-						sxz_z = sxz_z / K_z[k] + psi_sxz_z[j][i][k];
-						psi_syz_z[j][i][k] = b_z[k] * psi_syz_z[j][i][k] + a_z[k] * syz_z;
-						syz_z = syz_z / K_z[k] + psi_syz_z[j][i][k];
-						psi_szz_z[j][i][k] = b_z_half[k] * psi_szz_z[j][i][k] + a_z_half[k] * szz_z;
-						szz_z = szz_z / K_z_half[k] + psi_szz_z[j][i][k];}
-
-
-					if((POS[3]==NPROCZ-1) && (k>=nz2+1)){
-						h1 = (k-nz2+FW);
-						psi_sxz_z[j][i][h1] = b_z[h1] * psi_sxz_z[j][i][h1] + a_z[h1] * sxz_z;
-						sxz_z = sxz_z / K_z[h1] + psi_sxz_z[j][i][h1];
-						psi_syz_z[j][i][h1] = b_z[h1] * psi_syz_z[j][i][h1] + a_z[h1] * syz_z;
-						syz_z = syz_z / K_z[h1] + psi_syz_z[j][i][h1];
-						psi_szz_z[j][i][h1] = b_z_half[h1] * psi_szz_z[j][i][h1] + a_z_half[h1] * szz_z;
-						szz_z = szz_z / K_z_half[h1] + psi_szz_z[j][i][h1];}
-
-
-					vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-
-				}
-			}
-		}
-	}
-
-	if(POS[2]==NPROCY-1){
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-		for (j=ny2+1;j<=ny2+FW;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-			for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-				for (k=1;k<=NZ;k++){
-
-					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-					sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-					sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-					syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-					syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-					sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-
-					h1 = (j-ny2+FW);
-
-					psi_sxy_y[h1][i][k] = b_y[h1] * psi_sxy_y[h1][i][k] + a_y[h1] * sxy_y;
-					sxy_y = sxy_y / K_y[h1] + psi_sxy_y[h1][i][k];
-					psi_syy_y[h1][i][k] = b_y_half[h1] * psi_syy_y[h1][i][k] + a_y_half[h1] * syy_y;
-					syy_y = syy_y / K_y_half[h1] + psi_syy_y[h1][i][k];
-					psi_syz_y[h1][i][k] = b_y[h1] * psi_syz_y[h1][i][k] + a_y[h1] * syz_y;
-					syz_y = syz_y / K_y[h1] + psi_syz_y[h1][i][k];
-
-					if((POS[3]==0) && (k<=FW)){
-						psi_sxz_z[j][i][k] = b_z[k] * psi_sxz_z[j][i][k] + a_z[k] * sxz_z;
-						sxz_z = sxz_z / K_z[k] + psi_sxz_z[j][i][k];
-						psi_syz_z[j][i][k] = b_z[k] * psi_syz_z[j][i][k] + a_z[k] * syz_z;
-						syz_z = syz_z / K_z[k] + psi_syz_z[j][i][k];
-						psi_szz_z[j][i][k] = b_z_half[k] * psi_szz_z[j][i][k] + a_z_half[k] * szz_z;
-						szz_z = szz_z / K_z_half[k] + psi_szz_z[j][i][k];}
-
-
-					if((POS[3]==NPROCZ-1) && (k>=nz2+1)){
-						h1 = (k-nz2+FW);
-						psi_sxz_z[j][i][h1] = b_z[h1] * psi_sxz_z[j][i][h1] + a_z[h1] * sxz_z;
-						sxz_z = sxz_z / K_z[h1] + psi_sxz_z[j][i][h1];
-						psi_syz_z[j][i][h1] = b_z[h1] * psi_syz_z[j][i][h1] + a_z[h1] * syz_z;
-						syz_z = syz_z / K_z[h1] + psi_syz_z[j][i][h1];
-						psi_szz_z[j][i][h1] = b_z_half[h1] * psi_szz_z[j][i][h1] + a_z_half[h1] * szz_z;
-						szz_z = szz_z / K_z_half[h1] + psi_szz_z[j][i][h1];}
-
-					vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-
-				} 
-			}
-		}
-	}
-
-	/* boundaries in z-direction */
-
-	if(POS[3]==0){
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-		for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-			for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-				for (k=1;k<=FW;k++){
-
-					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-					sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-					sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-					syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-					syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-					sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-
-
-					psi_sxz_z[j][i][k] = b_z[k] * psi_sxz_z[j][i][k] + a_z[k] * sxz_z;
-					sxz_z = sxz_z / K_z[k] + psi_sxz_z[j][i][k];
-					psi_syz_z[j][i][k] = b_z[k] * psi_syz_z[j][i][k] + a_z[k] * syz_z;
-					syz_z = syz_z / K_z[k] + psi_syz_z[j][i][k];
-					psi_szz_z[j][i][k] = b_z_half[k] * psi_szz_z[j][i][k] + a_z_half[k] * szz_z;
-					szz_z = szz_z / K_z_half[k] + psi_szz_z[j][i][k];
-
-					vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-
-				}
-			}
-		}
-	}
-
-	if(POS[3]==NPROCZ-1){
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-		for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-			for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-				for (k=nz2+1;k<=nz2+FW;k++){
-					sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-					sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-					sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-					sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-					syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-					syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-					sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-					syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-					szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-
-					h1 = (k-nz2+FW);
-
-					psi_sxz_z[j][i][h1] = b_z[h1] * psi_sxz_z[j][i][h1] + a_z[h1] * sxz_z;
-					sxz_z = sxz_z / K_z[h1] + psi_sxz_z[j][i][h1];
-					psi_syz_z[j][i][h1] = b_z[h1] * psi_syz_z[j][i][h1] + a_z[h1] * syz_z;
-					syz_z = syz_z / K_z[h1] + psi_syz_z[j][i][h1];
-					psi_szz_z[j][i][h1] = b_z_half[h1] * psi_szz_z[j][i][h1] + a_z_half[h1] * szz_z;
-					szz_z = szz_z / K_z_half[h1] + psi_szz_z[j][i][h1];
-
-					vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-					vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-					vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
 				}
 			}
 		}
@@ -12,14 +12,11 @@
 
 double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		int nt, Velocity *v, float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc,
-		float *** absorb_coeff, int * stype){
+		const AbsorbFrame *absorb_frame, int * stype){
 
 
 	extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
-	extern int MYID, FDORDER, ABS_TYPE, LOG, FDCOEFF;
-	extern int OUTNTIMESTEPINFO;
-
-	extern FILE *FP;
+	extern int FDORDER, ABS_TYPE, LOG, FDCOEFF;
 
 	register int i, j, k, l;
 	float  amp, alpha_rad, beta_rad, rjp, rkp, rip;
@@ -31,8 +28,7 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         float ***vy = v->y;
         float ***vz = v->z;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+	if (LOG) time1=MPI_Wtime();
 
 	switch (FDORDER){
 	case 2 :
@@ -301,31 +297,32 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 
 
 
-	/* absorbing boundary condition (exponential damping) */
+	/* absorbing boundary condition (exponential damping),
+	   the pressure is damped by absorb_s_acoustic */
 
 	if (ABS_TYPE==2){
-		for (j=ny1;j<=ny2;j++){
-			for (i=nx1;i<=nx2;i++){
-				for (k=nz1;k<=nz2;k++){
-					vx[j][i][k]*=absorb_coeff[j][i][k];
-					vy[j][i][k]*=absorb_coeff[j][i][k];
-					vz[j][i][k]*=absorb_coeff[j][i][k];
-					sxx[j][i][k]*=absorb_coeff[j][i][k];
+		float ***u[3] = {vx, vy, vz};
+		absorb_damp(absorb_frame,nx1,nx2,ny1,ny2,nz1,nz2,3,u);
+	}
 
-				}
-			}
-		}
+	if (LOG) {
+		time2=MPI_Wtime();
+		time=time2-time1;
 	}
+	return time;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
+}
 
-			time2=MPI_Wtime();
-			time=time2-time1;
-			fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time);
-		}
-	return time;
 
+/*------------------------------------------------------------------------
+ *   damping of the pressure at gridpoints [nx1...nx2][ny1...ny2][nz1...nz2]
+ *   in the absorbing frame (ABS_TYPE=2). Must be called after the particle
+ *   velocity stencil has read the undamped pressure at these gridpoints.
+ *  ----------------------------------------------------------------------*/
+void absorb_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+		float *** sxx, const AbsorbFrame *absorb_frame){
+
+	absorb_damp(absorb_frame,nx1,nx2,ny1,ny2,nz1,nz2,1,&sxx);
 }
 
 
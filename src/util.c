@@ -354,7 +354,11 @@ float ***f3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
 		for (j=ncl+1;j<=nch;j++) t[i][j]=t[i][j-1]+ndep;
 	}
 
-	/* initializing 3tensor */
+	/* initializing 3tensor, in parallel with the same static partitioning
+	   of the first index as the update loops (first-touch placement) */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(j, d)
+#endif
 	for (i=nrl;i<=nrh;i++)
 		for (j=ncl;j<=nch;j++)
 			for (d=ndl;d<=ndh;d++) t[i][j][d]=0.0;
@@ -364,6 +368,168 @@ float ***f3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
 }
 
 
+/*
+ * Number of floats between the starts of two consecutive rows of a tensor
+ * allocated by `f3tensor_aligned`, i.e. t[j][i+1] - t[j][i].
+ * The row length ndh-ndl+1 is padded so that every row starts on a
+ * FIELD_ALIGN boundary. A point (j, i, k) lies at offset
+ * ((j-nrl)*(nch-ncl+1) + (i-ncl))*ld + k - ndl + f3tensor_aligned_front(ndl)
+ * from the start of the data block.
+ */
+int f3tensor_aligned_ld(int ndl, int ndh){
+	const int w=FIELD_ALIGN/sizeof(float);
+
+	return ((f3tensor_aligned_front(ndl)+ndh-ndl+1+w-1)/w)*w;
+}
+
+
+/*
+ * Number of unused floats in front of element ndl of each row. It is chosen
+ * such that element k=1, where the update loops start, is aligned
+ * (element ndl if ndl > 1).
+ */
+int f3tensor_aligned_front(int ndl){
+	const int w=FIELD_ALIGN/sizeof(float);
+
+	return (ndl<1) ? (w-(1-ndl)%w)%w : 0;
+}
+
+
+float ***f3tensor_aligned(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
+	/* allocate a float 3tensor with subscript range m[nrl..nrh][ncl..nch][ndl..ndh]
+	   like f3tensor(), but with rows padded to f3tensor_aligned_ld() floats and
+	   starting on a FIELD_ALIGN boundary, and intializing the tensor with 0.0 */
+	int i,j,d, nrow=nrh-nrl+1,ncol=nch-ncl+1;
+	int ld=f3tensor_aligned_ld(ndl,ndh), front=f3tensor_aligned_front(ndl);
+	float ***t, *data;
+
+	/* allocate pointers to pointers to rows */
+	t=(float ***) malloc((size_t) ((nrow+NR_END)*sizeof(float**)));
+	if (!t) err("allocation failure 1 in function f3tensor_aligned() ");
+	t += NR_END;
+	t -= nrl;
+
+	/* allocate pointers to rows and set pointers to them */
+	t[nrl]=(float **) malloc((size_t)((nrow*ncol+NR_END)*sizeof(float*)));
+	if (!t[nrl]) err("allocation failure 2 in function f3tensor_aligned() ");
+	t[nrl] += NR_END;
+	t[nrl] -= ncl;
+
+	/* allocate rows; the size is a multiple of FIELD_ALIGN as required by
+	   aligned_alloc */
+	data=(float *) aligned_alloc(FIELD_ALIGN,(size_t)nrow*ncol*ld*sizeof(float));
+	if (!data) err("allocation failure 3 in function f3tensor_aligned() ");
+
+	for (i=nrl;i<=nrh;i++){
+		t[i]=t[nrl]+(i-nrl)*ncol;
+		for (j=ncl;j<=nch;j++)
+			t[i][j]=data+((size_t)(i-nrl)*ncol+(j-ncl))*ld+front-ndl;
+	}
+
+	/* initializing 3tensor including the padding, first-touch placement as
+	   in f3tensor() */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(j, d)
+#endif
+	for (i=nrl;i<=nrh;i++)
+		for (j=ncl;j<=nch;j++)
+			for (d=ndl-front;d<ndl-front+ld;d++) t[i][j][d]=0.0;
+
+	/* return pointer to array of pointer to rows */
+	return t;
+}
+
+
+uint16_t ***u16tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
+	/* allocate a 3tensor of unsigned 16-bit integers with subscript range
+	   m[nrl..nrh][ncl..nch][ndl..ndh] like i3tensor(), used for material
+	   parameters in 16-bit storage (see mat16.c) */
+	int i,j,d, nrow=nrh-nrl+1,ncol=nch-ncl+1,ndep=ndh-ndl+1;
+	uint16_t ***t;
+
+	/* allocate pointers to pointers to rows */
+	t=(uint16_t ***) malloc((size_t) ((nrow+NR_END)*sizeof(uint16_t**)));
+	if (!t) err("allocation failure 1 in function u16tensor() ");
+	t += NR_END;
+	t -= nrl;
+
+	/* allocate pointers to rows and set pointers to them */
+	t[nrl]=(uint16_t **) malloc((size_t)((nrow*ncol+NR_END)*sizeof(uint16_t*)));
+	if (!t[nrl]) err("allocation failure 2 in function u16tensor() ");
+	t[nrl] += NR_END;
+	t[nrl] -= ncl;
+
+	/* allocate rows and set pointers to them */
+	t[nrl][ncl]=(uint16_t *) malloc((size_t)nrow*ncol*ndep*sizeof(uint16_t)+NR_END*sizeof(uint16_t));
+	if (!t[nrl][ncl]) err("allocation failure 3 in function u16tensor() ");
+	t[nrl][ncl] += NR_END;
+	t[nrl][ncl] -= ndl;
+
+	for (j=ncl+1;j<=nch;j++) t[nrl][j]=t[nrl][j-1]+ndep;
+	for (i=nrl+1;i<=nrh;i++){
+		t[i]=t[i-1]+ncol;
+		t[i][ncl]=t[i-1][ncl]+(size_t)ncol*ndep;
+		for (j=ncl+1;j<=nch;j++) t[i][j]=t[i][j-1]+ndep;
+	}
+
+	/* initializing 3tensor, first-touch placement as in f3tensor() */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(j, d)
+#endif
+	for (i=nrl;i<=nrh;i++)
+		for (j=ncl;j<=nch;j++)
+			for (d=ndl;d<=ndh;d++) t[i][j][d]=0;
+
+	/* return pointer to array of pointer to rows */
+	return t;
+}
+
+
+uint8_t ***u8tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
+	/* allocate a 3tensor of unsigned 8-bit integers with subscript range
+	   m[nrl..nrh][ncl..nch][ndl..ndh] like i3tensor(), used for the index
+	   volume of the material table (see mat_table.c) */
+	int i,j,d, nrow=nrh-nrl+1,ncol=nch-ncl+1,ndep=ndh-ndl+1;
+	uint8_t ***t;
+
+	/* allocate pointers to pointers to rows */
+	t=(uint8_t ***) malloc((size_t) ((nrow+NR_END)*sizeof(uint8_t**)));
+	if (!t) err("allocation failure 1 in function u8tensor() ");
+	t += NR_END;
+	t -= nrl;
+
+	/* allocate pointers to rows and set pointers to them */
+	t[nrl]=(uint8_t **) malloc((size_t)((nrow*ncol+NR_END)*sizeof(uint8_t*)));
+	if (!t[nrl]) err("allocation failure 2 in function u8tensor() ");
+	t[nrl] += NR_END;
+	t[nrl] -= ncl;
+
+	/* allocate rows and set pointers to them */
+	t[nrl][ncl]=(uint8_t *) malloc((size_t)nrow*ncol*ndep*sizeof(uint8_t)+NR_END*sizeof(uint8_t));
+	if (!t[nrl][ncl]) err("allocation failure 3 in function u8tensor() ");
+	t[nrl][ncl] += NR_END;
+	t[nrl][ncl] -= ndl;
+
+	for (j=ncl+1;j<=nch;j++) t[nrl][j]=t[nrl][j-1]+ndep;
+	for (i=nrl+1;i<=nrh;i++){
+		t[i]=t[i-1]+ncol;
+		t[i][ncl]=t[i-1][ncl]+(size_t)ncol*ndep;
+		for (j=ncl+1;j<=nch;j++) t[i][j]=t[i][j-1]+ndep;
+	}
+
+	/* initializing 3tensor, first-touch placement as in f3tensor() */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) private(j, d)
+#endif
+	for (i=nrl;i<=nrh;i++)
+		for (j=ncl;j<=nch;j++)
+			for (d=ndl;d<=ndh;d++) t[i][j][d]=0;
+
+	/* return pointer to array of pointer to rows */
+	return t;
+}
+
+
 int ***i3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
 	/* allocate a integer 3tensor with subscript range m[nrl..nrh][ncl..nch][ndl..ndh]
 		   and intializing the matrix, e.g. m[nrl..nrh][ncl..nch][ndl..ndh]=0.0 */
@@ -515,6 +681,36 @@ void free_f3tensor(float ***t,
 	free((FREE_ARG) (t+nrl-NR_END));
 }
 
+void free_f3tensor_aligned(float ***t,
+        int nrl, int nrh ATTR_UNUSED,
+        int ncl, int nch ATTR_UNUSED,
+        int ndl, int ndh ATTR_UNUSED) {
+	/* free a float tensor allocated by f3tensor_aligned() */
+	free(t[nrl][ncl]+ndl-f3tensor_aligned_front(ndl));
+	free((FREE_ARG) (t[nrl]+ncl-NR_END));
+	free((FREE_ARG) (t+nrl-NR_END));
+}
+
+void free_u8tensor(uint8_t ***t,
+        int nrl, int nrh ATTR_UNUSED,
+        int ncl, int nch ATTR_UNUSED,
+        int ndl, int ndh ATTR_UNUSED) {
+	/* free a 8-bit tensor allocated by u8tensor() */
+	free((FREE_ARG) (t[nrl][ncl]+ndl-NR_END));
+	free((FREE_ARG) (t[nrl]+ncl-NR_END));
+	free((FREE_ARG) (t+nrl-NR_END));
+}
+
+void free_u16tensor(uint16_t ***t,
+        int nrl, int nrh ATTR_UNUSED,
+        int ncl, int nch ATTR_UNUSED,
+        int ndl, int ndh ATTR_UNUSED) {
+	/* free a 16-bit tensor allocated by u16tensor() */
+	free((FREE_ARG) (t[nrl][ncl]+ndl-NR_END));
+	free((FREE_ARG) (t[nrl]+ncl-NR_END));
+	free((FREE_ARG) (t+nrl-NR_END));
+}
+
 void free_i3tensor(int ***t,
         int nrl, int nrh ATTR_UNUSED,
         int ncl, int nch ATTR_UNUSED,
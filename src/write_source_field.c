@@ -28,9 +28,10 @@ void write_source_field(
     // External (global) variables.
     extern int NX, NY, NZ, POS[4], IDX, IDY, IDZ;
 
-    int i, j, k;
+    int k, nplane = ((NX - 1) / IDX + 1) * ((NY - 1) / IDY + 1);
     FILE *fp;
     char file[STRING_SIZE];
+    float *plane;
 
     sprintf(file, "%s.%d.%d.%d", source_field_file, POS[1], POS[2], POS[3]);
     fp = fopen(file, "w");
@@ -38,13 +39,12 @@ void write_source_field(
         err2("Cannot open file %s for writing\n", source_field_file);
     }
 
+    plane = vector(0, nplane - 1);
     for (k = 1; k <= NZ; k += IDZ) {
-        for (i = 1; i <= NX; i += IDX) {
-            for (j = 1; j <= NY; j += IDY) {
-                writedsk(fp, s[j][i][k], format);
-            }
-        }
+        snap_copy(plane, s, IDX, IDY, 1, 1, 1, k, NX, NY, k);
+        writedsk_block(fp, plane, nplane, format);
     }
+    free_vector(plane, 0, nplane - 1);
 
     fclose(fp);
 }
@@ -33,3 +33,28 @@ void writedsk(FILE *fp_out, float amp, int format){
 			err(" No output was written. ");
 	}
 }
+
+
+/*
+ * Write the n values buf[0..n-1] on disk, binary data with one call of
+ * fwrite. The formats are the same as for writedsk().
+ */
+void writedsk_block(FILE *fp_out, const float *buf, int n, int format){
+
+	int m;
+
+	switch(format){
+		case 1 : /* SU*/
+			err(" Sorry, SU-format for snapshots not implemented yet. \n");
+			break;
+		case 2 :  /*ASCII*/
+			for (m=0;m<n;m++) fprintf(fp_out,"%e\n", buf[m]);
+			break;
+		case 3 :   /* BINARY */
+			fwrite(buf, sizeof(float), (size_t) n, fp_out);
+			break;
+		default :
+			printf(" Don't know the format for the snapshot-data !\n");
+			err(" No output was written. ");
+	}
+}
@@ -24,21 +24,21 @@ void writemod(char modfile[STRING_SIZE], float ***q, int format) {
     // External (global) variables.
     extern int NX, NY, NZ, POS[4], IDX, IDY, IDZ;
 
-    int i, j, k;
+    int k, nplane = ((NX - 1) / IDX + 1) * ((NY - 1) / IDY + 1);
     FILE *fpmod;
     char file[STRING_SIZE];
+    float *plane;
 
     /*printf("\n\n PE %d is writing model to \n",MYID);*/
     sprintf(file, "%s.%i%i%i", modfile, POS[1], POS[2], POS[3]);
     /*printf("\t%s\n\n", file);*/
     fpmod = fopen(file, "w");
+    plane = vector(0, nplane - 1);
     for (k = 1; k <= NZ; k += IDZ) {
-        for (i = 1; i <= NX; i += IDX) {
-            for (j = 1; j <= NY; j += IDY) {
-                writedsk(fpmod, q[j][i][k], format);
-            }
-        }
+        snap_copy(plane, q, IDX, IDY, 1, 1, 1, k, NX, NY, k);
+        writedsk_block(fpmod, plane, nplane, format);
     }
+    free_vector(plane, 0, nplane - 1);
 
     fclose(fpmod);
 }
@@ -4,6 +4,7 @@
    
    ----------------------------------------------------------------------*/
 #include <limits.h>
+#include "enum.h"
 #include "fd.h"
 #include "globvar.h"
 
@@ -21,10 +22,14 @@ void writepar(FILE *fp, int ns){
 	extern float REC_ARRAY_DEPTH, REC_ARRAY_DIST;
 	extern int SEISMO, NDT, NDTSHIFT, NGEOPH, SEIS_FORMAT[6], FREE_SURF;
 	extern int  READMOD, READREC, DRX, DRZ, BOUNDARY, SRCREC, IDX, IDY, IDZ;
-	extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING;
+	extern float TSNAP1, TSNAP2, TSNAPINC, REFREC[4], DAMPING, SNAP_TOL, DECOMP_CPML;
 	extern char SNAP_FILE[STRING_SIZE], SOURCE_FILE[STRING_SIZE], SIGNAL_FILE[STRING_SIZE], REC_FILE[STRING_SIZE], SEIS_FILE[STRING_SIZE];
+	extern char SNAP_PLAN[STRING_SIZE];
 	extern char  MFILE[STRING_SIZE];
-	extern int NP, NPROCX, NPROCY, NPROCZ, MYID;
+	extern int NP, NPROCX, NPROCY, NPROCZ, MYID, OVERLAP_COMM, PERSISTENT_COMM, THREADS, SIMD, DECOMP;
+	extern int TILE_X, TILE_Y, TILE_Z, TILE_AUTO, TIME_BLOCK, MAT_PRECISION, MAT_COMPRESS;
+	extern int SNAP_MPIIO, SNAP_ASYNC, SNAP_COMPRESS, CHECKPTREAD, CHECKPTWRITE, CHECKPT_INC, CHECKPT_MPIIO, SEIS_BLOCK, SEIS_MPIIO;
+	extern char CHECKPTFILE[STRING_SIZE];
 	
 	/* definition of local variables */
 	char th1[3], file_ext[8];
@@ -42,6 +47,14 @@ void writepar(FILE *fp, int ns){
 	fprintf(fp," Number of PEs in horizontal y-direction (NPROCY): %d\n",NPROCY);
 	fprintf(fp," Number of PEs in vertical   z-direction (NPROCZ): %d\n",NPROCZ);
 	fprintf(fp," Total number of PEs in use: %d\n",NP);
+	if (DECOMP==1)
+		fprintf(fp," Sizes of the sub grids balance the cost of the CPML frame (DECOMP=1),\n extra cost of a grid point in the frame DECOMP_CPML=%.2f.\n",DECOMP_CPML);
+	if (OVERLAP_COMM)
+		fprintf(fp," Exchange between PEs overlapped with computation (OVERLAP_COMM).\n");
+	if (PERSISTENT_COMM)
+		fprintf(fp," Exchange between PEs with persistent requests (PERSISTENT_COMM).\n");
+	if (THREADS > 1)
+		fprintf(fp," Number of OpenMP threads per PE (THREADS): %d\n",THREADS);
 	fprintf(fp,"\n");
 	fprintf(fp," ----------------------- Discretization  ---------------------\n");
 	fprintf(fp," Number of gridpoints in x-direction (NX): %i\n", NX);
@@ -63,6 +76,20 @@ void writepar(FILE *fp, int ns){
 	if ((FDORDER<0)||(FDORDER%2!=0)||(FDORDER>12))
 		err(" Incorrect FDORDER (must be 2, 4, 8, or 12) ! ");
 	fprintf(fp," Order of temporal FD operators: %i \n",FDORDER_TIME);
+	if (SIMD == 0)
+		fprintf(fp," Vectorized AVX2/AVX-512 kernels disabled (SIMD=0).\n");
+	if (TILE_AUTO)
+		fprintf(fp," Tile sizes of the update loops chosen from the L2 cache size (TILE_AUTO=1).\n");
+	else if (TILE_X || TILE_Y || TILE_Z)
+		fprintf(fp," Tile sizes of the update loops (TILE_X, TILE_Y, TILE_Z): %d, %d, %d \n",TILE_X,TILE_Y,TILE_Z);
+	if (TIME_BLOCK > 1)
+		fprintf(fp," Time steps per sweep of the acoustic program (TIME_BLOCK): %d \n",TIME_BLOCK);
+	if (MAT_PRECISION == MAT_FP16)
+		fprintf(fp," Material parameters of the update kernels stored as FP16 (MAT_PRECISION=1).\n");
+	else if (MAT_PRECISION == MAT_BF16)
+		fprintf(fp," Material parameters of the update kernels stored as BF16 (MAT_PRECISION=2).\n");
+	if (MAT_COMPRESS)
+		fprintf(fp," Material parameters of the update kernels stored as table of media (MAT_COMPRESS=1).\n");
 	
 	
 	fprintf(fp,"\n");
@@ -270,6 +297,23 @@ void writepar(FILE *fp, int ns){
 		default:
 			err(" Don't know the format for the Snapshot-data ! \n");
 		}
+		if (SNAP_MPIIO)
+			fprintf(fp," \n All PEs write into one file per component with MPI-IO (SNAP_MPIIO=1),\n no merge with snapmerge required.");
+		if (SNAP_ASYNC)
+			fprintf(fp," \n The snapshots are written by an I/O thread during the time stepping (SNAP_ASYNC=1).");
+		switch (SNAP_COMPRESS){
+		case 1 :
+			fprintf(fp," \n The snapshots of the PEs are compressed lossless (SNAP_COMPRESS=1).");
+			break;
+		case 2 :
+			fprintf(fp," \n The snapshots of the PEs are compressed with the absolute error bound\n SNAP_TOL=%e (SNAP_COMPRESS=2).",SNAP_TOL);
+			break;
+		case 3 :
+			fprintf(fp," \n The snapshots of the PEs are compressed with the error bound\n SNAP_TOL=%e relative to the largest amplitude (SNAP_COMPRESS=3).",SNAP_TOL);
+			break;
+		}
+		if (SNAP_PLAN[0])
+			fprintf(fp," \n Only the planes and boxes of SNAP_PLAN are written at full resolution\n with MPI-IO:\n\t %s",SNAP_PLAN);
 		switch (SNAP_PLANE){
 		case 1 :
 			fprintf(fp," \nDiv and curl output will be as Energy without sign. \n");
@@ -406,6 +450,10 @@ void writepar(FILE *fp, int ns){
 		fprintf(fp," samplingrate of seismic data:                %e s\n",NDT*DT);
 		if (!READREC) fprintf(fp," Trace-spacing: %e m\n", NGEOPH*DX);
 		fprintf(fp," Number of samples per receiver:              %i \n", ns);
+		if ((SEIS_BLOCK) && (SEIS_BLOCK < ns))
+			fprintf(fp," Samples written to disk in blocks of:        %i \n", SEIS_BLOCK);
+		if (SEIS_MPIIO)
+			fprintf(fp," Each PE writes its traces with MPI-IO (SEIS_MPIIO=1). \n");
 		if (!SEIS_FORMAT[5]) SEIS_FORMAT[5]= USHRT_MAX; /* default */
 		if (ns<=abs(SEIS_FORMAT[5])) fprintf(fp," Number of samples per trace:                 %i \n", ns);
 		else if (SEIS_FORMAT[5]<0){
@@ -422,6 +470,16 @@ void writepar(FILE *fp, int ns){
 		fprintf(fp,"\n");
 	}
 
+	if (CHECKPTREAD || CHECKPTWRITE){
+		fprintf(fp," -----------------------  CHECKPOINTS  ----------------------\n");
+		fprintf(fp," checkpoint file: %s%s \n",CHECKPTFILE,(CHECKPT_MPIIO) ? " (one file, MPI-IO)" : ".<PE>");
+		if (CHECKPTREAD) fprintf(fp," The simulation is continued from the checkpoint.\n");
+		if (CHECKPTWRITE) fprintf(fp," A checkpoint is saved at the end of the simulation.\n");
+		if (CHECKPTWRITE && CHECKPT_INC)
+			fprintf(fp," A checkpoint is saved every %d time steps.\n",CHECKPT_INC);
+		fprintf(fp,"\n");
+	}
+
 	fprintf(fp,"\n **********************************************************");
 	fprintf(fp,"\n ******* PARAMETERS READ or PROCESSED within ASOFI3D *******");
 	fprintf(fp,"\n **********************************************************\n\n");
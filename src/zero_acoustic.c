@@ -30,3 +30,26 @@ float *** sxx){
 		}
 	
 }
+
+
+/* PML-splitting variables of one PML block */
+void zero_PML_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+float *** vx1, float *** vy2, float *** vz3,
+float *** sxx1, float *** sxx2, float *** sxx3){
+
+	register int i, j, k;
+
+		for (j=ny1;j<=ny2;j++){
+			for (i=nx1;i<=nx2;i++){
+				for (k=nz1;k<=nz2;k++){
+				vx1[j][i][k]=0.0;
+				vy2[j][i][k]=0.0;
+				vz3[j][i][k]=0.0;
+				sxx1[j][i][k]=0.0;
+				sxx2[j][i][k]=0.0;
+				sxx3[j][i][k]=0.0;
+				}
+			}
+		}
+
+}
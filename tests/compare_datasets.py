@@ -5,8 +5,9 @@ Comparison is done using expression:
 
     abs(a - b) <= (atol + rtol * abs(b))
 
-where a and b are datasets, atol is the absolute tolerance (default 1e-8),
+where a and b are datasets, atol is the absolute tolerance (default 1e-15),
 rtol the relative tolerance (default 1e-5).
+With --atol-peak, atol is a fraction of the peak amplitude max(abs(b)).
 
 The result of the comparison is provided as an exit code of this script.
 Exit codes are:
@@ -37,6 +38,12 @@ def main(argv=None):
         '--atol', help='Absolute tolerance', type=float, default=1e-15)
     p.add_argument(
         '--verbose', '-v', help='Print results to stdout', action='store_true')
+    p.add_argument(
+        '--atol-peak', help='Take atol relative to the peak amplitude of '
+        'the 2nd dataset', action='store_true')
+    p.add_argument(
+        '--report', help='Print the maximum deviation to stdout',
+        action='store_true')
 
     args = p.parse_args()
 
@@ -46,14 +53,23 @@ def main(argv=None):
 
     data1, data2 = get_datasets(filename1, filename2)
 
-    try:
-        result = np.allclose(data1, data2, rtol=rtol, atol=atol)
-    except ValueError:
-        if verbose:
+    if data1.shape != data2.shape:
+        if verbose or args.report:
             print('Shapes do not match')
-        # `np.allclose` returns `ValueError`, when shapes do not match.
         return 2
 
+    peak = np.max(np.abs(data2)) if data2.size else 0.0
+    if args.atol_peak:
+        atol = atol * peak
+
+    if args.report:
+        maxdev = np.max(np.abs(data1 - data2)) if data2.size else 0.0
+        print('Max deviation: {:.6e}, peak amplitude: {:.6e}, '
+              'relative to peak: {:.6e}'.format(
+                  maxdev, peak, maxdev / peak if peak > 0 else 0.0))
+
+    result = np.allclose(data1, data2, rtol=rtol, atol=atol)
+
     if result:
         if verbose:
             print('Datasets are elementwise close within tolerance')
@@ -67,6 +83,7 @@ def main(argv=None):
 def get_datasets(filename1, filename2):
     rsf_format = '.rsf' in filename1 and '.rsf' in filename2
     bin_format = '.bin' in filename1 and '.bin' in filename2
+    su_format = filename1.endswith('.su') and filename2.endswith('.su')
 
     if rsf_format:
         file1 = rsf.Input(filename1)
@@ -90,12 +107,31 @@ def get_datasets(filename1, filename2):
         data2 = np.fromfile(filename2, dtype=np.float32)
         data1.reshape((NY / IDY, NX / IDX, NZ / IDZ, nsnap))
         data2.reshape((NY / IDY, NX / IDX, NZ / IDZ, nsnap))
+    elif su_format:
+        data1 = read_su(filename1)
+        data2 = read_su(filename2)
     else:
         raise Exception('Cannot determine dataset format!')
 
     return data1, data2
 
 
+def read_su(filename):
+    """Read the traces of a Seismic Unix file (IEEE754/LE floats).
+
+    Returns
+    -------
+    2D array with one trace per row.
+    """
+    raw = np.fromfile(filename, dtype=np.uint8)
+    if raw.size == 0:
+        return np.zeros((0, 0), dtype=np.float32)
+    # Number of samples per trace is stored in bytes 115-116 of the header.
+    ns = int(raw[114:116].view('<u2')[0])
+    traces = raw.reshape((-1, 240 + 4 * ns))[:, 240:]
+    return traces.copy().view('<f4')
+
+
 def read_asofi3d_json(json_filename):
     with open(json_filename) as fp:
         line_list = fp.readlines()
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# Regression test 16.
+# Checks the 16-bit storage of the material parameters (MAT_PRECISION).
+# The model of test 10 is computed with FP32, FP16 and BF16 material
+# parameters and the maximum deviation of the FP16 and BF16 seismograms
+# from the FP32 seismograms is reported. The deviation must stay below
+# 1 % of the peak amplitude.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_16"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: FP32 (0), FP16 (1) and BF16 (2) material parameters,
+# seismograms in SU format.
+for prec in 0 1 2; do
+    sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+        -e "s/\"L\" : \"0\",/&\n\t\t\t\"MAT_PRECISION\" : \"${prec}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${prec}.log"
+    mv tmp/su/test_p.su "tmp/su/test_p_${prec}.su"
+done
+
+# Compare with the FP32 seismograms.
+for prec in 1 2; do
+    tests/compare_datasets.py \
+        "tmp/su/test_p_${prec}.su" tmp/su/test_p_0.su \
+        --rtol=0 --atol=1e-2 --atol-peak --report
+    result=$?
+    if [ "$result" -ne "0" ]; then
+        error "Seismograms (pressure) with MAT_PRECISION=${prec} differ"
+    fi
+done
+
+log "PASS"
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Regression test 17.
+# Checks the table of media (MAT_COMPRESS).
+# The model of test 10 is computed with dense material parameters and with
+# the table of media and index volume. The seismograms must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_17"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: dense arrays (0) and table of media (1), seismograms in SU
+# format.
+for compress in 0 1; do
+    sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+        -e "s/\"L\" : \"0\",/&\n\t\t\t\"MAT_COMPRESS\" : \"${compress}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${compress}.log"
+    mv tmp/su/test_p.su "tmp/su/test_p_${compress}.su"
+done
+
+tests/compare_datasets.py tmp/su/test_p_1.su tmp/su/test_p_0.su \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) with MAT_COMPRESS=1 differ"
+fi
+
+log "PASS"
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Regression test 18.
+# Checks the vectorized float conversions for SEG-Y/SU files (segy_conv.c).
+# The SSE2 and AVX2 kernels must give the same results as the scalar code
+# in rwsegy.c for all 2^32 bit patterns.
+. tests/functions.sh
+
+readonly TEST_ID="TEST_18"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+log "Compiling 'segy_conv_bench'. See tmp/make.log for details"
+make --directory=src segy_conv_bench > tmp/make.log
+if [ "$?" -ne 0 ]; then
+    error "Compilation of segy_conv_bench failed"
+fi
+
+bin/segy_conv_bench -check > tmp/log/segy_conv_bench.log
+result=$?
+cat tmp/log/segy_conv_bench.log > /dev/stderr
+if [ "$result" -ne "0" ]; then
+    error "Vectorized and scalar float conversions differ"
+fi
+
+log "PASS"
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Regression test 19.
+# Checks the compressed snapshots (SNAP_COMPRESS).
+# The model of test 10 is computed with uncompressed, lossless and lossy
+# (relative error bound 1e-3) snapshots of the particle velocity, which
+# are merged by snapmerge. The lossless snapshots must be identical to the
+# uncompressed ones, the lossy ones must stay within the error bound.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_19"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: no compression (0), lossless (1) and relative error bound (3),
+# snapshots of the particle velocity.
+for compress in 0 1 3; do
+    sed -e 's/"SNAP" : "0"/"SNAP" : "1"/' \
+        -e 's/"TSNAP1" : "0.5"/"TSNAP1" : "0.1"/' \
+        -e 's/"TSNAP2" : "0.6"/"TSNAP2" : "0.2"/' \
+        -e 's/"TSNAPINC" : "0.2"/"TSNAPINC" : "0.05"/' \
+        -e "s/\"SNAP_FORMAT\" : \"3\",/&\n\t\t\t\"SNAP_COMPRESS\" : \"${compress}\",\n\t\t\t\"SNAP_TOL\" : \"1e-3\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${compress}.log"
+    for comp in vx vy vz; do
+        mv "tmp/snap/test.bin.${comp}" "tmp/snap/test_${compress}.bin.${comp}"
+    done
+done
+
+for comp in vx vy vz; do
+    if ! cmp -s "tmp/snap/test_1.bin.${comp}" "tmp/snap/test_0.bin.${comp}"; then
+        error "Lossless snapshots (${comp}) differ"
+    fi
+    python3 -c "
+import sys
+import numpy as np
+a = np.fromfile(sys.argv[1], dtype=np.float32).astype(np.float64)
+b = np.fromfile(sys.argv[2], dtype=np.float32).astype(np.float64)
+print('max. deviation %e, bound %e' % (abs(a - b).max(), 1e-3 * abs(b).max()))
+sys.exit(int(a.shape != b.shape or abs(a - b).max() > 1e-3 * abs(b).max()))
+" "tmp/snap/test_3.bin.${comp}" "tmp/snap/test_0.bin.${comp}"
+    if [ "$?" -ne "0" ]; then
+        error "Lossy snapshots (${comp}) exceed the error bound"
+    fi
+done
+
+log "PASS"
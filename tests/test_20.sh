@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Regression test 20.
+# Checks the load-balanced domain decomposition (DECOMP).
+# The model of test 10 is computed with sub grids of equal size and with
+# sub grids balanced for the cost of the CPML frame, which differ in size.
+# The seismograms must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_20"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: equal (0) and balanced (1) sub grids, seismograms in SU format.
+for decomp in 0 1; do
+    sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+        -e "s/\"NPROCZ\" : \"4\",/&\n\t\t\t\"DECOMP\" : \"${decomp}\",\n\t\t\t\"DECOMP_CPML\" : \"4.0\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${decomp}.log"
+    mv tmp/su/test_p.su "tmp/su/test_p_${decomp}.su"
+done
+
+tests/compare_datasets.py tmp/su/test_p_1.su tmp/su/test_p_0.su \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) with DECOMP=1 differ"
+fi
+
+log "PASS"
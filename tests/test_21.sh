@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+# Regression test 21.
+# Checks the automatic choice of NPROCX, NPROCY and NPROCZ.
+# The model of test 10 is computed with the 2x2x4 PEs given in the parameter
+# file and with 12 PEs whose layout is chosen by the program
+# (NPROCX=NPROCY=NPROCZ=0). The seismograms must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_21"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: given (fixed) and automatic (auto) decomposition, seismograms
+# in SU format.
+sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+    "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+run_solver np=16 dir=tmp log="ASOFI3D_fixed.log"
+mv tmp/su/test_p.su "tmp/su/test_p_fixed.su"
+
+sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+    -e 's/"NPROC\([XYZ]\)" : "[0-9]*"/"NPROC\1" : "0"/' \
+    "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+run_solver np=12 dir=tmp log="ASOFI3D_auto.log"
+mv tmp/su/test_p.su "tmp/su/test_p_auto.su"
+
+if ! grep -q "Automatic domain decomposition" tmp/ASOFI3D_auto.log; then
+    error "No automatic domain decomposition in the log file"
+fi
+
+tests/compare_datasets.py tmp/su/test_p_auto.su tmp/su/test_p_fixed.su \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) with automatic decomposition differ"
+fi
+
+log "PASS"
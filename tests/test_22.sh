@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Regression test 22.
+# Checks the overlap of the exchange between PEs with the update of the
+# interior of the sub grids (OVERLAP_COMM).
+# The model of test 10 is computed with the blocking exchange and with the
+# overlapped exchange. The seismograms must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_22"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: blocking (0) and overlapped (1) exchange, seismograms in SU
+# format.
+for overlap in 0 1; do
+    sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+        -e "s/\"NPROCZ\" : \"4\",/&\n\t\t\t\"OVERLAP_COMM\" : \"${overlap}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${overlap}.log"
+    mv tmp/su/test_p.su "tmp/su/test_p_${overlap}.su"
+done
+
+tests/compare_datasets.py tmp/su/test_p_1.su tmp/su/test_p_0.su \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) with OVERLAP_COMM=1 differ"
+fi
+
+log "PASS"
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Regression test 23.
+# Checks the input of model files with MPI-IO (READMOD=1).
+# Random P-wave, S-wave and density models on the grid of test 10 are read
+# by sub grids of different size (DECOMP=1). Each PE writes the model it
+# has read, and the files merged by mergemod must be identical to the
+# input files.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_23"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Random models, y running fastest, then x, then z.
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(23)
+n = 200 * 200 * 200
+for ext, lo, hi in (('vp', 2800, 3300), ('vs', 1500, 1900), ('rho', 1900, 2100)):
+    rng.uniform(lo, hi, n).astype(np.float32).tofile('tmp/model/test.' + ext)
+"
+if [ "$?" -ne "0" ]; then
+    error "Could not create the model files"
+fi
+
+# Run code: a few time steps with the models read from file and written
+# back without decimation.
+sed -e 's/"READMOD" : "0"/"READMOD" : "1"/' \
+    -e 's/"WRITE_MODELFILES" : "0"/"WRITE_MODELFILES" : "1"/' \
+    -e 's/"TIME" : "0.23"/"TIME" : "0.005"/' \
+    -e 's/"ID\([XYZ]\)" : "2"/"ID\1" : "1"/' \
+    -e "s/\"NPROCZ\" : \"4\",/&\n\t\t\t\"DECOMP\" : \"1\",\n\t\t\t\"DECOMP_CPML\" : \"4.0\",/" \
+    "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+for ext in vp vs rho; do
+    if ! cmp -s "tmp/model/test.SOFI3D.${ext}" "tmp/model/test.${ext}"; then
+        error "Model (${ext}) read with MPI-IO differs from the model file"
+    fi
+done
+
+log "PASS"
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Regression test 24.
+# Checks the snapshots written with MPI-IO (SNAP_MPIIO).
+# The model of test 10 is computed with snapshots of the particle velocity
+# written into one file per PE, merged by snapmerge, and written into one
+# file per component with MPI-IO. The merged files must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_24"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: files per PE (0) and MPI-IO (1), snapshots of the particle
+# velocity.
+for mpiio in 0 1; do
+    sed -e 's/"SNAP" : "0"/"SNAP" : "1"/' \
+        -e 's/"TSNAP1" : "0.5"/"TSNAP1" : "0.1"/' \
+        -e 's/"TSNAP2" : "0.6"/"TSNAP2" : "0.2"/' \
+        -e 's/"TSNAPINC" : "0.2"/"TSNAPINC" : "0.05"/' \
+        -e "s/\"SNAP_FORMAT\" : \"3\",/&\n\t\t\t\"SNAP_MPIIO\" : \"${mpiio}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${mpiio}.log"
+    for comp in vx vy vz; do
+        mv "tmp/snap/test.bin.${comp}" "tmp/snap/test_${mpiio}.bin.${comp}"
+    done
+done
+
+for comp in vx vy vz; do
+    if ! cmp -s "tmp/snap/test_1.bin.${comp}" "tmp/snap/test_0.bin.${comp}"; then
+        error "Snapshots (${comp}) written with MPI-IO differ"
+    fi
+done
+
+log "PASS"
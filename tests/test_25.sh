@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Regression test 25.
+# Checks the restart of a simulation from a checkpoint (CHECKPTREAD).
+# The model of test 10 is computed without interruption, and it is
+# computed with periodic checkpoints (CHECKPT_INC) in files of the PEs
+# written by threads and in one file written with MPI-IO. The runs with
+# checkpoints are terminated after the first checkpoint and resumed from
+# it; the seismograms must be identical to those of the uninterrupted run.
+# A checkpoint which does not match the parameters of the simulation and a
+# corrupted checkpoint must be rejected.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_25"
+
+# Checkpoint files as seen from the directory `tmp`.
+readonly CHECKPT_FILE="tmp/tmp/checkpoint_sofi3D"
+
+# Write the parameter file, seismograms in SU format and checkpoints every
+# 200 time steps, with the given additional sed expression.
+# USAGE: write_par mpiio read write [sed-expression]
+write_par() {
+    sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+        -e "s/\"CHECKPTREAD\" : \"0\"/\"CHECKPTREAD\" : \"$2\"/" \
+        -e "s/\"CHECKPTWRITE\" : \"0\"/\"CHECKPTWRITE\" : \"$3\"/" \
+        -e "s/\"NPROCZ\" : \"4\",/&\n\t\t\t\"CHECKPT_INC\" : \"200\",\n\t\t\t\"CHECKPT_MPIIO\" : \"$1\",/" \
+        -e "${4:-s/^//}" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+}
+
+# Run the solver, which must terminate with the given error message.
+# USAGE: run_solver_error log message
+run_solver_error() {
+    log "Running solver. Output is captured to tmp/$1"
+    if ./run_asofi3D.sh 16 tmp > "tmp/$1" 2>&1; then
+        error "Solver did not reject the checkpoint ($1)"
+    fi
+    if ! grep -q "$2" "tmp/$1"; then
+        error "Solver did not report: $2"
+    fi
+}
+
+# Number of complete checkpoint files.
+count_checkpoint_files() {
+    ls "${CHECKPT_FILE}"* 2> /dev/null | grep -vc '\.tmp$'
+}
+
+# Setup function prepares environment for the test (creates directories).
+setup
+mkdir tmp/tmp
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code without interruption.
+write_par 0 0 0
+run_solver np=16 dir=tmp log=ASOFI3D_ref.log
+mv tmp/su/test_p.su tmp/su/test_p_ref.su
+
+# Run code with checkpoints in files of the PEs (0) and in one file (1).
+for mpiio in 0 1; do
+    if [ "$mpiio" -eq "0" ]; then nfiles=16; else nfiles=1; fi
+    rm -f "${CHECKPT_FILE}"*
+
+    # Terminate the run when the first checkpoint is complete.
+    write_par "$mpiio" 0 1
+    log "Running solver. Output is captured to tmp/ASOFI3D_${mpiio}_1.log"
+    setsid ./run_asofi3D.sh 16 tmp > "tmp/ASOFI3D_${mpiio}_1.log" 2>&1 &
+    pid=$!
+    while kill -0 "$pid" 2> /dev/null; do
+        if [ "$(count_checkpoint_files)" -eq "$nfiles" ]; then
+            kill -TERM -- -"$pid"
+            break
+        fi
+        sleep 0.2
+    done
+    wait "$pid"
+    if grep -q "Saving wavefield to check-point file" \
+            "tmp/ASOFI3D_${mpiio}_1.log"; then
+        error "The run finished before it could be terminated"
+    fi
+    if [ "$(count_checkpoint_files)" -ne "$nfiles" ]; then
+        error "Checkpoint files (CHECKPT_MPIIO=${mpiio}) are missing"
+    fi
+    mkdir -p "tmp/checkpoint_${mpiio}"
+    cp "${CHECKPT_FILE}"* "tmp/checkpoint_${mpiio}/"
+
+    # Corrupted data.
+    file="${CHECKPT_FILE}"
+    if [ "$mpiio" -eq "0" ]; then file="${CHECKPT_FILE}.0"; fi
+    printf '\x7f' | dd of="$file" bs=1 seek=$(( $(stat -c %s "$file") - 2 )) \
+        conv=notrunc 2> /dev/null
+    write_par "$mpiio" 1 0
+    run_solver_error "ASOFI3D_${mpiio}_checksum.log" "Checksum of checkpoint file"
+    cp "tmp/checkpoint_${mpiio}/"* tmp/tmp/
+
+    # Checkpoint of a simulation with a different width of the CPML frame.
+    if [ "$mpiio" -eq "0" ]; then
+        write_par "$mpiio" 1 0 's/"FW" : "25"/"FW" : "20"/'
+        run_solver_error "ASOFI3D_${mpiio}_header.log" "FW is 25 instead of 20"
+    fi
+
+    # Resume the run.
+    write_par "$mpiio" 1 0
+    run_solver np=16 dir=tmp log="ASOFI3D_${mpiio}_2.log"
+    if ! grep -q "Resuming shot 1 at time step" "tmp/ASOFI3D_${mpiio}_2.log"; then
+        error "The run (CHECKPT_MPIIO=${mpiio}) was not resumed"
+    fi
+    mv tmp/su/test_p.su "tmp/su/test_p_${mpiio}.su"
+
+    tests/compare_datasets.py "tmp/su/test_p_${mpiio}.su" tmp/su/test_p_ref.su \
+        --rtol=0 --atol=0
+    result=$?
+    if [ "$result" -ne "0" ]; then
+        error "Seismograms (pressure) resumed with CHECKPT_MPIIO=${mpiio} differ"
+    fi
+done
+
+log "PASS"
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Regression test 26.
+# Checks the streaming of the seismograms to temporary files (SEIS_BLOCK).
+# The model of test 10 is computed with the whole seismograms in memory and
+# with blocks of 64 samples per trace, the last block being incomplete. The
+# SEG-Y files must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_26"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: whole seismograms (0) and blocks of 64 samples (64).
+for block in 0 64; do
+    sed -e "s/\"SEIS_FORMAT\" : \"5\",/&\n\t\t\t\"SEIS_BLOCK\" : \"${block}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${block}.log"
+    mv tmp/su/test_p.sgy "tmp/su/test_p_${block}.sgy"
+done
+
+if ls tmp/su/*.blk.* > /dev/null 2>&1; then
+    error "Temporary seismogram files were not removed"
+fi
+
+if ! cmp -s tmp/su/test_p_64.sgy tmp/su/test_p_0.sgy; then
+    error "Seismograms (pressure) with SEIS_BLOCK=64 differ"
+fi
+
+log "PASS"
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Regression test 27.
+# Checks the output of the seismograms with MPI-IO (SEIS_MPIIO).
+# The model of test 10 is computed with the seismograms collected and
+# written by PE 0 and with the traces written by the PEs which recorded
+# them. The SEG-Y files (IBM floats, big endian) must be identical.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_27"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: output by PE 0 (0) and by all PEs with MPI-IO (1).
+for mpiio in 0 1; do
+    sed -e "s/\"SEIS_FORMAT\" : \"5\",/&\n\t\t\t\"SEIS_MPIIO\" : \"${mpiio}\",/" \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    run_solver np=16 dir=tmp log="ASOFI3D_${mpiio}.log"
+    mv tmp/su/test_p.sgy "tmp/su/test_p_${mpiio}.sgy"
+done
+
+if ! cmp -s tmp/su/test_p_1.sgy tmp/su/test_p_0.sgy; then
+    error "Seismograms (pressure) with SEIS_MPIIO=1 differ"
+fi
+
+log "PASS"
@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Regression test 28.
+# Checks the snapshots of planes and boxes (SNAP_PLAN).
+# The model of test 10 is computed with snapshots of the whole model of
+# the particle velocity without decimation, merged by snapmerge, and with
+# snapshots of the planes y=1, x=100 and z=120 and a box, written with
+# MPI-IO. The planes and the box must be identical to the parts of the
+# whole snapshots.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_28"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_elastic.c"    src/
+cp "${TEST_PATH}/source.dat"         tmp/sources/
+cp "${TEST_PATH}/receiver.dat"       tmp/receiver/
+
+compile_code
+
+# Run code: whole model (all) and plan (plan), snapshots of the particle
+# velocity at 0.1 s and 0.2 s.
+for plan in all "y=1;x=100;z=120;x=50:150\/y=1:80\/z=60:180"; do
+    if [ "$plan" = "all" ]; then name=all; else name=plan; fi
+    sed -e 's/"SNAP" : "0"/"SNAP" : "1"/' \
+        -e 's/"TSNAP1" : "0.5"/"TSNAP1" : "0.1"/' \
+        -e 's/"TSNAP2" : "0.6"/"TSNAP2" : "0.2"/' \
+        -e 's/"TSNAPINC" : "0.2"/"TSNAPINC" : "0.1"/' \
+        -e 's/"ID\([XYZ]\)" : "2"/"ID\1" : "1"/' \
+        "${TEST_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+    if [ "$name" = "plan" ]; then
+        sed -i "s/\"SNAP_FORMAT\" : \"3\",/&\n\t\t\t\"SNAP_PLAN\" : \"${plan}\",/" \
+            tmp/in_and_out/asofi3D.json
+    fi
+    run_solver np=16 dir=tmp log="ASOFI3D_${name}.log"
+done
+
+for comp in vx vy vz; do
+    python3 -c "
+import sys
+import numpy as np
+prefix = sys.argv[1]
+# snapshots of the whole model, z slowest and y fastest
+a = np.fromfile(prefix, dtype=np.float32).reshape(-1, 200, 200, 200)
+parts = {'y1': a[:, :, :, 0:1], 'x100': a[:, :, 99:100, :],
+         'z120': a[:, 119:120, :, :], 'box4': a[:, 59:180, 49:150, 0:80]}
+ok = True
+for tag, part in parts.items():
+    b = np.fromfile(prefix + '.' + tag, dtype=np.float32)
+    same = (b.size == part.size) and np.array_equal(b, part.ravel())
+    print('%s.%s: %s' % (prefix, tag, 'identical' if same else 'differs'))
+    ok = ok and same
+sys.exit(int(not ok))
+" "tmp/snap/test.bin.${comp}"
+    if [ "$?" -ne "0" ]; then
+        error "Snapshots (${comp}) of SNAP_PLAN differ from the whole model"
+    fi
+done
+
+log "PASS"
@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+# Regression test 29.
+# Checks the split fields of the acoustic PML, which are only stored within
+# the PML blocks of the frame.
+# The acoustic modelling program computes a homogeneous model on the grid
+# of test 10 with the PML frame (ABS_TYPE=1). The seismograms must be
+# identical to the seismograms computed by the previous version, which
+# stored the split fields in the whole sub grids.
+. tests/functions.sh
+
+readonly MODEL="src/model_acoustic.c"
+readonly TEST_PATH="tests/fixtures/test_29"
+readonly INPUT_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_29"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${TEST_PATH}/model_acoustic.c"   src/
+cp "${INPUT_PATH}/source.dat"        tmp/sources/
+cp "${INPUT_PATH}/receiver.dat"      tmp/receiver/
+sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+    "${INPUT_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+
+log "Compiling 'sofi3D_acoustic'. See tmp/make.log for details"
+make --directory=src sofi3D_acoustic > tmp/make.log
+if [ "$?" -ne 0 ]; then
+    error "Compilation of sofi3D_acoustic failed"
+fi
+
+log "Running solver. Output is captured to tmp/ASOFI3D.log"
+(cd tmp && mpirun -n 16 nice -19 ../bin/sofi3D_acoustic in_and_out/asofi3D.json) \
+    > tmp/ASOFI3D.log &
+animate_progress $! "Running solver..."
+if [ $? -ne 0 ]; then
+    error "Running solver failed"
+fi
+
+tests/compare_datasets.py tmp/su/test_p.su "${TEST_PATH}/su/ref_p.su" \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) differ"
+fi
+
+log "PASS"
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Regression test 30.
+# Checks the CPML frame, which is updated in precomputed boxes of its
+# faces, edges and corners, next to a free surface.
+# The model of test 10 is computed with a free surface and fourth order
+# spatial operators. The seismograms must be identical to the seismograms
+# computed by the previous version, which tested the position of every
+# grid point within the frame.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_30"
+readonly INPUT_PATH="tests/fixtures/test_10"
+readonly TEST_ID="TEST_30"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy input to the directory where the test is executed.
+cp "${INPUT_PATH}/model_elastic.c"   src/
+cp "${INPUT_PATH}/source.dat"        tmp/sources/
+cp "${INPUT_PATH}/receiver.dat"      tmp/receiver/
+sed -e 's/"SEIS_FORMAT" : "5"/"SEIS_FORMAT" : "1"/' \
+    -e 's/"FREE_SURF" : "0"/"FREE_SURF" : "1"/' \
+    -e 's/"FDORDER" : "2"/"FDORDER" : "4"/' \
+    "${INPUT_PATH}/asofi3D.json" > tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+tests/compare_datasets.py tmp/su/test_p.su "${TEST_PATH}/su/ref_p.su" \
+    --rtol=0 --atol=0
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Seismograms (pressure) differ"
+fi
+
+log "PASS"